@@ -241,6 +241,17 @@ enum DW_SECT
   DW_SECT_MAX = DW_SECT_MACRO,
 };
 
+// Index attributes used in the DWARF 5 .debug_names section.
+
+enum DW_IDX
+{
+  DW_IDX_compile_unit = 1,
+  DW_IDX_type_unit = 2,
+  DW_IDX_die_offset = 3,
+  DW_IDX_parent = 4,
+  DW_IDX_type_hash = 5,
+};
+
 } // End namespace elfcpp.
 
 #endif // !defined(ELFCPP_DWARF_H)
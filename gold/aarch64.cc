@@ -29,6 +29,7 @@
 #include "elfcpp.h"
 #include "dwarf.h"
 #include "parameters.h"
+#include "gold-threads.h"
 #include "reloc.h"
 #include "aarch64.h"
 #include "object.h"
@@ -1368,9 +1369,55 @@ class Stub_table : public Output_data
   typedef std::set<The_erratum_stub*, The_erratum_stub_less> Erratum_stub_set;
   typedef typename Erratum_stub_set::iterator Erratum_stub_set_iter;
 
+  // A branch in the stub group of this table which may need a stub.
+  // The relocation is read once, in the first relaxation pass.  Later
+  // passes only recompute the addresses of the branch and of its
+  // destination, and look for a stub if they no longer match.
+  struct Branch
+  {
+    // The object and the index of the section containing the branch.
+    The_aarch64_relobj* relobj;
+    unsigned int shndx;
+    // The relocation.
+    unsigned int r_type;
+    unsigned int r_sym;
+    AArch64_address r_offset;
+    typename elfcpp::Elf_types<size>::Elf_Swxword addend;
+    // The global symbol, or NULL for a local symbol.
+    const Sized_symbol<size>* gsym;
+    // Whether the symbol is defined in a discarded section, and if so
+    // whether to pretend that it is defined in the kept section.
+    bool is_defined_in_discarded_section;
+    bool use_kept_section;
+    // Whether the branch has been examined in any pass.
+    bool examined;
+    // The addresses of the branch and of its destination when the
+    // branch was last examined, and the stub it used then, if any.
+    AArch64_address address;
+    AArch64_address destination;
+    The_reloc_stub* stub;
+  };
+
+  typedef std::vector<Branch> Branch_list;
+
+  // A warning found while reading the branches.  Branches may be read
+  // in parallel, so the warnings are recorded and reported later, in
+  // input order.
+  struct Branch_warning
+  {
+    // The relocation section, the section it applies to, and the
+    // index and offset of the relocation.
+    unsigned int reloc_shndx;
+    unsigned int data_shndx;
+    size_t relnum;
+    AArch64_address r_offset;
+  };
+
+  typedef std::vector<Branch_warning> Branch_warning_list;
+
   Stub_table(The_aarch64_input_section* owner)
     : Output_data(), owner_(owner), reloc_stubs_size_(0),
-      erratum_stubs_size_(0), prev_data_size_(0)
+      erratum_stubs_size_(0), prev_data_size_(0), branches_()
   { }
 
   ~Stub_table()
@@ -1421,10 +1468,15 @@ class Stub_table : public Output_data
     return r;
   }
 
-  // Finalize stubs. No-op here, just for completeness.
+  // Finalize stubs.  We no longer need the branches.
   void
   finalize_stubs()
-  { }
+  { Branch_list().swap(this->branches_); }
+
+  // Return the branches in the stub group of this table.
+  Branch_list&
+  branches()
+  { return this->branches_; }
 
   // Look up a relocation stub using KEY. Return NULL if there is none.
   The_reloc_stub*
@@ -1504,6 +1556,8 @@ class Stub_table : public Output_data
   off_t erratum_stubs_size_;
   // data size of this in the previous pass.
   off_t prev_data_size_;
+  // The branches which may need stubs in this table.
+  Branch_list branches_;
 };  // End of Stub_table
 
 
@@ -1757,10 +1811,19 @@ class AArch64_relobj : public Sized_relobj_file<size, big_endian>
 	      Output_section*, const Symbol_table*,
 	      The_target_aarch64*);
 
-  // Scan all relocation sections for stub generation.
+  // Scan all text sections for errata.
+  void
+  scan_sections_for_errata(The_target_aarch64*, const Symbol_table*);
+
+  // Read the branches which may need relocation stubs from all
+  // relocation sections, and add them to BRANCHES.  Add the warnings
+  // to WARNINGS.
   void
-  scan_sections_for_stubs(The_target_aarch64*, const Symbol_table*,
-			  const Layout*);
+  read_branches_for_stubs(The_target_aarch64*, const Symbol_table*,
+			  const Layout*,
+			  typename The_stub_table::Branch_list* branches,
+			  typename The_stub_table::Branch_warning_list*
+			    warnings);
 
   // Whether a section is a scannable text section.
   bool
@@ -2139,7 +2202,7 @@ AArch64_relobj<size, big_endian>::text_section_is_scannable(
 
 
 // Determine if we want to scan the SHNDX-th section for relocation stubs.
-// This is a helper for AArch64_relobj::scan_sections_for_stubs().
+// This is a helper for AArch64_relobj::read_branches_for_stubs().
 
 template<int size, bool big_endian>
 bool
@@ -2256,14 +2319,47 @@ AArch64_relobj<size, big_endian>::scan_errata(
 }
 
 
-// Scan relocations for stub generation.
+// Scan the text sections for errata.  Erratum stubs depend on the
+// exact addresses of the instructions, so this is done in every
+// relaxation pass.
+
+template<int size, bool big_endian>
+void
+AArch64_relobj<size, big_endian>::scan_sections_for_errata(
+    The_target_aarch64* target,
+    const Symbol_table* symtab)
+{
+  unsigned int shnum = this->shnum();
+  const unsigned int shdr_size = elfcpp::Elf_sizes<size>::shdr_size;
+
+  // Read the section headers.
+  const unsigned char* pshdrs = this->get_view(this->elf_file()->shoff(),
+					       shnum * shdr_size,
+					       true, true);
+
+  const Relobj::Output_sections& out_sections(this->output_sections());
+
+  const unsigned char* p = pshdrs + shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += shdr_size)
+    {
+      const elfcpp::Shdr<size, big_endian> shdr(p);
+      scan_errata(i, shdr, out_sections[i], symtab, target);
+    }
+}
+
+
+// Read the branches which may need relocation stubs.  This is done
+// once, in the first relaxation pass, and may run in parallel for
+// objects in different files.
 
 template<int size, bool big_endian>
 void
-AArch64_relobj<size, big_endian>::scan_sections_for_stubs(
+AArch64_relobj<size, big_endian>::read_branches_for_stubs(
     The_target_aarch64* target,
     const Symbol_table* symtab,
-    const Layout* layout)
+    const Layout* layout,
+    typename The_stub_table::Branch_list* branches,
+    typename The_stub_table::Branch_warning_list* warnings)
 {
   unsigned int shnum = this->shnum();
   const unsigned int shdr_size = elfcpp::Elf_sizes<size>::shdr_size;
@@ -2284,58 +2380,27 @@ AArch64_relobj<size, big_endian>::scan_sections_for_stubs(
   relinfo.layout = layout;
   relinfo.object = this;
 
-  // Do relocation stubs scanning.
   const unsigned char* p = pshdrs + shdr_size;
   for (unsigned int i = 1; i < shnum; ++i, p += shdr_size)
     {
       const elfcpp::Shdr<size, big_endian> shdr(p);
-      if (parameters->options().fix_cortex_a53_843419()
-	  || parameters->options().fix_cortex_a53_835769())
-	scan_errata(i, shdr, out_sections[i], symtab, target);
       if (this->section_needs_reloc_stub_scanning(shdr, out_sections, symtab,
 						  pshdrs))
 	{
 	  unsigned int index = this->adjust_shndx(shdr.get_sh_info());
-	  AArch64_address output_offset =
-	      this->get_output_section_offset(index);
-	  AArch64_address output_address;
-	  if (output_offset != invalid_address)
-	    {
-	      output_address = out_sections[index]->address() + output_offset;
-	    }
-	  else
-	    {
-	      // Currently this only happens for a relaxed section.
-	      const Output_relaxed_input_section* poris =
-		  out_sections[index]->find_relaxed_input_section(this, index);
-	      gold_assert(poris != NULL);
-	      output_address = poris->address();
-	    }
 
 	  // Get the relocations.
 	  const unsigned char* prelocs = this->get_view(shdr.get_sh_offset(),
 							shdr.get_sh_size(),
 							true, false);
 
-	  // Get the section contents.
-	  section_size_type input_view_size = 0;
-	  const unsigned char* input_view =
-	      this->section_contents(index, &input_view_size, false);
-
 	  relinfo.reloc_shndx = i;
 	  relinfo.data_shndx = index;
-	  unsigned int sh_type = shdr.get_sh_type();
-	  unsigned int reloc_size;
-	  gold_assert (sh_type == elfcpp::SHT_RELA);
-	  reloc_size = elfcpp::Elf_sizes<size>::rela_size;
-
-	  Output_section* os = out_sections[index];
-	  target->scan_section_for_stubs(&relinfo, sh_type, prelocs,
-					 shdr.get_sh_size() / reloc_size,
-					 os,
-					 output_offset == invalid_address,
-					 input_view, output_address,
-					 input_view_size);
+	  gold_assert(shdr.get_sh_type() == elfcpp::SHT_RELA);
+	  const unsigned int reloc_size = elfcpp::Elf_sizes<size>::rela_size;
+	  target->read_reloc_section_for_stubs(&relinfo, prelocs,
+					       shdr.get_sh_size() / reloc_size,
+					       branches, warnings);
 	}
     }
 }
@@ -2791,6 +2856,10 @@ class Target_aarch64 : public Sized_target<size, big_endian>
   typedef Erratum_stub<size, big_endian> The_erratum_stub;
   typedef typename Reloc_stub<size, big_endian>::Key The_reloc_stub_key;
   typedef Stub_table<size, big_endian> The_stub_table;
+  typedef typename The_stub_table::Branch The_stub_branch;
+  typedef typename The_stub_table::Branch_list Stub_branch_list;
+  typedef typename The_stub_table::Branch_warning_list
+      Stub_branch_warning_list;
   typedef std::vector<The_stub_table*> Stub_table_list;
   typedef typename Stub_table_list::iterator Stub_table_iterator;
   typedef AArch64_input_section<size, big_endian> The_aarch64_input_section;
@@ -2808,7 +2877,8 @@ class Target_aarch64 : public Sized_target<size, big_endian>
       rela_irelative_(NULL), copy_relocs_(elfcpp::R_AARCH64_COPY),
       got_mod_index_offset_(-1U),
       tlsdesc_reloc_info_(), tls_base_symbol_defined_(false),
-      stub_tables_(), stub_group_size_(0), aarch64_input_section_map_()
+      stub_tables_(), stub_group_size_(0), aarch64_input_section_map_(),
+      relax_stats_()
   { }
 
   // Scan the relocations to determine unreferenced sections for
@@ -2840,6 +2910,19 @@ class Target_aarch64 : public Sized_target<size, big_endian>
 	      size_t local_symbol_count,
 	      const unsigned char* plocal_symbols);
 
+  // Prescan the relocations, dropping the ones that need no work.
+  bool
+  prescan_relocs(Symbol_table* symtab,
+		 Sized_relobj_file<size, big_endian>* object,
+		 unsigned int data_shndx,
+		 unsigned int sh_type,
+		 const unsigned char* prelocs,
+		 size_t reloc_count,
+		 bool needs_special_offset_handling,
+		 size_t local_symbol_count,
+		 const unsigned char* plocal_symbols,
+		 std::vector<unsigned char>* pending);
+
   // Finalize the sections.
   void
   do_finalize_sections(Layout*, const Input_objects*, Symbol_table*);
@@ -2967,26 +3050,13 @@ class Target_aarch64 : public Sized_target<size, big_endian>
   unsigned int
   tcb_size() const { return This::TCB_SIZE; }
 
-  // Scan a section for stub generation.
-  void
-  scan_section_for_stubs(const Relocate_info<size, big_endian>*, unsigned int,
-			 const unsigned char*, size_t, Output_section*,
-			 bool, const unsigned char*,
-			 Address,
-			 section_size_type);
-
-  // Scan a relocation section for stub.
-  template<int sh_type>
+  // Read the branches which may need stubs from a relocation section.
   void
-  scan_reloc_section_for_stubs(
-      const The_relocate_info* relinfo,
-      const unsigned char* prelocs,
-      size_t reloc_count,
-      Output_section* output_section,
-      bool needs_special_offset_handling,
-      const unsigned char* view,
-      Address view_address,
-      section_size_type);
+  read_reloc_section_for_stubs(const The_relocate_info* relinfo,
+			       const unsigned char* prelocs,
+			       size_t reloc_count,
+			       Stub_branch_list* branches,
+			       Stub_branch_warning_list* warnings);
 
   // Relocate a single stub.
   void
@@ -3083,12 +3153,45 @@ class Target_aarch64 : public Sized_target<size, big_endian>
 		 bool stubs_always_after_branch,
 		 const Task* task);
 
+  // Print statistics about the relaxation passes.
+  virtual void
+  do_print_relax_stats() const;
+
+  // Read the branches which may need stubs from all the objects.
   void
-  scan_reloc_for_stub(const The_relocate_info*, unsigned int,
-		      const Sized_symbol<size>*, unsigned int,
-		      const Symbol_value<size>*,
-		      typename elfcpp::Elf_types<size>::Elf_Swxword,
-		      Address Elf_Addr);
+  read_stub_branches(const Input_objects*, const Symbol_table*,
+		     const Layout*, const Task*);
+
+  // Examine the branches of all stub groups.
+  void
+  examine_stub_groups(const Symbol_table*, bool first_pass, const Task*);
+
+  // Statistics about examining the branches of one stub group.
+  struct Stub_group_stats
+  {
+    Stub_group_stats()
+      : moved(0), looked_up(0)
+    { }
+
+    // The number of branches which moved relative to their destination.
+    size_t moved;
+    // The number of branches whose stub was looked up.
+    size_t looked_up;
+  };
+
+  // Return the address of a section containing branches.
+  Address
+  stub_branch_section_address(The_aarch64_relobj*, unsigned int) const;
+
+  // Compute the destination of a branch.
+  bool
+  stub_branch_destination(const The_stub_branch&, const Symbol_table*,
+			  const Task*, Address*);
+
+  // Examine the branches of one stub group.
+  void
+  examine_stub_branches(The_stub_table*, const Symbol_table*, const Task*,
+			Stub_group_stats*);
 
   // Make an output section.
   Output_section*
@@ -3105,6 +3208,16 @@ class Target_aarch64 : public Sized_target<size, big_endian>
       : issued_non_pic_error_(false)
     { }
 
+    // Return true if local() or global() would do nothing for a
+    // relocation.  These are called by prescan_relocs.
+    static inline bool
+    local_reloc_is_trivial(unsigned int r_type,
+			   const elfcpp::Sym<size, big_endian>& lsym,
+			   bool is_discarded);
+
+    static inline bool
+    global_reloc_is_trivial(unsigned int r_type, const Symbol* gsym);
+
     inline void
     local(Symbol_table* symtab, Layout* layout, Target_aarch64* target,
 	  Sized_relobj_file<size, big_endian>* object,
@@ -3374,6 +3487,32 @@ class Target_aarch64 : public Sized_target<size, big_endian>
     GOT_TYPE_TLS_DESC = 3       // GOT entry for TLS_DESC pair
   };
 
+  // Statistics about a relaxation pass, for --stats.
+  struct Relax_stats
+  {
+    Relax_stats()
+      : groups(0), groups_examined(0), branches(0), moved(0), looked_up(0)
+    { }
+
+    // The number of stub groups.
+    unsigned int groups;
+    // The number of stub groups with branches which moved.
+    unsigned int groups_examined;
+    // The number of branches which may need stubs.
+    size_t branches;
+    // The number of branches which moved relative to their destination.
+    size_t moved;
+    // The number of branches whose stub was looked up.
+    size_t looked_up;
+  };
+
+  // Jobs which read the branches which may need stubs from all the
+  // objects of one input file.
+  class Read_stub_branches_jobs;
+
+  // Jobs which examine the branches of one stub group.
+  class Examine_stub_groups_jobs;
+
   // This type is used as the argument to the target specific
   // relocation routines.  The only target specific reloc is
   // R_AARCh64_TLSDESC against a local symbol.
@@ -3421,6 +3560,8 @@ class Target_aarch64 : public Sized_target<size, big_endian>
   // Actual stub group size
   section_size_type stub_group_size_;
   AArch64_input_section_map aarch64_input_section_map_;
+  // Statistics about each relaxation pass, for --stats.
+  std::vector<Relax_stats> relax_stats_;
 };  // End of Target_aarch64
 
 
@@ -3716,113 +3857,35 @@ Target_aarch64<size, big_endian>::do_make_elf_object(
 }
 
 
-// Scan a relocation for stub generation.
+// Read the branches which may need stubs from a relocation section.
+// Only the relocation is looked at here; the addresses are computed
+// when the branches are examined.  This may run in parallel for
+// objects in different files, so it must not change anything but
+// BRANCHES and WARNINGS.
 
 template<int size, bool big_endian>
 void
-Target_aarch64<size, big_endian>::scan_reloc_for_stub(
-    const Relocate_info<size, big_endian>* relinfo,
-    unsigned int r_type,
-    const Sized_symbol<size>* gsym,
-    unsigned int r_sym,
-    const Symbol_value<size>* psymval,
-    typename elfcpp::Elf_types<size>::Elf_Swxword addend,
-    Address address)
-{
-  const AArch64_relobj<size, big_endian>* aarch64_relobj =
-      static_cast<AArch64_relobj<size, big_endian>*>(relinfo->object);
-
-  Symbol_value<size> symval;
-  if (gsym != NULL)
-    {
-      const AArch64_reloc_property* arp = aarch64_reloc_property_table->
-	get_reloc_property(r_type);
-      if (gsym->use_plt_offset(arp->reference_flags()))
-	{
-	  // This uses a PLT, change the symbol value.
-	  symval.set_output_value(this->plt_section()->address()
-				  + gsym->plt_offset());
-	  psymval = &symval;
-	}
-      else if (gsym->is_undefined())
-	// There is no need to generate a stub symbol is undefined.
-	return;
-    }
-
-  // Get the symbol value.
-  typename Symbol_value<size>::Value value = psymval->value(aarch64_relobj, 0);
-
-  // Owing to pipelining, the PC relative branches below actually skip
-  // two instructions when the branch offset is 0.
-  Address destination = static_cast<Address>(-1);
-  switch (r_type)
-    {
-    case elfcpp::R_AARCH64_CALL26:
-    case elfcpp::R_AARCH64_JUMP26:
-      destination = value + addend;
-      break;
-    default:
-      gold_unreachable();
-    }
-
-  int stub_type = The_reloc_stub::
-      stub_type_for_reloc(r_type, address, destination);
-  if (stub_type == ST_NONE)
-    return;
-
-  The_stub_table* stub_table = aarch64_relobj->stub_table(relinfo->data_shndx);
-  gold_assert(stub_table != NULL);
-
-  The_reloc_stub_key key(stub_type, gsym, aarch64_relobj, r_sym, addend);
-  The_reloc_stub* stub = stub_table->find_reloc_stub(key);
-  if (stub == NULL)
-    {
-      stub = new The_reloc_stub(stub_type);
-      stub_table->add_reloc_stub(stub, key);
-    }
-  stub->set_destination_address(destination);
-}  // End of Target_aarch64::scan_reloc_for_stub
-
-
-// This function scans a relocation section for stub generation.
-// The template parameter Relocate must be a class type which provides
-// a single function, relocate(), which implements the machine
-// specific part of a relocation.
-
-// BIG_ENDIAN is the endianness of the data.  SH_TYPE is the section type:
-// SHT_REL or SHT_RELA.
-
-// PRELOCS points to the relocation data.  RELOC_COUNT is the number
-// of relocs.  OUTPUT_SECTION is the output section.
-// NEEDS_SPECIAL_OFFSET_HANDLING is true if input offsets need to be
-// mapped to output offsets.
-
-// VIEW is the section data, VIEW_ADDRESS is its memory address, and
-// VIEW_SIZE is the size.  These refer to the input section, unless
-// NEEDS_SPECIAL_OFFSET_HANDLING is true, in which case they refer to
-// the output section.
-
-template<int size, bool big_endian>
-template<int sh_type>
-void inline
-Target_aarch64<size, big_endian>::scan_reloc_section_for_stubs(
-    const Relocate_info<size, big_endian>* relinfo,
+Target_aarch64<size, big_endian>::read_reloc_section_for_stubs(
+    const The_relocate_info* relinfo,
     const unsigned char* prelocs,
     size_t reloc_count,
-    Output_section* /*output_section*/,
-    bool /*needs_special_offset_handling*/,
-    const unsigned char* /*view*/,
-    Address view_address,
-    section_size_type)
+    Stub_branch_list* branches,
+    Stub_branch_warning_list* warnings)
 {
-  typedef typename Reloc_types<sh_type,size,big_endian>::Reloc Reltype;
+  typedef typename Reloc_types<elfcpp::SHT_RELA, size, big_endian>::Reloc
+      Reltype;
 
   const int reloc_size =
-      Reloc_types<sh_type,size,big_endian>::reloc_size;
-  AArch64_relobj<size, big_endian>* object =
-      static_cast<AArch64_relobj<size, big_endian>*>(relinfo->object);
+      Reloc_types<elfcpp::SHT_RELA, size, big_endian>::reloc_size;
+  The_aarch64_relobj* object =
+      static_cast<The_aarch64_relobj*>(relinfo->object);
   unsigned int local_count = object->local_symbol_count();
 
+  // A branch in a section which is not in a stub group can not get a
+  // stub.
+  if (object->stub_table(relinfo->data_shndx) == NULL)
+    return;
+
   gold::Default_comdat_behavior default_comdat_behavior;
   Comdat_behavior comdat_behavior = CB_UNDETERMINED;
 
@@ -3836,22 +3899,24 @@ Target_aarch64<size, big_endian>::scan_reloc_section_for_stubs(
 	  && r_type != elfcpp::R_AARCH64_JUMP26)
 	continue;
 
-      section_offset_type offset =
-	  convert_to_section_size_type(reloc.get_r_offset());
+      The_stub_branch branch;
+      branch.relobj = object;
+      branch.shndx = relinfo->data_shndx;
+      branch.r_type = r_type;
+      branch.r_sym = r_sym;
+      branch.r_offset = reloc.get_r_offset();
+      branch.addend = reloc.get_r_addend();
+      branch.gsym = NULL;
+      branch.is_defined_in_discarded_section = false;
+      branch.use_kept_section = false;
+      branch.examined = false;
+      branch.address = 0;
+      branch.destination = 0;
+      branch.stub = NULL;
 
-      // Get the addend.
-      typename elfcpp::Elf_types<size>::Elf_Swxword addend =
-	  reloc.get_r_addend();
-
-      const Sized_symbol<size>* sym;
-      Symbol_value<size> symval;
-      const Symbol_value<size> *psymval;
-      bool is_defined_in_discarded_section;
-      unsigned int shndx;
       if (r_sym < local_count)
 	{
-	  sym = NULL;
-	  psymval = object->local_symbol(r_sym);
+	  const Symbol_value<size>* psymval = object->local_symbol(r_sym);
 
 	  // If the local symbol belongs to a section we are discarding,
 	  // and that section is a debug section, try to find the
@@ -3859,87 +3924,33 @@ Target_aarch64<size, big_endian>::scan_reloc_section_for_stubs(
 	  // counterpart in the kept section.  The symbol must not
 	  // correspond to a section we are folding.
 	  bool is_ordinary;
-	  shndx = psymval->input_shndx(&is_ordinary);
-	  is_defined_in_discarded_section =
+	  unsigned int shndx = psymval->input_shndx(&is_ordinary);
+	  branch.is_defined_in_discarded_section =
 	    (is_ordinary
 	     && shndx != elfcpp::SHN_UNDEF
 	     && !object->is_section_included(shndx)
 	     && !relinfo->symtab->is_section_folded(object, shndx));
 
-	  // We need to compute the would-be final value of this local
-	  // symbol.
-	  if (!is_defined_in_discarded_section)
-	    {
-	      typedef Sized_relobj_file<size, big_endian> ObjType;
-	      if (psymval->is_section_symbol())
-		symval.set_is_section_symbol();
-	      typename ObjType::Compute_final_local_value_status status =
-		object->compute_final_local_value(r_sym, psymval, &symval,
-						  relinfo->symtab);
-	      if (status == ObjType::CFLV_OK)
-		{
-		  // Currently we cannot handle a branch to a target in
-		  // a merged section.  If this is the case, issue an error
-		  // and also free the merge symbol value.
-		  if (!symval.has_output_value())
-		    {
-		      const std::string& section_name =
-			object->section_name(shndx);
-		      object->error(_("cannot handle branch to local %u "
-					  "in a merged section %s"),
-					r_sym, section_name.c_str());
-		    }
-		  psymval = &symval;
-		}
-	      else
-		{
-		  // We cannot determine the final value.
-		  continue;
-		}
-	    }
+	  // If symbol is a section symbol, we don't know the actual type
+	  // of destination, so it never gets a stub.
+	  if (!branch.is_defined_in_discarded_section
+	      && psymval->is_section_symbol())
+	    continue;
 	}
       else
 	{
-	  const Symbol* gsym;
-	  gsym = object->global_symbol(r_sym);
+	  const Symbol* gsym = object->global_symbol(r_sym);
 	  gold_assert(gsym != NULL);
 	  if (gsym->is_forwarder())
 	    gsym = relinfo->symtab->resolve_forwards(gsym);
 
-	  sym = static_cast<const Sized_symbol<size>*>(gsym);
-	  if (sym->has_symtab_index() && sym->symtab_index() != -1U)
-	    symval.set_output_symtab_index(sym->symtab_index());
-	  else
-	    symval.set_no_output_symtab_entry();
-
-	  // We need to compute the would-be final value of this global
-	  // symbol.
-	  const Symbol_table* symtab = relinfo->symtab;
-	  const Sized_symbol<size>* sized_symbol =
-	      symtab->get_sized_symbol<size>(gsym);
-	  Symbol_table::Compute_final_value_status status;
-	  typename elfcpp::Elf_types<size>::Elf_Addr value =
-	      symtab->compute_final_value<size>(sized_symbol, &status);
-
-	  // Skip this if the symbol has not output section.
-	  if (status == Symbol_table::CFVS_NO_OUTPUT_SECTION)
-	    continue;
-	  symval.set_output_value(value);
-
-	  if (gsym->type() == elfcpp::STT_TLS)
-	    symval.set_is_tls_symbol();
-	  else if (gsym->type() == elfcpp::STT_GNU_IFUNC)
-	    symval.set_is_ifunc_symbol();
-	  psymval = &symval;
-
-	  is_defined_in_discarded_section =
+	  branch.gsym = static_cast<const Sized_symbol<size>*>(gsym);
+	  branch.is_defined_in_discarded_section =
 	      (gsym->is_defined_in_discarded_section()
 	       && gsym->is_undefined());
-	  shndx = 0;
 	}
 
-      Symbol_value<size> symval2;
-      if (is_defined_in_discarded_section)
+      if (branch.is_defined_in_discarded_section)
 	{
 	  if (comdat_behavior == CB_UNDETERMINED)
 	    {
@@ -3947,64 +3958,232 @@ Target_aarch64<size, big_endian>::scan_reloc_section_for_stubs(
 	      comdat_behavior = default_comdat_behavior.get(name.c_str());
 	    }
 	  if (comdat_behavior == CB_PRETEND)
+	    branch.use_kept_section = true;
+	  else if (comdat_behavior == CB_WARNING)
 	    {
-	      bool found;
-	      typename elfcpp::Elf_types<size>::Elf_Addr value =
-		object->map_to_kept_section(shndx, &found);
-	      if (found)
-		symval2.set_output_value(value + psymval->input_value());
-	      else
-		symval2.set_output_value(0);
+	      typename The_stub_table::Branch_warning warning;
+	      warning.reloc_shndx = relinfo->reloc_shndx;
+	      warning.data_shndx = relinfo->data_shndx;
+	      warning.relnum = i;
+	      warning.r_offset = branch.r_offset;
+	      warnings->push_back(warning);
 	    }
-	  else
+	}
+
+      branches->push_back(branch);
+    }
+}  // End of Target_aarch64::read_reloc_section_for_stubs
+
+
+// Return the address of section SHNDX of RELOBJ, which contains
+// branches which may need stubs.
+
+template<int size, bool big_endian>
+typename Target_aarch64<size, big_endian>::Address
+Target_aarch64<size, big_endian>::stub_branch_section_address(
+    The_aarch64_relobj* relobj, unsigned int shndx) const
+{
+  Address offset = relobj->get_output_section_offset(shndx);
+  if (offset != The_aarch64_relobj::invalid_address)
+    return relobj->output_section(shndx)->address() + offset;
+
+  // Currently this only happens for a relaxed section.
+  const The_aarch64_input_section* input_section =
+      this->find_aarch64_input_section(relobj, shndx);
+  gold_assert(input_section != NULL);
+  return input_section->address();
+}
+
+
+// Compute the destination of BRANCH in the current layout.  Return
+// false if the branch does not need a stub whatever the layout.  If
+// TASK is not NULL, we are running single-threaded and report errors.
+
+template<int size, bool big_endian>
+bool
+Target_aarch64<size, big_endian>::stub_branch_destination(
+    const The_stub_branch& branch,
+    const Symbol_table* symtab,
+    const Task* task,
+    Address* destination)
+{
+  The_aarch64_relobj* object = branch.relobj;
+  const Sized_symbol<size>* gsym = branch.gsym;
+
+  Symbol_value<size> symval;
+  const Symbol_value<size>* psymval;
+  unsigned int shndx;
+  if (gsym == NULL)
+    {
+      psymval = object->local_symbol(branch.r_sym);
+      bool is_ordinary;
+      shndx = psymval->input_shndx(&is_ordinary);
+
+      // We need to compute the would-be final value of this local
+      // symbol.
+      if (!branch.is_defined_in_discarded_section)
+	{
+	  typedef Sized_relobj_file<size, big_endian> ObjType;
+	  if (psymval->is_section_symbol())
+	    symval.set_is_section_symbol();
+	  typename ObjType::Compute_final_local_value_status status =
+	    object->compute_final_local_value(branch.r_sym, psymval, &symval,
+					      symtab);
+	  // If we cannot determine the final value, give up.
+	  if (status != ObjType::CFLV_OK)
+	    return false;
+
+	  // Currently we cannot handle a branch to a target in a
+	  // merged section.  If this is the case, issue an error.
+	  if (!symval.has_output_value() && task != NULL)
 	    {
-	      if (comdat_behavior == CB_WARNING)
-		gold_warning_at_location(relinfo, i, offset,
-					 _("relocation refers to discarded "
-					   "section"));
-	      symval2.set_output_value(0);
+	      Task_lock_obj<Object> tl(task, object);
+	      const std::string& section_name = object->section_name(shndx);
+	      object->error(_("cannot handle branch to local %u "
+			      "in a merged section %s"),
+			    branch.r_sym, section_name.c_str());
 	    }
-	  symval2.set_no_output_symtab_entry();
-	  psymval = &symval2;
+	  psymval = &symval;
 	}
+    }
+  else
+    {
+      // We need to compute the would-be final value of this global
+      // symbol.
+      Symbol_table::Compute_final_value_status status;
+      typename elfcpp::Elf_types<size>::Elf_Addr value =
+	  symtab->compute_final_value<size>(gsym, &status);
+
+      // Skip this if the symbol has not output section.
+      if (status == Symbol_table::CFVS_NO_OUTPUT_SECTION)
+	return false;
+      symval.set_output_value(value);
 
-      // If symbol is a section symbol, we don't know the actual type of
-      // destination.  Give up.
-      if (psymval->is_section_symbol())
-	continue;
+      if (gsym->type() == elfcpp::STT_TLS)
+	symval.set_is_tls_symbol();
+      else if (gsym->type() == elfcpp::STT_GNU_IFUNC)
+	symval.set_is_ifunc_symbol();
+      psymval = &symval;
+      shndx = 0;
+    }
 
-      this->scan_reloc_for_stub(relinfo, r_type, sym, r_sym, psymval,
-				addend, view_address + offset);
-    }  // End of iterating relocs in a section
-}  // End of Target_aarch64::scan_reloc_section_for_stubs
+  Symbol_value<size> symval2;
+  if (branch.is_defined_in_discarded_section)
+    {
+      if (branch.use_kept_section)
+	{
+	  bool found;
+	  typename elfcpp::Elf_types<size>::Elf_Addr value =
+	    object->map_to_kept_section(shndx, &found);
+	  if (found)
+	    symval2.set_output_value(value + psymval->input_value());
+	  else
+	    symval2.set_output_value(0);
+	}
+      else
+	symval2.set_output_value(0);
+      symval2.set_no_output_symtab_entry();
+      psymval = &symval2;
+    }
 
+  // If symbol is a section symbol, we don't know the actual type of
+  // destination.  Give up.
+  if (psymval->is_section_symbol())
+    return false;
 
-// Scan an input section for stub generation.
+  Symbol_value<size> pltval;
+  if (gsym != NULL)
+    {
+      const AArch64_reloc_property* arp = aarch64_reloc_property_table->
+	get_reloc_property(branch.r_type);
+      if (gsym->use_plt_offset(arp->reference_flags()))
+	{
+	  // This uses a PLT, change the symbol value.
+	  pltval.set_output_value(this->plt_section()->address()
+				  + gsym->plt_offset());
+	  psymval = &pltval;
+	}
+      else if (gsym->is_undefined())
+	// There is no need to generate a stub symbol is undefined.
+	return false;
+    }
+
+  // Owing to pipelining, the PC relative branches below actually skip
+  // two instructions when the branch offset is 0.
+  *destination = psymval->value(object, 0) + branch.addend;
+  return true;
+}  // End of Target_aarch64::stub_branch_destination
+
+
+// Examine the branches in the stub group of STUB_TABLE and add the
+// stubs they need.  A branch whose address and destination have not
+// changed since it was last examined still uses the same stub, if any,
+// so only the branches which moved are looked at again.  This runs in
+// parallel for different stub tables except in the first pass, when
+// TASK is not NULL.
 
 template<int size, bool big_endian>
 void
-Target_aarch64<size, big_endian>::scan_section_for_stubs(
-    const Relocate_info<size, big_endian>* relinfo,
-    unsigned int sh_type,
-    const unsigned char* prelocs,
-    size_t reloc_count,
-    Output_section* output_section,
-    bool needs_special_offset_handling,
-    const unsigned char* view,
-    Address view_address,
-    section_size_type view_size)
-{
-  gold_assert(sh_type == elfcpp::SHT_RELA);
-  this->scan_reloc_section_for_stubs<elfcpp::SHT_RELA>(
-      relinfo,
-      prelocs,
-      reloc_count,
-      output_section,
-      needs_special_offset_handling,
-      view,
-      view_address,
-      view_size);
-}
+Target_aarch64<size, big_endian>::examine_stub_branches(
+    The_stub_table* stub_table,
+    const Symbol_table* symtab,
+    const Task* task,
+    Stub_group_stats* stats)
+{
+  Stub_branch_list& branches(stub_table->branches());
+  The_aarch64_relobj* relobj = NULL;
+  unsigned int shndx = 0;
+  Address section_address = 0;
+  for (typename Stub_branch_list::iterator p = branches.begin();
+       p != branches.end();
+       ++p)
+    {
+      // Branches from the same section are next to each other.
+      if (p->relobj != relobj || p->shndx != shndx)
+	{
+	  relobj = p->relobj;
+	  shndx = p->shndx;
+	  section_address = this->stub_branch_section_address(relobj, shndx);
+	}
+
+      Address destination = 0;
+      if (!this->stub_branch_destination(*p, symtab, task, &destination))
+	continue;
+      Address address = section_address + p->r_offset;
+      if (p->examined
+	  && p->address == address
+	  && p->destination == destination)
+	continue;
+
+      ++stats->moved;
+      p->examined = true;
+      p->address = address;
+      p->destination = destination;
+
+      int stub_type = The_reloc_stub::
+	  stub_type_for_reloc(p->r_type, address, destination);
+      if (stub_type == ST_NONE)
+	{
+	  p->stub = NULL;
+	  continue;
+	}
+
+      if (p->stub == NULL || p->stub->type() != stub_type)
+	{
+	  ++stats->looked_up;
+	  The_reloc_stub_key key(stub_type, p->gsym, relobj, p->r_sym,
+				 p->addend);
+	  The_reloc_stub* stub = stub_table->find_reloc_stub(key);
+	  if (stub == NULL)
+	    {
+	      stub = new The_reloc_stub(stub_type);
+	      stub_table->add_reloc_stub(stub, key);
+	    }
+	  p->stub = stub;
+	}
+      p->stub->set_destination_address(destination);
+    }
+}  // End of Target_aarch64::examine_stub_branches
 
 
 // Relocate a single stub.
@@ -5502,6 +5681,214 @@ Target_aarch64<size, big_endian>::new_aarch64_input_section(
 }
 
 
+// Read the branches which may need stubs from the objects of one
+// input file per job.  Objects in the same archive share a file, so
+// each file is only used by one thread.
+
+template<int size, bool big_endian>
+class Target_aarch64<size, big_endian>::Read_stub_branches_jobs
+  : public Parallel_jobs
+{
+ public:
+  Read_stub_branches_jobs(Target_aarch64<size, big_endian>* target,
+			  const Symbol_table* symtab, const Layout* layout,
+			  const Task* task,
+			  const std::vector<The_aarch64_relobj*>& objects,
+			  const std::vector<std::vector<unsigned int> >& files,
+			  std::vector<Stub_branch_list>* branches,
+			  std::vector<Stub_branch_warning_list>* warnings)
+    : target_(target), symtab_(symtab), layout_(layout), task_(task),
+      objects_(objects), files_(files), branches_(branches),
+      warnings_(warnings)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    const std::vector<unsigned int>& file_objects(this->files_[i]);
+    // Locking one object locks the file for all of them.
+    Task_lock_obj<Object> tl(this->task_, this->objects_[file_objects[0]]);
+    for (std::vector<unsigned int>::const_iterator p = file_objects.begin();
+	 p != file_objects.end();
+	 ++p)
+      this->objects_[*p]->read_branches_for_stubs(this->target_,
+						  this->symtab_,
+						  this->layout_,
+						  &(*this->branches_)[*p],
+						  &(*this->warnings_)[*p]);
+  }
+
+ private:
+  Target_aarch64<size, big_endian>* target_;
+  const Symbol_table* symtab_;
+  const Layout* layout_;
+  const Task* task_;
+  const std::vector<The_aarch64_relobj*>& objects_;
+  const std::vector<std::vector<unsigned int> >& files_;
+  std::vector<Stub_branch_list>* branches_;
+  std::vector<Stub_branch_warning_list>* warnings_;
+};
+
+
+// Examine the branches of one stub group per job.  Each job only
+// changes its own stub table.
+
+template<int size, bool big_endian>
+class Target_aarch64<size, big_endian>::Examine_stub_groups_jobs
+  : public Parallel_jobs
+{
+ public:
+  Examine_stub_groups_jobs(Target_aarch64<size, big_endian>* target,
+			   const Symbol_table* symtab,
+			   std::vector<Stub_group_stats>* stats)
+    : target_(target), symtab_(symtab), stats_(stats)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    this->target_->examine_stub_branches(this->target_->stub_tables_[i],
+					 this->symtab_, NULL,
+					 &(*this->stats_)[i]);
+  }
+
+ private:
+  Target_aarch64<size, big_endian>* target_;
+  const Symbol_table* symtab_;
+  std::vector<Stub_group_stats>* stats_;
+};
+
+
+// Read the branches which may need stubs, in parallel, and give them
+// to the stub tables of their sections.  The branches of each stub
+// table are kept in input order, so that stubs are added in the same
+// order however many threads are used.  The warnings are reported
+// afterward, in input order too.
+
+template<int size, bool big_endian>
+void
+Target_aarch64<size, big_endian>::read_stub_branches(
+    const Input_objects* input_objects,
+    const Symbol_table* symtab,
+    const Layout* layout,
+    const Task* task)
+{
+  // Group the objects by input file.
+  std::vector<The_aarch64_relobj*> objects;
+  std::vector<std::vector<unsigned int> > files;
+  Unordered_map<const File_read*, unsigned int> file_indexes;
+  for (Input_objects::Relobj_iterator op = input_objects->relobj_begin();
+       op != input_objects->relobj_end();
+       ++op)
+    {
+      const File_read* file = &(*op)->input_file()->file();
+      std::pair<Unordered_map<const File_read*, unsigned int>::iterator, bool>
+	ins = file_indexes.insert(std::make_pair(file, files.size()));
+      if (ins.second)
+	files.push_back(std::vector<unsigned int>());
+      files[ins.first->second].push_back(objects.size());
+      objects.push_back(static_cast<The_aarch64_relobj*>(*op));
+    }
+
+  std::vector<Stub_branch_list> branches(objects.size());
+  std::vector<Stub_branch_warning_list> warnings(objects.size());
+  Read_stub_branches_jobs jobs(this, symtab, layout, task, objects, files,
+			       &branches, &warnings);
+  jobs.run(files.size(), Parallel_jobs::default_thread_count());
+
+  for (size_t i = 0; i < branches.size(); ++i)
+    {
+      if (!warnings[i].empty())
+	{
+	  // Finding the location may read the debug information.
+	  Task_lock_obj<Object> tl(task, objects[i]);
+	  The_relocate_info relinfo;
+	  relinfo.symtab = symtab;
+	  relinfo.layout = layout;
+	  relinfo.object = objects[i];
+	  for (typename Stub_branch_warning_list::const_iterator p =
+		 warnings[i].begin();
+	       p != warnings[i].end();
+	       ++p)
+	    {
+	      relinfo.reloc_shndx = p->reloc_shndx;
+	      relinfo.data_shndx = p->data_shndx;
+	      gold_warning_at_location(&relinfo, p->relnum, p->r_offset,
+				       _("relocation refers to discarded "
+					 "section"));
+	    }
+	}
+
+      for (typename Stub_branch_list::const_iterator p = branches[i].begin();
+	   p != branches[i].end();
+	   ++p)
+	p->relobj->stub_table(p->shndx)->branches().push_back(*p);
+      Stub_branch_list().swap(branches[i]);
+    }
+}
+
+
+// Examine the branches of all stub groups and record statistics for
+// this pass.  The first pass runs single-threaded, so that errors are
+// reported in order; computing the symbol values also sets up lookup
+// tables which later passes only read.
+
+template<int size, bool big_endian>
+void
+Target_aarch64<size, big_endian>::examine_stub_groups(
+    const Symbol_table* symtab,
+    bool first_pass,
+    const Task* task)
+{
+  std::vector<Stub_group_stats> stats(this->stub_tables_.size());
+  if (first_pass)
+    {
+      for (size_t i = 0; i < this->stub_tables_.size(); ++i)
+	this->examine_stub_branches(this->stub_tables_[i], symtab, task,
+				    &stats[i]);
+    }
+  else
+    {
+      Examine_stub_groups_jobs jobs(this, symtab, &stats);
+      jobs.run(this->stub_tables_.size(),
+	       Parallel_jobs::default_thread_count());
+    }
+
+  Relax_stats pass_stats;
+  pass_stats.groups = this->stub_tables_.size();
+  for (size_t i = 0; i < this->stub_tables_.size(); ++i)
+    {
+      pass_stats.branches += this->stub_tables_[i]->branches().size();
+      pass_stats.moved += stats[i].moved;
+      pass_stats.looked_up += stats[i].looked_up;
+      if (stats[i].moved > 0)
+	++pass_stats.groups_examined;
+    }
+  this->relax_stats_.push_back(pass_stats);
+}
+
+
+// Print statistics about the relaxation passes to stderr.  This is
+// used for --stats.
+
+template<int size, bool big_endian>
+void
+Target_aarch64<size, big_endian>::do_print_relax_stats() const
+{
+  for (size_t i = 0; i < this->relax_stats_.size(); ++i)
+    {
+      const Relax_stats& stats(this->relax_stats_[i]);
+      fprintf(stderr, _("%s: relaxation pass %zu: stub groups: %u; "
+			"examined: %u; branches: %zu; moved: %zu; "
+			"stubs looked up: %zu\n"),
+	      program_name, i + 1, stats.groups, stats.groups_examined,
+	      stats.branches, stats.moved, stats.looked_up);
+    }
+}
+
+
 // Relaxation hook.  This is where we do stub generation.
 
 template<int size, bool big_endian>
@@ -5544,19 +5931,31 @@ Target_aarch64<size, big_endian>::do_relax(
 	}
     }
 
-  // Scan relocs for relocation stubs
-  for (Input_objects::Relobj_iterator op = input_objects->relobj_begin();
-       op != input_objects->relobj_end();
-       ++op)
+  // Read the branches which may need relocation stubs once.  Later
+  // passes only examine the branches again.
+  if (pass == 1)
+    this->read_stub_branches(input_objects, symtab, layout, task);
+
+  // Scan for errata.
+  if (parameters->options().fix_cortex_a53_843419()
+      || parameters->options().fix_cortex_a53_835769())
     {
-      The_aarch64_relobj* aarch64_relobj =
-	  static_cast<The_aarch64_relobj*>(*op);
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from Layout::finalize, so it is OK to lock.
-      Task_lock_obj<Object> tl(task, aarch64_relobj);
-      aarch64_relobj->scan_sections_for_stubs(this, symtab, layout);
+      for (Input_objects::Relobj_iterator op = input_objects->relobj_begin();
+	   op != input_objects->relobj_end();
+	   ++op)
+	{
+	  The_aarch64_relobj* aarch64_relobj =
+	      static_cast<The_aarch64_relobj*>(*op);
+	  // Lock the object so we can read from it.  This is only called
+	  // single-threaded from Layout::finalize, so it is OK to lock.
+	  Task_lock_obj<Object> tl(task, aarch64_relobj);
+	  aarch64_relobj->scan_sections_for_errata(this, symtab);
+	}
     }
 
+  // Add the relocation stubs which the branches need.
+  this->examine_stub_groups(symtab, pass == 1, task);
+
   bool any_stub_table_changed = false;
   for (Stub_table_iterator siter = this->stub_tables_.begin();
        siter != this->stub_tables_.end() && !any_stub_table_changed; ++siter)
@@ -5945,6 +6344,83 @@ Target_aarch64<size, big_endian>::Scan::reloc_needs_plt_for_ifunc(
   return flags != 0;
 }
 
+// Return true if a relocation of type R_TYPE needs no work in
+// Scan::local or Scan::global when the symbol is resolved locally.
+
+static inline bool
+aarch64_reloc_is_trivial(unsigned int r_type)
+{
+  switch (r_type)
+    {
+    case elfcpp::R_AARCH64_NONE:
+    case elfcpp::R_AARCH64_PREL64:
+    case elfcpp::R_AARCH64_PREL32:
+    case elfcpp::R_AARCH64_PREL16:
+    case elfcpp::R_AARCH64_LD_PREL_LO19:
+    case elfcpp::R_AARCH64_ADR_PREL_LO21:
+    case elfcpp::R_AARCH64_ADR_PREL_PG_HI21:
+    case elfcpp::R_AARCH64_ADR_PREL_PG_HI21_NC:
+    case elfcpp::R_AARCH64_ADD_ABS_LO12_NC:
+    case elfcpp::R_AARCH64_LDST8_ABS_LO12_NC:
+    case elfcpp::R_AARCH64_LDST16_ABS_LO12_NC:
+    case elfcpp::R_AARCH64_LDST32_ABS_LO12_NC:
+    case elfcpp::R_AARCH64_LDST64_ABS_LO12_NC:
+    case elfcpp::R_AARCH64_LDST128_ABS_LO12_NC:
+    case elfcpp::R_AARCH64_TSTBR14:
+    case elfcpp::R_AARCH64_CONDBR19:
+    case elfcpp::R_AARCH64_JUMP26:
+    case elfcpp::R_AARCH64_CALL26:
+      return true;
+
+    // These need a dynamic relocation, or are an error, in a
+    // position independent link.
+    case elfcpp::R_AARCH64_ABS64:
+    case elfcpp::R_AARCH64_ABS32:
+    case elfcpp::R_AARCH64_ABS16:
+    case elfcpp::R_AARCH64_MOVW_UABS_G0:
+    case elfcpp::R_AARCH64_MOVW_UABS_G0_NC:
+    case elfcpp::R_AARCH64_MOVW_UABS_G1:
+    case elfcpp::R_AARCH64_MOVW_UABS_G1_NC:
+    case elfcpp::R_AARCH64_MOVW_UABS_G2:
+    case elfcpp::R_AARCH64_MOVW_UABS_G2_NC:
+    case elfcpp::R_AARCH64_MOVW_UABS_G3:
+    case elfcpp::R_AARCH64_MOVW_SABS_G0:
+    case elfcpp::R_AARCH64_MOVW_SABS_G1:
+    case elfcpp::R_AARCH64_MOVW_SABS_G2:
+      return !parameters->options().output_is_position_independent();
+
+    default:
+      return false;
+    }
+}
+
+// Return true if Scan::local would do nothing for a relocation.
+
+template<int size, bool big_endian>
+inline bool
+Target_aarch64<size, big_endian>::Scan::local_reloc_is_trivial(
+    unsigned int r_type,
+    const elfcpp::Sym<size, big_endian>& lsym,
+    bool is_discarded)
+{
+  if (is_discarded)
+    return true;
+  if (lsym.get_st_type() == elfcpp::STT_GNU_IFUNC)
+    return false;
+  return aarch64_reloc_is_trivial(r_type);
+}
+
+// Return true if Scan::global would do nothing for a relocation.
+
+template<int size, bool big_endian>
+inline bool
+Target_aarch64<size, big_endian>::Scan::global_reloc_is_trivial(
+    unsigned int r_type,
+    const Symbol* gsym)
+{
+  return prescan_symbol_is_local(gsym) && aarch64_reloc_is_trivial(r_type);
+}
+
 // Scan a relocation for a local symbol.
 
 template<int size, bool big_endian>
@@ -6759,6 +7235,41 @@ Target_aarch64<size, big_endian>::scan_relocs(
     plocal_symbols);
 }
 
+// Prescan relocations for a section.
+
+template<int size, bool big_endian>
+bool
+Target_aarch64<size, big_endian>::prescan_relocs(
+    Symbol_table* symtab,
+    Sized_relobj_file<size, big_endian>* object,
+    unsigned int,
+    unsigned int sh_type,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    bool needs_special_offset_handling,
+    size_t local_symbol_count,
+    const unsigned char* plocal_symbols,
+    std::vector<unsigned char>* pending)
+{
+  typedef gold::Default_classify_reloc<elfcpp::SHT_RELA, size, big_endian>
+      Classify_reloc;
+
+  // Leave the error to scan_relocs.
+  if (sh_type == elfcpp::SHT_REL)
+    return false;
+
+  gold::prescan_relocs<size, big_endian, Scan, Classify_reloc>(
+    symtab,
+    object,
+    prelocs,
+    reloc_count,
+    needs_special_offset_handling,
+    local_symbol_count,
+    plocal_symbols,
+    pending);
+  return true;
+}
+
 // Return the value to use for a dynamic which requires special
 // treatment.  This is how we support equality comparisons of function
 // pointers across shared library boundaries, as described in the
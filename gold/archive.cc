@@ -25,7 +25,9 @@
 #include <cerrno>
 #include <cstring>
 #include <climits>
+#include <algorithm>
 #include <vector>
+#include <fcntl.h>
 #include "libiberty.h"
 #include "filenames.h"
 
@@ -33,6 +35,7 @@
 #include "options.h"
 #include "mapfile.h"
 #include "fileread.h"
+#include "gold-threads.h"
 #include "readsyms.h"
 #include "symtab.h"
 #include "object.h"
@@ -178,6 +181,7 @@ struct Archive::Archive_header
 unsigned int Archive::total_archives;
 unsigned int Archive::total_members;
 unsigned int Archive::total_members_loaded;
+unsigned int Archive::total_members_prefetched;
 
 // Archive methods.
 
@@ -199,9 +203,9 @@ Archive::Archive(const std::string& name, Input_file* input_file,
                  bool is_thin_archive, Dirsearch* dirpath, Task* task)
   : Library_base(task), name_(name), input_file_(input_file), armap_(),
     armap_names_(), extended_names_(), armap_checked_(), seen_offsets_(),
-    members_(), is_thin_archive_(is_thin_archive), included_member_(false),
-    nested_archives_(), dirpath_(dirpath), num_members_(0),
-    included_all_members_(false)
+    member_offsets_(), members_(), is_thin_archive_(is_thin_archive),
+    included_member_(false), nested_archives_(), dirpath_(dirpath),
+    num_members_(0), included_all_members_(false)
 {
   this->no_export_ =
     parameters->options().check_excluded_libs(input_file->found_name());
@@ -797,6 +801,8 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
   do
     {
       added_new_object = false;
+      if (parameters->options().prefetch_archive_members())
+	this->prefetch_members(symtab, layout);
       for (size_t i = 0; i < armap_size; ++i)
 	{
           if (this->armap_checked_[i])
@@ -856,6 +862,141 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
   return true;
 }
 
+// Jobs which check the symbols in the archive map which add_symbols
+// has not yet checked, each job handling a range of entries.  The
+// symbol table does not change while they run, since we are in the
+// middle of Add_archive_symbols.
+
+class Archive::Check_armap_jobs : public Parallel_jobs
+{
+ public:
+  // The number of archive map entries handled by each job.
+  static const size_t chunk_size = 4096;
+
+  Check_armap_jobs(const Archive* archive, Symbol_table* symtab,
+		   Layout* layout, std::vector<unsigned char>* results)
+    : archive_(archive), symtab_(symtab), layout_(layout), results_(results)
+  { }
+
+ protected:
+  void
+  do_job(size_t i);
+
+ private:
+  const Archive* archive_;
+  Symbol_table* symtab_;
+  Layout* layout_;
+  std::vector<unsigned char>* results_;
+};
+
+void
+Archive::Check_armap_jobs::do_job(size_t i)
+{
+  const Archive* archive = this->archive_;
+  size_t start = i * chunk_size;
+  size_t end = std::min(start + chunk_size, archive->armap_.size());
+  char* tmpbuf = NULL;
+  size_t tmpbuflen = 0;
+  for (size_t j = start; j < end; ++j)
+    {
+      if (archive->armap_checked_[j])
+	continue;
+      const char* sym_name = (archive->armap_names_.data()
+			      + archive->armap_[j].name_offset);
+      Symbol* sym;
+      std::string why;
+      (*this->results_)[j] =
+	Archive::should_include_member(this->symtab_, this->layout_,
+				       sym_name, &sym, &why, &tmpbuf,
+				       &tmpbuflen);
+    }
+  if (tmpbuf != NULL)
+    free(tmpbuf);
+}
+
+// Check the entries in the archive map which add_symbols has not yet
+// checked, in parallel.  Those for symbols which are already defined
+// will never cause a member to be included, so we mark them as
+// checked, as add_symbols would.  Those which say that we will include
+// a member are only a prediction, since add_symbols checks the
+// entries in order and may find the symbol defined by a member it
+// included earlier; we use them to ask the system to start reading
+// the members, so that the reads overlap with each other and with
+// our work on the members before them.
+
+void
+Archive::prefetch_members(Symbol_table* symtab, Layout* layout)
+{
+  const size_t armap_size = this->armap_.size();
+  if (armap_size == 0)
+    return;
+
+  std::vector<unsigned char> results(armap_size,
+				     Archive::SHOULD_INCLUDE_UNKNOWN);
+  Check_armap_jobs jobs(this, symtab, layout, &results);
+  jobs.run((armap_size + Check_armap_jobs::chunk_size - 1)
+	   / Check_armap_jobs::chunk_size,
+	   Parallel_jobs::default_thread_count());
+
+  std::vector<off_t> wanted;
+  for (size_t i = 0; i < armap_size; ++i)
+    {
+      if (results[i] == Archive::SHOULD_INCLUDE_NO)
+	this->armap_checked_[i] = true;
+      else if (results[i] == Archive::SHOULD_INCLUDE_YES)
+	{
+	  off_t off = this->armap_[i].file_offset;
+	  if (this->seen_offsets_.find(off) == this->seen_offsets_.end()
+	      && this->members_.find(off) == this->members_.end())
+	    wanted.push_back(off);
+	}
+    }
+
+  // The members of a thin archive are in other files.
+  if (wanted.empty() || this->is_thin_archive_)
+    return;
+
+  std::sort(wanted.begin(), wanted.end());
+  wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+
+  if (this->member_offsets_.empty())
+    {
+      this->member_offsets_.reserve(this->num_members_);
+      for (size_t i = 0; i < armap_size; ++i)
+	this->member_offsets_.push_back(this->armap_[i].file_offset);
+      std::sort(this->member_offsets_.begin(), this->member_offsets_.end());
+      this->member_offsets_.erase(std::unique(this->member_offsets_.begin(),
+					      this->member_offsets_.end()),
+				  this->member_offsets_.end());
+    }
+
+  Archive::total_members_prefetched += wanted.size();
+
+#ifdef HAVE_POSIX_FADVISE
+  // A member extends to the next member in the archive map.  Merge
+  // the extents of adjacent members.
+  int descriptor = this->input_file_->file().descriptor();
+  off_t filesize = this->input_file_->file().filesize();
+  size_t i = 0;
+  while (i < wanted.size())
+    {
+      off_t start = wanted[i];
+      off_t end;
+      while (true)
+	{
+	  std::vector<off_t>::const_iterator p =
+	    std::upper_bound(this->member_offsets_.begin(),
+			     this->member_offsets_.end(), wanted[i]);
+	  end = p == this->member_offsets_.end() ? filesize : *p;
+	  ++i;
+	  if (i >= wanted.size() || wanted[i] != end)
+	    break;
+	}
+      ::posix_fadvise(descriptor, start, end - start, POSIX_FADV_WILLNEED);
+    }
+#endif
+}
+
 // Return whether the archive includes a member which defines the
 // symbol SYM.
 
@@ -1087,6 +1228,8 @@ Archive::print_stats()
           program_name, Archive::total_members);
   fprintf(stderr, _("%s: loaded archive members: %u\n"),
           program_name, Archive::total_members_loaded);
+  fprintf(stderr, _("%s: prefetched archive members: %u\n"),
+          program_name, Archive::total_members_prefetched);
 }
 
 // Add_archive_symbols methods.
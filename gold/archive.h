@@ -286,6 +286,10 @@ class Archive : public Library_base
   static unsigned int total_members;
   // Number of archive members loaded.
   static unsigned int total_members_loaded;
+  // Number of archive members prefetched.
+  static unsigned int total_members_prefetched;
+
+  class Check_armap_jobs;
 
   // Get a view into the underlying file.
   const unsigned char*
@@ -335,6 +339,11 @@ class Archive : public Library_base
   bool
   include_all_members(Symbol_table*, Layout*, Input_objects*, Mapfile*);
 
+  // Check the archive map in parallel, and prefetch the members which
+  // add_symbols is likely to include.
+  void
+  prefetch_members(Symbol_table*, Layout*);
+
   // Include an archive member in the link.
   bool
   include_member(Symbol_table*, Layout*, Input_objects*, off_t off,
@@ -395,6 +404,9 @@ class Archive : public Library_base
   std::vector<bool> armap_checked_;
   // Track which elements have been included by offset.
   Unordered_set<off_t, Seen_hash> seen_offsets_;
+  // The sorted offsets of the elements in the archive map, used to
+  // find the extent of an element to prefetch.
+  std::vector<off_t> member_offsets_;
   // Table of objects whose symbols have been pre-read.
   std::map<off_t, Archive_member> members_;
   // True if this is a thin archive.
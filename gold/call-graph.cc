@@ -0,0 +1,308 @@
+// call-graph.cc -- order functions using a call graph profile
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "elfcpp.h"
+#include "link-cache.h"
+#include "object.h"
+#include "output.h"
+#include "symtab.h"
+#include "call-graph.h"
+
+namespace gold
+{
+
+// We do not let a cluster grow beyond this size, so that the hot
+// code in a cluster stays within a few pages.
+const uint64_t call_graph_max_cluster_size = 1024 * 1024;
+
+// We do not merge two clusters if the density of the result would be
+// less than that of the caller's cluster divided by this.
+const uint64_t call_graph_max_density_degradation = 8;
+
+// Sort clusters by decreasing density.  Ties go to the cluster which
+// was created first, so that the order does not depend on the sort
+// implementation.
+
+class Call_graph_cluster_compare
+{
+ public:
+  Call_graph_cluster_compare(const std::vector<double>& densities)
+    : densities_(densities)
+  { }
+
+  bool
+  operator()(unsigned int i1, unsigned int i2) const
+  {
+    if (this->densities_[i1] != this->densities_[i2])
+      return this->densities_[i1] > this->densities_[i2];
+    return i1 < i2;
+  }
+
+ private:
+  const std::vector<double>& densities_;
+};
+
+// Class Call_graph.
+
+// Return the index of NAME in names_.
+
+unsigned int
+Call_graph::name_index(const std::string& name,
+		       std::map<std::string, unsigned int>* indexes)
+{
+  std::pair<std::map<std::string, unsigned int>::iterator, bool> ins =
+    indexes->insert(std::make_pair(name, this->names_.size()));
+  if (ins.second)
+    this->names_.push_back(name);
+  return ins.first->second;
+}
+
+// Read the call graph from FILENAME.  Blank lines and lines starting
+// with '#' are ignored.
+
+void
+Call_graph::read(const char* filename)
+{
+  std::ifstream in(filename);
+  if (!in)
+    gold_fatal(_("unable to open --call-graph-ordering-file file %s: %s"),
+	       filename, strerror(errno));
+  record_link_cache_input(filename);
+
+  std::map<std::string, unsigned int> indexes;
+  std::string line;
+  unsigned int lineno = 0;
+  while (std::getline(in, line))
+    {
+      ++lineno;
+      if (!line.empty() && line[line.length() - 1] == '\r')   // Windows
+	line.resize(line.length() - 1);
+      if (line.empty() || line[0] == '#')
+	continue;
+
+      std::istringstream fields(line);
+      std::string caller;
+      std::string callee;
+      uint64_t weight;
+      std::string extra;
+      if (!(fields >> caller >> callee >> weight) || (fields >> extra))
+	{
+	  gold_error(_("%s:%u: expected CALLER CALLEE WEIGHT"),
+		     filename, lineno);
+	  continue;
+	}
+      if (weight == 0)
+	continue;
+
+      unsigned int caller_index = this->name_index(caller, &indexes);
+      unsigned int callee_index = this->name_index(callee, &indexes);
+      this->edges_.push_back(Edge(caller_index, callee_index, weight));
+    }
+}
+
+// Map the symbol named by names_[I] to the section which defines it,
+// and return the size of the section in *SIZE.  Return false if the
+// symbol is not defined in an executable section of an object file
+// which we are including in the output.
+
+bool
+Call_graph::find_section(const Task* task, Symbol_table* symtab,
+			 unsigned int i, Section_id* secn, uint64_t* size)
+{
+  Symbol* sym = symtab->lookup(this->names_[i].c_str());
+  if (sym == NULL
+      || sym->source() != Symbol::FROM_OBJECT
+      || sym->object()->is_dynamic()
+      || sym->object()->pluginobj() != NULL)
+    return false;
+
+  bool is_ordinary;
+  unsigned int shndx = sym->shndx(&is_ordinary);
+  if (!is_ordinary || shndx == elfcpp::SHN_UNDEF)
+    return false;
+
+  Relobj* relobj = static_cast<Relobj*>(sym->object());
+  Output_section* os = relobj->output_section(shndx);
+  if (os == NULL || (os->flags() & elfcpp::SHF_EXECINSTR) == 0)
+    return false;
+
+  Task_lock_obj<Object> tlo(task, relobj);
+  *size = relobj->section_size(shndx);
+  *secn = Section_id(relobj, shndx);
+  return true;
+}
+
+// Compute the order of the sections using the C3 heuristic described
+// in "Optimizing Function Placement for Large-Scale Data-Center
+// Applications" by Ottoni and Maher.
+
+void
+Call_graph::order_sections(const Task* task, Symbol_table* symtab,
+			   std::map<Section_id, unsigned int>* order_map)
+{
+  // Map each name to a cluster holding the section which defines
+  // it, or -1U.  Initially each section is in its own cluster.
+  std::vector<unsigned int> name_clusters(this->names_.size(), -1U);
+  std::vector<Cluster> clusters;
+  std::vector<Section_id> sections;
+  std::map<Section_id, unsigned int> section_clusters;
+  for (unsigned int i = 0; i < this->names_.size(); ++i)
+    {
+      Section_id secn;
+      uint64_t size;
+      if (!this->find_section(task, symtab, i, &secn, &size))
+	continue;
+      std::pair<std::map<Section_id, unsigned int>::iterator, bool> ins =
+	section_clusters.insert(std::make_pair(secn, clusters.size()));
+      if (ins.second)
+	{
+	  clusters.push_back(Cluster(sections.size(),
+				     std::max(size, static_cast<uint64_t>(1))));
+	  sections.push_back(secn);
+	}
+      name_clusters[i] = ins.first->second;
+    }
+
+  // Sum the weights of the calls into each section, and find the
+  // heaviest caller of each.  Calls within a section make it hotter,
+  // but do not affect its placement.
+  for (std::vector<Edge>::const_iterator p = this->edges_.begin();
+       p != this->edges_.end();
+       ++p)
+    {
+      unsigned int from = name_clusters[p->caller];
+      unsigned int to = name_clusters[p->callee];
+      if (to == -1U)
+	continue;
+      Cluster& c(clusters[to]);
+      c.weight += p->weight;
+      if (from == -1U || from == to)
+	continue;
+      if (c.best_pred == -1U || c.best_pred_weight < p->weight)
+	{
+	  c.best_pred = from;
+	  c.best_pred_weight = p->weight;
+	}
+    }
+
+  std::vector<double> densities(clusters.size());
+  std::vector<unsigned int> sorted(clusters.size());
+  for (unsigned int i = 0; i < clusters.size(); ++i)
+    {
+      clusters[i].initial_weight = clusters[i].weight;
+      densities[i] = clusters[i].density();
+      sorted[i] = i;
+    }
+  std::sort(sorted.begin(), sorted.end(),
+	    Call_graph_cluster_compare(densities));
+
+  // Visit the sections from the densest, appending each to the
+  // cluster of its heaviest caller.  LEADERS maps each section to the
+  // cluster which holds it.
+  std::vector<unsigned int> leaders(clusters.size());
+  for (unsigned int i = 0; i < clusters.size(); ++i)
+    leaders[i] = i;
+  for (std::vector<unsigned int>::const_iterator p = sorted.begin();
+       p != sorted.end();
+       ++p)
+    {
+      Cluster& c(clusters[*p]);
+
+      // Ignore callers which account for too little of the calls.
+      if (c.best_pred == -1U
+	  || c.best_pred_weight * 10 <= c.initial_weight)
+	continue;
+
+      unsigned int pred = c.best_pred;
+      while (leaders[pred] != pred)
+	{
+	  leaders[pred] = leaders[leaders[pred]];
+	  pred = leaders[pred];
+	}
+      if (pred == *p)
+	continue;
+
+      Cluster& pc(clusters[pred]);
+      if (c.size + pc.size > call_graph_max_cluster_size)
+	continue;
+      double new_density = (static_cast<double>(c.weight + pc.weight)
+			    / (c.size + pc.size));
+      if (new_density * call_graph_max_density_degradation < pc.density())
+	continue;
+
+      leaders[*p] = pred;
+      pc.sections.insert(pc.sections.end(), c.sections.begin(),
+			 c.sections.end());
+      pc.size += c.size;
+      pc.weight += c.weight;
+      c.sections.clear();
+    }
+
+  // Place the clusters from the densest.
+  sorted.clear();
+  for (unsigned int i = 0; i < clusters.size(); ++i)
+    {
+      if (leaders[i] == i)
+	{
+	  densities[i] = clusters[i].density();
+	  sorted.push_back(i);
+	}
+    }
+  std::sort(sorted.begin(), sorted.end(),
+	    Call_graph_cluster_compare(densities));
+
+  unsigned int position = 1;
+  for (std::vector<unsigned int>::const_iterator p = sorted.begin();
+       p != sorted.end();
+       ++p)
+    {
+      const std::vector<unsigned int>& secs(clusters[*p].sections);
+      for (std::vector<unsigned int>::const_iterator q = secs.begin();
+	   q != secs.end();
+	   ++q)
+	(*order_map)[sections[*q]] = position++;
+    }
+
+  this->sections_ordered_ = sections.size();
+  this->clusters_ = sorted.size();
+}
+
+// Print statistics.
+
+void
+Call_graph::print_stats() const
+{
+  fprintf(stderr, _("%s: call graph edges: %lu\n"),
+	  program_name, static_cast<unsigned long>(this->edges_.size()));
+  fprintf(stderr, _("%s: call graph sections ordered: %u in %u clusters\n"),
+	  program_name, this->sections_ordered_, this->clusters_);
+}
+
+} // End namespace gold.
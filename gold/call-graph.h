@@ -0,0 +1,136 @@
+// call-graph.h -- order functions using a call graph profile  -*- C++ -*-
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_CALL_GRAPH_H
+#define GOLD_CALL_GRAPH_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "object.h"
+
+namespace gold
+{
+
+class Task;
+class Symbol_table;
+
+// This class implements --call-graph-ordering-file.  The file holds
+// the edges of a weighted call graph, one per line, as
+//   CALLER CALLEE WEIGHT
+// where CALLER and CALLEE are symbol names and WEIGHT is, for
+// example, the number of samples in which CALLER called CALLEE.
+// Once all the input sections have been laid out, we map each symbol
+// to the section which defines it, and order the executable sections
+// using the C3 heuristic: each section is appended to the cluster of
+// its most frequent caller, as long as the cluster stays small and
+// dense enough, and the clusters are then placed hottest first.  As
+// with --section-ordering-file, the sections which do not appear in
+// the profile are placed ahead of the ones which do.
+
+class Call_graph
+{
+ public:
+  Call_graph()
+    : names_(), edges_(), sections_ordered_(0), clusters_(0)
+  { }
+
+  // Read the call graph from FILENAME.
+  void
+  read(const char* filename);
+
+  // Compute the order of the sections named by the call graph, and
+  // record it in ORDER_MAP, which maps sections to their positions.
+  void
+  order_sections(const Task*, Symbol_table*,
+		 std::map<Section_id, unsigned int>* order_map);
+
+  // Print statistics.
+  void
+  print_stats() const;
+
+ private:
+  // An edge in the call graph.  The caller and callee are indexes
+  // into names_.
+  struct Edge
+  {
+    Edge(unsigned int caller_arg, unsigned int callee_arg,
+	 uint64_t weight_arg)
+      : caller(caller_arg), callee(callee_arg), weight(weight_arg)
+    { }
+
+    unsigned int caller;
+    unsigned int callee;
+    uint64_t weight;
+  };
+
+  // A cluster of sections to be laid out together.
+  struct Cluster
+  {
+    Cluster(unsigned int section, uint64_t size_arg)
+      : sections(1, section), size(size_arg), weight(0), initial_weight(0),
+	best_pred(-1U), best_pred_weight(0)
+    { }
+
+    // The density of the cluster: the number of calls into it for
+    // each byte.
+    double
+    density() const
+    { return static_cast<double>(this->weight) / this->size; }
+
+    // The sections in the cluster, in order.
+    std::vector<unsigned int> sections;
+    // The total size of the sections.
+    uint64_t size;
+    // The total weight of the calls into the sections.
+    uint64_t weight;
+    // The weight of the calls into the first section.
+    uint64_t initial_weight;
+    // The section which most often calls the first section, or -1U.
+    unsigned int best_pred;
+    // The weight of the calls from best_pred.
+    uint64_t best_pred_weight;
+  };
+
+  // Map the symbol named by names_[I] to its section.
+  bool
+  find_section(const Task*, Symbol_table*, unsigned int i,
+	       Section_id* secn, uint64_t* size);
+
+  // Return the index of a name in names_, adding it if necessary.
+  unsigned int
+  name_index(const std::string& name,
+	     std::map<std::string, unsigned int>* indexes);
+
+  // The symbol names in the call graph.
+  std::vector<std::string> names_;
+  // The edges of the call graph.
+  std::vector<Edge> edges_;
+  // The number of sections ordered.
+  unsigned int sections_ordered_;
+  // The number of clusters they were placed in.
+  unsigned int clusters_;
+};
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_CALL_GRAPH_H)
@@ -24,11 +24,24 @@
 #include <zlib.h>
 #include "parameters.h"
 #include "options.h"
+#include "workqueue.h"
+#include "timer.h"
 #include "compressed_output.h"
 
 namespace gold
 {
 
+// The zlib compression level to use.
+
+static int
+zlib_compress_level()
+{
+  if (parameters->options().optimize() >= 1)
+    return 9;
+  else
+    return 1;
+}
+
 // Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
 // if it successfully compressed, false if it failed for any reason
 // (including not having zlib support in the library).  If it returns
@@ -48,11 +61,7 @@ zlib_compress(int header_size,
   *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
   *compressed_data = new unsigned char[*compressed_size + header_size];
 
-  int compress_level;
-  if (parameters->options().optimize() >= 1)
-    compress_level = 9;
-  else
-    compress_level = 1;
+  int compress_level = zlib_compress_level();
 
   int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
                      compressed_size,
@@ -72,6 +81,109 @@ zlib_compress(int header_size,
     }
 }
 
+// Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE into a raw
+// deflate stream, with no zlib header or trailer, which may be
+// concatenated with the streams for the data which follows it.
+// DICTIONARY is the data which immediately precedes
+// UNCOMPRESSED_DATA, used to prime the compressor so that matches
+// across the boundary are not lost.  IS_LAST is true if this is the
+// last piece of the data, in which case the stream is terminated.
+// Returns true on success, and sets *COMPRESSED_DATA, allocated using
+// new, and *COMPRESSED_SIZE.
+
+static bool
+zlib_compress_raw(const unsigned char* dictionary,
+		  unsigned long dictionary_size,
+		  const unsigned char* uncompressed_data,
+		  unsigned long uncompressed_size,
+		  bool is_last,
+		  unsigned char** compressed_data,
+		  unsigned long* compressed_size)
+{
+  z_stream strm;
+  strm.zalloc = NULL;
+  strm.zfree = NULL;
+  strm.opaque = NULL;
+
+  // A negative window size means a raw deflate stream.
+  int rc = deflateInit2(&strm, zlib_compress_level(), Z_DEFLATED, -15, 8,
+			Z_DEFAULT_STRATEGY);
+  if (rc != Z_OK)
+    return false;
+
+  if (dictionary_size > 0)
+    {
+      rc = deflateSetDictionary(&strm,
+				const_cast<Bytef*>(dictionary),
+				dictionary_size);
+      if (rc != Z_OK)
+	{
+	  deflateEnd(&strm);
+	  return false;
+	}
+    }
+
+  // A sync flush may add a few bytes beyond the bound for a finished
+  // stream.
+  unsigned long bound = deflateBound(&strm, uncompressed_size) + 16;
+  *compressed_data = new unsigned char[bound];
+
+  strm.next_in = const_cast<Bytef*>(uncompressed_data);
+  strm.avail_in = uncompressed_size;
+  strm.next_out = *compressed_data;
+  strm.avail_out = bound;
+
+  // A sync flush ends the stream on a byte boundary without marking
+  // the last block as final, so the next chunk's stream can follow.
+  rc = deflate(&strm, is_last ? Z_FINISH : Z_SYNC_FLUSH);
+  bool ok = (is_last ? rc == Z_STREAM_END : rc == Z_OK)
+	     && strm.avail_in == 0
+	     && strm.avail_out > 0;
+  *compressed_size = bound - strm.avail_out;
+  deflateEnd(&strm);
+
+  if (!ok)
+    {
+      delete[] *compressed_data;
+      *compressed_data = NULL;
+      return false;
+    }
+  return true;
+}
+
+// A Compress_task compresses one chunk of an Output_compressed_section.
+
+class Compress_task : public Task
+{
+ public:
+  Compress_task(Output_compressed_section* os, unsigned int chunk,
+		Task_token* final_blocker)
+    : os_(os), chunk_(chunk), final_blocker_(final_blocker)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->os_->compress_chunk(this->chunk_); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  // Unblock FINAL_BLOCKER_ when done.
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  std::string
+  get_name() const
+  { return "Compress_task"; }
+
+ private:
+  Output_compressed_section* os_;
+  const unsigned int chunk_;
+  Task_token* const final_blocker_;
+};
+
 // Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, into a buffer
 // UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns TRUE if it
 // decompressed successfully, false if it failed.  The buffer, of
@@ -211,8 +323,149 @@ decompress_input_section(const unsigned char* compressed_data,
 
 // Class Output_compressed_section.
 
+unsigned int Output_compressed_section::compressed_section_count;
+unsigned int Output_compressed_section::compressed_chunk_count;
+uint64_t Output_compressed_section::uncompressed_bytes;
+uint64_t Output_compressed_section::compressed_bytes;
+long Output_compressed_section::chunk_compress_time;
+
+// We don't split sections into chunks smaller than this, since the
+// overhead of the separate streams and tasks would outweigh the gain.
+
+static const off_t min_compress_chunk_size = 256 * 1024;
+
+// Return the number of chunks to compress in parallel.  This depends
+// only on the section size and the options, not on the number of
+// threads, so that the output is the same however we are run.
+
+unsigned int
+Output_compressed_section::compress_task_count() const
+{
+  uint64_t max_tasks = this->options_->compress_debug_sections_threads();
+  if (max_tasks <= 1
+      || strcmp(this->options_->compress_debug_sections(), "none") == 0)
+    return 0;
+
+  off_t size = this->postprocessing_buffer_size();
+  uint64_t count = (size + min_compress_chunk_size - 1)
+		   / min_compress_chunk_size;
+  if (count > max_tasks)
+    count = max_tasks;
+  return count <= 1 ? 0 : count;
+}
+
+// Split the section into chunks and queue a task for each one.
+
+void
+Output_compressed_section::queue_compress_tasks(Workqueue* workqueue,
+						Task_token* blocker)
+{
+  unsigned int count = this->compress_task_count();
+  gold_assert(count > 0 && this->chunks_.empty());
+
+  // At this point the contents of all regular input sections will
+  // have been copied into the postprocessing buffer, and relocations
+  // will have been applied.  Now we need to copy in the contents of
+  // anything other than a regular input section.
+  this->write_to_postprocessing_buffer();
+
+  off_t size = this->postprocessing_buffer_size();
+  off_t chunk_size = (size + count - 1) / count;
+  this->chunks_.resize(count);
+  for (unsigned int i = 0; i < count; ++i)
+    {
+      Compressed_chunk* chunk = &this->chunks_[i];
+      chunk->offset = i * chunk_size;
+      chunk->size = std::min(chunk_size, size - chunk->offset);
+    }
+
+  for (unsigned int i = 0; i < count; ++i)
+    workqueue->queue(new Compress_task(this, i, blocker));
+}
+
+// Compress chunk I.
+
+void
+Output_compressed_section::compress_chunk(unsigned int i)
+{
+  Timer timer;
+  timer.start();
+
+  Compressed_chunk* chunk = &this->chunks_[i];
+  const unsigned char* buffer = this->postprocessing_buffer();
+
+  // Prime the compressor with the preceding window of data.
+  const off_t window_size = 32 * 1024;
+  off_t dictionary_size = std::min(chunk->offset, window_size);
+
+  const unsigned char* p = buffer + chunk->offset;
+  chunk->adler = adler32(adler32(0, NULL, 0), p, chunk->size);
+  if (!zlib_compress_raw(p - dictionary_size, dictionary_size, p,
+			 chunk->size, i + 1 == this->chunks_.size(),
+			 &chunk->data, &chunk->data_size))
+    chunk->failed = true;
+
+  chunk->compress_time = timer.get_elapsed_time().wall;
+}
+
+// Combine the compressed chunks into one zlib stream, consisting of a
+// two byte header, the concatenated raw deflate streams, and the
+// Adler-32 checksum of all the data.  This allocates the result in the
+// same way as zlib_compress.
+
+bool
+Output_compressed_section::combine_chunks(int header_size,
+					  unsigned char** compressed_data,
+					  unsigned long* compressed_size)
+{
+  // Each task only sets the status of its own chunk; the tasks have
+  // all finished by now.
+  unsigned long size = 2 + 4;
+  for (Compressed_chunks::const_iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      if (p->failed)
+	return false;
+      size += p->data_size;
+    }
+
+  *compressed_data = new unsigned char[header_size + size];
+  unsigned char* pov = *compressed_data + header_size;
+
+  // CMF is deflate with a 32K window.  FLG records the compression
+  // level as compress2 would, and makes the header a multiple of 31.
+  const unsigned int cmf = 0x78;
+  unsigned int flg = zlib_compress_level() >= 9 ? 3 << 6 : 0;
+  flg += 31 - (cmf * 256 + flg) % 31;
+  pov[0] = cmf;
+  pov[1] = flg;
+  pov += 2;
+
+  unsigned long adler = adler32(0, NULL, 0);
+  for (Compressed_chunks::iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      memcpy(pov, p->data, p->data_size);
+      pov += p->data_size;
+      adler = adler32_combine(adler, p->adler, p->size);
+
+      ++compressed_chunk_count;
+      chunk_compress_time += p->compress_time;
+    }
+
+  elfcpp::Swap_unaligned<32, true>::writeval(pov, adler);
+  pov += 4;
+  gold_assert(pov == *compressed_data + header_size + size);
+
+  *compressed_size = header_size + size;
+  return true;
+}
+
 // Set the final data size of a compressed section.  This is where
-// we actually compress the section data.
+// we actually compress the section data, unless that was done by
+// tasks queued by queue_compress_tasks.
 
 void
 Output_compressed_section::set_final_data_size()
@@ -226,8 +479,10 @@ Output_compressed_section::set_final_data_size()
   // At this point the contents of all regular input sections will
   // have been copied into the postprocessing buffer, and relocations
   // will have been applied.  Now we need to copy in the contents of
-  // anything other than a regular input section.
-  this->write_to_postprocessing_buffer();
+  // anything other than a regular input section.  If we compressed
+  // in chunks, this was done before queuing the tasks.
+  if (this->chunks_.empty())
+    this->write_to_postprocessing_buffer();
 
   bool success = false;
   enum { none, gnu_zlib, gabi_zlib } compress;
@@ -248,12 +503,28 @@ Output_compressed_section::set_final_data_size()
     }
   else
     compress = none;
-  if (compress != none)
+  if (compress != none && !this->chunks_.empty())
+    success = this->combine_chunks(compression_header_size, &this->data_,
+				   &compressed_size);
+  else if (compress != none)
     success = zlib_compress(compression_header_size, uncompressed_data,
 			    uncompressed_size, &this->data_,
 			    &compressed_size);
+
+  for (Compressed_chunks::iterator p = this->chunks_.begin();
+       p != this->chunks_.end();
+       ++p)
+    {
+      delete[] p->data;
+      p->data = NULL;
+    }
+
   if (success)
     {
+      ++compressed_section_count;
+      uncompressed_bytes += uncompressed_size;
+      compressed_bytes += compressed_size;
+
       elfcpp::Elf_Xword flags = this->flags();
       if (compress == gabi_zlib)
 	{
@@ -319,6 +590,24 @@ Output_compressed_section::set_final_data_size()
     }
 }
 
+// Print statistics about compressed sections.
+
+void
+Output_compressed_section::print_stats()
+{
+  fprintf(stderr, _("%s: compressed sections: %u\n"),
+	  program_name, compressed_section_count);
+  fprintf(stderr, _("%s: compressed section bytes: %llu -> %llu\n"),
+	  program_name,
+	  static_cast<unsigned long long>(uncompressed_bytes),
+	  static_cast<unsigned long long>(compressed_bytes));
+  fprintf(stderr, _("%s: compressed section chunks: %u\n"),
+	  program_name, compressed_chunk_count);
+  fprintf(stderr, _("%s: compressed section chunk time: %ld.%03ld\n"),
+	  program_name, chunk_compress_time / 1000,
+	  chunk_compress_time % 1000);
+}
+
 // Write out a compressed section.  If we couldn't compress, we just
 // write it out as normal, uncompressed data.
 
@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -36,6 +37,8 @@ namespace gold
 {
 
 class General_options;
+class Workqueue;
+class Task_token;
 
 // Read the compression header of a compressed debug section and return
 // the uncompressed size.
@@ -60,9 +63,33 @@ class Output_compressed_section : public Output_section
 			    const char* name, elfcpp::Elf_Word flags,
 			    elfcpp::Elf_Xword type)
     : Output_section(name, flags, type),
-      options_(options)
+      options_(options), data_(NULL), chunks_()
   { this->set_requires_postprocessing(); }
 
+  // Return the number of chunks into which the contents of this
+  // section will be split by queue_compress_tasks.  This is zero if
+  // the section should be compressed in one piece by
+  // set_final_data_size.
+  unsigned int
+  compress_task_count() const;
+
+  // Copy the contents of the section into the postprocessing buffer,
+  // split it into compress_task_count() chunks, and queue a task to
+  // compress each one.  Each task unblocks BLOCKER when done; the
+  // caller must have already added the blockers.  This must be called
+  // after all input sections have been relocated.
+  void
+  queue_compress_tasks(Workqueue*, Task_token* blocker);
+
+  // Compress chunk I.  This is called by the compression task, and
+  // may run in parallel with other chunks.
+  void
+  compress_chunk(unsigned int i);
+
+  // Print statistics about compressed sections to stderr.
+  static void
+  print_stats();
+
  protected:
   // Set the final data size.
   void
@@ -73,12 +100,61 @@ class Output_compressed_section : public Output_section
   do_write(Output_file*);
 
  private:
+  // A piece of the section which is compressed separately into a raw
+  // deflate stream.  The streams are concatenated to form a single
+  // zlib stream.
+  struct Compressed_chunk
+  {
+    Compressed_chunk()
+      : offset(0), size(0), data(NULL), data_size(0), adler(0),
+	failed(false), compress_time(0)
+    { }
+
+    // Offset and size of the uncompressed data in the postprocessing
+    // buffer.
+    off_t offset;
+    off_t size;
+    // The compressed data, allocated with new[], or NULL on failure.
+    unsigned char* data;
+    // The size of the compressed data.
+    unsigned long data_size;
+    // The Adler-32 checksum of the uncompressed data.
+    unsigned long adler;
+    // Whether compressing this chunk failed.
+    bool failed;
+    // Wall clock time in milliseconds spent compressing this chunk.
+    long compress_time;
+  };
+
+  typedef std::vector<Compressed_chunk> Compressed_chunks;
+
+  // Combine the compressed chunks into a single zlib stream following
+  // a header of HEADER_SIZE bytes.
+  bool
+  combine_chunks(int header_size, unsigned char** compressed_data,
+		 unsigned long* compressed_size);
+
   // The options--this includes the compression type.
   const General_options* options_;
   // The compressed data.
   unsigned char* data_;
   // The new section name if we do compress.
   std::string new_section_name_;
+  // The chunks compressed by tasks queued by queue_compress_tasks.
+  // This is empty if the section is compressed in one piece.
+  Compressed_chunks chunks_;
+
+  // Statistics, reported by print_stats.
+  // Number of sections compressed.
+  static unsigned int compressed_section_count;
+  // Number of chunks compressed in parallel tasks.
+  static unsigned int compressed_chunk_count;
+  // Total size of the sections before compression.
+  static uint64_t uncompressed_bytes;
+  // Total size of the sections after compression.
+  static uint64_t compressed_bytes;
+  // Total wall clock time in milliseconds spent in compression tasks.
+  static long chunk_compress_time;
 };
 
 } // End namespace gold.
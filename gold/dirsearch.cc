@@ -32,6 +32,7 @@
 #include "gold-threads.h"
 #include "options.h"
 #include "workqueue.h"
+#include "link-cache.h"
 #include "dirsearch.h"
 
 namespace
@@ -263,14 +264,18 @@ Dirsearch::find(const std::vector<std::string>& names,
 	{
 	  if (pdc->find(*n))
 	    {
+	      record_link_cache_probe(p->name() + '/' + *n, true);
 	      *is_in_sysroot = p->is_in_sysroot();
 	      *pindex = i;
 	      *found_name = *n;
 	      return p->name() + '/' + *n;
 	    }
 	  else
-	    gold_debug(DEBUG_FILES, "Attempt to open %s/%s failed",
-		       p->name().c_str(), (*n).c_str());
+	    {
+	      gold_debug(DEBUG_FILES, "Attempt to open %s/%s failed",
+			 p->name().c_str(), (*n).c_str());
+	      record_link_cache_probe(p->name() + '/' + *n, false);
+	    }
 	}
     }
 
@@ -289,14 +294,18 @@ Dirsearch::find_file_in_dir_list(const std::string& name,
   struct stat buf;
   std::string extra_name = extra_search_dir + '/' + name;
 
-  if (stat(extra_name.c_str(), &buf) == 0)
+  bool found = stat(extra_name.c_str(), &buf) == 0;
+  record_link_cache_probe(extra_name, found);
+  if (found)
     return extra_name;
   for (General_options::Dir_list::const_iterator dir = directories.begin();
        dir != directories.end();
        ++dir)
     {
       std::string full_name = dir->name() + '/' + name;
-      if (stat(full_name.c_str(), &buf) == 0)
+      found = stat(full_name.c_str(), &buf) == 0;
+      record_link_cache_probe(full_name, found);
+      if (found)
         return full_name;
     }
   return name;
@@ -966,6 +966,12 @@ class Dwarf_line_info
             std::vector<std::string>* other_lines)
   { return this->do_addr2line(shndx, offset, other_lines); }
 
+  // Return a new Dwarf_line_info for OBJECT, for the size and
+  // endianness of the target.  If READ_SHNDX is not -1U, only read the
+  // line information for that section.
+  static Dwarf_line_info*
+  create(Object* object, unsigned int read_shndx);
+
   // A helper function for a single addr2line lookup.  It also keeps a
   // cache of the last CACHE_SIZE Dwarf_line_info objects it created;
   // set to 0 not to cache at all.  The larger CACHE_SIZE is, the more
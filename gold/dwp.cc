@@ -45,6 +45,7 @@
 #include "compressed_output.h"
 #include "stringpool.h"
 #include "dwarf_reader.h"
+#include "gold-threads.h"
 
 static void
 usage(FILE* fd, int) ATTRIBUTE_NORETURN;
@@ -99,6 +100,23 @@ struct Unit_set
   { }
 };
 
+// The location of a compilation unit or type unit in an input
+// .debug_info.dwo or .debug_types.dwo section.
+
+struct Unit_location
+{
+  // The offset and length of the unit within the section.
+  off_t offset;
+  off_t length;
+  // The DWO ID of a compilation unit, or the signature of a type unit.
+  uint64_t signature;
+
+  Unit_location(off_t o, off_t l, uint64_t s)
+    : offset(o), length(l), signature(s)
+  { }
+};
+typedef std::vector<Unit_location> Unit_list;
+
 // An input file.
 // This class may represent a .dwo file, a .dwp file
 // produced by an earlier run, or an executable file whose
@@ -109,8 +127,13 @@ class Dwo_file
  public:
   Dwo_file(const char* name)
     : name_(name), obj_(NULL), input_file_(NULL), is_compressed_(),
-      sect_offsets_(), str_offset_map_()
-  { }
+      sect_offsets_(), str_offset_map_(), debug_types_(), debug_str_(0),
+      debug_cu_index_(0), debug_tu_index_(0), info_units_(), types_units_(),
+      machine_(0), size_(0), big_endian_(false), osabi_(0), abiversion_(0)
+  {
+    for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+      this->debug_shndx_[i] = 0;
+  }
 
   ~Dwo_file();
 
@@ -119,9 +142,16 @@ class Dwo_file
   void
   read_executable(File_list* files);
 
-  // Read the input file and send its contents to OUTPUT_FILE.
+  // Read the input file: find the debug sections, decompress them,
+  // and find the units in them.  This does not use the output file,
+  // so it may be run for several input files in parallel.
+  void
+  read();
+
+  // Send the contents of the input file, which must have been read,
+  // to OUTPUT_FILE.
   void
-  read(Dwp_output_file* output_file);
+  add_to_output(Dwp_output_file* output_file);
 
   // Verify a .dwp file given a list of .dwo files referenced by the
   // corresponding executable file.  Returns true if no problems
@@ -146,14 +176,15 @@ class Dwo_file
 
   // Create a Sized_relobj_dwo of the given size and endianness,
   // and record the target info.  P is a pointer to the ELF header
-  // in memory.
+  // in memory.  If DECOMPRESS is true, decompress the compressed
+  // sections now.
   Relobj*
-  make_object(Dwp_output_file* output_file);
+  make_object(Dwp_output_file* output_file, bool decompress);
 
   template <int size, bool big_endian>
   Relobj*
   sized_make_object(const unsigned char* p, Input_file* input_file,
-		    Dwp_output_file* output_file);
+		    Dwp_output_file* output_file, bool decompress);
 
   // Return the number of sections in the input object file.
   unsigned int
@@ -221,10 +252,11 @@ class Dwo_file
   remap_str_offset(section_offset_type val);
 
   // Add a set of .debug_info.dwo or .debug_types.dwo and related sections
-  // to OUTPUT_FILE.
+  // to OUTPUT_FILE.  UNITS are the units found in the .debug_info.dwo
+  // or .debug_types.dwo section.
   void
   add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
-	       bool is_debug_types);
+	       bool is_debug_types, const Unit_list& units);
 
   // The filename.
   const char* name_;
@@ -238,6 +270,25 @@ class Dwo_file
   std::vector<Section_bounds> sect_offsets_;
   // Map input string offsets to output string offsets.
   Str_offset_map str_offset_map_;
+  // The debug sections found by read(), indexed by DW_SECT.
+  unsigned int debug_shndx_[elfcpp::DW_SECT_MAX + 1];
+  // The .debug_types.dwo sections.
+  std::vector<unsigned int> debug_types_;
+  // The .debug_str.dwo section.
+  unsigned int debug_str_;
+  // The .debug_cu_index and .debug_tu_index sections of a .dwp file.
+  unsigned int debug_cu_index_;
+  unsigned int debug_tu_index_;
+  // The units in the .debug_info.dwo section, and in each of the
+  // .debug_types.dwo sections.
+  Unit_list info_units_;
+  std::vector<Unit_list> types_units_;
+  // The target info from the ELF header.
+  int machine_;
+  int size_;
+  bool big_endian_;
+  int osabi_;
+  int abiversion_;
 };
 
 // An ELF input file.
@@ -264,6 +315,10 @@ class Sized_relobj_dwo : public Sized_relobj<size, big_endian>
   void
   setup();
 
+  // Decompress the compressed sections.
+  void
+  decompress_sections();
+
  protected:
   // Return section type.
   unsigned int
@@ -711,23 +766,23 @@ class Dwo_name_info_reader : public Dwarf_info_reader
   File_list* files_;
 };
 
-// A specialization of Dwarf_info_reader, for reading DWARF CUs and TUs
-// and adding them to the output file.
+// A specialization of Dwarf_info_reader, for finding the DWARF CUs
+// and TUs in an input file.
 
 class Unit_reader : public Dwarf_info_reader
 {
  public:
   Unit_reader(bool is_type_unit, Relobj* object, unsigned int shndx)
     : Dwarf_info_reader(is_type_unit, object, NULL, 0, shndx, 0, 0),
-      output_file_(NULL), sections_(NULL)
+      units_(NULL)
   { }
 
   ~Unit_reader()
   { }
 
-  // Read the CUs or TUs and add them to the output file.
+  // Read the CUs or TUs and record their locations in UNITS.
   void
-  add_units(Dwp_output_file*, unsigned int debug_abbrev, Section_bounds*);
+  read_units(unsigned int debug_abbrev, Unit_list* units);
 
  protected:
   // Visit a compilation unit.
@@ -740,8 +795,7 @@ class Unit_reader : public Dwarf_info_reader
 		  uint64_t signature, Dwarf_die*);
 
  private:
-  Dwp_output_file* output_file_;
-  Section_bounds* sections_;
+  Unit_list* units_;
 };
 
 // Return the name of a DWARF .dwo section.
@@ -824,12 +878,41 @@ Sized_relobj_dwo<size, big_endian>::do_section_contents(
   return this->get_view(loc.file_offset, *plen, true, cache);
 }
 
+// Decompress the compressed sections, and keep the contents until the
+// object is deleted.  This lets us decompress the sections of several
+// files in parallel, before they are used.
+
+template <int size, bool big_endian>
+void
+Sized_relobj_dwo<size, big_endian>::decompress_sections()
+{
+  Compressed_section_map* compressed_sections = this->compressed_sections();
+  if (compressed_sections == NULL)
+    return;
+  for (Compressed_section_map::iterator p = compressed_sections->begin();
+       p != compressed_sections->end();
+       ++p)
+    {
+      if (p->second.contents != NULL)
+	continue;
+      section_size_type len;
+      bool is_new;
+      const unsigned char* contents =
+	  this->decompressed_section_contents(p->first, &len, &is_new);
+      if (is_new)
+	p->second.contents = contents;
+    }
+}
+
 // Class Dwo_file.
 
 Dwo_file::~Dwo_file()
 {
   if (this->obj_ != NULL)
-    delete this->obj_;
+    {
+      this->obj_->discard_decompressed_sections();
+      delete this->obj_;
+    }
   if (this->input_file_ != NULL)
     delete this->input_file_;
 }
@@ -840,7 +923,7 @@ Dwo_file::~Dwo_file()
 void
 Dwo_file::read_executable(File_list* files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object(NULL, false);
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -880,25 +963,20 @@ Dwo_file::read_executable(File_list* files)
     }
 }
 
-// Read the input file and send its contents to OUTPUT_FILE.
+// Read the input file, find the debug sections, and find the units in
+// them.  The compressed sections are decompressed here, so that this
+// work can be done for several files in parallel.
 
 void
-Dwo_file::read(Dwp_output_file* output_file)
+Dwo_file::read()
 {
-  this->obj_ = this->make_object(output_file);
+  this->obj_ = this->make_object(NULL, true);
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
   this->sect_offsets_.resize(shnum);
 
-  typedef std::vector<unsigned int> Types_list;
-  Types_list debug_types;
-  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
-  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
-    debug_shndx[i] = 0;
-  unsigned int debug_str = 0;
-  unsigned int debug_cu_index = 0;
-  unsigned int debug_tu_index = 0;
+  unsigned int* debug_shndx = this->debug_shndx_;
 
   // Scan the section table and collect debug sections.
   // (Section index 0 is a dummy section; skip it.)
@@ -920,7 +998,7 @@ Dwo_file::read(Dwp_output_file* output_file)
       if (strcmp(suffix, "info.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_INFO] = i;
       else if (strcmp(suffix, "types.dwo") == 0)
-	debug_types.push_back(i);
+	this->debug_types_.push_back(i);
       else if (strcmp(suffix, "abbrev.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_ABBREV] = i;
       else if (strcmp(suffix, "line.dwo") == 0)
@@ -928,7 +1006,7 @@ Dwo_file::read(Dwp_output_file* output_file)
       else if (strcmp(suffix, "loc.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_LOC] = i;
       else if (strcmp(suffix, "str.dwo") == 0)
-	debug_str = i;
+	this->debug_str_ = i;
       else if (strcmp(suffix, "str_offsets.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_STR_OFFSETS] = i;
       else if (strcmp(suffix, "macinfo.dwo") == 0)
@@ -936,45 +1014,87 @@ Dwo_file::read(Dwp_output_file* output_file)
       else if (strcmp(suffix, "macro.dwo") == 0)
 	debug_shndx[elfcpp::DW_SECT_MACRO] = i;
       else if (strcmp(suffix, "cu_index") == 0)
-	debug_cu_index = i;
+	this->debug_cu_index_ = i;
       else if (strcmp(suffix, "tu_index") == 0)
-	debug_tu_index = i;
+	this->debug_tu_index_ = i;
     }
 
+  // The units of a .dwp file are found from its index sections when
+  // it is added to the output file.
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
+    return;
+
+  // If we found no index sections, this is a .dwo file.  Find the
+  // units in the .debug_info.dwo and .debug_types.dwo sections.
+  if ((debug_shndx[elfcpp::DW_SECT_INFO] > 0 || !this->debug_types_.empty())
+      && debug_shndx[elfcpp::DW_SECT_ABBREV] == 0)
+    gold_fatal(_("%s: no .debug_abbrev.dwo section found"), this->name_);
+
+  if (debug_shndx[elfcpp::DW_SECT_INFO] > 0)
+    {
+      Unit_reader reader(false, this->obj_, debug_shndx[elfcpp::DW_SECT_INFO]);
+      reader.read_units(debug_shndx[elfcpp::DW_SECT_ABBREV],
+			&this->info_units_);
+    }
+
+  this->types_units_.resize(this->debug_types_.size());
+  for (unsigned int i = 0; i < this->debug_types_.size(); ++i)
+    {
+      Unit_reader reader(true, this->obj_, this->debug_types_[i]);
+      reader.read_units(debug_shndx[elfcpp::DW_SECT_ABBREV],
+			&this->types_units_[i]);
+    }
+}
+
+// Send the contents of the input file to OUTPUT_FILE.  The files are
+// added in order, so the output does not depend on how they were read.
+
+void
+Dwo_file::add_to_output(Dwp_output_file* output_file)
+{
+  output_file->record_target_info(this->name_, this->machine_, this->size_,
+				  this->big_endian_, this->osabi_,
+				  this->abiversion_);
+
+  unsigned int debug_shndx[elfcpp::DW_SECT_MAX + 1];
+  for (unsigned int i = 0; i <= elfcpp::DW_SECT_MAX; i++)
+    debug_shndx[i] = this->debug_shndx_[i];
+
   // Merge the input string table into the output string table.
-  this->add_strings(output_file, debug_str);
+  this->add_strings(output_file, this->debug_str_);
 
   // If we found any .dwp index sections, read those and add the section
   // sets to the output file.
-  if (debug_cu_index > 0 || debug_tu_index > 0)
+  if (this->debug_cu_index_ > 0 || this->debug_tu_index_ > 0)
     {
-      if (debug_cu_index > 0)
-	this->read_unit_index(debug_cu_index, debug_shndx, output_file, false);
-      if (debug_tu_index > 0)
+      if (this->debug_cu_index_ > 0)
+	this->read_unit_index(this->debug_cu_index_, debug_shndx, output_file,
+			      false);
+      if (this->debug_tu_index_ > 0)
         {
-	  if (debug_types.size() > 1)
+	  if (this->debug_types_.size() > 1)
 	    gold_fatal(_("%s: .dwp file must have no more than one "
 			 ".debug_types.dwo section"), this->name_);
-          if (debug_types.size() == 1)
-            debug_shndx[elfcpp::DW_SECT_TYPES] = debug_types[0];
+          if (this->debug_types_.size() == 1)
+            debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[0];
           else
             debug_shndx[elfcpp::DW_SECT_TYPES] = 0;
-	  this->read_unit_index(debug_tu_index, debug_shndx, output_file, true);
+	  this->read_unit_index(this->debug_tu_index_, debug_shndx,
+				output_file, true);
 	}
       return;
     }
 
   // If we found no index sections, this is a .dwo file.
   if (debug_shndx[elfcpp::DW_SECT_INFO] > 0)
-    this->add_unit_set(output_file, debug_shndx, false);
+    this->add_unit_set(output_file, debug_shndx, false, this->info_units_);
 
   debug_shndx[elfcpp::DW_SECT_INFO] = 0;
-  for (Types_list::const_iterator tp = debug_types.begin();
-       tp != debug_types.end();
-       ++tp)
+  for (unsigned int i = 0; i < this->debug_types_.size(); ++i)
     {
-      debug_shndx[elfcpp::DW_SECT_TYPES] = *tp;
-      this->add_unit_set(output_file, debug_shndx, true);
+      debug_shndx[elfcpp::DW_SECT_TYPES] = this->debug_types_[i];
+      this->add_unit_set(output_file, debug_shndx, true,
+			 this->types_units_[i]);
     }
 }
 
@@ -985,7 +1105,7 @@ Dwo_file::read(Dwp_output_file* output_file)
 bool
 Dwo_file::verify(const File_list& files)
 {
-  this->obj_ = this->make_object(NULL);
+  this->obj_ = this->make_object(NULL, false);
 
   unsigned int shnum = this->shnum();
   this->is_compressed_.resize(shnum);
@@ -1024,7 +1144,7 @@ Dwo_file::verify(const File_list& files)
 // and record the target info.
 
 Relobj*
-Dwo_file::make_object(Dwp_output_file* output_file)
+Dwo_file::make_object(Dwp_output_file* output_file, bool decompress)
 {
   // Open the input file.
   Input_file* input_file = new Input_file(this->name_);
@@ -1059,14 +1179,14 @@ Dwo_file::make_object(Dwp_output_file* output_file)
       if (big_endian)
 #ifdef HAVE_TARGET_32_BIG
 	return this->sized_make_object<32, true>(elf_header, input_file,
-						 output_file);
+						 output_file, decompress);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_32_LITTLE
 	return this->sized_make_object<32, false>(elf_header, input_file,
-						  output_file);
+						  output_file, decompress);
 #else
 	gold_unreachable();
 #endif
@@ -1076,14 +1196,14 @@ Dwo_file::make_object(Dwp_output_file* output_file)
       if (big_endian)
 #ifdef HAVE_TARGET_64_BIG
 	return this->sized_make_object<64, true>(elf_header, input_file,
-						 output_file);
+						 output_file, decompress);
 #else
 	gold_unreachable();
 #endif
       else
 #ifdef HAVE_TARGET_64_LITTLE
 	return this->sized_make_object<64, false>(elf_header, input_file,
-						  output_file);
+						  output_file, decompress);
 #else
 	gold_unreachable();
 #endif
@@ -1098,17 +1218,23 @@ Dwo_file::make_object(Dwp_output_file* output_file)
 template <int size, bool big_endian>
 Relobj*
 Dwo_file::sized_make_object(const unsigned char* p, Input_file* input_file,
-			    Dwp_output_file* output_file)
+			    Dwp_output_file* output_file, bool decompress)
 {
   elfcpp::Ehdr<size, big_endian> ehdr(p);
   Sized_relobj_dwo<size, big_endian>* obj =
       new Sized_relobj_dwo<size, big_endian>(this->name_, input_file, ehdr);
   obj->setup();
+  if (decompress)
+    obj->decompress_sections();
+  this->machine_ = ehdr.get_e_machine();
+  this->size_ = size;
+  this->big_endian_ = big_endian;
+  this->osabi_ = ehdr.get_e_ident()[elfcpp::EI_OSABI];
+  this->abiversion_ = ehdr.get_e_ident()[elfcpp::EI_ABIVERSION];
   if (output_file != NULL)
-    output_file->record_target_info(
-	this->name_, ehdr.get_e_machine(), size, big_endian,
-	ehdr.get_e_ident()[elfcpp::EI_OSABI],
-	ehdr.get_e_ident()[elfcpp::EI_ABIVERSION]);
+    output_file->record_target_info(this->name_, this->machine_, size,
+				    big_endian, this->osabi_,
+				    this->abiversion_);
   return obj;
 }
 
@@ -1512,7 +1638,7 @@ Dwo_file::remap_str_offset(section_offset_type val)
 
 void
 Dwo_file::add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
-		       bool is_debug_types)
+		       bool is_debug_types, const Unit_list& units)
 {
   unsigned int shndx = (is_debug_types
 			? debug_shndx[elfcpp::DW_SECT_TYPES]
@@ -1532,11 +1658,53 @@ Dwo_file::add_unit_set(Dwp_output_file* output_file, unsigned int *debug_shndx,
 					 static_cast<elfcpp::DW_SECT>(i));
     }
 
-  // Parse the .debug_info or .debug_types section and add each compilation
-  // or type unit to the output file, along with the contributions to the
-  // related sections.
-  Unit_reader reader(is_debug_types, this->obj_, shndx);
-  reader.add_units(output_file, debug_shndx[elfcpp::DW_SECT_ABBREV], sections);
+  // Add each compilation or type unit found by read() to the output
+  // file, along with the contributions to the related sections.
+  section_size_type len;
+  bool is_new;
+  const unsigned char* contents = this->section_contents(shndx, &len, &is_new);
+  for (Unit_list::const_iterator p = units.begin(); p != units.end(); ++p)
+    {
+      gold_assert(p->offset >= 0
+		  && static_cast<section_size_type>(p->offset + p->length) <= len);
+      if (is_debug_types && output_file->lookup_tu(p->signature))
+	continue;
+
+      Unit_set* unit_set = new Unit_set();
+      unit_set->signature = p->signature;
+      for (unsigned int i = elfcpp::DW_SECT_ABBREV;
+	   i <= elfcpp::DW_SECT_MAX;
+	   ++i)
+	unit_set->sections[i] = sections[i];
+
+      if (is_debug_types)
+	{
+	  unsigned char* unit_contents = new unsigned char[p->length];
+	  memcpy(unit_contents, contents + p->offset, p->length);
+	  section_offset_type off =
+	      output_file->add_contribution(elfcpp::DW_SECT_TYPES,
+					    unit_contents, p->length, 1);
+	  Section_bounds bounds(off, p->length);
+	  unit_set->sections[elfcpp::DW_SECT_TYPES] = bounds;
+	  output_file->add_tu_set(unit_set);
+	}
+      else
+	{
+	  // Dwp_output_file::add_contribution writes the .debug_info.dwo
+	  // section directly to the output file, so we do not need to
+	  // duplicate the section contents, and add_contribution does not
+	  // need to free the memory.
+	  section_offset_type off =
+	      output_file->add_contribution(elfcpp::DW_SECT_INFO,
+					    contents + p->offset,
+					    p->length, 1);
+	  Section_bounds bounds(off, p->length);
+	  unit_set->sections[elfcpp::DW_SECT_INFO] = bounds;
+	  output_file->add_cu_set(unit_set);
+	}
+    }
+  if (is_new)
+    delete[] contents;
 }
 
 // Class Dwp_output_file.
@@ -2220,15 +2388,12 @@ Dwo_name_info_reader::visit_compilation_unit(off_t, off_t, Dwarf_die* die)
 
 // Class Unit_reader.
 
-// Read the CUs or TUs and add them to the output file.
+// Read the CUs or TUs and record their locations.
 
 void
-Unit_reader::add_units(Dwp_output_file* output_file,
-		       unsigned int debug_abbrev,
-		       Section_bounds* sections)
+Unit_reader::read_units(unsigned int debug_abbrev, Unit_list* units)
 {
-  this->output_file_ = output_file;
-  this->sections_ = sections;
+  this->units_ = units;
   this->set_abbrev_shndx(debug_abbrev);
   this->parse();
 }
@@ -2236,54 +2401,46 @@ Unit_reader::add_units(Dwp_output_file* output_file,
 // Visit a compilation unit.
 
 void
-Unit_reader::visit_compilation_unit(off_t, off_t cu_length, Dwarf_die* die)
+Unit_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
+				    Dwarf_die* die)
 {
   if (cu_length == 0)
     return;
 
-  Unit_set* unit_set = new Unit_set();
-  unit_set->signature = die->uint_attribute(elfcpp::DW_AT_GNU_dwo_id);
-  for (unsigned int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
-    unit_set->sections[i] = this->sections_[i];
-
-  // Dwp_output_file::add_contribution writes the .debug_info.dwo section
-  // directly to the output file, so we do not need to duplicate the
-  // section contents, and add_contribution does not need to free the memory.
-  section_offset_type off =
-      this->output_file_->add_contribution(elfcpp::DW_SECT_INFO,
-					   this->buffer_at_offset(0),
-					   cu_length, 1);
-  Section_bounds bounds(off, cu_length);
-  unit_set->sections[elfcpp::DW_SECT_INFO] = bounds;
-  this->output_file_->add_cu_set(unit_set);
+  uint64_t dwo_id = die->uint_attribute(elfcpp::DW_AT_GNU_dwo_id);
+  this->units_->push_back(Unit_location(cu_offset, cu_length, dwo_id));
 }
 
 // Visit a type unit.
 
 void
-Unit_reader::visit_type_unit(off_t, off_t tu_length, off_t,
+Unit_reader::visit_type_unit(off_t tu_offset, off_t tu_length, off_t,
 			     uint64_t signature, Dwarf_die*)
 {
   if (tu_length == 0)
     return;
-  if (this->output_file_->lookup_tu(signature))
-    return;
 
-  Unit_set* unit_set = new Unit_set();
-  unit_set->signature = signature;
-  for (unsigned int i = elfcpp::DW_SECT_ABBREV; i <= elfcpp::DW_SECT_MAX; ++i)
-    unit_set->sections[i] = this->sections_[i];
-
-  unsigned char* contents = new unsigned char[tu_length];
-  memcpy(contents, this->buffer_at_offset(0), tu_length);
-  section_offset_type off =
-      this->output_file_->add_contribution(elfcpp::DW_SECT_TYPES, contents,
-					   tu_length, 1);
-  Section_bounds bounds(off, tu_length);
-  unit_set->sections[elfcpp::DW_SECT_TYPES] = bounds;
-  this->output_file_->add_tu_set(unit_set);
+  this->units_->push_back(Unit_location(tu_offset, tu_length, signature));
 }
 
+// Jobs which read a batch of input files in parallel.
+
+class Dwo_read_jobs : public Parallel_jobs
+{
+ public:
+  Dwo_read_jobs(const std::vector<Dwo_file*>& files)
+    : files_(files)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  { this->files_[i]->read(); }
+
+ private:
+  const std::vector<Dwo_file*>& files_;
+};
+
 }; // End namespace gold
 
 using namespace gold;
@@ -2292,6 +2449,7 @@ using namespace gold;
 
 enum Dwp_options {
   VERIFY_ONLY = 0x101,
+  THREADS
 };
 
 struct option dwp_options[] =
@@ -2299,6 +2457,7 @@ struct option dwp_options[] =
     { "exec", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
     { "output", required_argument, NULL, 'o' },
+    { "threads", optional_argument, NULL, THREADS },
     { "verbose", no_argument, NULL, 'v' },
     { "verify-only", no_argument, NULL, VERIFY_ONLY },
     { "version", no_argument, NULL, 'V' },
@@ -2315,6 +2474,9 @@ usage(FILE* fd, int exit_status)
   fprintf(fd, _("  -e EXE, --exec EXE       Get list of dwo files from EXE"
 					   " (defaults output to EXE.dwp)\n"));
   fprintf(fd, _("  -o FILE, --output FILE   Set output dwp file name\n"));
+  fprintf(fd, _("  --threads[=N]            Read input files using N threads"
+					   " (defaults to the number of"
+					   " processors)\n"));
   fprintf(fd, _("  -v, --verbose            Verbose output\n"));
   fprintf(fd, _("  --verify-only            Verify output file against"
 					   " exec file\n"));
@@ -2363,12 +2525,6 @@ main(int argc, char** argv)
   Errors errors(program_name);
   set_parameters_errors(&errors);
 
-  // Initialize gold's global options.  We don't use these in
-  // this program, but they need to be initialized so that
-  // functions we call from libgold work properly.
-  General_options options;
-  set_parameters_options(&options);
-
   // In libiberty; expands @filename to the args in "filename".
   expandargv(&argc, &argv);
 
@@ -2378,6 +2534,8 @@ main(int argc, char** argv)
   const char* exe_filename = NULL;
   bool verbose = false;
   bool verify_only = false;
+  bool threads = false;
+  int thread_count = 0;
   int c;
   while ((c = getopt_long(argc, argv, "e:ho:vV", dwp_options, NULL)) != -1)
     {
@@ -2397,6 +2555,16 @@ main(int argc, char** argv)
 	  case VERIFY_ONLY:
 	    verify_only = true;
 	    break;
+	  case THREADS:
+	    threads = true;
+	    if (optarg != NULL)
+	      {
+		char* endp;
+		thread_count = strtol(optarg, &endp, 10);
+		if (*endp != '\0' || thread_count <= 0)
+		  gold_fatal(_("invalid thread count: %s"), optarg);
+	      }
+	    break;
 	  case 'V':
 	    print_version();
 	  case '?':
@@ -2405,6 +2573,28 @@ main(int argc, char** argv)
 	}
     }
 
+  // Initialize gold's global options.  We don't use most of these in
+  // this program, but they need to be initialized so that functions
+  // we call from libgold work properly.  The --threads option is
+  // passed on, so that libgold may run jobs in parallel.
+  std::vector<const char*> gold_args;
+  std::string thread_count_arg;
+  if (threads)
+    {
+      gold_args.push_back("--threads");
+      if (thread_count > 0)
+	{
+	  char buf[32];
+	  snprintf(buf, sizeof buf, "--thread-count=%d", thread_count);
+	  thread_count_arg = buf;
+	  gold_args.push_back(thread_count_arg.c_str());
+	}
+    }
+  Command_line command_line;
+  command_line.process(gold_args.size(),
+		       gold_args.empty() ? NULL : &gold_args[0]);
+  set_parameters_options(&command_line.options());
+
   if (output_filename.empty())
     {
       if (exe_filename == NULL)
@@ -2436,14 +2626,30 @@ main(int argc, char** argv)
       return ok ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
-  // Process each file, adding its contents to the output file.
+  // Process the files in batches.  The files in a batch are read and
+  // decompressed in parallel, and then added to the output file in
+  // order, so the output does not depend on the number of threads.
+  // Only one batch of input files is open at a time.
   Dwp_output_file output_file(output_filename.c_str());
-  for (File_list::const_iterator f = files.begin(); f != files.end(); ++f)
+  int jobs_thread_count = Parallel_jobs::default_thread_count();
+  size_t batch_size = jobs_thread_count > 1 ? 4 * jobs_thread_count : 1;
+  for (size_t start = 0; start < files.size(); start += batch_size)
     {
-      if (verbose)
-	fprintf(stderr, "%s\n", f->dwo_name.c_str());
-      Dwo_file dwo_file(f->dwo_name.c_str());
-      dwo_file.read(&output_file);
+      size_t end = std::min(start + batch_size, files.size());
+      std::vector<Dwo_file*> batch;
+      for (size_t i = start; i < end; ++i)
+	batch.push_back(new Dwo_file(files[i].dwo_name.c_str()));
+
+      Dwo_read_jobs jobs(batch);
+      jobs.run(batch.size(), jobs_thread_count);
+
+      for (size_t i = 0; i < batch.size(); ++i)
+	{
+	  if (verbose)
+	    fprintf(stderr, "%s\n", files[start + i].dwo_name.c_str());
+	  batch[i]->add_to_output(&output_file);
+	  delete batch[i];
+	}
     }
   output_file.finalize();
 
@@ -24,8 +24,10 @@
 
 #include <vector>
 #include <cstring>
+#include <algorithm>
 
 #include "elfcpp.h"
+#include "gold-threads.h"
 #include "parameters.h"
 #include "script.h"
 #include "symtab.h"
@@ -850,6 +852,54 @@ Sized_dynobj<size, big_endian>::do_get_global_symbol_counts(
   *used = count;
 }
 
+// The number of symbol names hashed by each job in Dynobj::Hash_jobs.
+
+static const size_t dynobj_hash_job_size = 4096;
+
+// Jobs which compute the hash codes of the names of a list of symbols.
+// Job I handles symbols I * dynobj_hash_job_size through the next
+// dynobj_hash_job_size symbols, and stores their hash codes at the
+// same indexes.
+
+class Dynobj::Hash_jobs : public Parallel_jobs
+{
+ public:
+  Hash_jobs(uint32_t (*hash)(const char*), const std::vector<Symbol*>& syms,
+	    std::vector<uint32_t>* hashvals)
+    : hash_(hash), syms_(syms), hashvals_(hashvals)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    size_t end = std::min((i + 1) * dynobj_hash_job_size, this->syms_.size());
+    for (size_t j = i * dynobj_hash_job_size; j < end; ++j)
+      (*this->hashvals_)[j] = this->hash_(this->syms_[j]->name());
+  }
+
+ private:
+  uint32_t (*hash_)(const char*);
+  const std::vector<Symbol*>& syms_;
+  std::vector<uint32_t>* hashvals_;
+};
+
+// Set HASHVALS to the hash codes of the names of SYMS.  Shared
+// libraries may export hundreds of thousands of symbols, so we hash
+// the names in parallel.
+
+void
+Dynobj::compute_hashes(uint32_t (*hash)(const char*),
+		       const std::vector<Symbol*>& syms,
+		       std::vector<uint32_t>* hashvals)
+{
+  hashvals->resize(syms.size());
+  size_t job_count = ((syms.size() + dynobj_hash_job_size - 1)
+		      / dynobj_hash_job_size);
+  Hash_jobs jobs(hash, syms, hashvals);
+  jobs.run(job_count, Parallel_jobs::default_thread_count());
+}
+
 // Given a vector of hash codes, compute the number of hash buckets to
 // use.
 
@@ -928,9 +978,8 @@ Dynobj::create_elf_hash_table(const std::vector<Symbol*>& dynsyms,
   unsigned int dynsym_count = dynsyms.size();
 
   // Get the hash values for all the symbols.
-  std::vector<uint32_t> dynsym_hashvals(dynsym_count);
-  for (unsigned int i = 0; i < dynsym_count; ++i)
-    dynsym_hashvals[i] = Dynobj::elf_hash(dynsyms[i]->name());
+  std::vector<uint32_t> dynsym_hashvals;
+  Dynobj::compute_hashes(Dynobj::elf_hash, dynsyms, &dynsym_hashvals);
 
   const unsigned int bucketcount =
     Dynobj::compute_bucket_count(dynsym_hashvals, false);
@@ -1080,9 +1129,6 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
   std::vector<Symbol*> hashed_dynsyms;
   hashed_dynsyms.reserve(count);
 
-  std::vector<uint32_t> dynsym_hashvals;
-  dynsym_hashvals.reserve(count);
-  
   for (unsigned int i = 0; i < count; ++i)
     {
       Symbol* sym = dynsyms[i];
@@ -1093,12 +1139,12 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
 	      || sym->is_forced_local()))
 	unhashed_dynsyms.push_back(sym);
       else
-	{
-	  hashed_dynsyms.push_back(sym);
-	  dynsym_hashvals.push_back(Dynobj::gnu_hash(sym->name()));
-	}
+	hashed_dynsyms.push_back(sym);
     }
 
+  std::vector<uint32_t> dynsym_hashvals;
+  Dynobj::compute_hashes(Dynobj::gnu_hash, hashed_dynsyms, &dynsym_hashvals);
+
   // Put the unhashed symbols at the start of the global portion of
   // the dynamic symbol table.
   const unsigned int unhashed_count = unhashed_dynsyms.size();
@@ -1226,6 +1272,18 @@ Dynobj::sized_create_gnu_hash_table(
   else
     maskbitslog2 += 2;
 
+  // With --hash-bloom-bits, grow the bloom filter until each symbol
+  // gets at least that many bits.  A larger filter lets the dynamic
+  // linker reject more lookups without walking a chain.
+  const unsigned int bloom_bits = parameters->options().hash_bloom_bits();
+  if (bloom_bits > 0)
+    {
+      const uint64_t want = static_cast<uint64_t>(nsyms) * bloom_bits;
+      while (maskbitslog2 < 31
+	     && (static_cast<uint64_t>(1) << maskbitslog2) < want)
+	++maskbitslog2;
+    }
+
   uint32_t shift1;
   if (size == 32)
     shift1 = 5;
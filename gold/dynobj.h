@@ -126,6 +126,16 @@ class Dynobj : public Object
   static uint32_t
   gnu_hash(const char*);
 
+  // Jobs which compute the hash codes of symbol names.
+  class Hash_jobs;
+
+  // Set HASHVALS to the hash codes of the names of SYMS, computed by
+  // HASH.  The names are hashed in parallel.
+  static void
+  compute_hashes(uint32_t (*hash)(const char*),
+		 const std::vector<Symbol*>& syms,
+		 std::vector<uint32_t>* hashvals);
+
   // Compute the number of hash buckets to use.
   static unsigned int
   compute_bucket_count(const std::vector<uint32_t>& hashcodes,
@@ -29,6 +29,7 @@
 #include "dwarf.h"
 #include "symtab.h"
 #include "reloc.h"
+#include "gold-threads.h"
 #include "ehframe.h"
 
 namespace gold
@@ -188,9 +189,6 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
       this->get_fde_addresses<size, big_endian>(of, &this->fde_offsets_,
 						&fde_addresses);
 
-      std::sort(fde_addresses.begin(), fde_addresses.end(),
-		Fde_address_compare<size>());
-
       typename elfcpp::Elf_types<size>::Elf_Addr output_address;
       output_address = this->address();
 
@@ -290,11 +288,117 @@ Eh_frame_hdr::get_fde_pc(
   return pc;
 }
 
+// Below this number of FDEs we build the table in a single thread.
+
+static const size_t parallel_eh_frame_hdr_min_fdes = 100000;
+
+// Return the start of slice I when splitting COUNT entries into
+// SLICE_COUNT slices.
+
+static inline size_t
+eh_frame_hdr_slice_start(size_t count, size_t slice_count, size_t i)
+{
+  return static_cast<size_t>((static_cast<uint64_t>(count) * i)
+			     / slice_count);
+}
+
+// Jobs which find the PCs for a slice of the FDEs and sort the slice.
+
+template<int size, bool big_endian>
+class Eh_frame_hdr::Fde_address_jobs : public Parallel_jobs
+{
+ public:
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+
+  Fde_address_jobs(Eh_frame_hdr* hdr, Address eh_frame_address,
+		   const unsigned char* eh_frame_contents,
+		   const Fde_offsets* fde_offsets,
+		   Fde_addresses<size>* fde_addresses, size_t slice_count)
+    : hdr_(hdr), eh_frame_address_(eh_frame_address),
+      eh_frame_contents_(eh_frame_contents), fde_offsets_(fde_offsets),
+      fde_addresses_(fde_addresses), slice_count_(slice_count)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    size_t count = this->fde_offsets_->size();
+    size_t start = eh_frame_hdr_slice_start(count, this->slice_count_, i);
+    size_t end = eh_frame_hdr_slice_start(count, this->slice_count_, i + 1);
+    for (size_t j = start; j < end; ++j)
+      {
+	const Fde_offset& fo((*this->fde_offsets_)[j]);
+	Address fde_pc =
+	  this->hdr_->template get_fde_pc<size, big_endian>(
+	      this->eh_frame_address_, this->eh_frame_contents_,
+	      fo.first, fo.second);
+	this->fde_addresses_->set(j, fde_pc,
+				  this->eh_frame_address_ + fo.first);
+      }
+    std::sort(this->fde_addresses_->begin() + start,
+	      this->fde_addresses_->begin() + end,
+	      Fde_address_compare<size>());
+  }
+
+ private:
+  Eh_frame_hdr* hdr_;
+  Address eh_frame_address_;
+  const unsigned char* eh_frame_contents_;
+  const Fde_offsets* fde_offsets_;
+  Fde_addresses<size>* fde_addresses_;
+  size_t slice_count_;
+};
+
+// Jobs which merge pairs of adjacent sorted runs of WIDTH slices.
+
+template<int size>
+class Eh_frame_hdr::Fde_merge_jobs : public Parallel_jobs
+{
+ public:
+  Fde_merge_jobs(Fde_addresses<size>* fde_addresses, size_t count,
+		 size_t slice_count, size_t width)
+    : fde_addresses_(fde_addresses), count_(count),
+      slice_count_(slice_count), width_(width)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    size_t first = i * 2 * this->width_;
+    size_t middle = std::min(first + this->width_, this->slice_count_);
+    size_t last = std::min(first + 2 * this->width_, this->slice_count_);
+    if (middle == last)
+      return;
+    typename Fde_addresses<size>::iterator base =
+      this->fde_addresses_->begin();
+    std::inplace_merge(base + eh_frame_hdr_slice_start(this->count_,
+						       this->slice_count_,
+						       first),
+		       base + eh_frame_hdr_slice_start(this->count_,
+						       this->slice_count_,
+						       middle),
+		       base + eh_frame_hdr_slice_start(this->count_,
+						       this->slice_count_,
+						       last),
+		       Fde_address_compare<size>());
+  }
+
+ private:
+  Fde_addresses<size>* fde_addresses_;
+  size_t count_;
+  size_t slice_count_;
+  size_t width_;
+};
+
 // Given an array of FDE offsets in the .eh_frame section, return an
 // array of offsets from the exception frame header to the FDE's
-// output PC and to the output address of the FDE itself.  We get the
-// FDE's PC by actually looking in the .eh_frame section we just wrote
-// to the output file.
+// output PC and to the output address of the FDE itself, sorted by
+// PC.  We get the FDE's PC by actually looking in the .eh_frame
+// section we just wrote to the output file.  For a large table we
+// split the work into slices which are converted and sorted in
+// parallel, and then merged.
 
 template<int size, bool big_endian>
 void
@@ -309,15 +413,21 @@ Eh_frame_hdr::get_fde_addresses(Output_file* of,
   const unsigned char* eh_frame_contents = of->get_input_view(eh_frame_offset,
 							      eh_frame_size);
 
-  for (Fde_offsets::const_iterator p = fde_offsets->begin();
-       p != fde_offsets->end();
-       ++p)
+  size_t count = fde_offsets->size();
+  int thread_count = Parallel_jobs::default_thread_count();
+  size_t slice_count = 1;
+  if (thread_count > 1 && count >= parallel_eh_frame_hdr_min_fdes)
+    slice_count = thread_count;
+
+  Fde_address_jobs<size, big_endian> jobs(this, eh_frame_address,
+					  eh_frame_contents, fde_offsets,
+					  fde_addresses, slice_count);
+  jobs.run(slice_count, thread_count);
+
+  for (size_t width = 1; width < slice_count; width *= 2)
     {
-      typename elfcpp::Elf_types<size>::Elf_Addr fde_pc;
-      fde_pc = this->get_fde_pc<size, big_endian>(eh_frame_address,
-						  eh_frame_contents,
-						  p->first, p->second);
-      fde_addresses->push_back(fde_pc, eh_frame_address + p->first);
+      Fde_merge_jobs<size> merger(fde_addresses, count, slice_count, width);
+      merger.run((slice_count + 2 * width - 1) / (2 * width), thread_count);
     }
 
   of->free_input_view(eh_frame_offset, eh_frame_size, eh_frame_contents);
@@ -525,6 +635,14 @@ operator<(const Cie& cie1, const Cie& cie2)
   return cie1.contents_ < cie2.contents_;
 }
 
+// Class Eh_frame_input.
+
+Eh_frame_input::~Eh_frame_input()
+{
+  for (Cies::iterator p = this->cies_.begin(); p != this->cies_.end(); ++p)
+    delete p->first;
+}
+
 // Class Eh_frame.
 
 Eh_frame::Eh_frame()
@@ -594,44 +712,158 @@ Eh_frame::add_ehframe_input_section(
       && elfcpp::Swap<32, big_endian>::readval(pcontents) == 0)
     return EH_END_MARKER_SECTION;
 
-  New_cies new_cies;
-  if (!this->do_add_ehframe_input_section(object, symbols, symbols_size,
-					  symbol_names, symbol_names_size,
-					  shndx, reloc_shndx,
-					  reloc_type, pcontents,
-					  contents_len, &new_cies))
+  // Use what was found when the symbols were read, if we did that.
+  Eh_frame_input* input;
+  if (!object->release_eh_frame_input(shndx, &input))
+    {
+      input = new Eh_frame_input();
+      if (!Eh_frame::do_read_ehframe_input_section(object, symbols,
+						   symbols_size,
+						   symbol_names,
+						   symbol_names_size,
+						   shndx, reloc_shndx,
+						   reloc_type, pcontents,
+						   contents_len, input))
+	{
+	  delete input;
+	  input = NULL;
+	}
+    }
+
+  if (input == NULL)
     {
       if (this->eh_frame_hdr_ != NULL)
 	this->eh_frame_hdr_->found_unrecognized_eh_frame_section();
+      return EH_UNRECOGNIZED_SECTION;
+    }
 
-      for (New_cies::iterator p = new_cies.begin();
-	   p != new_cies.end();
-	   ++p)
-	delete p->first;
+  this->add_ehframe_input(object, shndx, pcontents, input);
+  delete input;
 
-      return EH_UNRECOGNIZED_SECTION;
+  return EH_OPTIMIZABLE_SECTION;
+}
+
+// Read the CIEs and FDEs of an input section for later use by
+// add_ehframe_input_section.
+
+template<int size, bool big_endian>
+Eh_frame_input*
+Eh_frame::read_ehframe_input_section(
+    Sized_relobj_file<size, big_endian>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type)
+{
+  section_size_type contents_len;
+  const unsigned char* pcontents = object->section_contents(shndx,
+							    &contents_len,
+							    false);
+  if (contents_len == 0
+      || (contents_len == 4
+	  && elfcpp::Swap<32, big_endian>::readval(pcontents) == 0))
+    return NULL;
+
+  Eh_frame_input* input = new Eh_frame_input();
+  if (!Eh_frame::do_read_ehframe_input_section(object, symbols, symbols_size,
+					       symbol_names,
+					       symbol_names_size, shndx,
+					       reloc_shndx, reloc_type,
+					       pcontents, contents_len, input))
+    {
+      delete input;
+      return NULL;
+    }
+  return input;
+}
+
+// Add the CIEs and FDEs in INPUT, read from section SHNDX of OBJECT.
+// This merges the CIEs with those from earlier sections and discards
+// the FDEs for discarded code.
+
+void
+Eh_frame::add_ehframe_input(Relobj* object, unsigned int shndx,
+			    const unsigned char* pcontents,
+			    Eh_frame_input* input)
+{
+  Eh_frame_input::Cies* cies = input->cies();
+  std::vector<Cie*> cie_pointers(cies->size());
+  std::vector<bool> is_new(cies->size());
+  for (size_t i = 0; i < cies->size(); ++i)
+    {
+      Cie* cie = (*cies)[i].first;
+      Cie_offsets::iterator find_cie = this->cie_offsets_.end();
+      if ((*cies)[i].second)
+	find_cie = this->cie_offsets_.find(cie);
+      is_new[i] = find_cie == this->cie_offsets_.end();
+      cie_pointers[i] = is_new[i] ? cie : *find_cie;
+    }
+
+  const Eh_frame_input::Entries& entries(input->entries());
+  for (Eh_frame_input::Entries::const_iterator p = entries.begin();
+       p != entries.end();
+       ++p)
+    {
+      bool discard;
+      switch (p->kind)
+	{
+	case Eh_frame_input::ENTRY_CIE:
+	  discard = !is_new[p->cie_index];
+	  break;
+	case Eh_frame_input::ENTRY_FDE:
+	  // If we have discarded the section, we can also discard the
+	  // FDE.
+	  discard = (p->fde_shndx != 0
+		     && !object->is_section_included(p->fde_shndx));
+	  break;
+	default:
+	  discard = true;
+	  break;
+	}
+
+      if (discard)
+	{
+	  // We are deleting this CIE or FDE.  Record that in our
+	  // mapping from input sections to the output section.  At
+	  // this point we don't know for sure that we are doing a
+	  // special mapping for this input section, but that's
+	  // OK--if we don't do a special mapping, nobody will ever ask
+	  // for the mapping we add here.
+	  object->add_merge_mapping(this, shndx, p->input_offset, p->length,
+				    -1);
+	}
+      else if (p->kind == Eh_frame_input::ENTRY_FDE)
+	cie_pointers[p->cie_index]->add_fde(new Fde(object, shndx,
+						    p->input_offset,
+						    (pcontents
+						     + p->input_offset + 8),
+						    p->length - 8));
     }
 
   // Now that we know we are using this section, record any new CIEs
   // that we found.
-  for (New_cies::const_iterator p = new_cies.begin();
-       p != new_cies.end();
-       ++p)
+  for (size_t i = 0; i < cies->size(); ++i)
     {
-      if (p->second)
-	this->cie_offsets_.insert(p->first);
+      if (!is_new[i])
+	continue;
+      if ((*cies)[i].second)
+	this->cie_offsets_.insert((*cies)[i].first);
       else
-	this->unmergeable_cie_offsets_.push_back(p->first);
+	this->unmergeable_cie_offsets_.push_back((*cies)[i].first);
+      (*cies)[i].first = NULL;
     }
-
-  return EH_OPTIMIZABLE_SECTION;
 }
 
-// The bulk of the implementation of add_ehframe_input_section.
+// The bulk of the implementation of read_ehframe_input_section.
+// Record the CIEs and FDEs in INPUT.  Return false if we can't parse
+// the section.
 
 template<int size, bool big_endian>
 bool
-Eh_frame::do_add_ehframe_input_section(
+Eh_frame::do_read_ehframe_input_section(
     Sized_relobj_file<size, big_endian>* object,
     const unsigned char* symbols,
     section_size_type symbols_size,
@@ -642,7 +874,7 @@ Eh_frame::do_add_ehframe_input_section(
     unsigned int reloc_type,
     const unsigned char* pcontents,
     section_size_type contents_len,
-    New_cies* new_cies)
+    Eh_frame_input* input)
 {
   Track_relocs<size, big_endian> relocs;
 
@@ -694,17 +926,17 @@ Eh_frame::do_add_ehframe_input_section(
       if (id == 0)
 	{
 	  // CIE.
-	  if (!this->read_cie(object, shndx, symbols, symbols_size,
-			      symbol_names, symbol_names_size,
-			      pcontents, p, pentend, &relocs, &cies,
-			      new_cies))
+	  if (!Eh_frame::read_cie(object, shndx, symbols, symbols_size,
+				  symbol_names, symbol_names_size,
+				  pcontents, p, pentend, &relocs, &cies,
+				  input))
 	    return false;
 	}
       else
 	{
 	  // FDE.
-	  if (!this->read_fde(object, shndx, symbols, symbols_size,
-			      pcontents, id, p, pentend, &relocs, &cies))
+	  if (!Eh_frame::read_fde(object, symbols, symbols_size, pcontents,
+				  id, p, pentend, &relocs, &cies, input))
 	    return false;
 	}
 
@@ -729,7 +961,7 @@ Eh_frame::read_cie(Sized_relobj_file<size, big_endian>* object,
 		   const unsigned char* pcieend,
 		   Track_relocs<size, big_endian>* relocs,
 		   Offsets_to_cie* cies,
-		   New_cies* new_cies)
+		   Eh_frame_input* input)
 {
   bool mergeable = true;
 
@@ -922,48 +1154,40 @@ Eh_frame::read_cie(Sized_relobj_file<size, big_endian>* object,
   if (relocs->advance(pcieend - pcontents) > 0)
     return false;
 
-  Cie cie(object, shndx, (pcie - 8) - pcontents, fde_encoding, 
+  Cie cie(object, shndx, (pcie - 8) - pcontents, fde_encoding,
 	  personality_name, pcie, pcieend - pcie);
-  Cie* cie_pointer = NULL;
+
+  // See if we already saw this CIE in this section.  Whether it
+  // matches a CIE from an earlier section is decided when the section
+  // is added.
+  Eh_frame_input::Cies* new_cies = input->cies();
+  unsigned int cie_index = -1U;
   if (mergeable)
     {
-      Cie_offsets::iterator find_cie = this->cie_offsets_.find(&cie);
-      if (find_cie != this->cie_offsets_.end())
-	cie_pointer = *find_cie;
-      else
+      for (Eh_frame_input::Cies::const_iterator pc = new_cies->begin();
+	   pc != new_cies->end();
+	   ++pc)
 	{
-	  // See if we already saw this CIE in this object file.
-	  for (New_cies::const_iterator pc = new_cies->begin();
-	       pc != new_cies->end();
-	       ++pc)
+	  if (*(pc->first) == cie)
 	    {
-	      if (*(pc->first) == cie)
-		{
-		  cie_pointer = pc->first;
-		  break;
-		}
+	      cie_index = pc - new_cies->begin();
+	      break;
 	    }
 	}
     }
 
-  if (cie_pointer == NULL)
+  Eh_frame_input::Entry_kind kind = Eh_frame_input::ENTRY_DUPLICATE_CIE;
+  if (cie_index == -1U)
     {
-      cie_pointer = new Cie(cie);
-      new_cies->push_back(std::make_pair(cie_pointer, mergeable));
-    }
-  else
-    {
-      // We are deleting this CIE.  Record that in our mapping from
-      // input sections to the output section.  At this point we don't
-      // know for sure that we are doing a special mapping for this
-      // input section, but that's OK--if we don't do a special
-      // mapping, nobody will ever ask for the mapping we add here.
-      object->add_merge_mapping(this, shndx, (pcie - 8) - pcontents,
-                                pcieend - (pcie - 8), -1);
+      cie_index = new_cies->size();
+      new_cies->push_back(std::make_pair(new Cie(cie), mergeable));
+      kind = Eh_frame_input::ENTRY_CIE;
     }
+  input->add_entry(kind, (pcie - 8) - pcontents, pcieend - (pcie - 8),
+		   cie_index, 0);
 
   // Record this CIE plus the offset in the input section.
-  cies->insert(std::make_pair(pcie - pcontents, cie_pointer));
+  cies->insert(std::make_pair(pcie - pcontents, cie_index));
 
   return true;
 }
@@ -973,7 +1197,6 @@ Eh_frame::read_cie(Sized_relobj_file<size, big_endian>* object,
 template<int size, bool big_endian>
 bool
 Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
-		   unsigned int shndx,
 		   const unsigned char* symbols,
 		   section_size_type symbols_size,
 		   const unsigned char* pcontents,
@@ -981,7 +1204,8 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
 		   const unsigned char* pfde,
 		   const unsigned char* pfdeend,
 		   Track_relocs<size, big_endian>* relocs,
-		   Offsets_to_cie* cies)
+		   Offsets_to_cie* cies,
+		   Eh_frame_input* input)
 {
   // OFFSET is the distance between the 4 bytes before PFDE to the
   // start of the CIE.  The offset we recorded for the CIE is 8 bytes
@@ -990,7 +1214,8 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   Offsets_to_cie::const_iterator pcie = cies->find(cie_offset);
   if (pcie == cies->end())
     return false;
-  Cie* cie = pcie->second;
+  unsigned int cie_index = pcie->second;
+  const Cie* cie = (*input->cies())[cie_index].first;
 
   int pc_size = 0;
   switch (cie->fde_encoding() & 7)
@@ -1046,8 +1271,9 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
 	{
 	  // This FDE applies to a discarded function.  We
 	  // can discard this FDE.
-	  object->add_merge_mapping(this, shndx, (pfde - 8) - pcontents,
-				    pfdeend - (pfde - 8), -1);
+	  input->add_entry(Eh_frame_input::ENTRY_DISCARDED_FDE,
+			   (pfde - 8) - pcontents, pfdeend - (pfde - 8),
+			   cie_index, 0);
 	  return true;
 	}
 
@@ -1065,8 +1291,9 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   // pointer to a PC relative offset when generating a shared library.
   relocs->advance(pfdeend - pcontents);
 
-  // Find the section index for code that this FDE describes.
-  // If we have discarded the section, we can also discard the FDE.
+  // Find the section index for code that this FDE describes.  If
+  // that section is discarded, add_ehframe_input will discard the
+  // FDE.
   unsigned int fde_shndx;
   const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
   if (symndx >= symbols_size / sym_size)
@@ -1075,10 +1302,8 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
   bool is_ordinary;
   fde_shndx = object->adjust_sym_shndx(symndx, sym.get_st_shndx(),
 				       &is_ordinary);
-  bool is_discarded = (is_ordinary
-		       && fde_shndx != elfcpp::SHN_UNDEF
-		       && fde_shndx < object->shnum()
-		       && !object->is_section_included(fde_shndx));
+  if (!is_ordinary || fde_shndx >= object->shnum())
+    fde_shndx = 0;
 
   // Fetch the address range field from the FDE. The offset and size
   // of the field depends on the PC encoding given in the CIE, but
@@ -1101,17 +1326,11 @@ Eh_frame::read_fde(Sized_relobj_file<size, big_endian>* object,
       gold_unreachable();
     }
 
-  if (is_discarded || address_range == 0)
-    {
-      // This FDE applies to a discarded function.  We
-      // can discard this FDE.
-      object->add_merge_mapping(this, shndx, (pfde - 8) - pcontents,
-                                pfdeend - (pfde - 8), -1);
-      return true;
-    }
-
-  cie->add_fde(new Fde(object, shndx, (pfde - 8) - pcontents,
-		       pfde, pfdeend - pfde));
+  input->add_entry((address_range == 0
+		    ? Eh_frame_input::ENTRY_DISCARDED_FDE
+		    : Eh_frame_input::ENTRY_FDE),
+		   (pfde - 8) - pcontents, pfdeend - (pfde - 8),
+		   cie_index, fde_shndx);
 
   return true;
 }
@@ -1339,4 +1558,60 @@ Eh_frame::add_ehframe_input_section<64, true>(
     unsigned int reloc_type);
 #endif
 
+#ifdef HAVE_TARGET_32_LITTLE
+template
+Eh_frame_input*
+Eh_frame::read_ehframe_input_section<32, false>(
+    Sized_relobj_file<32, false>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
+#endif
+
+#ifdef HAVE_TARGET_32_BIG
+template
+Eh_frame_input*
+Eh_frame::read_ehframe_input_section<32, true>(
+    Sized_relobj_file<32, true>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
+#endif
+
+#ifdef HAVE_TARGET_64_LITTLE
+template
+Eh_frame_input*
+Eh_frame::read_ehframe_input_section<64, false>(
+    Sized_relobj_file<64, false>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
+#endif
+
+#ifdef HAVE_TARGET_64_BIG
+template
+Eh_frame_input*
+Eh_frame::read_ehframe_input_section<64, true>(
+    Sized_relobj_file<64, true>* object,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size,
+    unsigned int shndx,
+    unsigned int reloc_shndx,
+    unsigned int reloc_type);
+#endif
+
 } // End namespace gold.
@@ -102,15 +102,13 @@ class Eh_frame_hdr : public Output_section_data
     typedef typename std::vector<Fde_address> Fde_address_list;
     typedef typename Fde_address_list::iterator iterator;
 
-    Fde_addresses(unsigned int reserve)
-      : fde_addresses_()
-    { this->fde_addresses_.reserve(reserve); }
+    Fde_addresses(unsigned int count)
+      : fde_addresses_(count)
+    { }
 
     void
-    push_back(Address pc_address, Address fde_address)
-    {
-      this->fde_addresses_.push_back(std::make_pair(pc_address, fde_address));
-    }
+    set(unsigned int i, Address pc_address, Address fde_address)
+    { this->fde_addresses_[i] = std::make_pair(pc_address, fde_address); }
 
     iterator
     begin()
@@ -124,16 +122,30 @@ class Eh_frame_hdr : public Output_section_data
     Fde_address_list fde_addresses_;
   };
 
-  // Compare Fde_address objects.
+  // Compare Fde_address objects.  FDEs with the same PC are sorted
+  // by address, so that the order does not depend on how the table
+  // was sorted.
   template<int size>
   struct Fde_address_compare
   {
     bool
     operator()(const typename Fde_addresses<size>::Fde_address& f1,
 	       const typename Fde_addresses<size>::Fde_address& f2) const
-    { return f1.first < f2.first; }
+    {
+      if (f1.first != f2.first)
+	return f1.first < f2.first;
+      return f1.second < f2.second;
+    }
   };
 
+  // Jobs which fill in and sort slices of the FDE address table.
+  template<int size, bool big_endian>
+  class Fde_address_jobs;
+
+  // Jobs which merge sorted slices of the FDE address table.
+  template<int size>
+  class Fde_merge_jobs;
+
   // Return the PC to which an FDE refers.
   template<int size, bool big_endian>
   typename elfcpp::Elf_types<size>::Elf_Addr
@@ -141,7 +153,7 @@ class Eh_frame_hdr : public Output_section_data
 	     const unsigned char* eh_frame_contents,
 	     section_offset_type fde_offset, unsigned char fde_encoding);
 
-  // Convert Fde_offsets to Fde_addresses.
+  // Convert Fde_offsets to Fde_addresses, sorted by PC.
   template<int size, bool big_endian>
   void
   get_fde_addresses(Output_file* of,
@@ -358,6 +370,94 @@ class Cie
 extern bool operator<(const Cie&, const Cie&);
 extern bool operator==(const Cie&, const Cie&);
 
+// The CIEs and FDEs found in an input .eh_frame section.  Finding
+// them does not depend on the layout, so it is done when the symbols
+// are read, which may happen in parallel for different objects.
+// Eh_frame::add_ehframe_input_section then only has to decide which
+// FDEs to keep and merge the CIEs.
+
+class Eh_frame_input
+{
+ public:
+  // The kinds of entries in an .eh_frame section.
+  enum Entry_kind
+  {
+    // The first copy of a CIE in this section.
+    ENTRY_CIE,
+    // A CIE which is the same as an earlier one in this section.
+    ENTRY_DUPLICATE_CIE,
+    // An FDE.
+    ENTRY_FDE,
+    // An FDE for code which was discarded before this link.
+    ENTRY_DISCARDED_FDE
+  };
+
+  // A CIE or an FDE.
+  struct Entry
+  {
+    Entry(Entry_kind k, section_offset_type offset, section_size_type len,
+	  unsigned int cie, unsigned int shndx)
+      : input_offset(offset), length(len), cie_index(cie),
+	fde_shndx(shndx), kind(k)
+    { }
+
+    // Offset within the input section, including the length word.
+    section_offset_type input_offset;
+    // Length, including the length word and the CIE pointer or tag.
+    section_size_type length;
+    // For a CIE, its index in the list of CIEs.  For an FDE, the
+    // index of its CIE.
+    unsigned int cie_index;
+    // For an ENTRY_FDE, the section holding the code it describes,
+    // or 0 if the FDE is kept whichever sections are discarded.
+    unsigned int fde_shndx;
+    // The kind of entry.
+    Entry_kind kind;
+  };
+
+  typedef std::vector<Entry> Entries;
+
+  // A list of CIEs, and a bool indicating whether the CIE is
+  // mergeable.
+  typedef std::vector<std::pair<Cie*, bool> > Cies;
+
+  Eh_frame_input()
+    : cies_(), entries_()
+  { }
+
+  ~Eh_frame_input();
+
+  // The distinct CIEs in the section, in the order in which they
+  // first appear.
+  Cies*
+  cies()
+  { return &this->cies_; }
+
+  // The CIEs and FDEs in the section.
+  const Entries&
+  entries() const
+  { return this->entries_; }
+
+  // Add an entry.
+  void
+  add_entry(Entry_kind kind, section_offset_type input_offset,
+	    section_size_type length, unsigned int cie_index,
+	    unsigned int fde_shndx)
+  {
+    this->entries_.push_back(Entry(kind, input_offset, length, cie_index,
+				   fde_shndx));
+  }
+
+ private:
+  Eh_frame_input(const Eh_frame_input&);
+  Eh_frame_input& operator=(const Eh_frame_input&);
+
+  // The CIEs.  Any left here are deleted with this object.
+  Cies cies_;
+  // The entries.
+  Entries entries_;
+};
+
 // This class manages .eh_frame sections.  It discards duplicate
 // exception information.
 
@@ -396,6 +496,22 @@ class Eh_frame : public Output_section_data
 			    unsigned int shndx, unsigned int reloc_shndx,
 			    unsigned int reloc_type);
 
+  // Read the CIEs and FDEs in the input section SHNDX in OBJECT
+  // without adding them.  The arguments are as for
+  // add_ehframe_input_section.  This does not depend on the layout,
+  // so it may be called while reading symbols.  This returns NULL if
+  // the section is empty or the end marker, or if we can not parse
+  // it.
+  template<int size, bool big_endian>
+  static Eh_frame_input*
+  read_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
+			     const unsigned char* symbols,
+			     section_size_type symbols_size,
+			     const unsigned char* symbol_names,
+			     section_size_type symbol_names_size,
+			     unsigned int shndx, unsigned int reloc_shndx,
+			     unsigned int reloc_type);
+
   // Add a CIE and an FDE for a PLT section, to permit unwinding
   // through a PLT.  The FDE data should start with 8 bytes of zero,
   // which will be replaced by a 4 byte PC relative reference to the
@@ -444,36 +560,38 @@ class Eh_frame : public Output_section_data
   // A list of unmergeable CIEs.
   typedef std::vector<Cie*> Unmergeable_cie_offsets;
 
-  // A mapping from offsets to CIEs.  This is used while reading an
-  // input section.
-  typedef std::map<uint64_t, Cie*> Offsets_to_cie;
-
-  // A list of CIEs, and a bool indicating whether the CIE is
-  // mergeable.
-  typedef std::vector<std::pair<Cie*, bool> > New_cies;
+  // A mapping from offsets to the index of a CIE in an
+  // Eh_frame_input.  This is used while reading an input section.
+  typedef std::map<uint64_t, unsigned int> Offsets_to_cie;
 
   // Skip an LEB128.
   static bool
   skip_leb128(const unsigned char**, const unsigned char*);
 
-  // The implementation of add_ehframe_input_section.
+  // The implementation of read_ehframe_input_section.
   template<int size, bool big_endian>
-  bool
-  do_add_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
-			       const unsigned char* symbols,
-			       section_size_type symbols_size,
-			       const unsigned char* symbol_names,
-			       section_size_type symbol_names_size,
-			       unsigned int shndx,
-			       unsigned int reloc_shndx,
-			       unsigned int reloc_type,
-			       const unsigned char* pcontents,
-			       section_size_type contents_len,
-			       New_cies*);
+  static bool
+  do_read_ehframe_input_section(Sized_relobj_file<size, big_endian>* object,
+				const unsigned char* symbols,
+				section_size_type symbols_size,
+				const unsigned char* symbol_names,
+				section_size_type symbol_names_size,
+				unsigned int shndx,
+				unsigned int reloc_shndx,
+				unsigned int reloc_type,
+				const unsigned char* pcontents,
+				section_size_type contents_len,
+				Eh_frame_input*);
+
+  // Add the CIEs and FDEs read from the input section SHNDX in
+  // OBJECT, whose contents are PCONTENTS.
+  void
+  add_ehframe_input(Relobj* object, unsigned int shndx,
+		    const unsigned char* pcontents, Eh_frame_input*);
 
   // Read a CIE.
   template<int size, bool big_endian>
-  bool
+  static bool
   read_cie(Sized_relobj_file<size, big_endian>* object,
 	   unsigned int shndx,
 	   const unsigned char* symbols,
@@ -485,13 +603,12 @@ class Eh_frame : public Output_section_data
 	   const unsigned char* pcieend,
 	   Track_relocs<size, big_endian>* relocs,
 	   Offsets_to_cie* cies,
-	   New_cies* new_cies);
+	   Eh_frame_input* input);
 
   // Read an FDE.
   template<int size, bool big_endian>
-  bool
+  static bool
   read_fde(Sized_relobj_file<size, big_endian>* object,
-	   unsigned int shndx,
 	   const unsigned char* symbols,
 	   section_size_type symbols_size,
 	   const unsigned char* pcontents,
@@ -499,7 +616,8 @@ class Eh_frame : public Output_section_data
 	   const unsigned char* pfde,
 	   const unsigned char* pfdeend,
 	   Track_relocs<size, big_endian>* relocs,
-	   Offsets_to_cie* cies);
+	   Offsets_to_cie* cies,
+	   Eh_frame_input* input);
 
   // Template version of write function.
   template<int size, bool big_endian>
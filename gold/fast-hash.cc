@@ -0,0 +1,144 @@
+// fast-hash.cc -- a fast hash function for build IDs
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include "elfcpp.h"
+#include "fast-hash.h"
+
+namespace gold
+{
+
+// The primes used by xxHash64.
+
+const uint64_t fast_hash_prime1 = 0x9e3779b185ebca87ULL;
+const uint64_t fast_hash_prime2 = 0xc2b2ae3d27d4eb4fULL;
+const uint64_t fast_hash_prime3 = 0x165667b19e3779f9ULL;
+const uint64_t fast_hash_prime4 = 0x85ebca77c2b2ae63ULL;
+const uint64_t fast_hash_prime5 = 0x27d4eb2f165667c5ULL;
+
+static inline uint64_t
+fast_hash_rotl(uint64_t x, int r)
+{ return (x << r) | (x >> (64 - r)); }
+
+static inline uint64_t
+fast_hash_read64(const unsigned char* p)
+{ return elfcpp::Swap_unaligned<64, false>::readval(p); }
+
+static inline uint64_t
+fast_hash_read32(const unsigned char* p)
+{ return elfcpp::Swap_unaligned<32, false>::readval(p); }
+
+// Mix the 64-bit word INPUT into the lane ACC.
+
+static inline uint64_t
+fast_hash_round(uint64_t acc, uint64_t input)
+{
+  acc += input * fast_hash_prime2;
+  acc = fast_hash_rotl(acc, 31);
+  return acc * fast_hash_prime1;
+}
+
+// Merge the lane VAL into the hash value ACC.
+
+static inline uint64_t
+fast_hash_merge(uint64_t acc, uint64_t val)
+{
+  acc ^= fast_hash_round(0, val);
+  return acc * fast_hash_prime1 + fast_hash_prime4;
+}
+
+// Mix the last LEN bytes at P, which are fewer than 32, into H, and
+// return the final value.
+
+static uint64_t
+fast_hash_finish(uint64_t h, const unsigned char* p, size_t len)
+{
+  for (; len >= 8; p += 8, len -= 8)
+    {
+      h ^= fast_hash_round(0, fast_hash_read64(p));
+      h = fast_hash_rotl(h, 27) * fast_hash_prime1 + fast_hash_prime4;
+    }
+  if (len >= 4)
+    {
+      h ^= fast_hash_read32(p) * fast_hash_prime1;
+      h = fast_hash_rotl(h, 23) * fast_hash_prime2 + fast_hash_prime3;
+      p += 4;
+      len -= 4;
+    }
+  for (; len > 0; ++p, --len)
+    {
+      h ^= *p * fast_hash_prime5;
+      h = fast_hash_rotl(h, 11) * fast_hash_prime1;
+    }
+
+  h ^= h >> 33;
+  h *= fast_hash_prime2;
+  h ^= h >> 29;
+  h *= fast_hash_prime3;
+  h ^= h >> 32;
+  return h;
+}
+
+// Compute the hash, which is xxHash64 with a seed of zero.
+
+void*
+fast_hash_buffer(const char* buffer, size_t len, void* resblock)
+{
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(buffer);
+  const unsigned char* const end = p + len;
+
+  uint64_t h;
+  if (len >= 32)
+    {
+      uint64_t v1 = fast_hash_prime1 + fast_hash_prime2;
+      uint64_t v2 = fast_hash_prime2;
+      uint64_t v3 = 0;
+      uint64_t v4 = -fast_hash_prime1;
+      const unsigned char* const limit = end - 32;
+      do
+	{
+	  v1 = fast_hash_round(v1, fast_hash_read64(p));
+	  v2 = fast_hash_round(v2, fast_hash_read64(p + 8));
+	  v3 = fast_hash_round(v3, fast_hash_read64(p + 16));
+	  v4 = fast_hash_round(v4, fast_hash_read64(p + 24));
+	  p += 32;
+	}
+      while (p <= limit);
+
+      h = (fast_hash_rotl(v1, 1) + fast_hash_rotl(v2, 7)
+	   + fast_hash_rotl(v3, 12) + fast_hash_rotl(v4, 18));
+      h = fast_hash_merge(h, v1);
+      h = fast_hash_merge(h, v2);
+      h = fast_hash_merge(h, v3);
+      h = fast_hash_merge(h, v4);
+    }
+  else
+    h = fast_hash_prime5;
+
+  h = fast_hash_finish(h + len, p, end - p);
+
+  unsigned char* result = static_cast<unsigned char*>(resblock);
+  elfcpp::Swap_unaligned<64, false>::writeval(result, h);
+  return resblock;
+}
+
+} // End namespace gold.
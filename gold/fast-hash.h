@@ -0,0 +1,57 @@
+// fast-hash.h -- a fast hash function for build IDs  -*- C++ -*-
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_FAST_HASH_H
+#define GOLD_FAST_HASH_H
+
+#include <cstddef>
+
+namespace gold
+{
+
+// The size in bytes of the result of fast_hash_buffer.
+const size_t fast_hash_size = 8;
+
+// Compute a 64-bit hash of the LEN bytes at BUFFER, and store it in
+// RESBLOCK, which must have room for fast_hash_size bytes.  Return
+// RESBLOCK.  This has the same interface as md5_buffer and
+// sha1_buffer from libiberty.
+//
+// This is used for --build-id=fast.  It is xxHash64 with a seed of
+// zero, stored in little-endian order so that the result does not
+// depend on the host.  It is not a cryptographic hash: it mixes four
+// independent 64-bit lanes, so that the processor can work on several
+// words at once, and it is many times faster than MD5 or SHA-1.
+//
+// The build ID is only 8 bytes, because that is all the strength the
+// hash has; stretching it to 16 bytes would not make two different
+// outputs any less likely to get the same ID.  With 64 bits a
+// collision becomes likely only after about 2^32 distinct outputs,
+// which is plenty to tell apart the builds of a program.  Use
+// --build-id=sha1 or --build-id=tree when the ID must also be hard to
+// forge or must be unique across a very large collection.
+
+void*
+fast_hash_buffer(const char* buffer, size_t len, void* resblock);
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_FAST_HASH_H)
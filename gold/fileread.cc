@@ -47,6 +47,7 @@
 #include "binary.h"
 #include "descriptors.h"
 #include "gold-threads.h"
+#include "link-cache.h"
 #include "fileread.h"
 
 // For systems without mmap support.
@@ -124,6 +125,28 @@ static Initialize_lock file_counts_initialize_lock(&file_counts_lock);
 unsigned long long File_read::total_mapped_bytes;
 unsigned long long File_read::current_mapped_bytes;
 unsigned long long File_read::maximum_mapped_bytes;
+unsigned long long File_read::view_cache_hits;
+unsigned long long File_read::view_cache_misses;
+unsigned long long File_read::view_cache_evictions;
+File_read::View_lru File_read::view_lru;
+unsigned long long File_read::view_lru_bytes;
+
+// A lock for the views of all files, used for --file-view-budget.
+static Lock* file_views_lock = NULL;
+static Initialize_lock file_views_initialize_lock(&file_views_lock);
+
+// Count a view lookup in COUNTER, for --stats.
+
+static inline void
+count_view_lookup(unsigned long long* counter)
+{
+  if (parameters->options_valid() && parameters->options().stats())
+    {
+      file_counts_initialize_lock.initialize();
+      Hold_optional_lock hl(file_counts_lock);
+      ++*counter;
+    }
+}
 
 // Class File_read::View.
 
@@ -210,6 +233,7 @@ File_read::open(const Task* task, const std::string& name)
       this->size_ = s.st_size;
       gold_debug(DEBUG_FILES, "Attempt to open %s succeeded",
 		 this->name_.c_str());
+      record_link_cache_input(this->name_);
       this->token_.add_writer(task);
     }
 
@@ -284,6 +308,18 @@ File_read::release()
 	}
     }
 
+  // The views which were kept may now be discarded to stay within
+  // --file-view-budget, along with those of other files not in use.
+  Lock* budget_lock = File_read::view_budget_lock();
+  if (budget_lock == NULL)
+    this->in_use_ = false;
+  else
+    {
+      Hold_lock hl(*budget_lock);
+      this->mark_not_in_use();
+      File_read::trim_views();
+    }
+
   this->released_ = true;
 }
 
@@ -296,6 +332,9 @@ File_read::lock(const Task* task)
   gold_debug(DEBUG_FILES, "Locking file \"%s\"", this->name_.c_str());
   this->token_.add_writer(task);
   this->released_ = false;
+
+  Hold_optional_lock hl(File_read::view_budget_lock());
+  this->mark_in_use();
 }
 
 // Unlock the file.
@@ -329,7 +368,7 @@ File_read::is_locked() const
 
 inline File_read::View*
 File_read::find_view(off_t start, section_size_type size,
-		     unsigned int byteshift, File_read::View** vshifted) const
+		     unsigned int byteshift, File_read::View** vshifted)
 {
   gold_assert(start <= this->size_
 	      && (static_cast<unsigned long long>(size)
@@ -338,6 +377,9 @@ File_read::find_view(off_t start, section_size_type size,
   if (vshifted != NULL)
     *vshifted = NULL;
 
+  if (!this->in_use_)
+    this->mark_in_use();
+
   // If we have the whole file mmapped, and the alignment is right,
   // we can return it.
   if (this->whole_file_view_)
@@ -425,7 +467,11 @@ File_read::do_read(off_t start, section_size_type size, void* p)
 void
 File_read::read(off_t start, section_size_type size, void* p)
 {
-  const File_read::View* pv = this->find_view(start, size, -1U, NULL);
+  const File_read::View* pv;
+  {
+    Hold_optional_lock hl(File_read::view_budget_lock());
+    pv = this->find_view(start, size, -1U, NULL);
+  }
   if (pv != NULL)
     {
       memcpy(p, pv->data() + (start - pv->start() + pv->byteshift()), size);
@@ -454,6 +500,7 @@ File_read::add_view(File_read::View* v)
   // it; we put it on a list to be deleted when the file is unlocked.
   File_read::View* vold = ins.first->second;
   gold_assert(vold->size() < v->size());
+  File_read::forget_view(vold);
   if (vold->should_cache())
     {
       v->set_cache();
@@ -532,6 +579,11 @@ File_read::View*
 File_read::find_or_make_view(off_t offset, off_t start,
 			     section_size_type size, bool aligned, bool cache)
 {
+  Hold_optional_lock hl(File_read::view_budget_lock());
+
+  if (!this->in_use_)
+    this->mark_in_use();
+
   // Check that start and end of the view are within the file.
   if (start > this->size_
       || (static_cast<unsigned long long>(size)
@@ -566,7 +618,12 @@ File_read::find_or_make_view(off_t offset, off_t start,
   if (this->whole_file_view_ == NULL
       && parameters->options_valid()
       && parameters->options().map_whole_files())
-    this->whole_file_view_ = this->make_view(0, this->size_, 0, cache);
+    {
+      this->whole_file_view_ = this->make_view(0, this->size_, 0, cache);
+      count_view_lookup(&File_read::view_cache_misses);
+      if (File_read::view_budget_lock() != NULL)
+	File_read::trim_views();
+    }
 
   // Try to find a View with the required BYTESHIFT.
   File_read::View* vshifted;
@@ -577,12 +634,14 @@ File_read::find_or_make_view(off_t offset, off_t start,
     {
       if (cache)
 	v->set_cache();
+      count_view_lookup(&File_read::view_cache_hits);
       return v;
     }
 
   // If VSHIFTED is not NULL, then it has the data we need, but with
   // the wrong byteshift.
   v = vshifted;
+  File_read::View* new_view;
   if (v != NULL)
     {
       gold_assert(aligned);
@@ -599,14 +658,23 @@ File_read::find_or_make_view(off_t offset, off_t start,
 			      cache, View::DATA_ALLOCATED_ARRAY);
 
       this->add_view(shifted_view);
-      return shifted_view;
+      count_view_lookup(&File_read::view_cache_hits);
+      new_view = shifted_view;
+    }
+  else
+    {
+      // Make a new view.  If we don't need an aligned view, use a
+      // byteshift of 0, so that we can use mmap.
+      new_view = this->make_view(offset + start, size,
+				 aligned ? byteshift : 0,
+				 cache);
+      count_view_lookup(&File_read::view_cache_misses);
     }
 
-  // Make a new view.  If we don't need an aligned view, use a
-  // byteshift of 0, so that we can use mmap.
-  return this->make_view(offset + start, size,
-			 aligned ? byteshift : 0,
-			 cache);
+  if (File_read::view_budget_lock() != NULL)
+    File_read::trim_views();
+
+  return new_view;
 }
 
 // Get a view into the file.
@@ -733,9 +801,11 @@ File_read::read_multiple(off_t base, const Read_multiple& rm)
 	this->read(base + i_off, i_entry.size, i_entry.buffer);
       else
 	{
-	  File_read::View* view = this->find_view(base + i_off,
-						  end_off - i_off,
-						  -1U, NULL);
+	  File_read::View* view;
+	  {
+	    Hold_optional_lock hl(File_read::view_budget_lock());
+	    view = this->find_view(base + i_off, end_off - i_off, -1U, NULL);
+	  }
 	  if (view == NULL)
 	    this->do_readv(base, rm, i, j - i);
 	  else
@@ -773,6 +843,7 @@ File_read::clear_view_cache_marks()
   if (this->object_count_ > 1)
     return;
 
+  Hold_optional_lock hl(File_read::view_budget_lock());
   for (Views::iterator p = this->views_.begin();
        p != this->views_.end();
        ++p)
@@ -793,6 +864,7 @@ File_read::clear_views(Clear_views_mode mode)
 {
   bool keep_files_mapped = (parameters->options_valid()
 			    && parameters->options().keep_files_mapped());
+  Hold_optional_lock hl(File_read::view_budget_lock());
   Views::iterator p = this->views_.begin();
   while (p != this->views_.end())
     {
@@ -816,6 +888,7 @@ File_read::clear_views(Clear_views_mode mode)
 	{
 	  if (p->second == this->whole_file_view_)
 	    this->whole_file_view_ = NULL;
+	  File_read::forget_view(p->second);
 	  delete p->second;
 
 	  // map::erase invalidates only the iterator to the deleted
@@ -826,6 +899,10 @@ File_read::clear_views(Clear_views_mode mode)
 	}
       else
 	{
+	  // A view we are keeping after the file is gone can no longer
+	  // be discarded for --file-view-budget.
+	  if (mode == CLEAR_VIEWS_ALL)
+	    File_read::forget_view(p->second);
 	  p->second->clear_accessed();
 	  ++p;
 	}
@@ -847,6 +924,120 @@ File_read::clear_views(Clear_views_mode mode)
     }
 }
 
+// Return the lock to hold while using views.  With
+// --file-view-budget, trim_views may discard the views of any file
+// which is not in use, so we need a lock to make sure that a task
+// which has just locked a file does not see its views change.
+// Without it, only the task which has locked a file uses its views,
+// and we return NULL.
+
+Lock*
+File_read::view_budget_lock()
+{
+  if (!parameters->options_valid()
+      || parameters->options().file_view_budget() == 0
+      || !file_views_initialize_lock.initialize())
+    return NULL;
+  return file_views_lock;
+}
+
+// Note that a task is using the views of this file.  They may not be
+// discarded until it is released.
+
+void
+File_read::mark_in_use()
+{
+  this->in_use_ = true;
+  if (File_read::view_budget_lock() == NULL)
+    return;
+  for (Views::const_iterator p = this->views_.begin();
+       p != this->views_.end();
+       ++p)
+    File_read::forget_view(p->second);
+}
+
+// Note that no task is using the views of this file, so that those
+// which are not locked may be discarded.  They are the most recently
+// used views.  A view locked by a File_view can only be unlocked
+// while the file is in use, so it is considered again next time.
+
+void
+File_read::mark_not_in_use()
+{
+  this->in_use_ = false;
+  for (Views::const_iterator p = this->views_.begin();
+       p != this->views_.end();
+       ++p)
+    if (!p->second->is_permanent_view() && !p->second->is_locked())
+      this->touch_view(p->second);
+}
+
+// Put the view V at the front of the list of recently used views.
+
+void
+File_read::touch_view(View* v)
+{
+  if (v->in_lru())
+    {
+      File_read::view_lru.splice(File_read::view_lru.begin(),
+				 File_read::view_lru, v->lru_position());
+      return;
+    }
+  File_read::view_lru.push_front(std::make_pair(this, v));
+  v->set_lru_position(File_read::view_lru.begin());
+  File_read::view_lru_bytes += v->size();
+}
+
+// Remove the view V, which is about to be deleted or put aside, from
+// the list of recently used views.
+
+void
+File_read::forget_view(View* v)
+{
+  if (!v->in_lru())
+    return;
+  File_read::view_lru.erase(v->lru_position());
+  v->clear_lru_position();
+  File_read::view_lru_bytes -= v->size();
+}
+
+// Discard the view V, which no task is using.
+
+void
+File_read::evict_view(View* v)
+{
+  Views::iterator p =
+    this->views_.find(std::make_pair(v->start(), v->byteshift()));
+  gold_assert(p != this->views_.end() && p->second == v);
+  this->views_.erase(p);
+  if (v == this->whole_file_view_)
+    this->whole_file_view_ = NULL;
+  File_read::forget_view(v);
+  delete v;
+  ++File_read::view_cache_evictions;
+}
+
+// Discard the least recently used views until the views we keep fit
+// in --file-view-budget.  The list only holds views which are not
+// locked by a File_view, of files which no task is using, since a
+// task may use the views of a file it has locked without locking
+// them.  So we can discard any of them.
+
+void
+File_read::trim_views()
+{
+  const unsigned long long budget =
+    parameters->options().file_view_budget();
+  while (File_read::view_lru_bytes > budget)
+    {
+      gold_assert(!File_read::view_lru.empty());
+      File_read* owner = File_read::view_lru.back().first;
+      View* v = File_read::view_lru.back().second;
+      gold_assert(!owner->in_use_ && !v->is_locked());
+      owner->evict_view(v);
+    }
+}
+
 // Print statistical information to stderr.  This is used for --stats.
 
 void
@@ -856,6 +1047,12 @@ File_read::print_stats()
 	  program_name, File_read::total_mapped_bytes);
   fprintf(stderr, _("%s: maximum bytes mapped for read at one time: %llu\n"),
 	  program_name, File_read::maximum_mapped_bytes);
+  fprintf(stderr, _("%s: input file view cache hits: %llu\n"),
+	  program_name, File_read::view_cache_hits);
+  fprintf(stderr, _("%s: input file view cache misses: %llu\n"),
+	  program_name, File_read::view_cache_misses);
+  fprintf(stderr, _("%s: input file views discarded for budget: %llu\n"),
+	  program_name, File_read::view_cache_evictions);
 }
 
 // Class File_view.
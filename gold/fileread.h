@@ -62,6 +62,7 @@ class Position_dependent_options;
 class Input_file_argument;
 class Dirsearch;
 class File_view;
+class Lock;
 
 // File_read manages a file descriptor and mappings for a file we are
 // reading.
@@ -72,7 +73,7 @@ class File_read
   File_read()
     : name_(), descriptor_(-1), is_descriptor_opened_(false), object_count_(0),
       size_(0), token_(false), views_(), saved_views_(), mapped_bytes_(0),
-      released_(true), whole_file_view_(NULL)
+      released_(true), in_use_(false), whole_file_view_(NULL)
   { }
 
   ~File_read();
@@ -247,6 +248,21 @@ class File_read
   // --stats.
   static unsigned long long maximum_mapped_bytes;
 
+  // Number of views found in the cache if --stats.
+  static unsigned long long view_cache_hits;
+
+  // Number of views which had to be read from the file if --stats.
+  static unsigned long long view_cache_misses;
+
+  // Number of views discarded to stay within --file-view-budget.
+  static unsigned long long view_cache_evictions;
+
+  class View;
+
+  // A list of the views of input files which no task is using, in
+  // order of most recent use.  This is used for --file-view-budget.
+  typedef std::list<std::pair<File_read*, View*> > View_lru;
+
   // A view into the file.
   class View
   {
@@ -267,7 +283,7 @@ class File_read
 	 unsigned int byteshift, bool cache, Data_ownership data_ownership)
       : start_(start), size_(size), data_(data), lock_count_(0),
 	byteshift_(byteshift), cache_(cache), data_ownership_(data_ownership),
-	accessed_(true)
+	accessed_(true), in_lru_(false), lru_position_()
     { }
 
     ~View();
@@ -327,6 +343,32 @@ class File_read
     is_permanent_view() const
     { return this->data_ownership_ == DATA_NOT_OWNED; }
 
+    // Whether the view is on the list used for --file-view-budget.
+    bool
+    in_lru() const
+    { return this->in_lru_; }
+
+    // The position of the view on the list.
+    View_lru::iterator
+    lru_position() const
+    {
+      gold_assert(this->in_lru_);
+      return this->lru_position_;
+    }
+
+    // Record the position of the view on the list.
+    void
+    set_lru_position(View_lru::iterator p)
+    {
+      this->in_lru_ = true;
+      this->lru_position_ = p;
+    }
+
+    // Record that the view has been removed from the list.
+    void
+    clear_lru_position()
+    { this->in_lru_ = false; }
+
    private:
     View(const View&);
     View& operator=(const View&);
@@ -350,6 +392,10 @@ class File_read
     Data_ownership data_ownership_;
     // Whether the view has been accessed recently.
     bool accessed_;
+    // Whether the view is on the list used for --file-view-budget.
+    bool in_lru_;
+    // If in_lru_, the position of the view on the list.
+    View_lru::iterator lru_position_;
   };
 
   friend class View;
@@ -365,20 +411,22 @@ class File_read
   void
   reopen_descriptor();
 
-  // Find a view into the file.
+  // Find a view into the file.  This must be called with the
+  // view_budget_lock held.
   View*
   find_view(off_t start, section_size_type size, unsigned int byteshift,
-	    View** vshifted) const;
+	    View** vshifted);
 
   // Read data from the file into a buffer.
   void
   do_read(off_t start, section_size_type size, void* p);
 
-  // Add a view.
+  // Add a view.  This must be called with the view_budget_lock held.
   void
   add_view(View*);
 
-  // Make a view into the file.
+  // Make a view into the file.  This must be called with the
+  // view_budget_lock held.
   View*
   make_view(off_t start, section_size_type size, unsigned int byteshift,
 	    bool cache);
@@ -392,6 +440,49 @@ class File_read
   void
   clear_views(Clear_views_mode);
 
+  // Return the lock to hold while using views, or NULL if
+  // --file-view-budget is not in use.  Otherwise only the task which
+  // has locked a file uses its views.
+  static Lock*
+  view_budget_lock();
+
+  // Note that a task is using the views of the file, and remove them
+  // from the list used for --file-view-budget.  This and the
+  // following functions must be called with the view_budget_lock
+  // held, if there is one.
+  void
+  mark_in_use();
+
+  // Note that no task is using the views of the file, and put those
+  // which are not locked by a File_view on the list used for
+  // --file-view-budget.
+  void
+  mark_not_in_use();
+
+  // Add a view to the list used for --file-view-budget, or move it to
+  // the front if it is already there.
+  void
+  touch_view(View*);
+
+  // Remove a view from the list used for --file-view-budget.
+  static void
+  forget_view(View*);
+
+  // Discard a view which is not in use.
+  void
+  evict_view(View*);
+
+  // Discard the least recently used views which are not in use until
+  // we are within --file-view-budget.
+  static void
+  trim_views();
+
+  // The list of views used for --file-view-budget.
+  static View_lru view_lru;
+
+  // The total size of the views on view_lru.
+  static unsigned long long view_lru_bytes;
+
   // The size of a file page for buffering data.
   static const off_t page_size = 8192;
 
@@ -436,6 +527,11 @@ class File_read
   size_t mapped_bytes_;
   // Whether the file was released.
   bool released_;
+  // Whether a task is using the views of the file.  A task may lock
+  // the file through its token without calling lock, so this is set
+  // when the task first looks for a view, and cleared by release.
+  // Protected by the view_budget_lock, if there is one.
+  bool in_use_;
   // A view containing the whole file.  May be NULL if we mmap only
   // the relevant parts of the file.  Not NULL if:
   // - Flag --mmap_whole_files is set (default on 64-bit hosts).
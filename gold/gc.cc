@@ -22,45 +22,211 @@
 
 
 #include "gold.h"
+
+#include <algorithm>
+
 #include "object.h"
 #include "gc.h"
 #include "symtab.h"
+#include "gold-threads.h"
 
 namespace gold
 {
 
+// The number of sections in each job when marking in parallel.
+
+static const size_t gc_job_size = 1024;
+
+// Jobs which convert the references between sections into lists of
+// section numbers.  Job I handles the sections in
+// section_reloc_map_ starting with entry I * gc_job_size.
+
+class Gc_edge_jobs : public Parallel_jobs
+{
+ public:
+  typedef std::vector<Garbage_collection::Section_ref::const_iterator>
+    Entries;
+
+  Gc_edge_jobs(const Garbage_collection* gc, const Entries& entries,
+	       const std::vector<size_t>& edge_offsets,
+	       std::vector<unsigned int>* edges)
+    : gc_(gc), entries_(entries), edge_offsets_(edge_offsets), edges_(edges)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    size_t end = std::min((i + 1) * gc_job_size, this->entries_.size());
+    for (size_t e = i * gc_job_size; e < end; ++e)
+      {
+	const Garbage_collection::Sections_reachable& v =
+	  this->entries_[e]->second;
+	size_t off = this->edge_offsets_[e];
+	for (Garbage_collection::Sections_reachable::const_iterator p =
+	       v.begin();
+	     p != v.end();
+	     ++p)
+	  (*this->edges_)[off++] = this->gc_->section_number(*p);
+	gold_assert(off == this->edge_offsets_[e + 1]);
+      }
+  }
+
+ private:
+  const Garbage_collection* gc_;
+  const Entries& entries_;
+  const std::vector<size_t>& edge_offsets_;
+  std::vector<unsigned int>* edges_;
+};
+
+// Jobs which mark the sections referenced by the sections in the
+// current frontier.  Job I handles the frontier sections starting
+// with I * gc_job_size, and records the sections which it marks
+// first in NEXT[I].  Each section is marked by exactly one job, so
+// each section appears in the frontier at most once.  Sections are
+// marked with an atomic compare and swap if we have one, otherwise
+// with LOCK held.
+
+class Gc_mark_jobs : public Parallel_jobs
+{
+ public:
+  Gc_mark_jobs(const std::vector<unsigned int>& frontier,
+	       const std::vector<int>& section_entries,
+	       const std::vector<size_t>& edge_offsets,
+	       const std::vector<unsigned int>& edges,
+	       std::vector<unsigned char>* referenced,
+	       std::vector<std::vector<unsigned int> >* next,
+	       Lock* lock)
+    : frontier_(frontier), section_entries_(section_entries),
+      edge_offsets_(edge_offsets), edges_(edges), referenced_(referenced),
+      next_(next), lock_(lock)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    std::vector<unsigned int>* next = &(*this->next_)[i];
+    size_t end = std::min((i + 1) * gc_job_size, this->frontier_.size());
+    for (size_t f = i * gc_job_size; f < end; ++f)
+      {
+	int e = this->section_entries_[this->frontier_[f]];
+	if (e < 0)
+	  continue;
+	for (size_t j = this->edge_offsets_[e];
+	     j < this->edge_offsets_[e + 1];
+	     ++j)
+	  {
+	    unsigned int n = this->edges_[j];
+	    if (this->mark(&(*this->referenced_)[n]))
+	      next->push_back(n);
+	  }
+      }
+  }
+
+ private:
+  // Mark a section, and return whether it was not already marked.
+  bool
+  mark(unsigned char* p)
+  {
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_1
+    return *p == 0 && __sync_bool_compare_and_swap(p, 0, 1);
+#else
+    Hold_lock hl(*this->lock_);
+    if (*p != 0)
+      return false;
+    *p = 1;
+    return true;
+#endif
+  }
+
+  const std::vector<unsigned int>& frontier_;
+  const std::vector<int>& section_entries_;
+  const std::vector<size_t>& edge_offsets_;
+  const std::vector<unsigned int>& edges_;
+  std::vector<unsigned char>* referenced_;
+  std::vector<std::vector<unsigned int> >* next_;
+  Lock* lock_;
+};
+
 // Garbage collection uses a worklist style algorithm to determine the 
-// transitive closure of all referenced sections.
+// transitive closure of all referenced sections.  The sections of all
+// the objects are numbered consecutively, the references are turned
+// into lists of section numbers, and the sections are marked breadth
+// first starting from the worklist.  Each level of the search is split
+// into jobs which may run in parallel.  The set of marked sections does not depend on the
+// order in which the jobs run.
+
 void 
-Garbage_collection::do_transitive_closure()
+Garbage_collection::do_transitive_closure(const Input_objects* input_objects)
 {
-  while (!this->worklist().empty())
+  unsigned int section_count = 0;
+  for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
+       p != input_objects->relobj_end();
+       ++p)
+    {
+      this->section_base_[*p] = section_count;
+      section_count += (*p)->shnum();
+    }
+
+  this->referenced_.assign(section_count, 0);
+
+  // Number the sections which refer to other sections, and find
+  // where the references of each one start in EDGES.
+  Gc_edge_jobs::Entries entries;
+  entries.reserve(this->section_reloc_map_.size());
+  std::vector<size_t> edge_offsets;
+  edge_offsets.reserve(this->section_reloc_map_.size() + 1);
+  std::vector<int> section_entries(section_count, -1);
+  size_t edge_count = 0;
+  for (Section_ref::const_iterator p = this->section_reloc_map_.begin();
+       p != this->section_reloc_map_.end();
+       ++p)
     {
-      // Add elements from the work list to the referenced list
-      // one by one.
-      Section_id entry = this->worklist().back();
-      this->worklist().pop_back();
-      if (!this->referenced_list().insert(entry).second)
-        continue;
-      Garbage_collection::Section_ref::iterator find_it = 
-                this->section_reloc_map().find(entry);
-      if (find_it == this->section_reloc_map().end()) 
-          continue;
-      const Garbage_collection::Sections_reachable &v = find_it->second;
-      // Scan the vector of references for each work_list entry. 
-      for (Garbage_collection::Sections_reachable::const_iterator it_v =
-               v.begin();
-           it_v != v.end();
-           ++it_v)
-        {
-          // Do not add already processed sections to the work_list. 
-          if (this->referenced_list().find(*it_v)
-              == this->referenced_list().end())
-            {
-              this->worklist().push_back(*it_v);
-            }
-        }
+      unsigned int n = this->section_number(p->first);
+      section_entries[n] = entries.size();
+      entries.push_back(p);
+      edge_offsets.push_back(edge_count);
+      edge_count += p->second.size();
     }
+  edge_offsets.push_back(edge_count);
+
+  int thread_count = Parallel_jobs::default_thread_count();
+
+  std::vector<unsigned int> edges(edge_count);
+  Gc_edge_jobs edge_jobs(this, entries, edge_offsets, &edges);
+  edge_jobs.run((entries.size() + gc_job_size - 1) / gc_job_size,
+		thread_count);
+
+  // Mark the roots.
+  std::vector<unsigned int> frontier;
+  for (Worklist_type::const_iterator p = this->work_list_.begin();
+       p != this->work_list_.end();
+       ++p)
+    {
+      unsigned int n = this->section_number(*p);
+      if (this->referenced_[n] == 0)
+	{
+	  this->referenced_[n] = 1;
+	  frontier.push_back(n);
+	}
+    }
+  this->work_list_.clear();
+
+  Lock lock;
+  while (!frontier.empty())
+    {
+      size_t job_count = (frontier.size() + gc_job_size - 1) / gc_job_size;
+      std::vector<std::vector<unsigned int> > next(job_count);
+      Gc_mark_jobs mark_jobs(frontier, section_entries, edge_offsets, edges,
+			     &this->referenced_, &next, &lock);
+      mark_jobs.run(job_count, thread_count);
+
+      frontier.clear();
+      for (size_t i = 0; i < job_count; ++i)
+	frontier.insert(frontier.end(), next[i].begin(), next[i].end());
+    }
+
   this->worklist_ready();
 }
 
@@ -41,6 +41,7 @@ class Sized_relobj_file;
 class Output_section;
 class General_options;
 class Layout;
+class Input_objects;
 
 class Garbage_collection
 {
@@ -53,17 +54,16 @@ class Garbage_collection
   // identifier (cident) to the list of sections that have that name.
   // Different object files can have cident sections with the same name.
   typedef std::map<std::string, Sections_reachable> Cident_section_map;
+  // Maps an object to the number of its first section when all the
+  // sections of all the objects are numbered consecutively.
+  typedef Unordered_map<const Relobj*, unsigned int> Section_base_map;
 
   Garbage_collection()
-  : is_worklist_ready_(false)
+  : is_worklist_ready_(false), section_base_(), referenced_()
   { }
 
   // Accessor methods for the private members.
 
-  Sections_reachable&
-  referenced_list()
-  { return referenced_list_; }
-
   Section_ref&
   section_reloc_map()
   { return this->section_reloc_map_; }
@@ -80,13 +80,21 @@ class Garbage_collection
   worklist_ready()
   { this->is_worklist_ready_ = true; }
 
+  // Mark all the sections reachable from the worklist.
+  // INPUT_OBJECTS holds all the objects whose sections may be
+  // referenced.
   void
-  do_transitive_closure();
+  do_transitive_closure(const Input_objects* input_objects);
 
   bool
-  is_section_garbage(Relobj* obj, unsigned int shndx)
-  { return (this->referenced_list().find(Section_id(obj, shndx))
-            == this->referenced_list().end()); }
+  is_section_garbage(Relobj* obj, unsigned int shndx) const
+  {
+    Section_base_map::const_iterator p = this->section_base_.find(obj);
+    if (p == this->section_base_.end())
+      return true;
+    gold_assert(shndx < obj->shnum());
+    return this->referenced_[p->second + shndx] == 0;
+  }
 
   Cident_section_map*
   cident_sections()
@@ -97,6 +105,19 @@ class Garbage_collection
 		     Section_id secn)
   { this->cident_sections_[section_name].insert(secn); }
 
+  // Return the number of a section when all the sections of all the
+  // objects are numbered consecutively.  This is only valid during
+  // and after do_transitive_closure.
+  unsigned int
+  section_number(const Section_id& secn) const
+  {
+    Section_base_map::const_iterator p =
+      this->section_base_.find(secn.first);
+    gold_assert(p != this->section_base_.end()
+		&& secn.second < secn.first->shnum());
+    return p->second + secn.second;
+  }
+
   // Add a reference from the SRC_SHNDX-th section of SRC_OBJECT to
   // DST_SHNDX-th section of DST_OBJECT.
   void
@@ -114,8 +135,12 @@ class Garbage_collection
   Worklist_type work_list_;
   bool is_worklist_ready_;
   Section_ref section_reloc_map_;
-  Sections_reachable referenced_list_;
   Cident_section_map cident_sections_;
+  // The number of the first section of each object.
+  Section_base_map section_base_;
+  // Whether each section, indexed by section number, is referenced.
+  // Set by do_transitive_closure.
+  std::vector<unsigned char> referenced_;
 };
 
 // Data to pass between successive invocations of do_layout
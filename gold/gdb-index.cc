@@ -22,12 +22,22 @@
 
 #include "gold.h"
 
+#include <algorithm>
+#include <cstring>
+#include <map>
+
 #include "gdb-index.h"
 #include "dwarf_reader.h"
 #include "dwarf.h"
 #include "object.h"
 #include "output.h"
 #include "demangle.h"
+#include "int_encoding.h"
+#include "target.h"
+#include "parameters.h"
+#include "options.h"
+#include "token.h"
+#include "gold-threads.h"
 
 namespace gold
 {
@@ -171,6 +181,277 @@ mapped_index_string_hash(const unsigned char* str)
   return r;
 }
 
+// The hash function for names in the .debug_names section.  This is
+// the DJB hash function, applied to the name with upper case letters
+// folded to lower case, as the DWARF 5 standard requires.  Only ASCII
+// letters are folded.
+
+static uint32_t
+debug_names_hash(const char* str, size_t len)
+{
+  uint32_t h = 5381;
+  for (size_t i = 0; i < len; ++i)
+    {
+      unsigned char c = str[i];
+      if (c >= 'A' && c <= 'Z')
+	c += 'a' - 'A';
+      h = h * 33 + c;
+    }
+  return h;
+}
+
+// The results of scanning one .debug_info or .debug_types input
+// section.  The results are collected here, rather than added
+// directly to the Gdb_index, so that sections may be scanned in
+// parallel and then added to the index in their original order.  CU
+// and TU indexes here are local to the section.
+
+class Gdb_index_scan
+{
+ public:
+  Gdb_index_scan(bool is_type_unit,
+		 Relobj* object,
+		 const unsigned char* symbols,
+		 off_t symbols_size,
+		 unsigned int shndx,
+		 unsigned int reloc_shndx,
+		 unsigned int reloc_type)
+    : is_type_unit_(is_type_unit), object_(object), symbols_(symbols),
+      symbols_size_(symbols_size), shndx_(shndx), reloc_shndx_(reloc_shndx),
+      reloc_type_(reloc_type), comp_units_(), type_units_(), ranges_(),
+      symbols_list_(), debug_names_list_(), names_(),
+      cu_nopubnames_count_(0), tu_nopubnames_count_(0)
+  { }
+
+  // Use SYMBOLS, a copy of the symbols which outlives the scan,
+  // since the original will not be available when the section is
+  // scanned later.
+  void
+  set_symbols(const unsigned char* symbols)
+  { this->symbols_ = symbols; }
+
+  // Return the object.
+  Relobj*
+  object() const
+  { return this->object_; }
+
+  // Scan the section.  PUBTABLES holds the state of the pubnames
+  // and pubtypes sections of the object.
+  void
+  scan(Gdb_index_pubtables* pubtables);
+
+  // Add a compilation unit.
+  int
+  add_comp_unit(off_t cu_offset, off_t cu_length)
+  {
+    this->comp_units_.push_back(std::make_pair(cu_offset, cu_length));
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a type unit.
+  int
+  add_type_unit(off_t tu_offset, off_t type_offset, uint64_t signature)
+  {
+    this->type_units_.push_back(Type_unit(tu_offset, type_offset, signature));
+    return this->type_units_.size() - 1;
+  }
+
+  // Count a compilation unit (if IS_CU) or type unit whose names
+  // come from its DIEs rather than from its pubnames.
+  void
+  count_nopubnames(bool is_cu)
+  {
+    if (is_cu)
+      ++this->cu_nopubnames_count_;
+    else
+      ++this->tu_nopubnames_count_;
+  }
+
+  // Add an address range.
+  void
+  add_address_range_list(int cu_index, Dwarf_range_list* ranges)
+  { this->ranges_.push_back(std::make_pair(cu_index, ranges)); }
+
+  // Add a symbol.  The hash codes are computed here, so that the
+  // work is done by the thread scanning the section.
+  void
+  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
+
+  // Add a name for the .debug_names section, for the DIE at
+  // DIE_OFFSET with tag TAG.
+  void
+  add_debug_name(int cu_index, const char* name, off_t die_offset,
+		 unsigned int tag);
+
+  // Add the results to GDB_INDEX and DEBUG_NAMES, either of which may
+  // be NULL.
+  void
+  add_to_index(Gdb_index* gdb_index, Debug_names* debug_names);
+
+ private:
+  // A type unit.
+  struct Type_unit
+  {
+    Type_unit(off_t off, off_t toff, uint64_t sig)
+      : tu_offset(off), type_offset(toff), type_signature(sig)
+    { }
+    off_t tu_offset;
+    off_t type_offset;
+    uint64_t type_signature;
+  };
+
+  // A symbol.  The name is at NAME_OFFSET in NAMES_.
+  struct Scanned_symbol
+  {
+    size_t name_offset;
+    size_t name_length;
+    unsigned int hash;
+    size_t stringpool_hash;
+    int cu_index;
+    uint8_t flags;
+  };
+
+  // A name for the .debug_names section.  The name is at NAME_OFFSET
+  // in NAMES_.
+  struct Scanned_name
+  {
+    size_t name_offset;
+    size_t name_length;
+    uint32_t hash;
+    size_t stringpool_hash;
+    int cu_index;
+    off_t die_offset;
+    unsigned int tag;
+  };
+
+  // Add NAME to NAMES_, returning its offset.
+  size_t
+  add_name_string(const char* name, size_t len)
+  {
+    size_t offset = this->names_.size();
+    this->names_.append(name, len + 1);
+    return offset;
+  }
+
+  // Map a CU or TU index local to the section to an index in the
+  // Gdb_index, given the index of the first CU and first TU.
+  static int
+  map_cu_index(int cu_index, int cu_base, int tu_base)
+  {
+    if (cu_index >= 0)
+      return cu_base + cu_index;
+    return -1 - (tu_base + (-1 - cu_index));
+  }
+
+  // The section to scan.
+  bool is_type_unit_;
+  Relobj* object_;
+  const unsigned char* symbols_;
+  off_t symbols_size_;
+  unsigned int shndx_;
+  unsigned int reloc_shndx_;
+  unsigned int reloc_type_;
+  // The compilation units, as offset and length pairs.
+  std::vector<std::pair<off_t, off_t> > comp_units_;
+  // The type units.
+  std::vector<Type_unit> type_units_;
+  // The address ranges, with the CU index.
+  std::vector<std::pair<int, Dwarf_range_list*> > ranges_;
+  // The symbols, in the order in which they were found.
+  std::vector<Scanned_symbol> symbols_list_;
+  // The names for the .debug_names section, in the order in which
+  // they were found.
+  std::vector<Scanned_name> debug_names_list_;
+  // The names of the symbols, each followed by a null byte.
+  std::string names_;
+  // The number of compilation units and type units without
+  // pubnames/pubtypes, for --stats.
+  unsigned int cu_nopubnames_count_;
+  unsigned int tu_nopubnames_count_;
+};
+
+// The state of the .debug_pubnames and .debug_pubtypes sections of the
+// object being scanned.  Each thread scanning sections has its own
+// instance.
+
+class Gdb_index_pubtables
+{
+ public:
+  Gdb_index_pubtables()
+    : cu_pubname_map_(), cu_pubtype_map_(), pubnames_table_(NULL),
+      pubtypes_table_(NULL), pubnames_object_(NULL), stmt_list_offset_(-1)
+  { }
+
+  ~Gdb_index_pubtables()
+  {
+    delete this->pubnames_table_;
+    delete this->pubtypes_table_;
+  }
+
+  // Return the object whose pubnames and pubtypes were last read.
+  const Relobj*
+  object() const
+  { return this->pubnames_object_; }
+
+  // Read the pubnames and pubtypes sections of OBJECT.
+  void
+  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
+                                 Relobj* object,
+                                 const unsigned char* symbols,
+                                 off_t symbols_size);
+
+  // Return the offset into the pubnames table for the cu at the given
+  // offset.
+  off_t
+  find_pubname_offset(off_t cu_offset);
+
+  // Return the offset into the pubtypes table for the cu at the
+  // given offset.
+  off_t
+  find_pubtype_offset(off_t cu_offset);
+
+  // Return TRUE if we have already processed the pubnames and types
+  // set for OBJECT of the CUs and TUS associated with the statement
+  // list at OFFSET.
+  bool
+  pubnames_read(const Relobj* object, off_t offset);
+
+  // Record that we have already read the pubnames associated with
+  // OBJECT and OFFSET.
+  void
+  set_pubnames_read(const Relobj* object, off_t offset);
+
+  // Return a pointer to the given table.
+  Dwarf_pubnames_table*
+  pubnames_table()
+  { return pubnames_table_; }
+
+  Dwarf_pubnames_table*
+  pubtypes_table()
+  { return pubtypes_table_; }
+
+ private:
+  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
+
+  // Create a map from dies to pubnames.
+  Dwarf_pubnames_table*
+  map_pubtable_to_dies(unsigned int attr,
+                       Gdb_index_info_reader* dwinfo,
+                       Relobj* object,
+                       const unsigned char* symbols,
+                       off_t symbols_size);
+
+  Pubname_offset_map cu_pubname_map_;
+  Pubname_offset_map cu_pubtype_map_;
+  // Tables to store the pubnames section of the current object.
+  Dwarf_pubnames_table* pubnames_table_;
+  Dwarf_pubnames_table* pubtypes_table_;
+  // Object, stmt list offset of the CUs and TUs associated with the
+  // last read pubnames and pubtypes sections.
+  const Relobj* pubnames_object_;
+  off_t stmt_list_offset_;
+};
+
 // A specialization of Dwarf_info_reader, for building the .gdb_index.
 
 class Gdb_index_info_reader : public Dwarf_info_reader
@@ -183,15 +464,31 @@ class Gdb_index_info_reader : public Dwarf_info_reader
 			unsigned int shndx,
 			unsigned int reloc_shndx,
 			unsigned int reloc_type,
-			Gdb_index* gdb_index)
+			Gdb_index_scan* scan,
+			Gdb_index_pubtables* pubtables)
     : Dwarf_info_reader(is_type_unit, object, symbols, symbols_size, shndx,
 			reloc_shndx, reloc_type),
-      gdb_index_(gdb_index), cu_index_(0), cu_language_(0)
+      scan_(scan), pubtables_(pubtables),
+      want_gdb_index_(parameters->options().gdb_index()),
+      want_debug_names_(parameters->options().debug_names()),
+      gdb_names_from_dies_(false), cu_index_(0), cu_language_(0)
   { }
 
   ~Gdb_index_info_reader()
   { this->clear_declarations(); }
 
+  // Count compilation units and type units for the statistics.
+  // This is called serially.
+  static void
+  add_stats(unsigned int cu_count, unsigned int cu_nopubnames_count,
+	    unsigned int tu_count, unsigned int tu_nopubnames_count)
+  {
+    Gdb_index_info_reader::dwarf_cu_count += cu_count;
+    Gdb_index_info_reader::dwarf_cu_nopubnames_count += cu_nopubnames_count;
+    Gdb_index_info_reader::dwarf_tu_count += tu_count;
+    Gdb_index_info_reader::dwarf_tu_nopubnames_count += tu_nopubnames_count;
+  }
+
   // Print usage statistics.
   static void
   print_stats();
@@ -219,12 +516,16 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   // indicate a string that we are managing.
   struct Declaration_pair
   {
-    Declaration_pair(off_t parent_offset, const char* name)
-      : parent_offset_(parent_offset), name_(name)
+    Declaration_pair(off_t parent_offset, const char* name,
+		     const char* linkage_name)
+      : parent_offset_(parent_offset), name_(name),
+	linkage_name_(linkage_name)
     { }
 
     off_t parent_offset_;
     const char* name_; 
+    // The linkage name, recorded only for .debug_names.
+    const char* linkage_name_;
   };
   typedef Unordered_map<off_t, Declaration_pair> Declaration_map;
 
@@ -269,6 +570,14 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   std::string
   get_qualified_name(Dwarf_die* die, Dwarf_die* context);
 
+  // Return the unqualified name of DIE, or NULL, and its linkage name.
+  const char*
+  get_simple_name(Dwarf_die* die, const char** linkage_name);
+
+  // Add the names of DIE to the .debug_names section.
+  void
+  add_debug_names(Dwarf_die* die);
+
   // Record the address ranges for a compilation unit.
   void
   record_cu_ranges(Dwarf_die* die);
@@ -285,8 +594,17 @@ class Gdb_index_info_reader : public Dwarf_info_reader
   void
   clear_declarations();
 
-  // The Gdb_index section.
-  Gdb_index* gdb_index_;
+  // Where to put the results of the scan.
+  Gdb_index_scan* scan_;
+  // The state of the pubnames and pubtypes sections.
+  Gdb_index_pubtables* pubtables_;
+  // Whether we are building a .gdb_index section.
+  bool want_gdb_index_;
+  // Whether we are building a .debug_names section.
+  bool want_debug_names_;
+  // Whether the names for the .gdb_index section of the current CU or
+  // TU come from its DIEs rather than from its pubnames.
+  bool gdb_names_from_dies_;
   // The current CU index (negative for a TU).
   int cu_index_;
   // The language of the current CU or TU.
@@ -321,8 +639,7 @@ void
 Gdb_index_info_reader::visit_compilation_unit(off_t cu_offset, off_t cu_length,
 					      Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_cu_count;
-  this->cu_index_ = this->gdb_index_->add_comp_unit(cu_offset, cu_length);
+  this->cu_index_ = this->scan_->add_comp_unit(cu_offset, cu_length);
   this->visit_top_die(root_die);
 }
 
@@ -333,10 +650,9 @@ Gdb_index_info_reader::visit_type_unit(off_t tu_offset, off_t,
 				       off_t type_offset, uint64_t signature,
 				       Dwarf_die* root_die)
 {
-  ++Gdb_index_info_reader::dwarf_tu_count;
   // Use a negative index to flag this as a TU instead of a CU.
-  this->cu_index_ = -1 - this->gdb_index_->add_type_unit(tu_offset, type_offset,
-							 signature);
+  this->cu_index_ = -1 - this->scan_->add_type_unit(tu_offset, type_offset,
+						    signature);
   this->visit_top_die(root_die);
 }
 
@@ -357,12 +673,19 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
       case elfcpp::DW_TAG_compile_unit:
       case elfcpp::DW_TAG_type_unit:
 	this->cu_language_ = die->int_attribute(elfcpp::DW_AT_language);
-	if (die->tag() == elfcpp::DW_TAG_compile_unit)
+	if (this->want_gdb_index_
+	    && die->tag() == elfcpp::DW_TAG_compile_unit)
 	  this->record_cu_ranges(die);
 	// If there is a pubnames and/or pubtypes section for this
-	// compilation unit, use those; otherwise, parse the DWARF
-	// info to extract the names.
-	if (!this->read_pubnames_and_pubtypes(die))
+	// compilation unit, use those for the .gdb_index section;
+	// otherwise, parse the DWARF info to extract the names.  The
+	// .debug_names section always needs the DIEs of a compilation
+	// unit.
+	this->gdb_names_from_dies_ = (this->want_gdb_index_
+				      && !this->read_pubnames_and_pubtypes(die));
+	if (this->gdb_names_from_dies_
+	    || (this->want_debug_names_
+		&& die->tag() == elfcpp::DW_TAG_compile_unit))
 	  {
 	    // Check for languages that require specialized knowledge to
 	    // construct fully-qualified names, that we don't yet support.
@@ -375,15 +698,19 @@ Gdb_index_info_reader::visit_top_die(Dwarf_die* die)
 		|| this->cu_language_ == elfcpp::DW_LANG_Fortran03
 		|| this->cu_language_ == elfcpp::DW_LANG_Fortran08)
 	      {
-		gold_warning(_("%s: --gdb-index currently supports "
-			       "only C and C++ languages"),
-			     this->object()->name().c_str());
+		if (this->want_gdb_index_)
+		  gold_warning(_("%s: --gdb-index currently supports "
+				 "only C and C++ languages"),
+			       this->object()->name().c_str());
+		else
+		  gold_warning(_("%s: --debug-names currently supports "
+				 "only C and C++ languages"),
+			       this->object()->name().c_str());
 		return;
 	      }
-	    if (die->tag() == elfcpp::DW_TAG_compile_unit)
-	      ++Gdb_index_info_reader::dwarf_cu_nopubnames_count;
-	    else
-	      ++Gdb_index_info_reader::dwarf_tu_nopubnames_count;
+	    if (this->gdb_names_from_dies_)
+	      this->scan_->count_nopubnames(die->tag()
+					    == elfcpp::DW_TAG_compile_unit);
 	    this->visit_children(die, NULL);
 	  }
 	break;
@@ -435,10 +762,14 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	else
 	  {
 	    // If the DIE is not a declaration, add it to the index.
-	    std::string full_name = this->get_qualified_name(die, context);
-	    if (!full_name.empty())
-	      this->gdb_index_->add_symbol(this->cu_index_,
-                                           full_name.c_str(), 0);
+	    if (this->gdb_names_from_dies_)
+	      {
+		std::string full_name = this->get_qualified_name(die, context);
+		if (!full_name.empty())
+		  this->scan_->add_symbol(this->cu_index_, full_name.c_str(),
+					  0);
+	      }
+	    this->add_debug_names(die);
 	  }
 	break;
       case elfcpp::DW_TAG_typedef:
@@ -474,11 +805,15 @@ Gdb_index_info_reader::visit_die(Dwarf_die* die, Dwarf_die* context)
 	  if (die->tag() == elfcpp::DW_TAG_namespace
 	      || !die->is_declaration())
 	    {
-	      if (full_name.empty())
-		full_name = this->get_qualified_name(die, context);
-	      if (!full_name.empty())
-		this->gdb_index_->add_symbol(this->cu_index_,
-					     full_name.c_str(), 0);
+	      if (this->gdb_names_from_dies_)
+		{
+		  if (full_name.empty())
+		    full_name = this->get_qualified_name(die, context);
+		  if (!full_name.empty())
+		    this->scan_->add_symbol(this->cu_index_,
+					    full_name.c_str(), 0);
+		}
+	      this->add_debug_names(die);
 	    }
 
 	  // We're interested in the children only for namespaces and
@@ -693,6 +1028,12 @@ Gdb_index_info_reader::add_declaration(Dwarf_die* die, Dwarf_die* context)
 
   off_t parent_offset = context != NULL ? context->offset() : 0;
 
+  const char* linkage_name = NULL;
+  if (this->want_debug_names_
+      && (die->tag() == elfcpp::DW_TAG_subprogram
+	  || die->tag() == elfcpp::DW_TAG_variable))
+    linkage_name = die->linkage_name();
+
   // If this DIE has a DW_AT_specification or DW_AT_abstract_origin
   // attribute, use the parent and name from the earlier declaration.
   off_t spec = die->specification();
@@ -705,6 +1046,8 @@ Gdb_index_info_reader::add_declaration(Dwarf_die* die, Dwarf_die* context)
         {
 	  parent_offset = it->second.parent_offset_;
 	  name = it->second.name_;
+	  if (linkage_name == NULL)
+	    linkage_name = it->second.linkage_name_;
         }
     }
 
@@ -718,7 +1061,7 @@ Gdb_index_info_reader::add_declaration(Dwarf_die* die, Dwarf_die* context)
         name = "(unknown)";
     }
 
-  Declaration_pair decl(parent_offset, name);
+  Declaration_pair decl(parent_offset, name, linkage_name);
   this->declarations_.insert(std::make_pair(die->offset(), decl));
 }
 
@@ -738,7 +1081,7 @@ Gdb_index_info_reader::add_declaration_with_full_name(
   memcpy(copy, full_name, len + 1);
 
   // Flag that we now manage the memory this points to.
-  Declaration_pair decl(-1, copy);
+  Declaration_pair decl(-1, copy, NULL);
   this->declarations_.insert(std::make_pair(die->offset(), decl));
 }
 
@@ -773,6 +1116,12 @@ Gdb_index_info_reader::get_qualified_name(Dwarf_die* die, Dwarf_die* context)
 
   off_t parent_offset = context != NULL ? context->offset() : 0;
 
+  const char* linkage_name = NULL;
+  if (this->want_debug_names_
+      && (die->tag() == elfcpp::DW_TAG_subprogram
+	  || die->tag() == elfcpp::DW_TAG_variable))
+    linkage_name = die->linkage_name();
+
   // If this DIE has a DW_AT_specification or DW_AT_abstract_origin
   // attribute, use the parent and name from the earlier declaration.
   off_t spec = die->specification();
@@ -785,6 +1134,8 @@ Gdb_index_info_reader::get_qualified_name(Dwarf_die* die, Dwarf_die* context)
         {
 	  parent_offset = it->second.parent_offset_;
 	  name = it->second.name_;
+	  if (linkage_name == NULL)
+	    linkage_name = it->second.linkage_name_;
         }
     }
 
@@ -812,6 +1163,64 @@ Gdb_index_info_reader::get_qualified_name(Dwarf_die* die, Dwarf_die* context)
   return full_name;
 }
 
+// Return the unqualified name of DIE, and set *LINKAGE_NAME to its
+// linkage name or NULL.  A DIE with a DW_AT_specification or
+// DW_AT_abstract_origin attribute gets its names from the earlier
+// declaration.
+
+const char*
+Gdb_index_info_reader::get_simple_name(Dwarf_die* die,
+				       const char** linkage_name)
+{
+  const char* name = die->name();
+  *linkage_name = NULL;
+  if (die->tag() == elfcpp::DW_TAG_subprogram
+      || die->tag() == elfcpp::DW_TAG_variable)
+    *linkage_name = die->linkage_name();
+  if (name != NULL && *linkage_name != NULL)
+    return name;
+
+  off_t spec = die->specification();
+  if (spec == 0)
+    spec = die->abstract_origin();
+  if (spec > 0)
+    {
+      Declaration_map::iterator it = this->declarations_.find(spec);
+      if (it != this->declarations_.end())
+	{
+	  if (*linkage_name == NULL)
+	    *linkage_name = it->second.linkage_name_;
+	  // A declaration whose fully-qualified name we constructed
+	  // does not record the unqualified name.
+	  if (name == NULL && it->second.parent_offset_ != -1)
+	    name = it->second.name_;
+	}
+    }
+  return name;
+}
+
+// Add DIE to the .debug_names section under its unqualified name,
+// and for a function or variable, under its linkage name too.  DIEs
+// in type units are not indexed.
+
+void
+Gdb_index_info_reader::add_debug_names(Dwarf_die* die)
+{
+  if (!this->want_debug_names_ || this->cu_index_ < 0)
+    return;
+
+  const char* linkage_name;
+  const char* name = this->get_simple_name(die, &linkage_name);
+  if (name != NULL)
+    this->scan_->add_debug_name(this->cu_index_, name, die->offset(),
+				die->tag());
+
+  if (linkage_name != NULL
+      && (name == NULL || strcmp(linkage_name, name) != 0))
+    this->scan_->add_debug_name(this->cu_index_, linkage_name,
+				die->offset(), die->tag());
+}
+
 // Record the address ranges for a compilation unit.
 
 void
@@ -825,8 +1234,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
     {
       Dwarf_range_list* ranges = this->read_range_list(shndx, ranges_offset);
       if (ranges != NULL)
-	this->gdb_index_->add_address_range_list(this->object(),
-						 this->cu_index_, ranges);
+	this->scan_->add_address_range_list(this->cu_index_, ranges);
       return;
     }
 
@@ -851,8 +1259,7 @@ Gdb_index_info_reader::record_cu_ranges(Dwarf_die* die)
         {
 	  Dwarf_range_list* ranges = new Dwarf_range_list();
 	  ranges->add(shndx, low_pc, high_pc);
-	  this->gdb_index_->add_address_range_list(this->object(),
-						   this->cu_index_, ranges);
+	  this->scan_->add_address_range_list(this->cu_index_, ranges);
         }
     }
 }
@@ -877,7 +1284,7 @@ Gdb_index_info_reader::read_pubtable(Dwarf_pubnames_table* table, off_t offset)
       if (name == NULL)
         break;
 
-      this->gdb_index_->add_symbol(this->cu_index_, name, flag_byte);
+      this->scan_->add_symbol(this->cu_index_, name, flag_byte);
     }
   return true;
 }
@@ -916,7 +1323,7 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
           // have read. If it does, then no need to read the pubnames.
           // If it doesn't, then the caller will have to parse the
           // dies manually to find the names.
-          return this->gdb_index_->pubnames_read(this->object(),
+          return this->pubtables_->pubnames_read(this->object(),
                                                  stmt_list_off);
         }
       else
@@ -928,10 +1335,10 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
 
   // We found the attribute, so we can check if the corresponding
   // pubnames have been read.
-  if (this->gdb_index_->pubnames_read(this->object(), stmt_list_off))
+  if (this->pubtables_->pubnames_read(this->object(), stmt_list_off))
     return true;
 
-  this->gdb_index_->set_pubnames_read(this->object(), stmt_list_off);
+  this->pubtables_->set_pubnames_read(this->object(), stmt_list_off);
 
   // We have an attribute, and the pubnames haven't been read, so read
   // them.
@@ -939,12 +1346,12 @@ Gdb_index_info_reader::read_pubnames_and_pubtypes(Dwarf_die* die)
   // In some of the cases, we could rely on the previous value of
   // offset here, but sorting out which cases complicates the logic
   // enough that it isn't worth it. So just look up the offset again.
-  offset = this->gdb_index_->find_pubname_offset(this->cu_offset());
-  names = this->read_pubtable(this->gdb_index_->pubnames_table(), offset);
+  offset = this->pubtables_->find_pubname_offset(this->cu_offset());
+  names = this->read_pubtable(this->pubtables_->pubnames_table(), offset);
 
   bool types = false;
-  offset = this->gdb_index_->find_pubtype_offset(this->cu_offset());
-  types = this->read_pubtable(this->gdb_index_->pubtypes_table(), offset);
+  offset = this->pubtables_->find_pubtype_offset(this->cu_offset());
+  types = this->read_pubtable(this->pubtables_->pubtypes_table(), offset);
   return names || types;
 }
 
@@ -978,41 +1385,130 @@ Gdb_index_info_reader::print_stats()
           program_name, Gdb_index_info_reader::dwarf_tu_nopubnames_count);
 }
 
-// Class Gdb_index.
+// Class Gdb_index_scan.
 
-// Construct the .gdb_index section.
+// Scan the section.
 
-Gdb_index::Gdb_index(Output_section* gdb_index_section)
-  : Output_section_data(4),
-    pubnames_table_(NULL),
-    pubtypes_table_(NULL),
-    gdb_index_section_(gdb_index_section),
-    comp_units_(),
-    type_units_(),
-    ranges_(),
-    cu_vector_list_(),
-    cu_vector_offsets_(NULL),
-    stringpool_(),
-    tu_offset_(0),
-    addr_offset_(0),
-    symtab_offset_(0),
-    cu_pool_offset_(0),
-    stringpool_offset_(0),
-    pubnames_object_(NULL),
-    stmt_list_offset_(-1)
+void
+Gdb_index_scan::scan(Gdb_index_pubtables* pubtables)
 {
-  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+  Gdb_index_info_reader dwinfo(this->is_type_unit_, this->object_,
+			       this->symbols_, this->symbols_size_,
+			       this->shndx_, this->reloc_shndx_,
+			       this->reloc_type_, this, pubtables);
+  if (parameters->options().gdb_index()
+      && this->object_ != pubtables->object())
+    pubtables->map_pubnames_and_types_to_dies(&dwinfo, this->object_,
+					      this->symbols_,
+					      this->symbols_size_);
+  dwinfo.parse();
 }
 
-Gdb_index::~Gdb_index()
+// Add a symbol.
+
+void
+Gdb_index_scan::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
 {
-  // Free the memory used by the symbol table.
-  delete this->gdb_symtab_;
-  // Free the memory used by the CU vectors.
-  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
-    delete this->cu_vector_list_[i];
+  Scanned_symbol sym;
+  sym.name_length = strlen(sym_name);
+  sym.name_offset = this->add_name_string(sym_name, sym.name_length);
+  sym.hash = mapped_index_string_hash(
+      reinterpret_cast<const unsigned char*>(sym_name));
+  sym.stringpool_hash = Stringpool::hash_string(sym_name, sym.name_length);
+  sym.cu_index = cu_index;
+  sym.flags = flags;
+  this->symbols_list_.push_back(sym);
+}
+
+// Add a name for the .debug_names section.
+
+void
+Gdb_index_scan::add_debug_name(int cu_index, const char* name,
+			       off_t die_offset, unsigned int tag)
+{
+  Scanned_name dn;
+  dn.name_length = strlen(name);
+  dn.name_offset = this->add_name_string(name, dn.name_length);
+  dn.hash = debug_names_hash(name, dn.name_length);
+  dn.stringpool_hash = Stringpool::hash_string(name, dn.name_length);
+  dn.cu_index = cu_index;
+  dn.die_offset = die_offset;
+  dn.tag = tag;
+  this->debug_names_list_.push_back(dn);
+}
+
+// Add the results to GDB_INDEX and DEBUG_NAMES, mapping our CU and TU
+// indexes to the indexes there.
+
+void
+Gdb_index_scan::add_to_index(Gdb_index* gdb_index, Debug_names* debug_names)
+{
+  Gdb_index_info_reader::add_stats(this->comp_units_.size(),
+				   this->cu_nopubnames_count_,
+				   this->type_units_.size(),
+				   this->tu_nopubnames_count_);
+
+  const char* names = this->names_.data();
+
+  if (debug_names != NULL)
+    {
+      int cu_base = 0;
+      for (size_t i = 0; i < this->comp_units_.size(); ++i)
+	{
+	  int index = debug_names->add_comp_unit(this->comp_units_[i].first);
+	  if (i == 0)
+	    cu_base = index;
+	}
+
+      for (size_t i = 0; i < this->debug_names_list_.size(); ++i)
+	{
+	  const Scanned_name& dn(this->debug_names_list_[i]);
+	  gold_assert(dn.cu_index >= 0);
+	  debug_names->add_name(cu_base + dn.cu_index,
+				names + dn.name_offset, dn.name_length,
+				dn.hash, dn.stringpool_hash, dn.die_offset,
+				dn.tag);
+	}
+    }
+
+  if (gdb_index == NULL)
+    return;
+
+  int cu_base = 0;
+  for (size_t i = 0; i < this->comp_units_.size(); ++i)
+    {
+      int index = gdb_index->add_comp_unit(this->comp_units_[i].first,
+					   this->comp_units_[i].second);
+      if (i == 0)
+	cu_base = index;
+    }
+
+  int tu_base = 0;
+  for (size_t i = 0; i < this->type_units_.size(); ++i)
+    {
+      const Type_unit& tu(this->type_units_[i]);
+      int index = gdb_index->add_type_unit(tu.tu_offset, tu.type_offset,
+					   tu.type_signature);
+      if (i == 0)
+	tu_base = index;
+    }
+
+  for (size_t i = 0; i < this->ranges_.size(); ++i)
+    gdb_index->add_address_range_list(this->object_,
+				      map_cu_index(this->ranges_[i].first,
+						   cu_base, tu_base),
+				      this->ranges_[i].second);
+
+  for (size_t i = 0; i < this->symbols_list_.size(); ++i)
+    {
+      const Scanned_symbol& sym(this->symbols_list_[i]);
+      gdb_index->add_symbol(map_cu_index(sym.cu_index, cu_base, tu_base),
+			    names + sym.name_offset, sym.name_length,
+			    sym.hash, sym.stringpool_hash, sym.flags);
+    }
 }
 
+// Class Gdb_index_pubtables.
 
 // Scan the pubnames and pubtypes sections and build a map of the
 // various cus and tus they refer to, so we can process the entries
@@ -1020,11 +1516,11 @@ Gdb_index::~Gdb_index()
 // Return the just-read table so it can be cached.
 
 Dwarf_pubnames_table*
-Gdb_index::map_pubtable_to_dies(unsigned int attr,
-                                Gdb_index_info_reader* dwinfo,
-                                Relobj* object,
-                                const unsigned char* symbols,
-                                off_t symbols_size)
+Gdb_index_pubtables::map_pubtable_to_dies(unsigned int attr,
+					  Gdb_index_info_reader* dwinfo,
+					  Relobj* object,
+					  const unsigned char* symbols,
+					  off_t symbols_size)
 {
   uint64_t section_offset = 0;
   Dwarf_pubnames_table* table;
@@ -1057,10 +1553,11 @@ Gdb_index::map_pubtable_to_dies(unsigned int attr,
 // Wrapper for map_pubtable_to_dies
 
 void
-Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                          Relobj* object,
-                                          const unsigned char* symbols,
-                                          off_t symbols_size)
+Gdb_index_pubtables::map_pubnames_and_types_to_dies(
+    Gdb_index_info_reader* dwinfo,
+    Relobj* object,
+    const unsigned char* symbols,
+    off_t symbols_size)
 {
   // This is a new object, so reset the relevant variables.
   this->pubnames_object_ = object;
@@ -1080,7 +1577,7 @@ Gdb_index::map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
 // table.
 
 off_t
-Gdb_index::find_pubname_offset(off_t cu_offset)
+Gdb_index_pubtables::find_pubname_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubname_map_.find(cu_offset);
   if (it != this->cu_pubname_map_.end())
@@ -1092,7 +1589,7 @@ Gdb_index::find_pubname_offset(off_t cu_offset)
 // table.
 
 off_t
-Gdb_index::find_pubtype_offset(off_t cu_offset)
+Gdb_index_pubtables::find_pubtype_offset(off_t cu_offset)
 {
   Pubname_offset_map::iterator it = this->cu_pubtype_map_.find(cu_offset);
   if (it != this->cu_pubtype_map_.end())
@@ -1100,10 +1597,52 @@ Gdb_index::find_pubtype_offset(off_t cu_offset)
   return -1;
 }
 
-// Scan a .debug_info or .debug_types input section.
+// Return TRUE if we have already processed the pubnames associated
+// with the statement list at the given OFFSET.
+
+bool
+Gdb_index_pubtables::pubnames_read(const Relobj* object, off_t offset)
+{
+  bool ret = (this->pubnames_object_ == object
+	      && this->stmt_list_offset_ == offset);
+  return ret;
+}
+
+// Record that we have processed the pubnames associated with the
+// statement list for OBJECT at the given OFFSET.
 
 void
-Gdb_index::scan_debug_info(bool is_type_unit,
+Gdb_index_pubtables::set_pubnames_read(const Relobj* object, off_t offset)
+{
+  this->pubnames_object_ = object;
+  this->stmt_list_offset_ = offset;
+}
+
+// Class Debug_index_scanner.
+
+Debug_index_scanner::Debug_index_scanner(Gdb_index* gdb_index,
+					 Debug_names* debug_names)
+  : gdb_index_(gdb_index), debug_names_(debug_names),
+    pubtables_(new Gdb_index_pubtables()), deferred_scans_(),
+    symbol_copies_()
+{ }
+
+Debug_index_scanner::~Debug_index_scanner()
+{
+  delete this->pubtables_;
+  for (std::map<const Relobj*, unsigned char*>::iterator p =
+	 this->symbol_copies_.begin();
+       p != this->symbol_copies_.end();
+       ++p)
+    delete[] p->second;
+}
+
+// Scan a .debug_info or .debug_types input section.  When using
+// threads, and not doing an incremental link, just record the section;
+// it will be scanned by scan_deferred_debug_info.
+
+void
+Debug_index_scanner::scan_debug_info(bool is_type_unit,
 			   Relobj* object,
 			   const unsigned char* symbols,
 			   off_t symbols_size,
@@ -1111,24 +1650,150 @@ Gdb_index::scan_debug_info(bool is_type_unit,
 			   unsigned int reloc_shndx,
 			   unsigned int reloc_type)
 {
-  Gdb_index_info_reader dwinfo(is_type_unit, object,
-			       symbols, symbols_size,
-			       shndx, reloc_shndx,
-			       reloc_type, this);
-  if (object != this->pubnames_object_)
-    map_pubnames_and_types_to_dies(&dwinfo, object, symbols, symbols_size);
-  dwinfo.parse();
+  Gdb_index_scan* scan = new Gdb_index_scan(is_type_unit, object,
+					    symbols, symbols_size,
+					    shndx, reloc_shndx, reloc_type);
+  if (parameters->options().threads() && !parameters->incremental())
+    {
+      // Keep one copy of the symbols of each object, shared by all
+      // of its sections.
+      if (symbols != NULL && symbols_size != 0)
+	{
+	  unsigned char*& copy(this->symbol_copies_[object]);
+	  if (copy == NULL)
+	    {
+	      copy = new unsigned char[symbols_size];
+	      memcpy(copy, symbols, symbols_size);
+	    }
+	  scan->set_symbols(copy);
+	}
+      this->deferred_scans_.push_back(scan);
+      return;
+    }
+
+  scan->scan(this->pubtables_);
+  scan->add_to_index(this->gdb_index_, this->debug_names_);
+  delete scan;
+}
+
+// Jobs which scan the deferred input sections.  Each job scans all the
+// input sections from one file, in order, so that only one thread
+// uses each file.
+
+class Scan_debug_info_jobs : public Parallel_jobs
+{
+ public:
+  Scan_debug_info_jobs(const Task* task,
+		       const std::vector<std::vector<Gdb_index_scan*> >& files)
+    : task_(task), files_(files)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    const std::vector<Gdb_index_scan*>& scans(this->files_[i]);
+    gold_assert(!scans.empty());
+    Task_lock_obj<Object> tlo(this->task_, scans.front()->object());
+    Gdb_index_pubtables pubtables;
+    for (std::vector<Gdb_index_scan*>::const_iterator p = scans.begin();
+	 p != scans.end();
+	 ++p)
+      (*p)->scan(&pubtables);
+  }
+
+ private:
+  const Task* task_;
+  const std::vector<std::vector<Gdb_index_scan*> >& files_;
+};
+
+// Scan the input sections recorded by scan_debug_info.  The sections
+// are scanned in parallel, grouped by file, and the results are then
+// added to the indexes in the original order, so that the indexes do
+// not depend on the number of threads.
+
+void
+Debug_index_scanner::scan_deferred_debug_info(const Task* task)
+{
+  if (this->deferred_scans_.empty())
+    return;
+
+  std::vector<std::vector<Gdb_index_scan*> > files;
+  std::map<const File_read*, size_t> file_indexes;
+  for (std::vector<Gdb_index_scan*>::const_iterator p =
+	 this->deferred_scans_.begin();
+       p != this->deferred_scans_.end();
+       ++p)
+    {
+      const File_read* file = &(*p)->object()->input_file()->file();
+      std::pair<std::map<const File_read*, size_t>::iterator, bool> ins =
+	file_indexes.insert(std::make_pair(file, files.size()));
+      if (ins.second)
+	files.push_back(std::vector<Gdb_index_scan*>());
+      files[ins.first->second].push_back(*p);
+    }
+
+  Scan_debug_info_jobs jobs(task, files);
+  jobs.run(files.size(), Parallel_jobs::default_thread_count());
+
+  for (std::vector<Gdb_index_scan*>::iterator p =
+	 this->deferred_scans_.begin();
+       p != this->deferred_scans_.end();
+       ++p)
+    {
+      (*p)->add_to_index(this->gdb_index_, this->debug_names_);
+      delete *p;
+    }
+  this->deferred_scans_.clear();
+
+  for (std::map<const Relobj*, unsigned char*>::iterator p =
+	 this->symbol_copies_.begin();
+       p != this->symbol_copies_.end();
+       ++p)
+    delete[] p->second;
+  this->symbol_copies_.clear();
+}
+
+// Class Gdb_index.
+
+// Construct the .gdb_index section.
+
+Gdb_index::Gdb_index(Output_section* gdb_index_section)
+  : Output_section_data(4),
+    gdb_index_section_(gdb_index_section),
+    comp_units_(),
+    type_units_(),
+    ranges_(),
+    cu_vector_list_(),
+    cu_vector_offsets_(NULL),
+    stringpool_(),
+    tu_offset_(0),
+    addr_offset_(0),
+    symtab_offset_(0),
+    cu_pool_offset_(0),
+    stringpool_offset_(0)
+{
+  this->gdb_symtab_ = new Gdb_hashtab<Gdb_symbol>();
+}
+
+Gdb_index::~Gdb_index()
+{
+  // Free the memory used by the symbol table.
+  delete this->gdb_symtab_;
+  // Free the memory used by the CU vectors.
+  for (unsigned int i = 0; i < this->cu_vector_list_.size(); ++i)
+    delete this->cu_vector_list_[i];
 }
 
 // Add a symbol.
 
 void
-Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
+Gdb_index::add_symbol(int cu_index, const char* sym_name, size_t len,
+		      unsigned int hash, size_t stringpool_hash, uint8_t flags)
 {
-  unsigned int hash = mapped_index_string_hash(
-      reinterpret_cast<const unsigned char*>(sym_name));
   Gdb_symbol* sym = new Gdb_symbol();
-  this->stringpool_.add(sym_name, true, &sym->name_key);
+  this->stringpool_.add_with_length_and_hash(sym_name, len, stringpool_hash,
+					     true, &sym->name_key);
   sym->hashval = hash;
   sym->cu_vector_index = 0;
 
@@ -1156,27 +1821,6 @@ Gdb_index::add_symbol(int cu_index, const char* sym_name, uint8_t flags)
     cu_vec->push_back(std::make_pair(cu_index, flags));
 }
 
-// Return TRUE if we have already processed the pubnames associated
-// with the statement list at the given OFFSET.
-
-bool
-Gdb_index::pubnames_read(const Relobj* object, off_t offset)
-{
-  bool ret = (this->pubnames_object_ == object
-	      && this->stmt_list_offset_ == offset);
-  return ret;
-}
-
-// Record that we have processed the pubnames associated with the
-// statement list for OBJECT at the given OFFSET.
-
-void
-Gdb_index::set_pubnames_read(const Relobj* object, off_t offset)
-{
-  this->pubnames_object_ = object;
-  this->stmt_list_offset_ = offset;
-}
-
 // Set the size of the .gdb_index section.
 
 void
@@ -1352,8 +1996,440 @@ Gdb_index::do_write(Output_file* of)
 void
 Gdb_index::print_stats()
 {
-  if (parameters->options().gdb_index())
+  if (parameters->options().gdb_index() || parameters->options().debug_names())
     Gdb_index_info_reader::print_stats();
 }
 
+// Class Debug_names.
+
+// The size of the .debug_names header, for 32-bit DWARF and an empty
+// augmentation string.
+const int debug_names_hdr_size = 36;
+
+// The number of names handled by each job when building the
+// .debug_names section.
+const size_t debug_names_job_size = 4096;
+
+// Write a ULEB 128 encoded VALUE to POV, returning the position after
+// it.
+
+static unsigned char*
+write_debug_names_uleb(unsigned char* pov, uint64_t value)
+{
+  do
+    {
+      unsigned char byte = value & 0x7f;
+      value >>= 7;
+      if (value != 0)
+	byte |= 0x80;
+      *pov++ = byte;
+    }
+  while (value != 0);
+  return pov;
+}
+
+Debug_names::Debug_names()
+  : Output_section_data(4), comp_units_(), names_(), name_map_(),
+    abbrev_codes_(), sorted_names_(), bucket_count_(0),
+    abbrev_table_size_(0), entry_pool_size_(0), entry_count_(0),
+    stringpool_(), string_data_(NULL)
+{
+  this->string_data_ = new Output_data_strtab(&this->stringpool_);
+}
+
+Debug_names::~Debug_names()
+{
+  for (size_t i = 0; i < this->names_.size(); ++i)
+    delete this->names_[i];
+}
+
+// Add a name.
+
+void
+Debug_names::add_name(int cu_index, const char* name, size_t len,
+		      uint32_t hash, size_t stringpool_hash, off_t die_offset,
+		      unsigned int tag)
+{
+  Stringpool::Key key;
+  this->stringpool_.add_with_length_and_hash(name, len, stringpool_hash,
+					     true, &key);
+  std::pair<Name_map::iterator, bool> ins =
+    this->name_map_.insert(std::make_pair(key, this->names_.size()));
+  if (ins.second)
+    {
+      Name* n = new Name();
+      n->name_key = key;
+      n->hash = hash;
+      n->entry_offset = 0;
+      this->names_.push_back(n);
+    }
+  this->names_[ins.first->second]->entries.push_back(
+      Name_entry(cu_index, die_offset, tag));
+  this->abbrev_codes_.insert(std::make_pair(tag, 0U));
+  ++this->entry_count_;
+}
+
+// Return the size of the entries for NAME in the entry pool: for each
+// entry, the abbreviation code, the CU index if there is more than one
+// CU, and the DIE offset; then a zero terminating the list.
+
+size_t
+Debug_names::entries_size(const Name& name) const
+{
+  bool need_cu_index = this->comp_units_.size() > 1;
+  size_t size = 1;
+  for (std::vector<Name_entry>::const_iterator p = name.entries.begin();
+       p != name.entries.end();
+       ++p)
+    {
+      std::map<unsigned int, unsigned int>::const_iterator code =
+	this->abbrev_codes_.find(p->tag);
+      gold_assert(code != this->abbrev_codes_.end());
+      size += get_length_as_unsigned_LEB_128(code->second);
+      if (need_cu_index)
+	size += get_length_as_unsigned_LEB_128(p->cu_index);
+      size += 4;
+    }
+  return size;
+}
+
+// Write the entries for NAME to POV.
+
+template<bool big_endian>
+void
+Debug_names::write_entries(const Name& name, unsigned char* pov) const
+{
+  bool need_cu_index = this->comp_units_.size() > 1;
+  for (std::vector<Name_entry>::const_iterator p = name.entries.begin();
+       p != name.entries.end();
+       ++p)
+    {
+      std::map<unsigned int, unsigned int>::const_iterator code =
+	this->abbrev_codes_.find(p->tag);
+      pov = write_debug_names_uleb(pov, code->second);
+      if (need_cu_index)
+	pov = write_debug_names_uleb(pov, p->cu_index);
+      elfcpp::Swap_unaligned<32, big_endian>::writeval(pov, p->die_offset);
+      pov += 4;
+    }
+  *pov = 0;
+}
+
+// Jobs which compute the sizes of the entries of the names.  Each job
+// handles debug_names_job_size names.
+
+class Debug_names::Entry_size_jobs : public Parallel_jobs
+{
+ public:
+  Entry_size_jobs(Debug_names* debug_names)
+    : debug_names_(debug_names)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    std::vector<Name*>& names(this->debug_names_->names_);
+    size_t end = std::min((i + 1) * debug_names_job_size, names.size());
+    for (size_t j = i * debug_names_job_size; j < end; ++j)
+      names[j]->entry_offset = this->debug_names_->entries_size(*names[j]);
+  }
+
+ private:
+  Debug_names* debug_names_;
+};
+
+// Jobs which write the name table and the entry pool.  Each job
+// handles debug_names_job_size names, in sorted order.
+
+class Debug_names::Write_entries_jobs : public Parallel_jobs
+{
+ public:
+  Write_entries_jobs(const Debug_names* debug_names, bool big_endian,
+		     unsigned char* hashes, unsigned char* string_offsets,
+		     unsigned char* entry_offsets, unsigned char* entry_pool,
+		     off_t string_base)
+    : debug_names_(debug_names), big_endian_(big_endian), hashes_(hashes),
+      string_offsets_(string_offsets), entry_offsets_(entry_offsets),
+      entry_pool_(entry_pool), string_base_(string_base)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    if (this->big_endian_)
+      this->write<true>(i);
+    else
+      this->write<false>(i);
+  }
+
+ private:
+  template<bool big_endian>
+  void
+  write(size_t i)
+  {
+    const Debug_names* dn = this->debug_names_;
+    const std::vector<unsigned int>& sorted(dn->sorted_names_);
+    size_t end = std::min((i + 1) * debug_names_job_size, sorted.size());
+    for (size_t j = i * debug_names_job_size; j < end; ++j)
+      {
+	const Name& name(*dn->names_[sorted[j]]);
+	elfcpp::Swap<32, big_endian>::writeval(this->hashes_ + 4 * j,
+					       name.hash);
+	off_t string_offset =
+	  (this->string_base_
+	   + dn->stringpool_.get_offset_from_key(name.name_key));
+	elfcpp::Swap<32, big_endian>::writeval(this->string_offsets_ + 4 * j,
+					       string_offset);
+	elfcpp::Swap<32, big_endian>::writeval(this->entry_offsets_ + 4 * j,
+					       name.entry_offset);
+	dn->write_entries<big_endian>(name,
+				      this->entry_pool_ + name.entry_offset);
+      }
+  }
+
+  const Debug_names* debug_names_;
+  bool big_endian_;
+  unsigned char* hashes_;
+  unsigned char* string_offsets_;
+  unsigned char* entry_offsets_;
+  unsigned char* entry_pool_;
+  off_t string_base_;
+};
+
+// Set the size of the .debug_names section.  Sort the names into hash
+// buckets and lay out the entry pool.
+
+void
+Debug_names::set_final_data_size()
+{
+  size_t name_count = this->names_.size();
+
+  // Use the same number of buckets as LLVM.
+  if (name_count > 1024)
+    this->bucket_count_ = name_count / 4;
+  else if (name_count > 16)
+    this->bucket_count_ = name_count / 2;
+  else
+    this->bucket_count_ = name_count > 0 ? name_count : 1;
+
+  // Sort the names by bucket, and within a bucket by hash code,
+  // keeping the order in which the names were added otherwise.
+  const unsigned int bucket_count = this->bucket_count_;
+  std::vector<unsigned int> bucket_starts(bucket_count + 1, 0);
+  for (size_t i = 0; i < name_count; ++i)
+    ++bucket_starts[this->names_[i]->hash % bucket_count + 1];
+  for (unsigned int b = 0; b < bucket_count; ++b)
+    bucket_starts[b + 1] += bucket_starts[b];
+  this->sorted_names_.resize(name_count);
+  std::vector<unsigned int> next(bucket_starts.begin(), bucket_starts.end());
+  for (size_t i = 0; i < name_count; ++i)
+    this->sorted_names_[next[this->names_[i]->hash % bucket_count]++] = i;
+  for (unsigned int b = 0; b < bucket_count; ++b)
+    {
+      std::vector<unsigned int>::iterator first =
+	this->sorted_names_.begin() + bucket_starts[b];
+      std::vector<unsigned int>::iterator last =
+	this->sorted_names_.begin() + bucket_starts[b + 1];
+      for (std::vector<unsigned int>::iterator p = first; p != last; ++p)
+	{
+	  // Buckets are small, so use an insertion sort.
+	  unsigned int index = *p;
+	  uint32_t hash = this->names_[index]->hash;
+	  std::vector<unsigned int>::iterator q = p;
+	  for (; q != first && this->names_[*(q - 1)]->hash > hash; --q)
+	    *q = *(q - 1);
+	  *q = index;
+	}
+    }
+
+  // Assign the abbreviation codes in order of tag.  Each abbreviation
+  // has the code, the tag, DW_IDX_compile_unit if there is more than
+  // one CU, DW_IDX_die_offset, and a terminating pair of zeroes.
+  bool need_cu_index = this->comp_units_.size() > 1;
+  unsigned int code = 0;
+  this->abbrev_table_size_ = 1;
+  for (std::map<unsigned int, unsigned int>::iterator p =
+	 this->abbrev_codes_.begin();
+       p != this->abbrev_codes_.end();
+       ++p)
+    {
+      p->second = ++code;
+      this->abbrev_table_size_ += (get_length_as_unsigned_LEB_128(code)
+				   + get_length_as_unsigned_LEB_128(p->first)
+				   + (need_cu_index ? 2 : 0)
+				   + 2 + 2);
+    }
+
+  // Compute the sizes of the entries in parallel, then turn them into
+  // offsets in sorted order.
+  Entry_size_jobs size_jobs(this);
+  size_jobs.run((name_count + debug_names_job_size - 1) / debug_names_job_size,
+		Parallel_jobs::default_thread_count());
+  off_t entry_offset = 0;
+  for (size_t i = 0; i < name_count; ++i)
+    {
+      Name* name = this->names_[this->sorted_names_[i]];
+      off_t size = name->entry_offset;
+      name->entry_offset = entry_offset;
+      entry_offset += size;
+    }
+  this->entry_pool_size_ = entry_offset;
+
+  section_size_type data_size = debug_names_hdr_size;
+  data_size += 4 * this->comp_units_.size();
+  data_size += 4 * bucket_count;
+  data_size += 3 * 4 * name_count;
+  data_size += this->abbrev_table_size_;
+  data_size += this->entry_pool_size_;
+  this->set_data_size(data_size);
+}
+
+// Write the data to the file.
+
+void
+Debug_names::do_write(Output_file* of)
+{
+  const off_t off = this->offset();
+  const off_t oview_size = this->data_size();
+  unsigned char* const oview = of->get_output_view(off, oview_size);
+  this->do_write_to_buffer(oview);
+  of->write_output_view(off, oview_size, oview);
+}
+
+// Write the data to a buffer.  This is used when the section is
+// compressed.
+
+void
+Debug_names::do_write_to_buffer(unsigned char* buffer)
+{
+  if (parameters->target().is_big_endian())
+    this->do_sized_write<true>(buffer);
+  else
+    this->do_sized_write<false>(buffer);
+}
+
+template<bool big_endian>
+void
+Debug_names::do_sized_write(unsigned char* oview)
+{
+  const off_t oview_size = this->data_size();
+  unsigned char* pov = oview;
+
+  // The offset of our strings in the .debug_str section.  We can not
+  // use the address of the string data, because the .debug_str
+  // section may be compressed.
+  off_t string_base = this->string_data_->output_section()
+    ->output_section_data_offset(this->string_data_);
+  uint64_t max_offset = string_base + this->string_data_->data_size();
+  if (!this->comp_units_.empty()
+      && static_cast<uint64_t>(this->comp_units_.back()) > max_offset)
+    max_offset = this->comp_units_.back();
+  if (max_offset > 0xffffffffU || oview_size > 0xffffffffU)
+    gold_error(_(".debug_names: offsets do not fit in 32-bit DWARF"));
+
+  // Write the header.
+  elfcpp::Swap<32, big_endian>::writeval(pov, oview_size - 4);
+  pov += 4;
+  // Version and padding.
+  elfcpp::Swap<16, big_endian>::writeval(pov, 5);
+  elfcpp::Swap<16, big_endian>::writeval(pov + 2, 0);
+  pov += 4;
+  // Counts of CUs, local TUs, and foreign TUs.
+  elfcpp::Swap<32, big_endian>::writeval(pov, this->comp_units_.size());
+  elfcpp::Swap<32, big_endian>::writeval(pov + 4, 0);
+  elfcpp::Swap<32, big_endian>::writeval(pov + 8, 0);
+  pov += 12;
+  elfcpp::Swap<32, big_endian>::writeval(pov, this->bucket_count_);
+  elfcpp::Swap<32, big_endian>::writeval(pov + 4, this->names_.size());
+  elfcpp::Swap<32, big_endian>::writeval(pov + 8, this->abbrev_table_size_);
+  // The augmentation string is empty.
+  elfcpp::Swap<32, big_endian>::writeval(pov + 12, 0);
+  pov += 16;
+
+  gold_assert(pov - oview == debug_names_hdr_size);
+
+  // Write the CU list.
+  for (size_t i = 0; i < this->comp_units_.size(); ++i)
+    {
+      elfcpp::Swap<32, big_endian>::writeval(pov, this->comp_units_[i]);
+      pov += 4;
+    }
+
+  // Write the buckets.  Each holds the index, starting at 1, of the
+  // first name in the bucket, or zero if the bucket is empty.
+  size_t name_count = this->names_.size();
+  size_t sorted_index = 0;
+  for (unsigned int b = 0; b < this->bucket_count_; ++b)
+    {
+      uint32_t value = 0;
+      if (sorted_index < name_count
+	  && (this->names_[this->sorted_names_[sorted_index]]->hash
+	      % this->bucket_count_) == b)
+	{
+	  value = sorted_index + 1;
+	  while (sorted_index < name_count
+		 && (this->names_[this->sorted_names_[sorted_index]]->hash
+		     % this->bucket_count_) == b)
+	    ++sorted_index;
+	}
+      elfcpp::Swap<32, big_endian>::writeval(pov, value);
+      pov += 4;
+    }
+
+  // The hash codes, string offsets, and entry offsets of the names,
+  // and the entry pool, are written in parallel.
+  unsigned char* hashes = pov;
+  unsigned char* string_offsets = hashes + 4 * name_count;
+  unsigned char* entry_offsets = string_offsets + 4 * name_count;
+  pov = entry_offsets + 4 * name_count;
+
+  // Write the abbreviation table.
+  bool need_cu_index = this->comp_units_.size() > 1;
+  for (std::map<unsigned int, unsigned int>::const_iterator p =
+	 this->abbrev_codes_.begin();
+       p != this->abbrev_codes_.end();
+       ++p)
+    {
+      pov = write_debug_names_uleb(pov, p->second);
+      pov = write_debug_names_uleb(pov, p->first);
+      if (need_cu_index)
+	{
+	  pov = write_debug_names_uleb(pov, elfcpp::DW_IDX_compile_unit);
+	  pov = write_debug_names_uleb(pov, elfcpp::DW_FORM_udata);
+	}
+      pov = write_debug_names_uleb(pov, elfcpp::DW_IDX_die_offset);
+      pov = write_debug_names_uleb(pov, elfcpp::DW_FORM_ref4);
+      *pov++ = 0;
+      *pov++ = 0;
+    }
+  *pov++ = 0;
+
+  gold_assert(pov - entry_offsets
+	      == static_cast<off_t>(4 * name_count + this->abbrev_table_size_));
+
+  Write_entries_jobs write_jobs(this, big_endian, hashes, string_offsets,
+				entry_offsets, pov, string_base);
+  write_jobs.run((name_count + debug_names_job_size - 1)
+		 / debug_names_job_size,
+		 Parallel_jobs::default_thread_count());
+  pov += this->entry_pool_size_;
+
+  gold_assert(pov - oview == oview_size);
+}
+
+// Print usage statistics.
+
+void
+Debug_names::print_stats() const
+{
+  fprintf(stderr, _("%s: debug_names names: %lu\n"),
+	  program_name, static_cast<unsigned long>(this->names_.size()));
+  fprintf(stderr, _("%s: debug_names entries: %lu\n"),
+	  program_name, static_cast<unsigned long>(this->entry_count_));
+  fprintf(stderr, _("%s: debug_names buckets: %u\n"),
+	  program_name, this->bucket_count_);
+}
+
 } // End namespace gold.
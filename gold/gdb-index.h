@@ -21,6 +21,7 @@
 // MA 02110-1301, USA.
 
 #include <sys/types.h>
+#include <map>
 #include <vector>
 
 #include "gold.h"
@@ -43,20 +44,26 @@ class Dwarf_range_list;
 template <typename T>
 class Gdb_hashtab;
 class Gdb_index_info_reader;
-class Dwarf_pubnames_table;
+class Gdb_index_scan;
+class Gdb_index_pubtables;
+class Gdb_index;
+class Debug_names;
+class Output_data_strtab;
+class Task;
 
-// This class manages the .gdb_index section, which is a fast
-// lookup table for DWARF information used by the gdb debugger.
-// The format of this section is described in gdb/doc/gdb.texinfo.
+// This class scans the .debug_info and .debug_types input sections
+// for the .gdb_index and .debug_names sections.  Either may be NULL.
 
-class Gdb_index : public Output_section_data
+class Debug_index_scanner
 {
  public:
-  Gdb_index(Output_section* gdb_index_section);
+  Debug_index_scanner(Gdb_index* gdb_index, Debug_names* debug_names);
 
-  ~Gdb_index();
+  ~Debug_index_scanner();
 
-  // Scan a .debug_info or .debug_types input section.
+  // Scan a .debug_info or .debug_types input section.  When using
+  // threads, this only records the section, and the scan is done by
+  // scan_deferred_debug_info.
   void scan_debug_info(bool is_type_unit,
 		       Relobj* object,
 		       const unsigned char* symbols,
@@ -65,6 +72,37 @@ class Gdb_index : public Output_section_data
 		       unsigned int reloc_shndx,
 		       unsigned int reloc_type);
 
+  // Scan the input sections recorded by scan_debug_info.  TASK is
+  // the task which is running.
+  void
+  scan_deferred_debug_info(const Task* task);
+
+ private:
+  // The .gdb_index section data, or NULL.
+  Gdb_index* gdb_index_;
+  // The .debug_names section data, or NULL.
+  Debug_names* debug_names_;
+  // The state of the pubnames and pubtypes sections, for scans which
+  // are not deferred.
+  Gdb_index_pubtables* pubtables_;
+  // The input sections whose scans are deferred, in order.
+  std::vector<Gdb_index_scan*> deferred_scans_;
+  // Copies of the symbols of the objects with deferred scans, shared
+  // by all the sections of each object.
+  std::map<const Relobj*, unsigned char*> symbol_copies_;
+};
+
+// This class manages the .gdb_index section, which is a fast
+// lookup table for DWARF information used by the gdb debugger.
+// The format of this section is described in gdb/doc/gdb.texinfo.
+
+class Gdb_index : public Output_section_data
+{
+ public:
+  Gdb_index(Output_section* gdb_index_section);
+
+  ~Gdb_index();
+
   // Add a compilation unit.
   int
   add_comp_unit(off_t cu_offset, off_t cu_length)
@@ -89,40 +127,13 @@ class Gdb_index : public Output_section_data
     this->ranges_.push_back(Per_cu_range_list(object, cu_index, ranges));
   }
 
-  // Add a symbol.  FLAGS are the gdb_index version 7 flags to be stored in
-  // the high-byte of the cu_index field.
+  // Add a symbol of length LEN.  HASH is the hash code for the
+  // symbol in the index, and STRINGPOOL_HASH is the hash code for the
+  // string pool.  FLAGS are the gdb_index version 7 flags to be
+  // stored in the high-byte of the cu_index field.
   void
-  add_symbol(int cu_index, const char* sym_name, uint8_t flags);
-
-  // Return the offset into the pubnames table for the cu at the given
-  // offset.
-  off_t
-  find_pubname_offset(off_t cu_offset);
-
-  // Return the offset into the pubtypes table for the cu at the
-  // given offset.
-  off_t
-  find_pubtype_offset(off_t cu_offset);
-
-  // Return TRUE if we have already processed the pubnames and types
-  // set for OBJECT of the CUs and TUS associated with the statement
-  // list at OFFSET.
-  bool
-  pubnames_read(const Relobj* object, off_t offset);
-
-  // Record that we have already read the pubnames associated with
-  // OBJECT and OFFSET.
-  void
-  set_pubnames_read(const Relobj* object, off_t offset);
-
-  // Return a pointer to the given table.
-  Dwarf_pubnames_table*
-  pubnames_table()
-  { return pubnames_table_; }
-
-  Dwarf_pubnames_table*
-  pubtypes_table()
-  { return pubtypes_table_; }
+  add_symbol(int cu_index, const char* sym_name, size_t len,
+	     unsigned int hash, size_t stringpool_hash, uint8_t flags);
 
   // Print usage statistics.
   static void
@@ -148,21 +159,6 @@ class Gdb_index : public Output_section_data
   do_print_to_mapfile(Mapfile* mapfile) const
   { mapfile->print_output_data(this, _("** gdb_index")); }
 
-  // Create a map from dies to pubnames.
-  Dwarf_pubnames_table*
-  map_pubtable_to_dies(unsigned int attr,
-                       Gdb_index_info_reader* dwinfo,
-                       Relobj* object,
-                       const unsigned char* symbols,
-                       off_t symbols_size);
-
-  // Wrapper for map_pubtable_to_dies
-  void
-  map_pubnames_and_types_to_dies(Gdb_index_info_reader* dwinfo,
-                                 Relobj* object,
-                                 const unsigned char* symbols,
-                                 off_t symbols_size);
-
  private:
   // An entry in the compilation unit list.
   struct Comp_unit
@@ -216,21 +212,6 @@ class Gdb_index : public Output_section_data
 
   typedef std::vector<std::pair<int, uint8_t> > Cu_vector;
 
-  typedef Unordered_map<off_t, off_t> Pubname_offset_map;
-  Pubname_offset_map cu_pubname_map_;
-  Pubname_offset_map cu_pubtype_map_;
-
-  // Scan the given pubtable and build a map of the various dies it
-  // refers to, so we can process the entries when we encounter the
-  // die.
-  void
-  map_pubtable_to_dies(Dwarf_pubnames_table* table,
-                       Pubname_offset_map* map);
-
-  // Tables to store the pubnames section of the current object.
-  Dwarf_pubnames_table* pubnames_table_;
-  Dwarf_pubnames_table* pubtypes_table_;
-
   // The .gdb_index section.
   Output_section* gdb_index_section_;
   // The list of DWARF compilation units.
@@ -253,10 +234,132 @@ class Gdb_index : public Output_section_data
   off_t symtab_offset_;
   off_t cu_pool_offset_;
   off_t stringpool_offset_;
-  // Object, stmt list offset of the CUs and TUs associated with the
-  // last read pubnames and pubtypes sections.
-  const Relobj* pubnames_object_;
-  off_t stmt_list_offset_;
+};
+
+// This class manages the DWARF 5 .debug_names section, a name lookup
+// table which consumers other than gdb can use.  The names are
+// written to an extra string table at the end of the .debug_str
+// section.  Type units in .debug_types sections are not indexed.
+
+class Debug_names : public Output_section_data
+{
+ public:
+  Debug_names();
+
+  ~Debug_names();
+
+  // Return the string table data to add to the .debug_str section.
+  Output_data_strtab*
+  string_data()
+  { return this->string_data_; }
+
+  // Add a compilation unit.
+  int
+  add_comp_unit(off_t cu_offset)
+  {
+    this->comp_units_.push_back(cu_offset);
+    return this->comp_units_.size() - 1;
+  }
+
+  // Add a name of length LEN for the DIE at DIE_OFFSET in the CU
+  // CU_INDEX, with tag TAG.  HASH is the hash code for the name in the
+  // index, and STRINGPOOL_HASH is the hash code for the string pool.
+  void
+  add_name(int cu_index, const char* name, size_t len, uint32_t hash,
+	   size_t stringpool_hash, off_t die_offset, unsigned int tag);
+
+  // Print usage statistics.
+  void
+  print_stats() const;
+
+ protected:
+  // This is called to update the section size prior to assigning
+  // the address and file offset.
+  void
+  update_data_size()
+  { this->set_final_data_size(); }
+
+  // Set the final data size.
+  void
+  set_final_data_size();
+
+  // Write the data to the file.
+  void
+  do_write(Output_file*);
+
+  // Write the data to a buffer, for a compressed section.
+  void
+  do_write_to_buffer(unsigned char* buffer);
+
+  // Write to a map file.
+  void
+  do_print_to_mapfile(Mapfile* mapfile) const
+  { mapfile->print_output_data(this, _("** debug_names")); }
+
+ private:
+  // An entry for a name: a DIE in a compilation unit.
+  struct Name_entry
+  {
+    Name_entry(int cu, off_t offset, unsigned int t)
+      : cu_index(cu), die_offset(offset), tag(t)
+    { }
+    int cu_index;
+    off_t die_offset;
+    unsigned int tag;
+  };
+
+  // A name in the index.
+  struct Name
+  {
+    Stringpool::Key name_key;
+    uint32_t hash;
+    // The entries, in the order in which they were added.
+    std::vector<Name_entry> entries;
+    // The offset of the entries in the entry pool.
+    off_t entry_offset;
+  };
+
+  typedef Unordered_map<Stringpool::Key, unsigned int> Name_map;
+
+  class Entry_size_jobs;
+  class Write_entries_jobs;
+
+  // Return the size of the entries for NAME in the entry pool.
+  size_t
+  entries_size(const Name& name) const;
+
+  // Write the entries for NAME to POV.
+  template<bool big_endian>
+  void
+  write_entries(const Name& name, unsigned char* pov) const;
+
+  // Write the section to OVIEW.
+  template<bool big_endian>
+  void
+  do_sized_write(unsigned char* oview);
+
+  // The list of compilation unit offsets in .debug_info.
+  std::vector<off_t> comp_units_;
+  // The names, in the order in which they were first added.
+  std::vector<Name*> names_;
+  // Map from a string pool key to an index in NAMES_.
+  Name_map name_map_;
+  // The tags used by the entries, in increasing order.
+  std::map<unsigned int, unsigned int> abbrev_codes_;
+  // The names to write, sorted by hash bucket.
+  std::vector<unsigned int> sorted_names_;
+  // The number of hash buckets.
+  unsigned int bucket_count_;
+  // The size of the abbreviation table.
+  size_t abbrev_table_size_;
+  // The size of the entry pool.
+  off_t entry_pool_size_;
+  // The number of entries.
+  size_t entry_count_;
+  // The strings, written at the end of .debug_str.
+  Stringpool stringpool_;
+  // The data for STRINGPOOL_.
+  Output_data_strtab* string_data_;
 };
 
 } // End namespace gold.
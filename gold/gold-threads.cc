@@ -23,6 +23,8 @@
 #include "gold.h"
 
 #include <cstring>
+#include <vector>
+#include <unistd.h>
 
 #ifdef ENABLE_THREADS
 #include <pthread.h>
@@ -31,6 +33,7 @@
 #include "options.h"
 #include "parameters.h"
 #include "gold-threads.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -447,4 +450,245 @@ Initialize_lock::do_run_once(void*)
   *this->pplock_ = new Lock();
 }
 
+// Class Parallel_jobs.
+
+#ifdef ENABLE_THREADS
+
+// The state of a run of Parallel_jobs, shared by the calling thread
+// and the threads which help it.  A helper Task may not start until
+// the jobs are done and Parallel_jobs::run has returned, so this is
+// reference counted, and it forgets the jobs when run returns.
+
+class Parallel_jobs_state
+{
+ public:
+  Parallel_jobs_state(Parallel_jobs* jobs, size_t count, int refs)
+    : lock_(), condvar_(this->lock_), jobs_(jobs), next_job_(0),
+      job_count_(count), running_(0), refs_(refs)
+  { }
+
+  // Take jobs and run them until there are none left.
+  void
+  run_jobs();
+
+  // Wait for the jobs which other threads are running, and forget
+  // the jobs.  This is called by Parallel_jobs::run.
+  void
+  finish();
+
+  // Drop a reference, and delete this if it was the last one.
+  void
+  release();
+
+ private:
+  // Controls access to the fields below.
+  Lock lock_;
+  // Signalled when the last running job completes.
+  Condvar condvar_;
+  // The jobs, or NULL once Parallel_jobs::run has returned.
+  Parallel_jobs* jobs_;
+  // The next job to run.
+  size_t next_job_;
+  // The number of jobs.
+  size_t job_count_;
+  // The number of jobs which are running.
+  int running_;
+  // The number of references to this.
+  int refs_;
+};
+
+void
+Parallel_jobs_state::run_jobs()
+{
+  while (true)
+    {
+      Parallel_jobs* jobs;
+      size_t i;
+      {
+	Hold_lock hl(this->lock_);
+	if (this->jobs_ == NULL || this->next_job_ >= this->job_count_)
+	  return;
+	jobs = this->jobs_;
+	i = this->next_job_++;
+	++this->running_;
+      }
+
+      jobs->do_job(i);
+
+      {
+	Hold_lock hl(this->lock_);
+	--this->running_;
+	if (this->running_ == 0)
+	  this->condvar_.broadcast();
+      }
+    }
+}
+
+void
+Parallel_jobs_state::finish()
+{
+  {
+    Hold_lock hl(this->lock_);
+    while (this->running_ > 0)
+      this->condvar_.wait();
+    this->jobs_ = NULL;
+  }
+  this->release();
+}
+
+void
+Parallel_jobs_state::release()
+{
+  bool last;
+  {
+    Hold_lock hl(this->lock_);
+    gold_assert(this->refs_ > 0);
+    --this->refs_;
+    last = this->refs_ == 0;
+  }
+  if (last)
+    delete this;
+}
+
+// A Task which helps to run Parallel_jobs on a Workqueue thread.
+
+class Parallel_jobs_task : public Task
+{
+ public:
+  Parallel_jobs_task(Parallel_jobs_state* state)
+    : state_(state)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*)
+  {
+    this->state_->run_jobs();
+    this->state_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Parallel_jobs_task"; }
+
+ private:
+  Parallel_jobs_state* state_;
+};
+
+// A routine passed to pthread_create which runs jobs.  This is only
+// used when there is no Workqueue.
+
+extern "C"
+{
+
+static void*
+c_run_parallel_jobs(void* arg)
+{
+  Parallel_jobs_state* state = reinterpret_cast<Parallel_jobs_state*>(arg);
+  state->run_jobs();
+  state->release();
+  return NULL;
+}
+
+}
+
+#endif // defined(ENABLE_THREADS)
+
+// Run the jobs.
+
+void
+Parallel_jobs::run(size_t count, int thread_count)
+{
+  if (static_cast<size_t>(thread_count) > count)
+    thread_count = count;
+
+#ifdef ENABLE_THREADS
+  Workqueue* workqueue = Parallel_jobs::workqueue;
+
+  // The jobs run on the threads of the Workqueue, so there is no
+  // point in asking for more.
+  if (workqueue != NULL && thread_count > workqueue->thread_count())
+    thread_count = workqueue->thread_count();
+
+  if (thread_count > 1 && parameters->options().threads())
+    {
+      // There is a reference for this thread and for each helper.
+      Parallel_jobs_state* state = new Parallel_jobs_state(this, count,
+							   thread_count);
+
+      std::vector<pthread_t> threads;
+      for (int i = 1; i < thread_count; ++i)
+	{
+	  if (workqueue != NULL)
+	    {
+	      workqueue->queue_soon(new Parallel_jobs_task(state));
+	      continue;
+	    }
+
+	  pthread_t tid;
+	  int err = pthread_create(&tid, NULL, c_run_parallel_jobs,
+				   reinterpret_cast<void*>(state));
+	  if (err != 0)
+	    {
+	      // We can still run the jobs in the threads we have.
+	      gold_warning(_("pthread_create failed: %s"), strerror(err));
+	      for (; i < thread_count; ++i)
+		state->release();
+	      break;
+	    }
+	  threads.push_back(tid);
+	}
+
+      state->run_jobs();
+
+      for (std::vector<pthread_t>::const_iterator p = threads.begin();
+	   p != threads.end();
+	   ++p)
+	{
+	  int err = pthread_join(*p, NULL);
+	  if (err != 0)
+	    gold_fatal(_("pthread_join failed: %s"), strerror(err));
+	}
+
+      // Helper Tasks which have not started yet will find that there
+      // is nothing left to do.
+      state->finish();
+      return;
+    }
+#endif // defined(ENABLE_THREADS)
+
+  for (size_t i = 0; i < count; ++i)
+    this->do_job(i);
+}
+
+// The Workqueue whose threads run the jobs.
+
+Workqueue* Parallel_jobs::workqueue;
+
+// Return the default number of threads.
+
+int
+Parallel_jobs::default_thread_count()
+{
+  if (!parameters->options().threads())
+    return 1;
+  if (Parallel_jobs::workqueue != NULL)
+    return Parallel_jobs::workqueue->thread_count();
+  if (parameters->options().thread_count() > 0)
+    return parameters->options().thread_count();
+#ifdef _SC_NPROCESSORS_ONLN
+  long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+  if (nprocs > 0)
+    return nprocs;
+#endif
+  return 1;
+}
+
 } // End namespace gold.
@@ -37,6 +37,8 @@ namespace gold
 class Condvar;
 class Once_initialize;
 class Initialize_lock_once;
+class Workqueue;
+class Parallel_jobs_state;
 
 // The interface for the implementation of a Lock.
 
@@ -262,6 +264,64 @@ class Initialize_lock : public Once
   Lock** const pplock_;
 };
 
+// A set of independent jobs, numbered from zero, which may be run in
+// parallel.  This is for work within a single Task which is easily
+// split up, such as sorting many separate lists, when queuing
+// separate Tasks on the Workqueue would require restructuring the
+// caller.  The calling thread runs jobs too, so this works when
+// threads are not in use.  The other jobs are run by helper Tasks on
+// the threads of the Workqueue, so they share its thread count and
+// show up in --trace-tasks.  A child class implements do_job.  Jobs
+// must not depend on the order in which they are run.
+
+class Parallel_jobs
+{
+ public:
+  Parallel_jobs()
+  { }
+
+  virtual
+  ~Parallel_jobs()
+  { }
+
+  // Run jobs 0 through COUNT - 1, using up to THREAD_COUNT threads,
+  // including the calling thread.  This returns when all the jobs
+  // have completed.
+  void
+  run(size_t count, int thread_count);
+
+  // Return the number of threads to use by default: 1 if we are not
+  // using threads, otherwise the number of threads which the
+  // Workqueue is using in the current phase of the link.  Without a
+  // Workqueue, as in dwp, this is the --thread-count option if it was
+  // given, otherwise the number of processors.
+  static int
+  default_thread_count();
+
+  // Set the Workqueue whose threads run the jobs.  This is set when
+  // the Workqueue is created, before any threads are started, and
+  // cleared when it is destroyed.
+  static void
+  set_workqueue(Workqueue* workqueue)
+  { Parallel_jobs::workqueue = workqueue; }
+
+ protected:
+  // Run job I.  This must be implemented by the child class.
+  virtual void
+  do_job(size_t i) = 0;
+
+ private:
+  // This class can not be copied.
+  Parallel_jobs(const Parallel_jobs&);
+  Parallel_jobs& operator=(const Parallel_jobs&);
+
+  friend class Parallel_jobs_state;
+
+  // The Workqueue whose threads run the jobs, or NULL if there is
+  // none.
+  static Workqueue* workqueue;
+};
+
 } // End namespace gold.
 
 #endif // !defined(GOLD_THREADS_H)
@@ -45,6 +45,8 @@
 #include "gc.h"
 #include "icf.h"
 #include "incremental.h"
+#include "link-cache.h"
+#include "call-graph.h"
 #include "timer.h"
 
 namespace gold
@@ -102,6 +104,87 @@ do_gold_unreachable(const char* filename, int lineno, const char* function)
   gold_exit(GOLD_ERR);
 }
 
+// Return the length of the valid UTF-8 sequence which starts at P
+// and ends before END, or 0 if there is none.
+
+static size_t
+utf8_sequence_length(const unsigned char* p, const unsigned char* end)
+{
+  // Only the first continuation byte may have a narrower range: this
+  // rejects overlong forms, surrogates, and codes past U+10FFFF.
+  unsigned char c = p[0];
+  unsigned char min = 0x80;
+  unsigned char max = 0xbf;
+  size_t len;
+  if (c >= 0xc2 && c <= 0xdf)
+    len = 2;
+  else if (c >= 0xe0 && c <= 0xef)
+    {
+      len = 3;
+      if (c == 0xe0)
+	min = 0xa0;
+      else if (c == 0xed)
+	max = 0x9f;
+    }
+  else if (c >= 0xf0 && c <= 0xf4)
+    {
+      len = 4;
+      if (c == 0xf0)
+	min = 0x90;
+      else if (c == 0xf4)
+	max = 0x8f;
+    }
+  else
+    return 0;
+
+  if (static_cast<size_t>(end - p) < len || p[1] < min || p[1] > max)
+    return 0;
+  for (size_t i = 2; i < len; ++i)
+    if (p[i] < 0x80 || p[i] > 0xbf)
+      return 0;
+  return len;
+}
+
+// Write the LEN bytes at STR to F as a JSON string.  Names in input
+// files need not be UTF-8, but JSON text must be, so a byte which is
+// not part of a valid UTF-8 sequence is written as an escaped
+// character with the same code.
+
+void
+write_json_string(FILE* f, const char* str, size_t len)
+{
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(str);
+  const unsigned char* end = p + len;
+  putc('"', f);
+  while (p < end)
+    {
+      unsigned char c = *p;
+      size_t n = 1;
+      if (c == '"' || c == '\\')
+	{
+	  putc('\\', f);
+	  putc(c, f);
+	}
+      else if (c < 0x20)
+	fprintf(f, "\\u%04x", c);
+      else if (c < 0x80)
+	putc(c, f);
+      else
+	{
+	  n = utf8_sequence_length(p, end);
+	  if (n == 0)
+	    {
+	      fprintf(f, "\\u%04x", c);
+	      n = 1;
+	    }
+	  else
+	    fwrite(p, 1, n, f);
+	}
+      p += n;
+    }
+  putc('"', f);
+}
+
 // This class arranges to run the functions done in the middle of the
 // link.  It is just a closure.
 
@@ -452,8 +535,8 @@ queue_middle_gc_tasks(const General_options& options,
     {
       Task_token* next_blocker = new Task_token(true);
       next_blocker->add_blocker();
-      workqueue->queue(new Read_relocs(symtab, layout, *p, this_blocker,
-				       next_blocker));
+      workqueue->queue(new Read_relocs(symtab, layout, *p, NULL, NULL,
+				       this_blocker, next_blocker));
       this_blocker = next_blocker;
     }
 
@@ -492,6 +575,14 @@ queue_middle_tasks(const General_options& options,
   if (timer != NULL)
     timer->stamp(0);
 
+  // Set the thread count for the middle phase now, since garbage
+  // collection and identical code folding below run jobs on the
+  // workqueue threads.
+  int thread_count = options.thread_count_middle();
+  if (thread_count == 0)
+    thread_count = std::max(2, input_objects->number_of_input_objects());
+  workqueue->set_thread_count(thread_count);
+
   // We have to support the case of not seeing any input objects, and
   // generate an empty file.  Existing builds depend on being able to
   // pass an empty archive to the linker and get an empty object file
@@ -500,6 +591,13 @@ queue_middle_tasks(const General_options& options,
       && layout->incremental_base() == NULL)
     parameters_force_valid_target();
 
+  // All the input files have been read.  If the link cache has an
+  // output for them, it copies it to the output file, and we are done.
+  Link_cache* link_cache = layout->link_cache();
+  if (link_cache != NULL
+      && link_cache->lookup(parameters->options().output_file_name()))
+    return;
+
   // Add any symbols named with -u options to the symbol table.
   symtab->add_undefined_symbols_from_command_line(layout);
 
@@ -522,7 +620,7 @@ queue_middle_tasks(const General_options& options,
       symtab->gc_mark_undef_symbols(layout);
       gold_assert(symtab->gc() != NULL);
       // Do a transitive closure on all references to determine the worklist.
-      symtab->gc()->do_transitive_closure();
+      symtab->gc()->do_transitive_closure(input_objects);
     }
 
   // If identical code folding (--icf) is chosen it makes sense to do it
@@ -530,7 +628,7 @@ queue_middle_tasks(const General_options& options,
   // be folding sections that will be garbage.
   if (parameters->options().icf_enabled())
     {
-      symtab->icf()->find_identical_sections(input_objects, symtab);
+      symtab->icf()->find_identical_sections(task, input_objects, symtab);
     }
 
   // Call Object::layout for the second time to determine the
@@ -560,13 +658,27 @@ queue_middle_tasks(const General_options& options,
       plugins->layout_deferred_objects();
     }
 
+  // Read the merged strings which were not read during layout.
+  layout->add_deferred_merge_strings(task);
+
+  // Scan the debug info for the .gdb_index section which was not
+  // scanned during layout.
+  layout->scan_deferred_gdb_index(task);
+
   // Finalize the .eh_frame section.
   layout->finalize_eh_frame_section();
 
-  /* If plugins have specified a section order, re-arrange input sections
-     according to a specified section order.  If --section-ordering-file is
-     also specified, do not do anything here.  */
-  if (parameters->options().has_plugins()
+  // If --call-graph-ordering-file was used, compute the order of the
+  // sections named in the call graph.
+  if (layout->call_graph() != NULL)
+    layout->call_graph()->order_sections(task, symtab,
+					 layout->get_section_order_map());
+
+  /* If plugins or the call graph have specified a section order,
+     re-arrange input sections according to a specified section order.
+     If --section-ordering-file is also specified, do not do anything
+     here.  */
+  if ((parameters->options().has_plugins() || layout->call_graph() != NULL)
       && layout->is_section_ordering_specified()
       && !parameters->options().section_ordering_file ())
     {
@@ -597,11 +709,6 @@ queue_middle_tasks(const General_options& options,
 	}
     }
 
-  int thread_count = options.thread_count_middle();
-  if (thread_count == 0)
-    thread_count = std::max(2, input_objects->number_of_input_objects());
-  workqueue->set_thread_count(thread_count);
-
   // Now we have seen all the input files.
   const bool doing_static_link =
     (!input_objects->any_dynamic()
@@ -710,6 +817,23 @@ queue_middle_tasks(const General_options& options,
 						 this_blocker));
     }
 
+  // The relocations of each object are first prescanned in parallel,
+  // after the common symbols are allocated, and then scanned in order.
+  // SCAN_BLOCKER keeps the first Scan_relocs task from running until
+  // all the Prescan_relocs tasks are done.  The Prescan_relocs tasks
+  // share COMMONS_BLOCKER, and the first Scan_relocs task deletes it.
+  // If there are no relocatable objects, it blocks the layout task
+  // instead, which deletes it.
+  Task_token* commons_blocker = this_blocker;
+  Task_token* scan_blocker = NULL;
+  if (input_objects->number_of_relobjs() > 0)
+    {
+      scan_blocker = new Task_token(true);
+      for (int i = 0; i < input_objects->number_of_relobjs(); ++i)
+	scan_blocker->add_blocker();
+      this_blocker = scan_blocker;
+    }
+
   // If doing garbage collection, the relocations have already been read.
   // Otherwise, read and scan the relocations.
   if (parameters->options().gc_sections()
@@ -721,9 +845,10 @@ queue_middle_tasks(const General_options& options,
 	{
 	  Task_token* next_blocker = new Task_token(true);
 	  next_blocker->add_blocker();
-	  workqueue->queue(new Scan_relocs(symtab, layout, *p,
-					   (*p)->get_relocs_data(),
-					   this_blocker, next_blocker));
+	  workqueue->queue(new Prescan_relocs(symtab, layout, *p,
+					      (*p)->get_relocs_data(),
+					      commons_blocker, scan_blocker,
+					      this_blocker, next_blocker));
 	  this_blocker = next_blocker;
 	}
     }
@@ -746,8 +871,9 @@ queue_middle_tasks(const General_options& options,
 	{
 	  Task_token* next_blocker = new Task_token(true);
 	  next_blocker->add_blocker();
-	  workqueue->queue(new Read_relocs(symtab, layout, *p, this_blocker,
-					   next_blocker));
+	  workqueue->queue(new Read_relocs(symtab, layout, *p,
+					   commons_blocker, scan_blocker,
+					   this_blocker, next_blocker));
 	  this_blocker = next_blocker;
 	}
     }
@@ -823,8 +949,8 @@ queue_final_tasks(const General_options& options,
 
   // Use a blocker to block the final cleanup task.
   Task_token* final_blocker = new Task_token(true);
-  // Write_symbols_task, Write_sections_task, Write_data_task,
-  // Relocate_tasks.
+  // The task which finishes writing the global symbols,
+  // Write_sections_task, Write_data_task, Relocate_tasks.
   final_blocker->add_blockers(3);
   final_blocker->add_blockers(input_objects->number_of_relobjs());
   if (!any_postprocessing_sections)
@@ -868,7 +994,7 @@ queue_final_tasks(const General_options& options,
 						    final_blocker);
       workqueue->queue(t);
     }
-  else
+  else if (layout->compress_task_count() == 0)
     {
       Task_token* new_final_blocker = new Task_token(true);
       new_final_blocker->add_blocker();
@@ -878,9 +1004,21 @@ queue_final_tasks(const General_options& options,
       workqueue->queue(t);
       final_blocker = new_final_blocker;
     }
+  else
+    {
+      // Compress the sections in parallel before writing them out.
+      Task_token* new_final_blocker = new Task_token(true);
+      new_final_blocker->add_blocker();
+      workqueue->queue(new Task_function(
+	  new Compress_sections_task_runner(layout, of, new_final_blocker),
+	  final_blocker,
+	  "Task_function Compress_sections_task_runner"));
+      final_blocker = new_final_blocker;
+    }
 
   // Create tasks for tree-style build ID computation, if necessary.
-  if (strcmp(options.build_id(), "tree") == 0)
+  if (strcmp(options.build_id(), "tree") == 0
+      || strcmp(options.build_id(), "fast") == 0)
     {
       // Queue a task to compute the build id.  This will be blocked by
       // FINAL_BLOCKER, and will in turn schedule the task to close
@@ -27,8 +27,10 @@
 #include "ansidecl.h"
 
 #include <cstddef>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <string>
 #include <stdint.h>
 #include <sys/types.h>
 
@@ -179,6 +181,10 @@ extern void do_gold_unreachable(const char*, int, const char*)
 extern void
 print_version(bool print_short);
 
+// Write the LEN bytes at STR to F as a JSON string.
+extern void
+write_json_string(FILE* f, const char* str, size_t len);
+
 // Get the version string.
 extern const char*
 get_version_string();
@@ -139,10 +139,16 @@
 // applications.  Up to 6 %  text size reductions.
 
 #include "gold.h"
+
+#include <cstring>
+
 #include "object.h"
 #include "gc.h"
 #include "icf.h"
 #include "symtab.h"
+#include "fileread.h"
+#include "gold-threads.h"
+#include "timer.h"
 #include "libiberty.h"
 #include "demangle.h"
 #include "elfcpp.h"
@@ -151,56 +157,91 @@
 namespace gold
 {
 
+// A reloc to a section that might be folded.  These are the only
+// parts of a section's contents which change from one iteration to
+// the next, so we record them in the first iteration.
+
+struct Icf_tracked_reloc
+{
+  // The unique section number of the section the reloc refers to.
+  unsigned int secn_id;
+  // The symbol value and the addend.
+  long long symvalue;
+  long long addend;
+  // The offset of the reloc.
+  uint64_t offset;
+
+  Icf_tracked_reloc(unsigned int secn_ida, long long symvaluea,
+		    long long addenda, uint64_t offseta)
+    : secn_id(secn_ida), symvalue(symvaluea), addend(addenda),
+      offset(offseta)
+  { }
+};
+
+typedef std::vector<Icf_tracked_reloc> Icf_tracked_relocs;
+
+// Information about each section which is a candidate for folding,
+// indexed by the unique section number, which is kept from one
+// iteration to the next.
+
+struct Icf_section_data
+{
+  // Whether a section or a group of identical sections is already
+  // known to be unique.
+  std::vector<bool> is_secn_or_group_unique;
+  // The checksum of the section's text, and then of SECTION_CONTENTS.
+  std::vector<uint32_t> cksums;
+  // The section's text and relocs to non-ICF sections.
+  std::vector<std::string> section_contents;
+  // The relocs to ICF sections.
+  std::vector<Icf_tracked_relocs> tracked_relocs;
+  // Whether the section must be read serially.  This is not a
+  // vector<bool> since it is set by several threads.
+  std::vector<unsigned char> needs_serial;
+
+  Icf_section_data(size_t count)
+    : is_secn_or_group_unique(count, false), cksums(count, 0),
+      section_contents(count), tracked_relocs(count), needs_serial(count, 0)
+  { }
+};
+
+// Format the symbol value, addend and offset of a reloc for the
+// section contents.  ADDEND_STR must be at least 50 bytes.
+
+static void
+format_addend(char* addend_str, size_t size, long long symvalue,
+	      long long addend, uint64_t offset)
+{
+  // It would be nice if we could use format macros in inttypes.h
+  // here but there are not in ISO/IEC C++ 1998.
+  snprintf(addend_str, size, "%llx %llx %llux",
+	   symvalue, addend, static_cast<unsigned long long>(offset));
+}
+
 // This function determines if a section or a group of identical
 // sections has unique contents.  Such unique sections or groups can be
 // declared final and need not be processed any further.
 // Parameters :
-// ID_SECTION : Vector mapping a section index to a Section_id pair.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
+// CKSUMS : The checksum of each section.  In the first iteration this
+//          is computed on the section's text, otherwise on its text and
+//          relocs to sections that cannot be folded.
 
 static void
-preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
-                               std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+preprocess_for_unique_sections(std::vector<bool>* is_secn_or_group_unique,
+                               const std::vector<uint32_t>& cksums)
 {
   Unordered_map<uint32_t, unsigned int> uniq_map;
   std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
     uniq_map_insert;
 
-  for (unsigned int i = 0; i < id_section.size(); i++)
+  for (unsigned int i = 0; i < cksums.size(); i++)
     {
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      uint32_t cksum;
-      Section_id secn = id_section[i];
-      section_size_type plen;
-      if (section_contents == NULL)
-        {
-          // Lock the object so we can read from it.  This is only called
-          // single-threaded from queue_middle_tasks, so it is OK to lock.
-          // Unfortunately we have no way to pass in a Task token.
-          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-          Task_lock_obj<Object> tl(dummy_task, secn.first);
-          const unsigned char* contents;
-          contents = secn.first->section_contents(secn.second,
-                                                  &plen,
-                                                  false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
-        }
-      else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
-      uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
+      uniq_map_insert = uniq_map.insert(std::make_pair(cksums[i], i));
       if (uniq_map_insert.second)
         {
           (*is_secn_or_group_unique)[i] = true;
@@ -252,48 +293,70 @@ get_rel_addend(const unsigned char* reloc_addend_ptr,
     }
 }
 
-// This returns the buffer containing the section's contents, both
-// text and relocs.  Relocs are differentiated as those pointing to
-// sections that could be folded and those that cannot.  Only relocs
-// pointing to sections that could be folded are recomputed on
-// subsequent invocations of this function.
+// Return whether computing the contents of SECN requires reading a
+// merge section from a file other than FILE.
+
+static bool
+needs_other_file(const Section_id& secn, const File_read* file,
+		 Symbol_table* symtab)
+{
+  if (!parameters->target().can_icf_inline_merge_sections())
+    return false;
+
+  Icf::Reloc_info_list& reloc_info_list = symtab->icf()->reloc_info_list();
+  Icf::Reloc_info_list::const_iterator it_reloc_info_list =
+    reloc_info_list.find(secn);
+  if (it_reloc_info_list == reloc_info_list.end())
+    return false;
+
+  const Icf::Sections_reachable_info& v =
+    it_reloc_info_list->second.section_info;
+  for (Icf::Sections_reachable_info::const_iterator it_v = v.begin();
+       it_v != v.end();
+       ++it_v)
+    {
+      if (it_v->first != NULL
+	  && &it_v->first->input_file()->file() != file
+	  && (it_v->first->section_flags(it_v->second)
+	      & elfcpp::SHF_MERGE) != 0)
+	return true;
+    }
+  return false;
+}
+
+// This computes the parts of the section's contents, both text and
+// relocs, which are the same in every iteration.  Relocs are
+// differentiated as those pointing to sections that could be folded
+// and those that cannot.  Relocs pointing to sections that could be
+// folded are recorded so that append_tracked_relocs can add them to
+// the contents in each iteration, using the kept section at that
+// time.  The object must be locked.  This may be called in parallel
+// for sections in different files, as long as the section does not
+// need to read a merge section in another file; see
+// needs_other_file.
 // Parameters  :
-// FIRST_ITERATION    : true if it is the first invocation.
 // SECN               : Section for which contents are desired.
-// SECTION_NUM        : Unique section number of this section.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
-// KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
+// TRACKED_RELOCS     : Set to the relocs to ICF sections.
+// SECTION_CONTENTS   : Set to the section's text and relocs to non-ICF
 //                      sections.
+// CKSUM              : Set to the checksum of SECTION_CONTENTS.
 
-static std::string
-get_section_contents(bool first_iteration,
-                     const Section_id& secn,
-                     unsigned int section_num,
-                     unsigned int* num_tracked_relocs,
+static void
+get_section_contents(const Section_id& secn,
                      Symbol_table* symtab,
-                     const std::vector<unsigned int>& kept_section_id,
-                     std::vector<std::string>* section_contents)
+                     Icf_tracked_relocs* tracked_relocs,
+                     std::string* section_contents,
+                     uint32_t* cksum)
 {
-  // Lock the object so we can read from it.  This is only called
-  // single-threaded from queue_middle_tasks, so it is OK to lock.
-  // Unfortunately we have no way to pass in a Task token.
-  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-  Task_lock_obj<Object> tl(dummy_task, secn.first);
-
   section_size_type plen;
-  const unsigned char* contents = NULL;
-  if (first_iteration)
-    contents = secn.first->section_contents(secn.second, &plen, false);
+  const unsigned char* contents;
+  contents = secn.first->section_contents(secn.second, &plen, false);
 
   // The buffer to hold all the contents including relocs.  A checksum
   // is then computed on this buffer.
   std::string buffer;
-  std::string icf_reloc_buffer;
 
-  if (num_tracked_relocs)
-    *num_tracked_relocs = 0;
+  tracked_relocs->clear();
 
   Icf::Reloc_info_list& reloc_info_list = 
     symtab->icf()->reloc_info_list();
@@ -301,9 +364,6 @@ get_section_contents(bool first_iteration,
   Icf::Reloc_info_list::iterator it_reloc_info_list =
     reloc_info_list.find(secn);
 
-  buffer.clear();
-  icf_reloc_buffer.clear();
-
   // Process relocs and put them into the buffer.
 
   if (it_reloc_info_list != reloc_info_list.end())
@@ -327,8 +387,7 @@ get_section_contents(bool first_iteration,
 
       for (; it_v != v.end(); ++it_v, ++it_s, ++it_a, ++it_o, ++it_addend_size)
         {
-	  if (first_iteration
-	      && it_v->first != NULL)
+	  if (it_v->first != NULL)
 	    {
 	      Symbol_location loc;
 	      loc.object = it_v->first;
@@ -351,28 +410,20 @@ get_section_contents(bool first_iteration,
           // where first is the symbol value and second is the
           // addend.
           char addend_str[50];
-
-	  // It would be nice if we could use format macros in inttypes.h
-	  // here but there are not in ISO/IEC C++ 1998.
-          snprintf(addend_str, sizeof(addend_str), "%llx %llx %llux",
-                   static_cast<long long>((*it_a).first),
-		   static_cast<long long>((*it_a).second),
-		   static_cast<unsigned long long>(*it_o));
+	  format_addend(addend_str, sizeof(addend_str), (*it_a).first,
+			(*it_a).second, *it_o);
 
 	  // If the symbol pointed to by the reloc is not in an ordinary
 	  // section or if the symbol type is not FROM_OBJECT, then the
 	  // object is NULL.
 	  if (it_v->first == NULL)
             {
-	      if (first_iteration)
-                {
-		  // If the symbol name is available, use it.
-                  if ((*it_s) != NULL)
-                      buffer.append((*it_s)->name());
-                  // Append the addend.
-                  buffer.append(addend_str);
-                  buffer.append("@");
-		}
+	      // If the symbol name is available, use it.
+	      if ((*it_s) != NULL)
+		  buffer.append((*it_s)->name());
+	      // Append the addend.
+	      buffer.append(addend_str);
+	      buffer.append("@");
 	      continue;
 	    }
 
@@ -383,12 +434,9 @@ get_section_contents(bool first_iteration,
           if (reloc_secn.first == secn.first
               && reloc_secn.second == secn.second)
             {
-              if (first_iteration)
-                {
-                  buffer.append("R");
-                  buffer.append(addend_str);
-                  buffer.append("@");
-                }
+	      buffer.append("R");
+	      buffer.append(addend_str);
+	      buffer.append("@");
               continue;
             }
           Icf::Uniq_secn_id_map& section_id_map =
@@ -403,30 +451,15 @@ get_section_contents(bool first_iteration,
               && section_id_map_it != section_id_map.end())
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
-
-              char kept_section_str[10];
-              unsigned int secn_id = section_id_map_it->second;
-              snprintf(kept_section_str, sizeof(kept_section_str), "%u",
-                       kept_section_id[secn_id]);
-              if (first_iteration)
-                {
-                  buffer.append("ICF_R");
-                  buffer.append(addend_str);
-                }
-              icf_reloc_buffer.append(kept_section_str);
-              // Append the addend.
-              icf_reloc_buffer.append(addend_str);
-              icf_reloc_buffer.append("@");
+	      tracked_relocs->push_back(
+		  Icf_tracked_reloc(section_id_map_it->second, (*it_a).first,
+				    (*it_a).second, *it_o));
+	      buffer.append("ICF_R");
+	      buffer.append(addend_str);
             }
           else
             {
               // This is a reloc to a section that cannot be folded.
-              // Process it only in the first iteration.
-              if (!first_iteration)
-                continue;
-
               uint64_t secn_flags = (it_v->first)->section_flags(it_v->second);
               // This reloc points to a merge section.  Hash the
               // contents of this section.
@@ -541,23 +574,166 @@ get_section_contents(bool first_iteration,
         }
     }
 
-  if (first_iteration)
+  buffer.append("Contents = ");
+  buffer.append(reinterpret_cast<const char*>(contents), plen);
+  section_contents->swap(buffer);
+  *cksum = xcrc32(reinterpret_cast<const unsigned char*>(
+		      section_contents->c_str()),
+		  section_contents->length(), 0xffffffff);
+}
+
+// Append the relocs to ICF sections to BUFFER, using the kept
+// section that each one currently refers to.
+
+static void
+append_tracked_relocs(const Icf_tracked_relocs& tracked_relocs,
+		      const std::vector<unsigned int>& kept_section_id,
+		      std::string* buffer)
+{
+  for (Icf_tracked_relocs::const_iterator p = tracked_relocs.begin();
+       p != tracked_relocs.end();
+       ++p)
+    {
+      char kept_section_str[10];
+      snprintf(kept_section_str, sizeof(kept_section_str), "%u",
+	       kept_section_id[p->secn_id]);
+      char addend_str[50];
+      format_addend(addend_str, sizeof(addend_str), p->symvalue, p->addend,
+		    p->offset);
+      buffer->append(kept_section_str);
+      // Append the addend.
+      buffer->append(addend_str);
+      buffer->append("@");
+    }
+}
+
+// Jobs which read the sections which are candidates for folding.
+// Each job handles all the sections from one input file, so that only
+// one thread uses each file.  In the first pass this computes the
+// checksum of each section's text; in the second pass it computes the
+// parts of each section's contents which do not change between
+// iterations.
+
+class Icf_read_jobs : public Parallel_jobs
+{
+ public:
+  Icf_read_jobs(const Task* task, Symbol_table* symtab,
+		const std::vector<Section_id>& id_section,
+		const std::vector<std::vector<unsigned int> >& files,
+		Icf_section_data* data)
+    : task_(task), symtab_(symtab), id_section_(id_section), files_(files),
+      data_(data), second_pass_(false)
+  { }
+
+  // Compute the parts of the section contents which do not change,
+  // rather than the checksum of the text.
+  void
+  set_second_pass()
+  { this->second_pass_ = true; }
+
+ protected:
+  void
+  do_job(size_t i);
+
+ private:
+  const Task* task_;
+  Symbol_table* symtab_;
+  const std::vector<Section_id>& id_section_;
+  const std::vector<std::vector<unsigned int> >& files_;
+  Icf_section_data* data_;
+  bool second_pass_;
+};
+
+void
+Icf_read_jobs::do_job(size_t i)
+{
+  const std::vector<unsigned int>& sections(this->files_[i]);
+  Icf_section_data* data = this->data_;
+  Object* first_object = NULL;
+  for (std::vector<unsigned int>::const_iterator p = sections.begin();
+       p != sections.end();
+       ++p)
     {
-      buffer.append("Contents = ");
-      buffer.append(reinterpret_cast<const char*>(contents), plen);
-      // Store the section contents that don't change to avoid recomputing
-      // during the next call to this function.
-      (*section_contents)[section_num] = buffer;
+      if (this->second_pass_ && data->is_secn_or_group_unique[*p])
+	continue;
+      first_object = this->id_section_[*p].first;
+      break;
     }
-  else
+  if (first_object == NULL)
+    return;
+
+  // Sections in the same archive share a file, so locking one object
+  // locks them all.
+  Task_lock_obj<Object> tl(this->task_, first_object);
+  const File_read* file = &first_object->input_file()->file();
+
+  for (std::vector<unsigned int>::const_iterator p = sections.begin();
+       p != sections.end();
+       ++p)
     {
-      gold_assert(buffer.empty());
-      // Reuse the contents computed in the previous iteration.
-      buffer.append((*section_contents)[section_num]);
+      unsigned int n = *p;
+      const Section_id& secn(this->id_section_[n]);
+      if (!this->second_pass_)
+	{
+	  section_size_type plen;
+	  const unsigned char* contents =
+	    secn.first->section_contents(secn.second, &plen, false);
+	  data->cksums[n] = xcrc32(contents, plen, 0xffffffff);
+	}
+      else if (!data->is_secn_or_group_unique[n])
+	{
+	  if (needs_other_file(secn, file, this->symtab_))
+	    data->needs_serial[n] = true;
+	  else
+	    get_section_contents(secn, this->symtab_,
+				 &data->tracked_relocs[n],
+				 &data->section_contents[n],
+				 &data->cksums[n]);
+	}
+    }
+}
+
+// Read the sections which are candidates for folding, in parallel.
+// See Icf_read_jobs.
+
+static void
+read_sections(const Task* task, Symbol_table* symtab,
+	      const std::vector<Section_id>& id_section,
+	      bool second_pass, Icf_section_data* data)
+{
+  // Group the sections by input file.
+  std::vector<std::vector<unsigned int> > files;
+  Unordered_map<const File_read*, unsigned int> file_indexes;
+  for (unsigned int i = 0; i < id_section.size(); ++i)
+    {
+      const File_read* file = &id_section[i].first->input_file()->file();
+      std::pair<Unordered_map<const File_read*, unsigned int>::iterator, bool>
+	ins = file_indexes.insert(std::make_pair(file, files.size()));
+      if (ins.second)
+	files.push_back(std::vector<unsigned int>());
+      files[ins.first->second].push_back(i);
     }
 
-  buffer.append(icf_reloc_buffer);
-  return buffer;
+  Icf_read_jobs jobs(task, symtab, id_section, files, data);
+  if (second_pass)
+    jobs.set_second_pass();
+  jobs.run(files.size(), Parallel_jobs::default_thread_count());
+
+  if (!second_pass)
+    return;
+
+  // Sections which read merge sections in other files can not be
+  // done in parallel, since another thread may be reading those
+  // files.
+  for (unsigned int i = 0; i < id_section.size(); ++i)
+    {
+      if (!data->needs_serial[i])
+	continue;
+      Task_lock_obj<Object> tl(task, id_section[i].first);
+      get_section_contents(id_section[i], symtab, &data->tracked_relocs[i],
+			   &data->section_contents[i], &data->cksums[i]);
+      data->needs_serial[i] = false;
+    }
 }
 
 // This function computes a checksum on each section to detect and form
@@ -573,83 +749,80 @@ get_section_contents(bool first_iteration,
 // identical sections.  A section is added to a group only after its
 // contents are explicitly compared with the kept section of the group.
 //
+// Reading the sections and computing the checksums of the parts of
+// their contents which do not change is done in parallel in the first
+// iteration.  Forming the groups is done serially, in section order,
+// and each section's relocs to ICF sections use the kept sections as
+// updated by the sections before it, so the result does not depend on
+// the number of threads.
+//
 // Parameters  :
-// ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
+// ITERATION_NUM      : Invocation instance of this function.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
 // ID_SECTION         : Vector mapping a section to an unique integer.
-// IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
-//                            sections is already known to be unique.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
+// DATA               : The information about each section which is
+//                      kept between iterations.
+// STATS              : Set to statistics about this iteration.
 
 static bool
-match_sections(unsigned int iteration_num,
+match_sections(const Task* task,
+	       unsigned int iteration_num,
                Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
                std::vector<unsigned int>* kept_section_id,
                const std::vector<Section_id>& id_section,
 	       const std::vector<uint64_t>& section_addraligns,
-               std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+	       Icf_section_data* data,
+	       Icf::Iteration_stats* stats)
 {
   Unordered_multimap<uint32_t, unsigned int> section_cksum;
   std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
             Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
   bool converged = true;
+  std::vector<bool>* is_secn_or_group_unique = &data->is_secn_or_group_unique;
 
+  // In the first iteration the checksums are computed on the section
+  // text; afterwards they are those computed by the first iteration
+  // on the parts of the contents which do not change.
+  if (iteration_num == 1)
+    read_sections(task, symtab, id_section, false, data);
+  preprocess_for_unique_sections(is_secn_or_group_unique, data->cksums);
   if (iteration_num == 1)
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   NULL);
-  else
-    preprocess_for_unique_sections(id_section,
-                                   is_secn_or_group_unique,
-                                   section_contents);
+    read_sections(task, symtab, id_section, true, data);
 
-  std::vector<std::string> full_section_contents;
+  std::vector<std::string> full_section_contents(id_section.size());
 
   for (unsigned int i = 0; i < id_section.size(); i++)
     {
-      full_section_contents.push_back("");
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      Section_id secn = id_section[i];
-      std::string this_secn_contents;
-      uint32_t cksum;
-      if (iteration_num == 1)
-        {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, secn, i, &num_relocs,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
-          (*num_tracked_relocs)[i] = num_relocs;
-        }
-      else
-        {
-          if ((*kept_section_id)[i] != i)
-            {
-              // This section is already folded into something.
-              continue;
-            }
-          this_secn_contents = get_section_contents(false, secn, i, NULL,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
-        }
+      if (iteration_num > 1 && (*kept_section_id)[i] != i)
+	{
+	  // This section is already folded into something.
+	  continue;
+	}
+
+      std::string icf_reloc_buffer;
+      append_tracked_relocs(data->tracked_relocs[i], *kept_section_id,
+			    &icf_reloc_buffer);
+      std::string this_secn_contents(data->section_contents[i]);
+      this_secn_contents.append(icf_reloc_buffer);
+
+      // The checksum of the unchanging part of the contents was
+      // computed when it was read; continue it over the relocs.
+      const unsigned char* icf_reloc_buffer_array =
+            reinterpret_cast<const unsigned char*>(icf_reloc_buffer.c_str());
+      uint32_t cksum = xcrc32(icf_reloc_buffer_array, icf_reloc_buffer.length(),
+			      data->cksums[i]);
+      ++stats->sections;
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
       size_t count = section_cksum.count(cksum);
 
       if (count == 0)
         {
           // Start a group with this cksum.
           section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
+          full_section_contents[i].swap(this_secn_contents);
         }
       else
         {
@@ -681,23 +854,24 @@ match_sections(unsigned int iteration_num,
 		{
 		  (*kept_section_id)[kept_section] = i;
 		  it->second = i;
-		  full_section_contents[kept_section].swap(
-		      full_section_contents[i]);
+		  full_section_contents[i].swap(
+		      full_section_contents[kept_section]);
 		}
 
               converged = false;
+	      ++stats->folded;
               break;
             }
           if (it == key_range.second)
             {
               // Create a new group for this cksum.
               section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
+              full_section_contents[i].swap(this_secn_contents);
             }
         }
       // If there are no relocs to foldable sections do not process
       // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
+      if (iteration_num == 1 && data->tracked_relocs[i].empty())
         (*is_secn_or_group_unique)[i] = true;
     }
 
@@ -745,16 +919,15 @@ is_function_ctor_or_dtor(const std::string& section_name)
 // This is the main ICF function called in gold.cc.  This does the
 // initialization and calls match_sections repeatedly (twice by default)
 // which computes the crc checksums and detects identical functions.
+// TASK is the task which is running, used to lock the objects.
 
 void
-Icf::find_identical_sections(const Input_objects* input_objects,
+Icf::find_identical_sections(const Task* task,
+			     const Input_objects* input_objects,
                              Symbol_table* symtab)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
   std::vector<uint64_t> section_addraligns;
-  std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
 
   // Decide which sections are possible candidates first.
@@ -763,11 +936,8 @@ Icf::find_identical_sections(const Input_objects* input_objects,
        p != input_objects->relobj_end();
        ++p)
     {
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from queue_middle_tasks, so it is OK to lock.
-      // Unfortunately we have no way to pass in a Task token.
-      const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-      Task_lock_obj<Object> tl(dummy_task, *p);
+      // Lock the object so we can read from it.
+      Task_lock_obj<Object> tl(task, *p);
 
       for (unsigned int i = 0;i < (*p)->shnum(); ++i)
         {
@@ -792,10 +962,7 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
 	  section_addraligns.push_back((*p)->section_addralign(i));
-          is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
           section_num++;
         }
     }
@@ -809,13 +976,27 @@ Icf::find_identical_sections(const Input_objects* input_objects,
 
   bool converged = false;
 
+  Icf_section_data data(section_num);
+
   while (!converged && (num_iterations < max_iterations))
     {
       num_iterations++;
-      converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
+
+      Timer timer;
+      timer.start();
+      Iteration_stats stats;
+      converged = match_sections(task, num_iterations, symtab,
+                                 &this->kept_section_id_,
                                  this->id_section_, section_addraligns,
-                                 &is_secn_or_group_unique, &section_contents);
+                                 &data, &stats);
+      stats.time = timer.get_elapsed_time().wall;
+      this->iteration_stats_.push_back(stats);
+
+      if (parameters->options().print_icf_sections())
+	gold_info(_("%s: ICF iteration %u: %u sections checksummed, "
+		    "%u folded, %ld.%03ld seconds"),
+		  program_name, num_iterations, stats.sections, stats.folded,
+		  stats.time / 1000, stats.time % 1000);
     }
 
   if (parameters->options().print_icf_sections())
@@ -857,6 +1038,22 @@ Icf::find_identical_sections(const Input_objects* input_objects,
   this->icf_ready();
 }
 
+// Print statistics about each iteration to stderr.  This is used for
+// --stats.
+
+void
+Icf::print_stats() const
+{
+  for (size_t i = 0; i < this->iteration_stats_.size(); ++i)
+    {
+      const Iteration_stats& stats(this->iteration_stats_[i]);
+      fprintf(stderr, _("%s: ICF iteration %zu: sections checksummed: %u; "
+			"folded: %u; time: %ld.%03ld\n"),
+	      program_name, i + 1, stats.sections, stats.folded,
+	      stats.time / 1000, stats.time % 1000);
+    }
+}
+
 // Unfolds the section denoted by OBJ and SHNDX if folded.
 
 void
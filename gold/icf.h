@@ -64,11 +64,26 @@ class Icf
   typedef Unordered_map<Section_id, Reloc_info,
                         Section_id_hash> Reloc_info_list;
 
+  // Statistics about one iteration, for --stats.
+  struct Iteration_stats
+  {
+    // The number of sections whose checksum was computed.
+    unsigned int sections;
+    // The number of sections folded.
+    unsigned int folded;
+    // The time taken, in milliseconds.
+    long time;
+
+    Iteration_stats()
+      : sections(0), folded(0), time(0)
+    { }
+  };
+
   Icf()
   : id_section_(), section_id_(), kept_section_id_(),
     fptr_section_id_(),
     icf_ready_(false),
-    reloc_info_list_()
+    reloc_info_list_(), iteration_stats_()
   { }
 
   // Returns the kept folded identical section corresponding to
@@ -79,7 +94,8 @@ class Icf
   // Forms groups of identical sections where the first member
   // of each group is the kept section during folding.
   void
-  find_identical_sections(const Input_objects* input_objects,
+  find_identical_sections(const Task* task,
+			  const Input_objects* input_objects,
                           Symbol_table* symtab);
 
   // This is set when ICF has been run and the groups of
@@ -142,6 +158,10 @@ class Icf
   section_to_int_map()
   { return this->section_id_; }
 
+  // Print statistics to stderr.
+  void
+  print_stats() const;
+
  private:
 
   // Maps integers to sections.
@@ -160,6 +180,8 @@ class Icf
   bool icf_ready_;
   // This list is populated by gc_process_relocs in gc.h.
   Reloc_info_list reloc_info_list_;
+  // Statistics about each iteration.
+  std::vector<Iteration_stats> iteration_stats_;
 };
 
 // This function returns true if this section corresponds to a function that
@@ -34,6 +34,7 @@
 #include "libiberty.h"
 #include "md5.h"
 #include "sha1.h"
+#include "fast-hash.h"
 #ifdef __MINGW32__
 #include <windows.h>
 #include <rpcdce.h>
@@ -48,14 +49,19 @@
 #include "symtab.h"
 #include "dynobj.h"
 #include "ehframe.h"
+#include "merge.h"
 #include "gdb-index.h"
 #include "compressed_output.h"
 #include "reduced_debug_output.h"
 #include "object.h"
 #include "reloc.h"
 #include "descriptors.h"
+#include "gold-threads.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "link-cache.h"
+#include "call-graph.h"
+#include "timer.h"
 #include "layout.h"
 
 namespace gold
@@ -239,18 +245,22 @@ Free_list::print_stats()
 	  program_name, Free_list::num_allocate_visits);
 }
 
-// A Hash_task computes the MD5 checksum of an array of char.
+// A Hash_task computes the checksum of an array of char, using
+// HASH_BUFFER, which is md5_buffer or fast_hash_buffer.
 
 class Hash_task : public Task
 {
  public:
+  typedef void* (*Hash_buffer)(const char*, size_t, void*);
+
   Hash_task(Output_file* of,
 	    size_t offset,
 	    size_t size,
 	    unsigned char* dst,
+	    Hash_buffer hash_buffer,
 	    Task_token* final_blocker)
     : of_(of), offset_(offset), size_(size), dst_(dst),
-      final_blocker_(final_blocker)
+      hash_buffer_(hash_buffer), final_blocker_(final_blocker)
   { }
 
   void
@@ -258,7 +268,8 @@ class Hash_task : public Task
   {
     const unsigned char* iv =
 	this->of_->get_input_view(this->offset_, this->size_);
-    md5_buffer(reinterpret_cast<const char*>(iv), this->size_, this->dst_);
+    this->hash_buffer_(reinterpret_cast<const char*>(iv), this->size_,
+		       this->dst_);
     this->of_->free_input_view(this->offset_, this->size_, iv);
   }
 
@@ -280,9 +291,41 @@ class Hash_task : public Task
   const size_t offset_;
   const size_t size_;
   unsigned char* const dst_;
+  const Hash_buffer hash_buffer_;
   Task_token* const final_blocker_;
 };
 
+// Write_map_task writes out a JSON map file.  Everything it needs
+// was recorded during layout, so it runs alongside the tasks which
+// write the output file.
+
+class Write_map_task : public Task
+{
+ public:
+  Write_map_task(Mapfile* mapfile)
+    : mapfile_(mapfile)
+  { }
+
+  void
+  run(Workqueue*)
+  { this->mapfile_->write_json(); }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  std::string
+  get_name() const
+  { return "Write_map_task"; }
+
+ private:
+  Mapfile* mapfile_;
+};
+
 // Layout::Relaxation_debug_check methods.
 
 // Check that sections and special data are in reset states.
@@ -368,7 +411,7 @@ void
 Layout_task_runner::run(Workqueue* workqueue, const Task* task)
 {
   // See if any of the input definitions violate the One Definition Rule.
-  // TODO: if this is too slow, do this as a task, rather than inline.
+  // The line information of the objects is read in parallel.
   this->symtab_->detect_odr_violations(task, this->options_.output_file_name());
 
   Layout* layout = this->layout_;
@@ -382,7 +425,8 @@ Layout_task_runner::run(Workqueue* workqueue, const Task* task)
 
   if (this->mapfile_ != NULL)
     {
-      this->mapfile_->print_discarded_sections(this->input_objects_);
+      this->mapfile_->print_discarded_sections(this->input_objects_,
+					       this->symtab_);
       layout->print_to_mapfile(this->mapfile_);
     }
 
@@ -414,6 +458,10 @@ Layout_task_runner::run(Workqueue* workqueue, const Task* task)
   // Queue up the final set of tasks.
   gold::queue_final_tasks(this->options_, this->input_objects_,
 			  this->symtab_, layout, workqueue, of);
+
+  // A JSON map is written while the output file is written.
+  if (this->mapfile_ != NULL && this->mapfile_->is_json())
+    workqueue->queue(new Write_map_task(this->mapfile_));
 }
 
 // Layout methods.
@@ -448,6 +496,8 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     added_eh_frame_data_(false),
     eh_frame_hdr_section_(NULL),
     gdb_index_data_(NULL),
+    debug_names_data_(NULL),
+    debug_index_scanner_(NULL),
     build_id_note_(NULL),
     debug_abbrev_(NULL),
     debug_info_(NULL),
@@ -465,14 +515,17 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     section_ordering_specified_(false),
     unique_segment_for_sections_specified_(false),
     incremental_inputs_(NULL),
+    link_cache_(NULL),
     record_output_section_data_from_script_(false),
     script_output_section_data_list_(),
     segment_states_(NULL),
     relaxation_debug_check_(NULL),
+    relaxation_pass_times_(),
     section_order_map_(),
     section_segment_map_(),
     input_section_position_(),
     input_section_glob_(),
+    call_graph_(NULL),
     incremental_base_(NULL),
     free_list_()
 {
@@ -733,6 +786,16 @@ Layout::include_section(Sized_relobj_file<size, big_endian>*, const char* name,
 	      && is_gdb_fast_lookup_section(name + 8))
 	    return false;
 	}
+      if (parameters->options().debug_names()
+	  && !parameters->options().relocatable()
+	  && (shdr.get_sh_flags() & elfcpp::SHF_ALLOC) == 0)
+	{
+	  // When building .debug_names, discard the input .debug_names
+	  // sections, which only index their own objects.
+	  if (strcmp(name, ".debug_names") == 0
+	      || strcmp(name, ".zdebug_names") == 0)
+	    return false;
+	}
       if (parameters->options().strip_lto_sections()
 	  && !parameters->options().relocatable()
 	  && (shdr.get_sh_flags() & elfcpp::SHF_ALLOC) == 0)
@@ -1499,6 +1562,177 @@ Layout::finalize_eh_frame_section()
     }
 }
 
+// Jobs which read the deferred input sections of merged string
+// sections.  Each job reads all the input sections from one file, so
+// that only one thread uses each file.
+
+class Read_merge_strings_jobs : public Parallel_jobs
+{
+ public:
+  // An input section which was not read when it was added.
+  struct Deferred_input
+  {
+    Output_merge_base* pomb;
+    size_t index;
+
+    Deferred_input(Output_merge_base* pomba, size_t indexa)
+      : pomb(pomba), index(indexa)
+    { }
+  };
+
+  typedef std::vector<Deferred_input> Deferred_inputs;
+
+  // Read the files FILES[FIRST] and following.
+  Read_merge_strings_jobs(const Task* task,
+			  const std::vector<Deferred_inputs>& files,
+			  size_t first)
+    : task_(task), files_(files), first_(first)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    const Deferred_inputs& inputs(this->files_[this->first_ + i]);
+    gold_assert(!inputs.empty());
+    Relobj* object =
+      inputs.front().pomb->deferred_input_section_object(inputs.front().index);
+    Task_lock_obj<Object> tlo(this->task_, object);
+    for (Deferred_inputs::const_iterator p = inputs.begin();
+	 p != inputs.end();
+	 ++p)
+      p->pomb->read_deferred_input_section(p->index);
+  }
+
+ private:
+  const Task* task_;
+  const std::vector<Deferred_inputs>& files_;
+  size_t first_;
+};
+
+// Jobs which add the strings read by Read_merge_strings_jobs.  Each
+// job handles one merged string section.
+
+class Add_merge_strings_jobs : public Parallel_jobs
+{
+ public:
+  Add_merge_strings_jobs(const std::vector<Output_merge_base*>& merge_sections)
+    : merge_sections_(merge_sections)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  { this->merge_sections_[i]->add_deferred_input_sections(); }
+
+ private:
+  const std::vector<Output_merge_base*>& merge_sections_;
+};
+
+// The number of bytes of merged string input sections to read before
+// adding their strings.  Deferred input sections are copied when they
+// are read, so this bounds the memory used for the copies.
+
+static const section_size_type merge_strings_batch_size = 64 * 1024 * 1024;
+
+// Read the strings of the merged string input sections which were
+// deferred when they were added.  The input sections are read and
+// their strings hashed in parallel, grouped by file, and then the
+// strings are added to the merged sections, in parallel across
+// sections but in the original order within each section, so the
+// output does not depend on the number of threads.  We do this in
+// batches of files, so that we only keep copies of the contents of a
+// batch of input sections at a time.
+
+void
+Layout::add_deferred_merge_strings(const Task* task)
+{
+  std::vector<Output_merge_base*> merge_sections;
+  for (Section_list::const_iterator p = this->section_list_.begin();
+       p != this->section_list_.end();
+       ++p)
+    (*p)->get_merge_sections(&merge_sections);
+
+  typedef Read_merge_strings_jobs::Deferred_inputs Deferred_inputs;
+  std::vector<Deferred_inputs> files;
+  std::vector<section_size_type> file_sizes;
+  std::map<const File_read*, size_t> file_indexes;
+  std::vector<Output_merge_base*> deferred_sections;
+  for (std::vector<Output_merge_base*>::const_iterator p =
+	 merge_sections.begin();
+       p != merge_sections.end();
+       ++p)
+    {
+      size_t count = (*p)->deferred_input_section_count();
+      if (count == 0)
+	continue;
+      deferred_sections.push_back(*p);
+      for (size_t i = 0; i < count; ++i)
+	{
+	  Relobj* object = (*p)->deferred_input_section_object(i);
+	  const File_read* file = &object->input_file()->file();
+	  std::pair<std::map<const File_read*, size_t>::iterator, bool> ins =
+	    file_indexes.insert(std::make_pair(file, files.size()));
+	  if (ins.second)
+	    {
+	      files.push_back(Deferred_inputs());
+	      file_sizes.push_back(0);
+	    }
+	  files[ins.first->second].push_back(
+	      Read_merge_strings_jobs::Deferred_input(*p, i));
+	  file_sizes[ins.first->second] +=
+	    (*p)->deferred_input_section_size(i);
+	}
+    }
+
+  if (deferred_sections.empty())
+    return;
+
+  int thread_count = Parallel_jobs::default_thread_count();
+
+  // Each merged section adds the strings of its input sections in
+  // order up to the first one which has not been read, so any input
+  // sections read ahead of that are kept until a later batch.  The
+  // files are in the order in which they first added an input
+  // section, which is normally the order in which every merged
+  // section added them, so normally nothing is kept.
+  size_t first = 0;
+  while (first < files.size())
+    {
+      size_t last = first;
+      section_size_type batch_size = 0;
+      do
+	batch_size += file_sizes[last++];
+      while (last < files.size()
+	     && batch_size + file_sizes[last] <= merge_strings_batch_size);
+
+      Read_merge_strings_jobs read_jobs(task, files, first);
+      read_jobs.run(last - first, thread_count);
+
+      Add_merge_strings_jobs add_jobs(deferred_sections);
+      add_jobs.run(deferred_sections.size(), thread_count);
+
+      first = last;
+    }
+
+  for (std::vector<Output_merge_base*>::const_iterator p =
+	 deferred_sections.begin();
+       p != deferred_sections.end();
+       ++p)
+    gold_assert((*p)->deferred_input_section_count() == 0);
+}
+
+// Scan the .debug_info and .debug_types sections which were not
+// scanned when they were added to the .gdb_index and .debug_names
+// sections.
+
+void
+Layout::scan_deferred_gdb_index(const Task* task)
+{
+  if (this->debug_index_scanner_ != NULL)
+    this->debug_index_scanner_->scan_deferred_debug_info(task);
+}
+
 // Create and return the magic .eh_frame section.  Create
 // .eh_frame_hdr also if appropriate.  OBJECT is the object with the
 // input .eh_frame section; it may be NULL.
@@ -1582,7 +1816,7 @@ Layout::add_eh_frame_for_plt(Output_data* plt, const unsigned char* cie_data,
 }
 
 // Scan a .debug_info or .debug_types section, and add summary
-// information to the .gdb_index section.
+// information to the .gdb_index and .debug_names sections.
 
 template<int size, bool big_endian>
 void
@@ -1594,23 +1828,54 @@ Layout::add_to_gdb_index(bool is_type_unit,
 			 unsigned int reloc_shndx,
 			 unsigned int reloc_type)
 {
-  if (this->gdb_index_data_ == NULL)
+  if (this->debug_index_scanner_ == NULL)
     {
-      Output_section* os = this->choose_output_section(NULL, ".gdb_index",
-						       elfcpp::SHT_PROGBITS, 0,
-						       false, ORDER_INVALID,
-						       false, false, false);
-      if (os == NULL)
-	return;
+      if (parameters->options().gdb_index())
+	{
+	  Output_section* os =
+	    this->choose_output_section(NULL, ".gdb_index",
+					elfcpp::SHT_PROGBITS, 0,
+					false, ORDER_INVALID,
+					false, false, false);
+	  if (os != NULL)
+	    {
+	      this->gdb_index_data_ = new Gdb_index(os);
+	      os->add_output_section_data(this->gdb_index_data_);
+	      os->set_after_input_sections();
+	    }
+	}
 
-      this->gdb_index_data_ = new Gdb_index(os);
-      os->add_output_section_data(this->gdb_index_data_);
-      os->set_after_input_sections();
+      if (parameters->options().debug_names())
+	{
+	  // The names in the .debug_names section are in a string
+	  // table added to the end of the .debug_str section.
+	  Output_section* os =
+	    this->choose_output_section(NULL, ".debug_names",
+					elfcpp::SHT_PROGBITS, 0,
+					false, ORDER_INVALID,
+					false, false, false);
+	  Output_section* str_os =
+	    this->choose_output_section(NULL, ".debug_str",
+					elfcpp::SHT_PROGBITS, 0,
+					false, ORDER_INVALID,
+					false, false, false);
+	  if (os != NULL && str_os != NULL)
+	    {
+	      this->debug_names_data_ = new Debug_names();
+	      os->add_output_section_data(this->debug_names_data_);
+	      str_os->add_output_section_data(
+		  this->debug_names_data_->string_data());
+	    }
+	}
+
+      this->debug_index_scanner_ =
+	new Debug_index_scanner(this->gdb_index_data_,
+				this->debug_names_data_);
     }
 
-  this->gdb_index_data_->scan_debug_info(is_type_unit, object, symbols,
-					 symbols_size, shndx, reloc_shndx,
-					 reloc_type);
+  this->debug_index_scanner_->scan_debug_info(is_type_unit, object, symbols,
+					      symbols_size, shndx,
+					      reloc_shndx, reloc_type);
 }
 
 // Add POSD to an output section using NAME, TYPE, and FLAGS.  Return
@@ -1657,8 +1922,13 @@ Layout::make_output_section(const char* name, elfcpp::Elf_Word type,
   if ((flags & elfcpp::SHF_ALLOC) == 0
       && strcmp(parameters->options().compress_debug_sections(), "none") != 0
       && is_compressible_debug_section(name))
-    os = new Output_compressed_section(&parameters->options(), name, type,
-				       flags);
+    {
+      Output_compressed_section* ocs =
+	new Output_compressed_section(&parameters->options(), name, type,
+				      flags);
+      this->compressed_sections_.push_back(ocs);
+      os = ocs;
+    }
   else if ((flags & elfcpp::SHF_ALLOC) == 0
 	   && parameters->options().strip_debug_non_line()
 	   && strcmp(".debug_abbrev", name) == 0)
@@ -2636,6 +2906,7 @@ Layout::read_layout_from_file()
   if (!in)
     gold_fatal(_("unable to open --section-ordering-file file %s: %s"),
 	       filename, strerror(errno));
+  record_link_cache_input(filename);
 
   std::getline(in, line);   // this chops off the trailing \n, if any
   unsigned int position = 1;
@@ -2660,6 +2931,18 @@ Layout::read_layout_from_file()
     }
 }
 
+// Read the call graph from the file specified with option
+// --call-graph-ordering-file.  The order of the sections is computed
+// once they have all been laid out.
+
+void
+Layout::read_call_graph_from_file()
+{
+  this->call_graph_ = new Call_graph();
+  this->call_graph_->read(parameters->options().call_graph_ordering_file());
+  this->set_section_ordering_specified();
+}
+
 // Finalize the layout.  When this is called, we have created all the
 // output sections and all the output segments which are based on
 // input sections.  We have several things to do, and we have to do
@@ -2783,16 +3066,23 @@ Layout::finalize(const Input_objects* input_objects, Symbol_table* symtab,
   if (target->may_relax())
     this->prepare_for_relaxation();
 
-  // Run the relaxation loop to lay out sections.
+  // Run the relaxation loop to lay out sections.  Each pass is timed
+  // for --stats.
+  bool again;
   do
     {
+      Timer timer;
+      timer.start();
       off = this->relaxation_loop_body(pass, target, symtab, &load_seg,
 				       phdr_seg, segment_headers, file_header,
 				       &shndx);
       pass++;
+      again = (target->may_relax()
+	       && target->relax(pass, input_objects, symtab, this, task));
+      if (target->may_relax())
+	this->relaxation_pass_times_.push_back(timer.get_elapsed_time().wall);
     }
-  while (target->may_relax()
-	 && target->relax(pass, input_objects, symtab, this, task));
+  while (again);
 
   // If there is a load segment that contains the file and program headers,
   // provide a symbol __ehdr_start pointing there.
@@ -3085,6 +3375,8 @@ Layout::create_build_id()
     descsz = 128 / 8;
   else if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
     descsz = 160 / 8;
+  else if (strcmp(style, "fast") == 0)
+    descsz = fast_hash_size;
   else if (strcmp(style, "uuid") == 0)
     {
 #ifndef __MINGW32__
@@ -5465,6 +5757,39 @@ Layout::write_sections_after_input_sections(Output_file* of)
   this->section_headers_->write(of);
 }
 
+// Return the number of tasks to use to compress sections.
+
+unsigned int
+Layout::compress_task_count() const
+{
+  unsigned int count = 0;
+  for (std::vector<Output_compressed_section*>::const_iterator p =
+	 this->compressed_sections_.begin();
+       p != this->compressed_sections_.end();
+       ++p)
+    if ((*p)->has_postprocessing_buffer())
+      count += (*p)->compress_task_count();
+  return count;
+}
+
+// Queue the tasks to compress sections.
+
+void
+Layout::queue_compress_tasks(Workqueue* workqueue, Task_token* blocker)
+{
+  // All the blockers must be added before any task is queued, lest
+  // the first tasks finish and release BLOCKER early.
+  blocker->add_blockers(this->compress_task_count());
+
+  for (std::vector<Output_compressed_section*>::const_iterator p =
+	 this->compressed_sections_.begin();
+       p != this->compressed_sections_.end();
+       ++p)
+    if ((*p)->has_postprocessing_buffer()
+	&& (*p)->compress_task_count() > 0)
+      (*p)->queue_compress_tasks(workqueue, blocker);
+}
+
 // If a tree-style build ID was requested, the parallel part of that computation
 // is already done, and the final hash-of-hashes is computed here.  For other
 // types of build IDs, all the work is done here.
@@ -5482,26 +5807,53 @@ Layout::write_build_id(Output_file* of, unsigned char* array_of_hashes,
   if (array_of_hashes == NULL)
     {
       const size_t output_file_size = this->output_file_size();
-      const unsigned char* iv = of->get_input_view(0, output_file_size);
       const char* style = parameters->options().build_id();
 
       // If we get here with style == "tree" then the output must be
       // too small for chunking, and we use SHA-1 in that case.
+      bool use_sha1;
       if ((strcmp(style, "sha1") == 0) || (strcmp(style, "tree") == 0))
-	sha1_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
+	use_sha1 = true;
       else if (strcmp(style, "md5") == 0)
-	md5_buffer(reinterpret_cast<const char*>(iv), output_file_size, ov);
+	use_sha1 = false;
       else
 	gold_unreachable();
 
-      of->free_input_view(0, output_file_size, iv);
+      // Hash the file a piece at a time, so that when the output file
+      // is not mapped we do not have to read all of it into memory.
+      struct sha1_ctx sha1_ctx;
+      struct md5_ctx md5_ctx;
+      if (use_sha1)
+	sha1_init_ctx(&sha1_ctx);
+      else
+	md5_init_ctx(&md5_ctx);
+      const size_t chunk_size = 1024 * 1024;
+      for (size_t off = 0; off < output_file_size; off += chunk_size)
+	{
+	  size_t len = std::min(chunk_size, output_file_size - off);
+	  const unsigned char* iv = of->get_input_view(off, len);
+	  if (use_sha1)
+	    sha1_process_bytes(iv, len, &sha1_ctx);
+	  else
+	    md5_process_bytes(iv, len, &md5_ctx);
+	  of->free_input_view(off, len, iv);
+	}
+      if (use_sha1)
+	sha1_finish_ctx(&sha1_ctx, ov);
+      else
+	md5_finish_ctx(&md5_ctx, ov);
     }
   else
     {
       // Non-overlapping substrings of the output file have been hashed.
-      // Compute SHA-1 hash of the hashes.
-      sha1_buffer(reinterpret_cast<const char*>(array_of_hashes),
-		  size_of_hashes, ov);
+      // Compute SHA-1 hash of the hashes, or for --build-id=fast, the
+      // fast hash of the hashes.
+      if (strcmp(parameters->options().build_id(), "fast") == 0)
+	fast_hash_buffer(reinterpret_cast<const char*>(array_of_hashes),
+			 size_of_hashes, ov);
+      else
+	sha1_buffer(reinterpret_cast<const char*>(array_of_hashes),
+		    size_of_hashes, ov);
       delete[] array_of_hashes;
     }
 
@@ -5587,6 +5939,19 @@ Layout::print_stats() const
        p != this->section_list_.end();
        ++p)
     (*p)->print_merge_stats();
+
+  if (this->debug_names_data_ != NULL)
+    this->debug_names_data_->print_stats();
+
+  if (this->call_graph_ != NULL)
+    this->call_graph_->print_stats();
+
+  for (size_t i = 0; i < this->relaxation_pass_times_.size(); ++i)
+    fprintf(stderr, _("%s: relaxation pass %zu: time: %ld.%03ld\n"),
+	    program_name, i + 1, this->relaxation_pass_times_[i] / 1000,
+	    this->relaxation_pass_times_[i] % 1000);
+  if (!this->relaxation_pass_times_.empty())
+    parameters->target().print_relax_stats();
 }
 
 // Write_sections_task methods.
@@ -5655,22 +6020,23 @@ Write_symbols_task::is_runnable()
   return NULL;
 }
 
-// We need to unlock FINAL_BLOCKER when finished.
+// We don't unlock FINAL_BLOCKER here; the task which finishes
+// writing the global symbols does that.
 
 void
-Write_symbols_task::locks(Task_locker* tl)
+Write_symbols_task::locks(Task_locker*)
 {
-  tl->add(this, this->final_blocker_);
 }
 
-// Run the task--write out the symbols.
+// Run the task--queue the tasks which write out the symbols.
 
 void
-Write_symbols_task::run(Workqueue*)
+Write_symbols_task::run(Workqueue* workqueue)
 {
   this->symtab_->write_globals(this->sympool_, this->dynpool_,
 			       this->layout_->symtab_xindex(),
-			       this->layout_->dynsym_xindex(), this->of_);
+			       this->layout_->dynsym_xindex(), this->of_,
+			       workqueue, this->final_blocker_);
 }
 
 // Write_after_input_sections_task methods.
@@ -5701,9 +6067,27 @@ Write_after_input_sections_task::run(Workqueue*)
   this->layout_->write_sections_after_input_sections(this->of_);
 }
 
+// Compress_sections_task_runner methods.
+
+// Queue the compression tasks, followed by the task which writes out
+// the sections which follow the input sections, which will be blocked
+// until the compression is done.
+
+void
+Compress_sections_task_runner::run(Workqueue* workqueue, const Task*)
+{
+  Task_token* post_compress_tasks_blocker = new Task_token(true);
+  this->layout_->queue_compress_tasks(workqueue, post_compress_tasks_blocker);
+  workqueue->queue(new Write_after_input_sections_task(
+      this->layout_, this->of_, post_compress_tasks_blocker,
+      this->final_blocker_));
+}
+
 // Build IDs can be computed as a "flat" sha1 or md5 of a string of bytes,
 // or as a "tree" where each chunk of the string is hashed and then those
 // hashes are put into a (much smaller) string which is hashed with sha1.
+// A "fast" build ID uses the same tree, but hashes both the chunks and
+// the hashes with fast_hash_buffer, and is used for any size of file.
 // We compute a checksum over the entire file because that is simplest.
 
 void
@@ -5717,27 +6101,40 @@ Build_id_task_runner::run(Workqueue* workqueue, const Task*)
   unsigned char* array_of_hashes = NULL;
   size_t size_of_hashes = 0;
 
-  if (strcmp(this->options_->build_id(), "tree") == 0
-      && this->options_->build_id_chunk_size_for_treehash() > 0
-      && filesize > 0
-      && (filesize >= this->options_->build_id_min_file_size_for_treehash()))
+  // A fast build ID always uses the tree.  If the chunk size is 0,
+  // the whole file is one chunk.
+  const bool is_fast = strcmp(this->options_->build_id(), "fast") == 0;
+  if ((is_fast && filesize > 0)
+      || (strcmp(this->options_->build_id(), "tree") == 0
+	  && this->options_->build_id_chunk_size_for_treehash() > 0
+	  && filesize > 0
+	  && (filesize
+	      >= this->options_->build_id_min_file_size_for_treehash())))
     {
       static const size_t MD5_OUTPUT_SIZE_IN_BYTES = 16;
-      const size_t chunk_size =
-	  this->options_->build_id_chunk_size_for_treehash();
+      const size_t hash_size = (is_fast
+				? fast_hash_size
+				: MD5_OUTPUT_SIZE_IN_BYTES);
+      const Hash_task::Hash_buffer hash_buffer = (is_fast
+						  ? fast_hash_buffer
+						  : md5_buffer);
+      size_t chunk_size = this->options_->build_id_chunk_size_for_treehash();
+      if (chunk_size == 0)
+	chunk_size = filesize;
       const size_t num_hashes = ((filesize - 1) / chunk_size) + 1;
       post_hash_tasks_blocker->add_blockers(num_hashes);
-      size_of_hashes = num_hashes * MD5_OUTPUT_SIZE_IN_BYTES;
+      size_of_hashes = num_hashes * hash_size;
       array_of_hashes = new unsigned char[size_of_hashes];
       unsigned char *dst = array_of_hashes;
       for (size_t i = 0, src_offset = 0; i < num_hashes;
-	   i++, dst += MD5_OUTPUT_SIZE_IN_BYTES, src_offset += chunk_size)
+	   i++, dst += hash_size, src_offset += chunk_size)
 	{
 	  size_t size = std::min(chunk_size, filesize - src_offset);
 	  workqueue->queue(new Hash_task(of,
 					 src_offset,
 					 size,
 					 dst,
+					 hash_buffer,
 					 post_hash_tasks_blocker));
 	}
     }
@@ -43,6 +43,8 @@ class General_options;
 class Incremental_inputs;
 class Incremental_binary;
 class Input_objects;
+class Link_cache;
+class Call_graph;
 class Mapfile;
 class Symbol_table;
 class Output_section_data;
@@ -57,8 +59,11 @@ class Output_data_dynamic;
 class Output_symtab_xindex;
 class Output_reduced_debug_abbrev_section;
 class Output_reduced_debug_info_section;
+class Output_compressed_section;
 class Eh_frame;
 class Gdb_index;
+class Debug_names;
+class Debug_index_scanner;
 class Target;
 struct Timespec;
 
@@ -594,6 +599,16 @@ class Layout
   void
   read_layout_from_file();
 
+  // Read the call graph from the file specified with linker option
+  // --call-graph-ordering-file.
+  void
+  read_call_graph_from_file();
+
+  // The call graph used to order sections, or NULL.
+  Call_graph*
+  call_graph() const
+  { return this->call_graph_; }
+
   // Layout an input reloc section when doing a relocatable link.  The
   // section is RELOC_SHNDX in OBJECT, with data in SHDR.
   // DATA_SECTION is the reloc section to which it refers.  RR is the
@@ -645,6 +660,12 @@ class Layout
   void
   finalize_eh_frame_section();
 
+  // After processing all input files, read the strings of merged
+  // string input sections which were not read when they were added.
+  // TASK is the task which is running.
+  void
+  add_deferred_merge_strings(const Task* task);
+
   // Add .eh_frame information for a PLT.  The FDE must start with a
   // 4-byte PC-relative reference to the start of the PLT, followed by
   // a 4-byte size of PLT.
@@ -654,7 +675,7 @@ class Layout
 		       size_t fde_length);
 
   // Scan a .debug_info or .debug_types section, and add summary
-  // information to the .gdb_index section.
+  // information to the .gdb_index and .debug_names sections.
   template<int size, bool big_endian>
   void
   add_to_gdb_index(bool is_type_unit,
@@ -665,6 +686,13 @@ class Layout
 		   unsigned int reloc_shndx,
 		   unsigned int reloc_type);
 
+  // After processing all input files, scan the .debug_info and
+  // .debug_types sections which were not scanned when they were
+  // added, for the .gdb_index and .debug_names sections.  TASK is the
+  // task which is running.
+  void
+  scan_deferred_gdb_index(const Task* task);
+
   // Handle a GNU stack note.  This is called once per input object
   // file.  SEEN_GNU_STACK is true if the object file has a
   // .note.GNU-stack section.  GNU_STACK_FLAGS is the section flags
@@ -801,6 +829,18 @@ class Layout
   any_postprocessing_sections() const
   { return this->any_postprocessing_sections_; }
 
+  // Return the number of tasks which queue_compress_tasks will
+  // queue.  If this is zero, compressed sections are compressed by
+  // write_sections_after_input_sections.
+  unsigned int
+  compress_task_count() const;
+
+  // Queue tasks to compress the compressed output sections in
+  // parallel.  This adds a blocker to BLOCKER for each task.  This
+  // must be called after all input sections have been written.
+  void
+  queue_compress_tasks(Workqueue*, Task_token* blocker);
+
   // Return the size of the output file.
   off_t
   output_file_size() const
@@ -894,6 +934,16 @@ class Layout
   incremental_inputs() const
   { return this->incremental_inputs_; }
 
+  // Return the link cache, or NULL if --link-cache is not in use.
+  Link_cache*
+  link_cache() const
+  { return this->link_cache_; }
+
+  // Set the link cache.
+  void
+  set_link_cache(Link_cache* link_cache)
+  { this->link_cache_ = link_cache; }
+
   // For the target-specific code to add dynamic tags which are common
   // to most targets.
   void
@@ -1381,8 +1431,14 @@ class Layout
   Output_section* eh_frame_hdr_section_;
   // The data for the .gdb_index section.
   Gdb_index* gdb_index_data_;
+  // The data for the .debug_names section.
+  Debug_names* debug_names_data_;
+  // The scanner for the .gdb_index and .debug_names sections.
+  Debug_index_scanner* debug_index_scanner_;
   // The space for the build ID checksum if there is one.
   Output_section_data* build_id_note_;
+  // The output sections whose contents are compressed.
+  std::vector<Output_compressed_section*> compressed_sections_;
   // The output section containing dwarf abbreviations
   Output_reduced_debug_abbrev_section* debug_abbrev_;
   // The output section containing the dwarf debug info tree
@@ -1421,6 +1477,8 @@ class Layout
   // In incremental build, holds information check the inputs and build the
   // .gnu_incremental_inputs section.
   Incremental_inputs* incremental_inputs_;
+  // The link cache, for --link-cache.
+  Link_cache* link_cache_;
   // Whether we record output section data created in script
   bool record_output_section_data_from_script_;
   // List of output data that needs to be removed at relaxation clean up.
@@ -1429,6 +1487,9 @@ class Layout
   Segment_states* segment_states_;
   // A relaxation debug checker.  We only create one when in debugging mode.
   Relaxation_debug_check* relaxation_debug_check_;
+  // The wall clock time of each relaxation pass in milliseconds, for
+  // --stats.  This is empty if the target does not relax.
+  std::vector<long> relaxation_pass_times_;
   // Plugins specify section_ordering using this map.  This is set in
   // update_section_order in plugin.cc
   std::map<Section_id, unsigned int> section_order_map_;
@@ -1441,6 +1502,8 @@ class Layout
   Unordered_map<std::string, unsigned int> input_section_position_;
   // Vector of glob only patterns in the section_ordering file.
   std::vector<std::string> input_section_glob_;
+  // The call graph from --call-graph-ordering-file.
+  Call_graph* call_graph_;
   // For incremental links, the base file to be modified.
   Incremental_binary* incremental_base_;
   // For incremental links, a list of free space within the file.
@@ -1599,6 +1662,29 @@ class Write_after_input_sections_task : public Task
   Task_token* final_blocker_;
 };
 
+// This task function queues the tasks which compress the contents of
+// compressed output sections in parallel.  It runs after all the
+// input sections have been written, and then queues the
+// Write_after_input_sections_task to run after the compression tasks.
+
+class Compress_sections_task_runner : public Task_function_runner
+{
+ public:
+  Compress_sections_task_runner(Layout* layout, Output_file* of,
+				Task_token* final_blocker)
+    : layout_(layout), of_(of), final_blocker_(final_blocker)
+  { }
+
+  // Run the operation.
+  void
+  run(Workqueue*, const Task*);
+
+ private:
+  Layout* layout_;
+  Output_file* of_;
+  Task_token* final_blocker_;
+};
+
 // This task function handles computation of the build id.
 // When using --build-id=tree, it schedules the tasks that
 // compute the hashes for each chunk of the file. This task
@@ -0,0 +1,870 @@
+// link-cache.cc -- cache link outputs keyed by their inputs
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <set>
+#include <utility>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+#include "sha1.h"
+#include "binary-io.h"
+
+#include "parameters.h"
+#include "errors.h"
+#include "options.h"
+#include "plugin.h"
+#include "gold-threads.h"
+#include "link-cache.h"
+
+namespace gold
+{
+
+// The size of a SHA-1 digest.
+const size_t link_cache_digest_size = 20;
+
+// The names of the files read by the link, and the files searched for
+// in the search path with whether they were found.  The lock is not
+// initialized until the options have been read; before that we are
+// not running threads.
+
+static std::set<std::string> link_cache_inputs;
+static std::set<std::pair<std::string, bool> > link_cache_probes;
+static Lock* link_cache_inputs_lock;
+static Initialize_lock
+link_cache_inputs_initialize_lock(&link_cache_inputs_lock);
+
+// Return whether we need to record inputs for the link cache.  Set
+// *LOCK_INITIALIZED to whether the lock is usable.
+
+static bool
+recording_link_cache_inputs(bool* lock_initialized)
+{
+  // Until the options have been read we do not know whether the
+  // link cache is in use, so we record the file regardless.
+  *lock_initialized = link_cache_inputs_initialize_lock.initialize();
+  return !*lock_initialized || parameters->options().link_cache() != NULL;
+}
+
+// Record that the link read the file NAME.
+
+void
+record_link_cache_input(const std::string& name)
+{
+  bool lock_initialized;
+  if (!recording_link_cache_inputs(&lock_initialized))
+    return;
+
+  Hold_optional_lock hl(lock_initialized ? link_cache_inputs_lock : NULL);
+  link_cache_inputs.insert(name);
+}
+
+// Record that the link searched for the file NAME.
+
+void
+record_link_cache_probe(const std::string& name, bool found)
+{
+  bool lock_initialized;
+  if (!recording_link_cache_inputs(&lock_initialized))
+    return;
+
+  Hold_optional_lock hl(lock_initialized ? link_cache_inputs_lock : NULL);
+  link_cache_probes.insert(std::make_pair(name, found));
+}
+
+// Copy the file FROM to the file TO, creating TO with MODE.  Return
+// false and set errno on failure.
+
+static bool
+copy_file(const char* from, const char* to, int mode)
+{
+  int in = ::open(from, O_RDONLY | O_BINARY);
+  if (in < 0)
+    return false;
+  int out = ::open(to, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, mode);
+  if (out < 0)
+    {
+      int err = errno;
+      ::close(in);
+      errno = err;
+      return false;
+    }
+
+  bool ok = true;
+  unsigned char buf[65536];
+  while (ok)
+    {
+      ssize_t len = ::read(in, buf, sizeof buf);
+      if (len < 0 && errno == EINTR)
+	continue;
+      if (len <= 0)
+	{
+	  ok = len == 0;
+	  break;
+	}
+      unsigned char* p = buf;
+      while (len > 0)
+	{
+	  ssize_t written = ::write(out, p, len);
+	  if (written < 0 && errno == EINTR)
+	    continue;
+	  if (written <= 0)
+	    {
+	      ok = false;
+	      break;
+	    }
+	  p += written;
+	  len -= written;
+	}
+    }
+
+  int err = errno;
+  ::close(in);
+  if (::close(out) < 0)
+    ok = false;
+  else
+    errno = err;
+  return ok;
+}
+
+// Return DIGEST in hex.
+
+static std::string
+digest_to_hex(const unsigned char* digest)
+{
+  static const char hex[] = "0123456789abcdef";
+  std::string ret;
+  for (size_t i = 0; i < link_cache_digest_size; ++i)
+    {
+      ret += hex[digest[i] >> 4];
+      ret += hex[digest[i] & 0xf];
+    }
+  return ret;
+}
+
+// Compute the SHA-1 digest of the rest of the file open as FD into
+// DIGEST, and set *SIZE to the number of bytes hashed.  Return false
+// if the file can not be read.
+
+static bool
+hash_descriptor(int fd, unsigned char* digest, off_t* size)
+{
+  struct sha1_ctx ctx;
+  sha1_init_ctx(&ctx);
+  unsigned char buf[65536];
+  off_t total = 0;
+  ssize_t len;
+  while ((len = ::read(fd, buf, sizeof buf)) != 0)
+    {
+      if (len < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return false;
+	}
+      sha1_process_bytes(buf, len, &ctx);
+      total += len;
+    }
+  sha1_finish_ctx(&ctx, digest);
+  *size = total;
+  return true;
+}
+
+// Read a line from F into *LINE, without the newline.  Return false
+// at the end of the file.
+
+static bool
+read_line(FILE* f, std::string* line)
+{
+  line->clear();
+  int c;
+  while ((c = getc(f)) != EOF)
+    {
+      if (c == '\n')
+	return true;
+      *line += static_cast<char>(c);
+    }
+  return !line->empty();
+}
+
+// Class Link_cache::Hash_input_jobs.
+
+// Compute the SHA-1 digests of the contents of the input files in
+// parallel.  A file which the manifest shows to be unchanged is not
+// read.
+
+class Link_cache::Hash_input_jobs : public Parallel_jobs
+{
+ public:
+  Hash_input_jobs(const Link_cache* link_cache,
+		  const std::vector<std::string>& names)
+    : link_cache_(link_cache), names_(names), inputs_(names.size()),
+      sizes_(names.size(), -1), reused_(names.size(), 0)
+  { }
+
+  // Return the identity and digest of input file I.
+  const Manifest_input&
+  input(size_t i) const
+  { return this->inputs_[i]; }
+
+  // Return whether any input file could not be read.  This may only
+  // be called after the jobs have run.
+  bool
+  failed() const;
+
+  // Return the number of files read and the number of bytes hashed.
+  // These may only be called after the jobs have run.
+  size_t
+  hashed_count() const;
+
+  off_t
+  bytes_hashed() const;
+
+  // Return the number of files whose digests were taken from the
+  // manifest.  This may only be called after the jobs have run.
+  size_t
+  reused_count() const;
+
+ protected:
+  void
+  do_job(size_t i);
+
+ private:
+  const Link_cache* link_cache_;
+  const std::vector<std::string>& names_;
+  // Each job only sets its own entry of these.
+  std::vector<Manifest_input> inputs_;
+  // The number of bytes hashed for each input file, or -1 if it could
+  // not be read.
+  std::vector<off_t> sizes_;
+  // Whether the digest of each input file came from the manifest.
+  // This is not a vector<bool>, whose elements share words.
+  std::vector<unsigned char> reused_;
+};
+
+void
+Link_cache::Hash_input_jobs::do_job(size_t i)
+{
+  const std::string& name(this->names_[i]);
+  int fd = ::open(name.c_str(), O_RDONLY | O_BINARY);
+  if (fd < 0)
+    return;
+
+  Manifest_input* mi = &this->inputs_[i];
+  if (!Link_cache::file_identity(name.c_str(), fd, &mi->identity))
+    {
+      ::close(fd);
+      return;
+    }
+
+  Manifest_inputs::const_iterator p =
+    this->link_cache_->manifest_inputs_.find(name);
+  if (p != this->link_cache_->manifest_inputs_.end()
+      && this->link_cache_->manifest_input_is_current(p->second,
+						       mi->identity))
+    {
+      ::close(fd);
+      mi->digest = p->second.digest;
+      this->sizes_[i] = 0;
+      this->reused_[i] = 1;
+      return;
+    }
+
+  unsigned char digest[link_cache_digest_size];
+  off_t size;
+  bool ok = hash_descriptor(fd, digest, &size);
+  ::close(fd);
+  if (!ok)
+    return;
+  mi->digest = digest_to_hex(digest);
+  this->sizes_[i] = size;
+}
+
+bool
+Link_cache::Hash_input_jobs::failed() const
+{
+  for (size_t i = 0; i < this->sizes_.size(); ++i)
+    if (this->sizes_[i] < 0)
+      return true;
+  return false;
+}
+
+size_t
+Link_cache::Hash_input_jobs::hashed_count() const
+{
+  size_t count = 0;
+  for (size_t i = 0; i < this->sizes_.size(); ++i)
+    if (this->sizes_[i] >= 0 && !this->reused_[i])
+      ++count;
+  return count;
+}
+
+off_t
+Link_cache::Hash_input_jobs::bytes_hashed() const
+{
+  off_t total = 0;
+  for (size_t i = 0; i < this->sizes_.size(); ++i)
+    if (this->sizes_[i] > 0)
+      total += this->sizes_[i];
+  return total;
+}
+
+size_t
+Link_cache::Hash_input_jobs::reused_count() const
+{
+  size_t count = 0;
+  for (size_t i = 0; i < this->reused_.size(); ++i)
+    if (this->reused_[i])
+      ++count;
+  return count;
+}
+
+// Return whether ARG names a plugin or passes it an option.  If ARG
+// takes a separate argument, set *SKIP_NEXT.
+
+static bool
+is_plugin_arg(const char* arg, bool* skip_next)
+{
+  *skip_next = false;
+  if (arg[0] != '-')
+    return false;
+  ++arg;
+  if (arg[0] == '-')
+    ++arg;
+  if (strncmp(arg, "plugin", 6) != 0)
+    return false;
+  arg += 6;
+  if (strncmp(arg, "-opt", 4) == 0)
+    arg += 4;
+  if (arg[0] == '\0')
+    {
+      *skip_next = true;
+      return true;
+    }
+  return arg[0] == '=';
+}
+
+// Class Link_cache.
+
+// We only look up a link in the cache when no plugin has claimed an
+// input file, in which case the plugins do not affect the output.  So
+// we leave the plugin options, which include names of temporary files
+// chosen by the compiler driver, out of the key.
+
+Link_cache::Link_cache(const char* dir, int argc, char** argv)
+  : dir_(dir), args_(), manifest_name_(), key_(), hit_(false),
+    manifest_hit_(false), manifest_found_(false),
+    warnings_before_manifest_(0), warnings_before_lookup_(0),
+    input_names_(), input_digests_(), manifest_inputs_(),
+    manifest_probes_(), manifest_key_(), manifest_time_(0),
+    lookup_time_(0), input_count_(0), reused_count_(0), bytes_hashed_(0),
+    evicted_count_(0)
+{
+  for (int i = 0; i < argc; ++i)
+    {
+      bool skip_next;
+      if (is_plugin_arg(argv[i], &skip_next))
+	i += skip_next ? 1 : 0;
+      else
+	this->args_.push_back(argv[i]);
+    }
+
+  // The manifest lists the input files by the names used by the
+  // link, which may be relative to the working directory.
+  char* cwd = getcwd(NULL, 0);
+  if (cwd == NULL)
+    return;
+  struct sha1_ctx ctx;
+  sha1_init_ctx(&ctx);
+  const char* version = get_version_string();
+  sha1_process_bytes(version, strlen(version) + 1, &ctx);
+  sha1_process_bytes(cwd, strlen(cwd) + 1, &ctx);
+  free(cwd);
+  for (std::vector<std::string>::const_iterator p = this->args_.begin();
+       p != this->args_.end();
+       ++p)
+    sha1_process_bytes(p->c_str(), p->length() + 1, &ctx);
+  unsigned char digest[link_cache_digest_size];
+  sha1_finish_ctx(&ctx, digest);
+  this->manifest_name_ = (this->dir_ + '/' + digest_to_hex(digest)
+			  + ".manifest");
+}
+
+// Return the name of the cache file for the current key.
+
+std::string
+Link_cache::cache_file_name() const
+{
+  gold_assert(!this->key_.empty());
+  return this->dir_ + '/' + this->key_ + ".output";
+}
+
+// Set *IDENTITY to the identity of a file.
+
+bool
+Link_cache::file_identity(const char* name, int fd, File_identity* identity)
+{
+  struct stat s;
+  if ((fd >= 0 ? ::fstat(fd, &s) : ::stat(name, &s)) < 0)
+    return false;
+  identity->dev = s.st_dev;
+  identity->ino = s.st_ino;
+  identity->size = s.st_size;
+#ifdef HAVE_STAT_ST_MTIM
+  identity->mtime_seconds = s.st_mtim.tv_sec;
+  identity->mtime_nanoseconds = s.st_mtim.tv_nsec;
+#else
+  identity->mtime_seconds = s.st_mtime;
+  identity->mtime_nanoseconds = 0;
+#endif
+  return true;
+}
+
+// A file modified in the same second as the manifest was made could
+// have been modified again after it was hashed without changing its
+// modification time, so we only trust the identity of a file which was
+// modified earlier.
+
+bool
+Link_cache::manifest_input_is_current(const Manifest_input& mi,
+				      const File_identity& identity) const
+{
+  return (mi.identity == identity
+	  && identity.mtime_seconds < this->manifest_time_);
+}
+
+// Read the manifest.  It is a text file with a line for each of the
+// inputs and searches, so any line we do not expect means that it is
+// not usable.
+
+bool
+Link_cache::read_manifest()
+{
+  if (this->manifest_name_.empty())
+    return false;
+  FILE* f = fopen(this->manifest_name_.c_str(), "r");
+  if (f == NULL)
+    return false;
+
+  std::string line;
+  bool ok = (read_line(f, &line)
+	     && line == "gold link cache manifest 1");
+  while (ok && read_line(f, &line))
+    {
+      const char* s = line.c_str();
+      int n = 0;
+      if (strncmp(s, "time ", 5) == 0)
+	ok = sscanf(s + 5, "%lld", &this->manifest_time_) == 1;
+      else if (strncmp(s, "output ", 7) == 0)
+	this->manifest_key_ = s + 7;
+      else if (strncmp(s, "input ", 6) == 0)
+	{
+	  char digest[2 * link_cache_digest_size + 1];
+	  Manifest_input mi;
+	  ok = (sscanf(s + 6, "%40s %llu %llu %lld %lld %ld%n", digest,
+		       &mi.identity.dev, &mi.identity.ino, &mi.identity.size,
+		       &mi.identity.mtime_seconds,
+		       &mi.identity.mtime_nanoseconds, &n) == 6
+		&& n > 0
+		&& s[6 + n] == ' '
+		&& strlen(digest) == 2 * link_cache_digest_size);
+	  if (ok)
+	    {
+	      mi.digest = digest;
+	      this->manifest_inputs_[s + 6 + n + 1] = mi;
+	    }
+	}
+      else if (strncmp(s, "probe ", 6) == 0
+	       && (s[6] == '+' || s[6] == '-')
+	       && s[7] == ' ')
+	this->manifest_probes_.insert(std::make_pair(std::string(s + 8),
+						     s[6] == '+'));
+      else
+	ok = false;
+    }
+  fclose(f);
+
+  if (!ok
+      || this->manifest_key_.length() != 2 * link_cache_digest_size
+      || this->manifest_inputs_.empty())
+    {
+      this->manifest_inputs_.clear();
+      this->manifest_probes_.clear();
+      return false;
+    }
+  return true;
+}
+
+// Write the manifest.  We write it to a temporary file and rename it,
+// so that a concurrent link never sees a partial file.
+
+void
+Link_cache::write_manifest() const
+{
+  if (this->manifest_name_.empty())
+    return;
+
+  for (size_t i = 0; i < this->input_names_.size(); ++i)
+    if (this->input_names_[i].find('\n') != std::string::npos)
+      return;
+  for (std::set<std::pair<std::string, bool> >::const_iterator p =
+	 link_cache_probes.begin();
+       p != link_cache_probes.end();
+       ++p)
+    if (p->first.find('\n') != std::string::npos)
+      return;
+
+  char suffix[32];
+  snprintf(suffix, sizeof suffix, ".tmp%ld", static_cast<long>(getpid()));
+  std::string temp_name = this->manifest_name_ + suffix;
+  FILE* f = fopen(temp_name.c_str(), "w");
+  if (f == NULL)
+    return;
+
+  fprintf(f, "gold link cache manifest 1\n");
+  fprintf(f, "time %lld\n", this->lookup_time_);
+  fprintf(f, "output %s\n", this->key_.c_str());
+  for (size_t i = 0; i < this->input_names_.size(); ++i)
+    {
+      const Manifest_input& mi(this->input_digests_[i]);
+      fprintf(f, "input %s %llu %llu %lld %lld %ld %s\n",
+	      mi.digest.c_str(), mi.identity.dev, mi.identity.ino,
+	      mi.identity.size, mi.identity.mtime_seconds,
+	      mi.identity.mtime_nanoseconds, this->input_names_[i].c_str());
+    }
+  for (std::set<std::pair<std::string, bool> >::const_iterator p =
+	 link_cache_probes.begin();
+       p != link_cache_probes.end();
+       ++p)
+    fprintf(f, "probe %c %s\n", p->second ? '+' : '-', p->first.c_str());
+
+  if (fclose(f) != 0
+      || ::rename(temp_name.c_str(), this->manifest_name_.c_str()) < 0)
+    ::unlink(temp_name.c_str());
+}
+
+// Copy a file from the cache to the output file.
+
+void
+Link_cache::copy_from_cache(const std::string& cache_name,
+			    const char* output_name) const
+{
+  // Unlink an existing output file first, as Output_file::open does,
+  // in case it is busy.
+  struct stat s;
+  if (::stat(output_name, &s) == 0
+      && (S_ISREG(s.st_mode) || S_ISLNK(s.st_mode))
+      && s.st_size != 0)
+    ::unlink(output_name);
+
+  int mode = parameters->options().relocatable() ? 0666 : 0777;
+  if (!copy_file(cache_name.c_str(), output_name, mode))
+    gold_fatal(_("%s: cannot copy from link cache %s: %s"),
+	       output_name, cache_name.c_str(), strerror(errno));
+
+  // Mark the file as recently used, for evict.
+  ::utime(cache_name.c_str(), NULL);
+}
+
+// Look for a manifest of an earlier link.  This runs before the
+// options have been used to read any files, so it only checks the
+// files and searches listed in the manifest.
+
+bool
+Link_cache::lookup_manifest(const char* output_name)
+{
+  this->warnings_before_manifest_ = parameters->errors()->warning_count();
+
+  // We do not know which input files a plugin will claim until we
+  // read them.
+  if (parameters->options().has_plugins())
+    return false;
+
+  if (!this->read_manifest())
+    return false;
+  this->manifest_found_ = true;
+
+  // A search which finds a file that it did not find before, or the
+  // other way around, may change the link.
+  for (std::set<std::pair<std::string, bool> >::const_iterator p =
+	 this->manifest_probes_.begin();
+       p != this->manifest_probes_.end();
+       ++p)
+    {
+      struct stat s;
+      bool found = ::lstat(p->first.c_str(), &s) == 0;
+      if (found != p->second)
+	return false;
+    }
+
+  // On a miss lookup checks the inputs again, so only count the
+  // digests reused here on a hit.
+  size_t reused_count = 0;
+  for (Manifest_inputs::const_iterator p = this->manifest_inputs_.begin();
+       p != this->manifest_inputs_.end();
+       ++p)
+    {
+      File_identity identity;
+      if (!Link_cache::file_identity(p->first.c_str(), -1, &identity))
+	return false;
+      if (this->manifest_input_is_current(p->second, identity))
+	{
+	  ++reused_count;
+	  continue;
+	}
+
+      int fd = ::open(p->first.c_str(), O_RDONLY | O_BINARY);
+      if (fd < 0)
+	return false;
+      unsigned char digest[link_cache_digest_size];
+      off_t size;
+      bool ok = hash_descriptor(fd, digest, &size);
+      ::close(fd);
+      if (!ok)
+	return false;
+      ++this->input_count_;
+      this->bytes_hashed_ += size;
+      if (digest_to_hex(digest) != p->second.digest)
+	return false;
+    }
+
+  std::string cache_name = this->dir_ + '/' + this->manifest_key_ + ".output";
+  struct stat s;
+  if (::stat(cache_name.c_str(), &s) < 0)
+    return false;
+
+  this->copy_from_cache(cache_name, output_name);
+  ::utime(this->manifest_name_.c_str(), NULL);
+  this->reused_count_ += reused_count;
+  this->hit_ = true;
+  this->manifest_hit_ = true;
+  return true;
+}
+
+// Compute the key and look for it in the cache.
+
+bool
+Link_cache::lookup(const char* output_name)
+{
+  // When a plugin claims an input file, the files that we actually
+  // link are generated by the plugin under new names each time.
+  if (parameters->options().has_plugins()
+      && parameters->options().plugins()->any_claimed())
+    return false;
+
+  this->warnings_before_lookup_ = parameters->errors()->warning_count();
+  this->lookup_time_ = time(NULL);
+
+  std::vector<std::string> names(link_cache_inputs.begin(),
+				 link_cache_inputs.end());
+  Hash_input_jobs jobs(this, names);
+  jobs.run(names.size(), Parallel_jobs::default_thread_count());
+  this->input_count_ += jobs.hashed_count();
+  this->reused_count_ += jobs.reused_count();
+  this->bytes_hashed_ += jobs.bytes_hashed();
+  if (jobs.failed())
+    return false;
+
+  struct sha1_ctx ctx;
+  sha1_init_ctx(&ctx);
+  const char* version = get_version_string();
+  sha1_process_bytes(version, strlen(version) + 1, &ctx);
+  for (std::vector<std::string>::const_iterator p = this->args_.begin();
+       p != this->args_.end();
+       ++p)
+    sha1_process_bytes(p->c_str(), p->length() + 1, &ctx);
+  for (size_t i = 0; i < names.size(); ++i)
+    {
+      const std::string& digest(jobs.input(i).digest);
+      sha1_process_bytes(names[i].c_str(), names[i].length() + 1, &ctx);
+      sha1_process_bytes(digest.c_str(), digest.length(), &ctx);
+      this->input_digests_.push_back(jobs.input(i));
+    }
+  this->input_names_.swap(names);
+  // A file that was searched for but not found is as much a part of
+  // the key as one that was found: if it appears, the link may change.
+  for (std::set<std::pair<std::string, bool> >::const_iterator p =
+	 link_cache_probes.begin();
+       p != link_cache_probes.end();
+       ++p)
+    {
+      sha1_process_bytes(p->first.c_str(), p->first.length() + 1, &ctx);
+      sha1_process_bytes(p->second ? "+" : "-", 1, &ctx);
+    }
+  unsigned char digest[link_cache_digest_size];
+  sha1_finish_ctx(&ctx, digest);
+  this->key_ = digest_to_hex(digest);
+
+  std::string cache_name = this->cache_file_name();
+  struct stat s;
+  if (::stat(cache_name.c_str(), &s) < 0)
+    return false;
+
+  this->copy_from_cache(cache_name, output_name);
+  this->hit_ = true;
+  return true;
+}
+
+// Add the output to the cache.  We copy it to a temporary file and
+// rename it, so that a concurrent link never sees a partial file.
+// Failing to update the cache is not an error.  A link found in the
+// cache stops before the warnings issued by layout, relocation or
+// writing the output, so we do not add a link that issued any.  A
+// link found by its manifest stops before reading any input files, so
+// we only write the manifest for a link that issued no warnings after
+// reading its options.
+
+void
+Link_cache::store(const char* output_name)
+{
+  if (this->key_.empty() || this->manifest_hit_)
+    return;
+
+  int warning_count = parameters->errors()->warning_count();
+  if (!this->hit_ && warning_count != this->warnings_before_lookup_)
+    return;
+
+  if (::mkdir(this->dir_.c_str(), 0777) < 0 && errno != EEXIST)
+    {
+      gold_warning(_("cannot create link cache directory %s: %s"),
+		   this->dir_.c_str(), strerror(errno));
+      return;
+    }
+
+  if (!this->hit_)
+    {
+      std::string cache_name = this->cache_file_name();
+      char suffix[32];
+      snprintf(suffix, sizeof suffix, ".tmp%ld",
+	       static_cast<long>(getpid()));
+      std::string temp_name = cache_name + suffix;
+      if (!copy_file(output_name, temp_name.c_str(), 0666)
+	  || ::rename(temp_name.c_str(), cache_name.c_str()) < 0)
+	{
+	  gold_warning(_("cannot add %s to link cache: %s"),
+		       output_name, strerror(errno));
+	  ::unlink(temp_name.c_str());
+	  return;
+	}
+    }
+
+  if (warning_count == this->warnings_before_manifest_
+      && !parameters->options().has_plugins())
+    this->write_manifest();
+
+  this->evict();
+}
+
+// Remove the least recently used outputs and manifests from the
+// cache until it fits in --link-cache-size.  A manifest whose output
+// is removed is simply not found.
+
+void
+Link_cache::evict()
+{
+  uint64_t limit = parameters->options().link_cache_size();
+  if (limit == 0)
+    return;
+
+  DIR* d = opendir(this->dir_.c_str());
+  if (d == NULL)
+    return;
+
+  // The files in the cache, by modification time and name, with their
+  // sizes.
+  typedef std::pair<std::pair<long long, std::string>, off_t> Cache_file;
+  std::vector<Cache_file> files;
+  uint64_t total = 0;
+  struct dirent* de;
+  while ((de = readdir(d)) != NULL)
+    {
+      std::string name(de->d_name);
+      size_t dot = name.rfind('.');
+      if (dot == std::string::npos
+	  || (name.compare(dot, std::string::npos, ".output") != 0
+	      && name.compare(dot, std::string::npos, ".manifest") != 0))
+	continue;
+      std::string path = this->dir_ + '/' + name;
+      File_identity identity;
+      if (!Link_cache::file_identity(path.c_str(), -1, &identity))
+	continue;
+      long long mtime = (identity.mtime_seconds * 1000000000LL
+			 + identity.mtime_nanoseconds);
+      files.push_back(std::make_pair(std::make_pair(mtime, path),
+				     identity.size));
+      total += identity.size;
+    }
+  closedir(d);
+
+  std::sort(files.begin(), files.end());
+  for (std::vector<Cache_file>::const_iterator p = files.begin();
+       p != files.end() && total > limit;
+       ++p)
+    {
+      if (::unlink(p->first.second.c_str()) == 0)
+	{
+	  total -= p->second;
+	  ++this->evicted_count_;
+	}
+    }
+}
+
+// Print statistics.
+
+void
+Link_cache::print_stats() const
+{
+  const char* result;
+  if (this->hit_)
+    result = _("hit");
+  else if (!this->key_.empty())
+    result = _("miss");
+  else
+    result = _("not used");
+  fprintf(stderr, _("%s: link cache: %s\n"), program_name, result);
+  if (this->manifest_hit_)
+    result = _("hit");
+  else if (this->manifest_found_)
+    result = _("miss");
+  else
+    result = _("not found");
+  fprintf(stderr, _("%s: link cache manifest: %s\n"), program_name, result);
+  fprintf(stderr, _("%s: link cache input files hashed: %lu\n"),
+	  program_name, static_cast<unsigned long>(this->input_count_));
+  fprintf(stderr, _("%s: link cache input digests reused: %lu\n"),
+	  program_name, static_cast<unsigned long>(this->reused_count_));
+  fprintf(stderr, _("%s: link cache bytes hashed: %lld\n"),
+	  program_name, static_cast<long long>(this->bytes_hashed_));
+  fprintf(stderr, _("%s: link cache files removed: %lu\n"),
+	  program_name, static_cast<unsigned long>(this->evicted_count_));
+}
+
+} // End namespace gold.
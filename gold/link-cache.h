@@ -0,0 +1,225 @@
+// link-cache.h -- cache link outputs keyed by their inputs  -*- C++ -*-
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#ifndef GOLD_LINK_CACHE_H
+#define GOLD_LINK_CACHE_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gold
+{
+
+// Record that the link read the file NAME.  File_read::open calls
+// this for every file that it opens, so that the link cache sees all
+// the inputs, including linker scripts read while parsing options.
+
+extern void
+record_link_cache_input(const std::string& name);
+
+// Record that the link searched for the file NAME, and whether it was
+// FOUND.  Dirsearch calls this for every file that it looks for in the
+// search path, so that the key changes when a file appears earlier in
+// the search path, even if it is not a file that the link went on to
+// read.
+
+extern void
+record_link_cache_probe(const std::string& name, bool found);
+
+// This class implements --link-cache.  The cache is a directory of
+// output files, each named by a SHA-1 hash of the linker version, the
+// command line, the names and contents of all the files read by the
+// link, and the results of all the searches for files in the search
+// path.  Once all the input files have been read, we compute the
+// hash.  If the cache holds an output for it, we copy that output
+// instead of laying out, relocating and writing the output file.
+// Otherwise, when the link succeeds without warnings after that point
+// we add its output to the cache; a link found in the cache could not
+// repeat those warnings.
+
+// Finding the output that way still reads the symbols of all the
+// input files.  So for each command line and working directory we
+// also keep a manifest listing the files read by the last link, with
+// the digest, size, inode and modification time of each, and the
+// results of its searches.  Before reading any input files, if the
+// searches give the same results and the files have the same
+// digests, we copy the output named by the manifest and do nothing
+// else.  A file with the same size, inode and modification time,
+// modified before the manifest was made, is taken to have the same
+// digest without reading it, so that a link in which only a few files
+// have changed only hashes those files.  The manifest is only written
+// for a link which issued no warnings after reading its options.
+
+// The least recently used files are removed from the cache when it
+// grows beyond --link-cache-size.
+
+class Link_cache
+{
+ public:
+  Link_cache(const char* dir, int argc, char** argv);
+
+  // Look for the manifest of an earlier link with the same command
+  // line.  This is called before reading any input files.  If the
+  // files and searches which it lists are unchanged, copy its output
+  // to OUTPUT_NAME and return true.
+  bool
+  lookup_manifest(const char* output_name);
+
+  // Compute the key from the inputs read so far, which must be all
+  // of them.  If the cache holds an output for the key, copy it to
+  // OUTPUT_NAME and return true.
+  bool
+  lookup(const char* output_name);
+
+  // Add OUTPUT_NAME to the cache, if lookup did not find it there,
+  // and write the manifest.
+  void
+  store(const char* output_name);
+
+  // Print statistics.
+  void
+  print_stats() const;
+
+ private:
+  class Hash_input_jobs;
+
+  // The identity of an input file: if it has not changed, neither
+  // have the contents of the file.
+  struct File_identity
+  {
+    File_identity()
+      : dev(0), ino(0), size(-1), mtime_seconds(0), mtime_nanoseconds(0)
+    { }
+
+    bool
+    operator==(const File_identity& fi) const
+    {
+      return (this->dev == fi.dev
+	      && this->ino == fi.ino
+	      && this->size == fi.size
+	      && this->mtime_seconds == fi.mtime_seconds
+	      && this->mtime_nanoseconds == fi.mtime_nanoseconds);
+    }
+
+    unsigned long long dev;
+    unsigned long long ino;
+    long long size;
+    long long mtime_seconds;
+    long mtime_nanoseconds;
+  };
+
+  // An input file listed in a manifest.
+  struct Manifest_input
+  {
+    // The identity of the file when it was hashed.
+    File_identity identity;
+    // The SHA-1 digest of the contents, in hex.
+    std::string digest;
+  };
+
+  typedef std::map<std::string, Manifest_input> Manifest_inputs;
+
+  // Return the name of the cache file for the current key.
+  std::string
+  cache_file_name() const;
+
+  // Read the manifest into manifest_inputs_, manifest_probes_,
+  // manifest_key_ and manifest_time_.  Return false if there is no
+  // usable manifest.
+  bool
+  read_manifest();
+
+  // Write the manifest for the current key.
+  void
+  write_manifest() const;
+
+  // Return whether the manifest entry MI describes the current
+  // contents of a file with IDENTITY, without reading the file.
+  bool
+  manifest_input_is_current(const Manifest_input& mi,
+			    const File_identity& identity) const;
+
+  // Set *IDENTITY to the identity of the file open as FD or, if FD is
+  // negative, of the file NAME.  Return false if it can not be found.
+  static bool
+  file_identity(const char* name, int fd, File_identity* identity);
+
+  // Copy the cache file CACHE_NAME to OUTPUT_NAME.
+  void
+  copy_from_cache(const std::string& cache_name,
+		  const char* output_name) const;
+
+  // Remove the least recently used files from the cache until it is
+  // no larger than --link-cache-size.
+  void
+  evict();
+
+  // The cache directory.
+  std::string dir_;
+  // The command line arguments.
+  std::vector<std::string> args_;
+  // The name of the manifest for the command line and working
+  // directory, or empty if the working directory is unknown.
+  std::string manifest_name_;
+  // The key in hex, or empty if it has not been computed or if the
+  // inputs could not be read.
+  std::string key_;
+  // Whether lookup or lookup_manifest found the output in the cache.
+  bool hit_;
+  // Whether lookup_manifest found the output in the cache.
+  bool manifest_hit_;
+  // Whether lookup_manifest found a manifest.
+  bool manifest_found_;
+  // The number of warnings issued before lookup_manifest.
+  int warnings_before_manifest_;
+  // The number of warnings issued before lookup.
+  int warnings_before_lookup_;
+  // The input files read by the link, with their identities and
+  // digests, as computed by lookup.
+  std::vector<std::string> input_names_;
+  std::vector<Manifest_input> input_digests_;
+  // The inputs listed by the manifest.
+  Manifest_inputs manifest_inputs_;
+  // The searches listed by the manifest.
+  std::set<std::pair<std::string, bool> > manifest_probes_;
+  // The key of the output named by the manifest.
+  std::string manifest_key_;
+  // The time at which the inputs listed by the manifest were hashed.
+  long long manifest_time_;
+  // The time at which lookup hashed the inputs.
+  long long lookup_time_;
+  // The number of input files hashed.
+  size_t input_count_;
+  // The number of input files whose digests were taken from the
+  // manifest without reading them.
+  size_t reused_count_;
+  // The number of bytes hashed.
+  off_t bytes_hashed_;
+  // The number of files removed from the cache.
+  size_t evicted_count_;
+};
+
+} // End namespace gold.
+
+#endif // !defined(GOLD_LINK_CACHE_H)
@@ -48,6 +48,8 @@
 #include "icf.h"
 #include "incremental.h"
 #include "gdb-index.h"
+#include "compressed_output.h"
+#include "link-cache.h"
 #include "timer.h"
 
 using namespace gold;
@@ -182,7 +184,10 @@ main(int argc, char** argv)
   Mapfile* mapfile = NULL;
   if (command_line.options().user_set_Map())
     {
-      mapfile = new Mapfile();
+      Mapfile::Format format = Mapfile::FORMAT_TEXT;
+      if (strcmp(command_line.options().Map_format(), "json") == 0)
+	format = Mapfile::FORMAT_JSON;
+      mapfile = new Mapfile(format);
       if (!mapfile->open(command_line.options().Map()))
 	{
 	  delete mapfile;
@@ -235,25 +240,66 @@ main(int argc, char** argv)
   if (parameters->options().section_ordering_file())
     layout.read_layout_from_file();
 
+  if (parameters->options().call_graph_ordering_file())
+    layout.read_call_graph_from_file();
+
+  // If the user asked for a link cache, it is consulted before
+  // reading any input files, using the manifest of an earlier link
+  // with the same command line, and again once all the input files
+  // have been read.
+  Link_cache* link_cache = NULL;
+  bool link_cache_hit = false;
+  if (command_line.options().link_cache() != NULL)
+    {
+      link_cache = new Link_cache(command_line.options().link_cache(),
+				  argc, argv);
+      layout.set_link_cache(link_cache);
+      link_cache_hit = link_cache->lookup_manifest(
+	  command_line.options().output_file_name());
+    }
+
   // Load plugin libraries.
   if (command_line.options().has_plugins())
     command_line.options().plugins()->load_plugins(&layout);
 
-  // Get the search path from the -L options.
-  Dirsearch search_path;
-  search_path.initialize(&workqueue, &command_line.options().library_path());
-
-  // Queue up the first set of tasks.
-  queue_initial_tasks(command_line.options(), search_path,
-		      command_line, &workqueue, &input_objects,
-		      &symtab, &layout, mapfile);
+  if (!link_cache_hit)
+    {
+      // Get the search path from the -L options.
+      Dirsearch search_path;
+      search_path.initialize(&workqueue,
+			     &command_line.options().library_path());
+
+      // Queue up the first set of tasks.
+      queue_initial_tasks(command_line.options(), search_path,
+			  command_line, &workqueue, &input_objects,
+			  &symtab, &layout, mapfile);
+
+      // Run the main task processing loop.
+      workqueue.process(0);
+    }
+  else if (command_line.options().stats())
+    {
+      // None of the passes ran.
+      timer.stamp(0);
+      timer.stamp(1);
+    }
 
-  // Run the main task processing loop.
-  workqueue.process(0);
+  // Write the timeline of the tasks, if --trace-tasks was used.
+  workqueue.write_trace();
 
   if (command_line.options().print_output_format())
     print_output_format();
 
+  if (parameters->options().fatal_warnings()
+      && errors.warning_count() > 0
+      && errors.error_count() == 0)
+    gold_error("treating warnings as errors");
+
+  // Add the output of a successful link to the link cache,
+  // before its statistics are printed.
+  if (link_cache != NULL && errors.error_count() == 0)
+    link_cache->store(command_line.options().output_file_name());
+
   if (command_line.options().stats())
     {
       timer.stamp(2);
@@ -295,14 +341,23 @@ main(int argc, char** argv)
       fprintf(stderr, _("%s: total space allocated by malloc: %d bytes\n"),
 	      program_name, m.arena);
 #endif
+      workqueue.print_stats();
       File_read::print_stats();
       Archive::print_stats();
       Lib_group::print_stats();
-      fprintf(stderr, _("%s: output file size: %lld bytes\n"),
-	      program_name, static_cast<long long>(layout.output_file_size()));
+      if (layout.output_file_size() >= 0)
+	fprintf(stderr, _("%s: output file size: %lld bytes\n"),
+		program_name,
+		static_cast<long long>(layout.output_file_size()));
       symtab.print_stats();
+      if (symtab.icf() != NULL)
+	symtab.icf()->print_stats();
       layout.print_stats();
       Gdb_index::print_stats();
+      Output_compressed_section::print_stats();
+      Output_file::print_stats();
+      if (link_cache != NULL)
+	link_cache->print_stats();
       Free_list::print_stats();
     }
 
@@ -310,19 +365,16 @@ main(int argc, char** argv)
   if (command_line.options().user_set_print_symbol_counts())
     input_objects.print_symbol_counts(&symtab);
 
-  // Output cross reference table.
+  // Output cross reference table.  It does not go in a JSON map.
   if (command_line.options().cref())
     input_objects.print_cref(&symtab,
-			     mapfile == NULL ? stdout : mapfile->file());
+			     (mapfile == NULL || mapfile->is_json()
+			      ? stdout
+			      : mapfile->file()));
 
   if (mapfile != NULL)
     mapfile->close();
 
-  if (parameters->options().fatal_warnings()
-      && errors.warning_count() > 0
-      && errors.error_count() == 0)
-    gold_error("treating warnings as errors");
-
   // If the user used --noinhibit-exec, we force the exit status to be
   // successful.  This is compatible with GNU ld.
   gold_exit((errors.error_count() == 0
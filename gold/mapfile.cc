@@ -29,21 +29,33 @@
 #include "archive.h"
 #include "symtab.h"
 #include "output.h"
+#include "icf.h"
+#include "gc.h"
 #include "mapfile.h"
 
 // This file holds the code for printing information to the map file.
 // In general we try to produce pretty much the same format as GNU ld.
+// With --Map-format=json we instead record what we would print, and
+// write it out as a JSON document later.
 
 namespace gold
 {
 
 // Mapfile constructor.
 
-Mapfile::Mapfile()
-  : map_file_(NULL),
+Mapfile::Mapfile(Format format)
+  : format_(format),
+    map_file_(NULL),
     printed_archive_header_(false),
     printed_common_header_(false),
-    printed_memory_map_header_(false)
+    printed_memory_map_header_(false),
+    wrote_json_(false),
+    json_archive_members_(),
+    json_commons_(),
+    json_discarded_sections_(),
+    json_input_sections_(),
+    json_output_sections_(),
+    json_symbols_()
 {
 }
 
@@ -80,6 +92,11 @@ Mapfile::open(const char* map_filename)
 void
 Mapfile::close()
 {
+  // If the link stopped before the map was written, write what we
+  // have.
+  if (this->is_json() && !this->wrote_json_)
+    this->write_json();
+
   if (fclose(this->map_file_) != 0)
     gold_error(_("cannot close map file: %s"), strerror(errno));
   this->map_file_ = NULL;
@@ -108,6 +125,26 @@ void
 Mapfile::report_include_archive_member(const std::string& member_name,
 				       const Symbol* sym, const char* why)
 {
+  if (this->is_json())
+    {
+      Json_archive_member m;
+      m.member = member_name;
+      m.symbol_name = NULL;
+      m.object = NULL;
+      if (sym == NULL)
+	m.why = why;
+      else
+	{
+	  m.symbol_name = sym->name();
+	  if (sym->source() == Symbol::FROM_OBJECT)
+	    m.object = sym->object();
+	  else
+	    m.why = "-u";
+	}
+      this->json_archive_members_.push_back(m);
+      return;
+    }
+
   // We print a header before the list of archive members, mainly for
   // GNU ld compatibility.
   if (!this->printed_archive_header_)
@@ -154,6 +191,16 @@ Mapfile::report_include_archive_member(const std::string& member_name,
 void
 Mapfile::report_allocate_common(const Symbol* sym, uint64_t symsize)
 {
+  if (this->is_json())
+    {
+      Json_common c;
+      c.symbol_name = sym->name();
+      c.size = symsize;
+      c.object = sym->object();
+      this->json_commons_.push_back(c);
+      return;
+    }
+
   if (!this->printed_common_header_)
     {
       fprintf(this->map_file_, _("\nAllocating common symbols\n"));
@@ -217,10 +264,19 @@ Mapfile::print_input_section_symbols(
 	  && is_ordinary
 	  && sym->is_defined())
 	{
-	  for (size_t i = 0; i < Mapfile::section_name_map_length; ++i)
-	    putc(' ', this->map_file_);
 	  const Sized_symbol<size>* ssym =
 	    static_cast<const Sized_symbol<size>*>(sym);
+	  if (this->is_json())
+	    {
+	      Json_symbol js;
+	      js.sym = sym;
+	      js.value = ssym->value();
+	      js.size = ssym->symsize();
+	      this->json_symbols_.push_back(js);
+	      continue;
+	    }
+	  for (size_t i = 0; i < Mapfile::section_name_map_length; ++i)
+	    putc(' ', this->map_file_);
 	  fprintf(this->map_file_,
 		  "0x%0*llx                %s\n",
 		  size / 4,
@@ -235,12 +291,15 @@ Mapfile::print_input_section_symbols(
 void
 Mapfile::print_input_section(Relobj* relobj, unsigned int shndx)
 {
-  putc(' ', this->map_file_);
-
   std::string name = relobj->section_name(shndx);
-  fprintf(this->map_file_, "%s", name.c_str());
 
-  this->advance_to_column(name.length() + 1, Mapfile::section_name_map_length);
+  if (!this->is_json())
+    {
+      putc(' ', this->map_file_);
+      fprintf(this->map_file_, "%s", name.c_str());
+      this->advance_to_column(name.length() + 1,
+			      Mapfile::section_name_map_length);
+    }
 
   Output_section* os;
   uint64_t addr;
@@ -257,17 +316,36 @@ Mapfile::print_input_section(Relobj* relobj, unsigned int shndx)
 	addr += os->address();
     }
 
-  char sizebuf[50];
   section_size_type size;
   if (!relobj->section_is_compressed(shndx, &size))
     size = relobj->section_size(shndx);
-  snprintf(sizebuf, sizeof sizebuf, "0x%llx",
-	   static_cast<unsigned long long>(size));
 
-  fprintf(this->map_file_, "0x%0*llx %10s %s\n",
-	  parameters->target().get_size() / 4,
-	  static_cast<unsigned long long>(addr), sizebuf,
-	  relobj->name().c_str());
+  if (this->is_json())
+    {
+      Json_input_section js;
+      js.name = name;
+      js.object = relobj;
+      js.shndx = shndx;
+      js.address = addr;
+      js.size = size;
+      js.discard_reason = NULL;
+      js.folded_object = NULL;
+      js.folded_shndx = 0;
+      js.first_symbol = this->json_symbols_.size();
+      js.last_symbol = js.first_symbol;
+      this->json_input_sections_.push_back(js);
+    }
+  else
+    {
+      char sizebuf[50];
+      snprintf(sizebuf, sizeof sizebuf, "0x%llx",
+	       static_cast<unsigned long long>(size));
+
+      fprintf(this->map_file_, "0x%0*llx %10s %s\n",
+	      parameters->target().get_size() / 4,
+	      static_cast<unsigned long long>(addr), sizebuf,
+	      relobj->name().c_str());
+    }
 
   if (os != NULL)
     {
@@ -312,6 +390,10 @@ Mapfile::print_input_section(Relobj* relobj, unsigned int shndx)
 	default:
 	  gold_unreachable();
 	}
+
+      if (this->is_json())
+	this->json_input_sections_.back().last_symbol =
+	  this->json_symbols_.size();
     }
 }
 
@@ -321,6 +403,42 @@ Mapfile::print_input_section(Relobj* relobj, unsigned int shndx)
 void
 Mapfile::print_output_data(const Output_data* od, const char* name)
 {
+  if (this->is_json())
+    {
+      uint64_t address = od->is_address_valid() ? od->address() : 0;
+      uint64_t size = od->current_data_size();
+
+      // Data such as the file header which comes before the first
+      // output section is listed as an output section itself.
+      if (this->json_output_sections_.empty())
+	{
+	  Json_output_section jos;
+	  jos.name = name;
+	  jos.address = address;
+	  jos.size = size;
+	  jos.has_load_address = false;
+	  jos.load_address = 0;
+	  jos.before_compression = false;
+	  jos.first_input = this->json_input_sections_.size();
+	  this->json_output_sections_.push_back(jos);
+	  return;
+	}
+
+      Json_input_section js;
+      js.name = name;
+      js.object = NULL;
+      js.shndx = 0;
+      js.address = address;
+      js.size = size;
+      js.discard_reason = NULL;
+      js.folded_object = NULL;
+      js.folded_shndx = 0;
+      js.first_symbol = this->json_symbols_.size();
+      js.last_symbol = js.first_symbol;
+      this->json_input_sections_.push_back(js);
+      return;
+    }
+
   this->print_memory_map_header();
 
   putc(' ', this->map_file_);
@@ -344,7 +462,8 @@ Mapfile::print_output_data(const Output_data* od, const char* name)
 // Print the discarded input sections.
 
 void
-Mapfile::print_discarded_sections(const Input_objects* input_objects)
+Mapfile::print_discarded_sections(const Input_objects* input_objects,
+				  Symbol_table* symtab)
 {
   bool printed_header = false;
   for (Input_objects::Relobj_iterator p = input_objects->relobj_begin();
@@ -367,6 +486,27 @@ Mapfile::print_discarded_sections(const Input_objects* input_objects)
 	       || sh_type == elfcpp::SHT_GROUP)
 	      && !relobj->is_section_included(i))
 	    {
+	      if (this->is_json())
+		{
+		  this->print_input_section(relobj, i);
+		  Json_input_section& js(this->json_input_sections_.back());
+		  if (symtab->icf() != NULL
+		      && symtab->icf()->is_section_folded(relobj, i))
+		    {
+		      Section_id kept = symtab->icf()->get_folded_section(relobj,
+									  i);
+		      js.discard_reason = "icf";
+		      js.folded_object = kept.first;
+		      js.folded_shndx = kept.second;
+		    }
+		  else if (symtab->gc() != NULL
+			   && symtab->gc()->is_section_garbage(relobj, i))
+		    js.discard_reason = "gc";
+		  else
+		    js.discard_reason = "other";
+		  continue;
+		}
+
 	      if (!printed_header)
 		{
 		  fprintf(this->map_file_, _("\nDiscarded input sections\n\n"));
@@ -377,6 +517,10 @@ Mapfile::print_discarded_sections(const Input_objects* input_objects)
 	    }
 	}
     }
+
+  // The discarded sections are recorded before any output section.
+  if (this->is_json())
+    this->json_discarded_sections_.swap(this->json_input_sections_);
 }
 
 // Print an output section.
@@ -384,6 +528,20 @@ Mapfile::print_discarded_sections(const Input_objects* input_objects)
 void
 Mapfile::print_output_section(const Output_section* os)
 {
+  if (this->is_json())
+    {
+      Json_output_section jos;
+      jos.name = os->name();
+      jos.address = os->address();
+      jos.size = os->current_data_size();
+      jos.has_load_address = os->has_load_address();
+      jos.load_address = jos.has_load_address ? os->load_address() : 0;
+      jos.before_compression = os->requires_postprocessing();
+      jos.first_input = this->json_input_sections_.size();
+      this->json_output_sections_.push_back(jos);
+      return;
+    }
+
   this->print_memory_map_header();
 
   fprintf(this->map_file_, "\n%s", os->name());
@@ -409,4 +567,159 @@ Mapfile::print_output_section(const Output_section* os)
   putc('\n', this->map_file_);
 }
 
+// Write a string to a JSON map, escaping it as needed.
+
+void
+Mapfile::write_json_string(const char* str)
+{
+  gold::write_json_string(this->map_file_, str, strlen(str));
+}
+
+// Write the input sections FIRST to LAST of SECTIONS as the elements
+// of a JSON array.  Addresses are written as hex strings, since they
+// may not fit in a JSON number; sizes are written as numbers.
+
+void
+Mapfile::write_json_input_sections(
+    const std::vector<Json_input_section>& sections,
+    size_t first, size_t last, const char* indent)
+{
+  FILE* f = this->map_file_;
+  for (size_t i = first; i < last; ++i)
+    {
+      const Json_input_section& js(sections[i]);
+      fprintf(f, "%s{\"name\": ", indent);
+      this->write_json_string(js.name.c_str());
+      if (js.object != NULL)
+	{
+	  fprintf(f, ", \"file\": ");
+	  this->write_json_string(js.object->name().c_str());
+	  fprintf(f, ", \"index\": %u", js.shndx);
+	}
+      if (js.discard_reason == NULL && js.address != -1ULL)
+	fprintf(f, ", \"address\": \"0x%llx\"",
+		static_cast<unsigned long long>(js.address));
+      fprintf(f, ", \"size\": %llu",
+	      static_cast<unsigned long long>(js.size));
+      if (js.discard_reason != NULL)
+	{
+	  fprintf(f, ", \"reason\": \"%s\"", js.discard_reason);
+	  if (js.folded_object != NULL)
+	    {
+	      fprintf(f, ", \"folded_into\": {\"file\": ");
+	      this->write_json_string(js.folded_object->name().c_str());
+	      fprintf(f, ", \"index\": %u}", js.folded_shndx);
+	    }
+	}
+      if (js.first_symbol < js.last_symbol)
+	{
+	  fprintf(f, ", \"symbols\": [");
+	  for (size_t j = js.first_symbol; j < js.last_symbol; ++j)
+	    {
+	      const Json_symbol& sym(this->json_symbols_[j]);
+	      fprintf(f, "%s\n%s  {\"name\": ", j == js.first_symbol ? "" : ",",
+		      indent);
+	      this->write_json_string(sym.sym->name());
+	      std::string demangled_name = sym.sym->demangled_name();
+	      if (demangled_name != sym.sym->name())
+		{
+		  fprintf(f, ", \"demangled\": ");
+		  this->write_json_string(demangled_name.c_str());
+		}
+	      fprintf(f, ", \"address\": \"0x%llx\", \"size\": %llu}",
+		      static_cast<unsigned long long>(sym.value),
+		      static_cast<unsigned long long>(sym.size));
+	    }
+	  fprintf(f, "\n%s]", indent);
+	}
+      fprintf(f, "}%s\n", i + 1 < last ? "," : "");
+    }
+}
+
+// Write out the JSON map.  The information was all recorded while the
+// link was running, so this only reads the names of symbols and
+// objects, and may run while the output file is being written.
+
+void
+Mapfile::write_json()
+{
+  gold_assert(this->is_json() && !this->wrote_json_);
+  this->wrote_json_ = true;
+
+  FILE* f = this->map_file_;
+  fprintf(f, "{\n  \"archive_members\": [\n");
+  for (size_t i = 0; i < this->json_archive_members_.size(); ++i)
+    {
+      const Json_archive_member& m(this->json_archive_members_[i]);
+      fprintf(f, "    {\"member\": ");
+      this->write_json_string(m.member.c_str());
+      if (m.object != NULL)
+	{
+	  fprintf(f, ", \"file\": ");
+	  this->write_json_string(m.object->name().c_str());
+	}
+      else
+	{
+	  fprintf(f, ", \"reason\": ");
+	  this->write_json_string(m.why.c_str());
+	}
+      if (m.symbol_name != NULL)
+	{
+	  fprintf(f, ", \"symbol\": ");
+	  this->write_json_string(m.symbol_name);
+	}
+      fprintf(f, "}%s\n",
+	      i + 1 < this->json_archive_members_.size() ? "," : "");
+    }
+
+  fprintf(f, "  ],\n  \"common_symbols\": [\n");
+  for (size_t i = 0; i < this->json_commons_.size(); ++i)
+    {
+      const Json_common& c(this->json_commons_[i]);
+      fprintf(f, "    {\"name\": ");
+      this->write_json_string(c.symbol_name);
+      fprintf(f, ", \"size\": %llu, \"file\": ",
+	      static_cast<unsigned long long>(c.size));
+      this->write_json_string(c.object->name().c_str());
+      fprintf(f, "}%s\n", i + 1 < this->json_commons_.size() ? "," : "");
+    }
+
+  fprintf(f, "  ],\n  \"discarded_sections\": [\n");
+  this->write_json_input_sections(this->json_discarded_sections_, 0,
+				  this->json_discarded_sections_.size(),
+				  "    ");
+
+  fprintf(f, "  ],\n  \"output_sections\": [\n");
+  for (size_t i = 0; i < this->json_output_sections_.size(); ++i)
+    {
+      const Json_output_section& jos(this->json_output_sections_[i]);
+      fprintf(f, "    {\"name\": ");
+      this->write_json_string(jos.name);
+      fprintf(f, ", \"address\": \"0x%llx\", \"size\": %llu",
+	      static_cast<unsigned long long>(jos.address),
+	      static_cast<unsigned long long>(jos.size));
+      if (jos.has_load_address)
+	fprintf(f, ", \"load_address\": \"0x%llx\"",
+		static_cast<unsigned long long>(jos.load_address));
+      if (jos.before_compression)
+	fprintf(f, ", \"before_compression\": true");
+
+      size_t last_input = (i + 1 < this->json_output_sections_.size()
+			   ? this->json_output_sections_[i + 1].first_input
+			   : this->json_input_sections_.size());
+      fprintf(f, ", \"input_sections\": [");
+      if (jos.first_input < last_input)
+	{
+	  putc('\n', f);
+	  this->write_json_input_sections(this->json_input_sections_,
+					  jos.first_input, last_input,
+					  "      ");
+	  fprintf(f, "    ");
+	}
+      fprintf(f, "]}%s\n",
+	      i + 1 < this->json_output_sections_.size() ? "," : "");
+    }
+  fprintf(f, "  ]\n}\n");
+}
+
 } // End namespace gold.
@@ -25,12 +25,15 @@
 
 #include <cstdio>
 #include <string>
+#include <vector>
 
 namespace gold
 {
 
 class Archive;
 class Symbol;
+class Symbol_table;
+class Object;
 class Relobj;
 template<int size, bool big_endian>
 class Sized_relobj_file;
@@ -42,7 +45,16 @@ class Output_data;
 class Mapfile
 {
  public:
-  Mapfile();
+  // The format of the map file.
+  enum Format
+  {
+    // Text in the style of GNU ld.
+    FORMAT_TEXT,
+    // A JSON document, for tools.
+    FORMAT_JSON
+  };
+
+  Mapfile(Format format = FORMAT_TEXT);
 
   ~Mapfile();
 
@@ -59,6 +71,14 @@ class Mapfile
   file()
   { return this->map_file_; }
 
+  // Return whether we are writing a JSON map.  The information is
+  // collected while the map is printed, and written out by
+  // write_json, which may run in parallel with writing the output
+  // file.
+  bool
+  is_json() const
+  { return this->format_ == FORMAT_JSON; }
+
   // Report that we are including a member from an archive.  This is
   // called by the archive reading code.
   void
@@ -69,9 +89,10 @@ class Mapfile
   void
   report_allocate_common(const Symbol*, uint64_t symsize);
 
-  // Print discarded input sections.
+  // Print discarded input sections.  SYMTAB is used to say why a
+  // section was discarded.
   void
-  print_discarded_sections(const Input_objects*);
+  print_discarded_sections(const Input_objects*, Symbol_table* symtab);
 
   // Print an output section.
   void
@@ -85,7 +106,79 @@ class Mapfile
   void
   print_output_data(const Output_data*, const char* name);
 
+  // Write out the JSON map.  This only uses what was recorded by the
+  // functions above, so it does not need to lock any object.
+  void
+  write_json();
+
  private:
+  // An archive member recorded for the JSON map.  A symbol may be
+  // resolved to a different object later, so we record names rather
+  // than symbols.
+  struct Json_archive_member
+  {
+    std::string member;
+    // The name of the symbol which caused the member to be included,
+    // or NULL.
+    const char* symbol_name;
+    // The object which referred to the symbol, or NULL.
+    const Object* object;
+    // Why the member was included when OBJECT is NULL.
+    std::string why;
+  };
+
+  // A common symbol recorded for the JSON map.
+  struct Json_common
+  {
+    const char* symbol_name;
+    uint64_t size;
+    const Object* object;
+  };
+
+  // A symbol recorded for the JSON map.
+  struct Json_symbol
+  {
+    const Symbol* sym;
+    uint64_t value;
+    uint64_t size;
+  };
+
+  // An input section, or linker created data, recorded for the JSON
+  // map.
+  struct Json_input_section
+  {
+    std::string name;
+    // The object, or NULL for linker created data.
+    const Object* object;
+    unsigned int shndx;
+    uint64_t address;
+    uint64_t size;
+    // Why the section was discarded, or NULL if it was kept.
+    const char* discard_reason;
+    // For a section folded by --icf, the section it was folded into.
+    const Object* folded_object;
+    unsigned int folded_shndx;
+    // The symbols defined in the section, as a range of json_symbols_.
+    size_t first_symbol;
+    size_t last_symbol;
+  };
+
+  // An output section recorded for the JSON map.
+  struct Json_output_section
+  {
+    const char* name;
+    uint64_t address;
+    uint64_t size;
+    bool has_load_address;
+    uint64_t load_address;
+    bool before_compression;
+    // The index in json_input_sections_ of the first input section.
+    // The input sections run up to the first input section of the
+    // next output section.
+    size_t first_input;
+  };
+
+
   // The space we allow for a section name.
   static const size_t section_name_map_length;
 
@@ -103,6 +196,17 @@ class Mapfile
   print_input_section_symbols(const Sized_relobj_file<size, big_endian>*,
 			      unsigned int shndx);
 
+  // Write a JSON string.
+  void
+  write_json_string(const char*);
+
+  // Write a JSON array of input sections.
+  void
+  write_json_input_sections(const std::vector<Json_input_section>&,
+			    size_t first, size_t last, const char* indent);
+
+  // The format we are writing.
+  Format format_;
   // Map file to write to.
   FILE* map_file_;
   // Whether we have printed the archive member header.
@@ -111,6 +215,15 @@ class Mapfile
   bool printed_common_header_;
   // Whether we have printed the memory map header.
   bool printed_memory_map_header_;
+  // Whether write_json has been called.
+  bool wrote_json_;
+  // Information recorded for the JSON map.
+  std::vector<Json_archive_member> json_archive_members_;
+  std::vector<Json_common> json_commons_;
+  std::vector<Json_input_section> json_discarded_sections_;
+  std::vector<Json_input_section> json_input_sections_;
+  std::vector<Json_output_section> json_output_sections_;
+  std::vector<Json_symbol> json_symbols_;
 };
 
 } // End namespace gold.
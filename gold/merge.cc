@@ -23,8 +23,12 @@
 #include "gold.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
 
+#include "parameters.h"
+#include "options.h"
+#include "timer.h"
 #include "merge.h"
 #include "compressed_output.h"
 
@@ -439,53 +443,92 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
 						     unsigned int shndx)
 {
   section_size_type sec_len;
-  bool is_new;
-  const unsigned char* pdata = object->decompressed_section_contents(shndx,
-								     &sec_len,
-								     &is_new);
-
-  const Char_type* p = reinterpret_cast<const Char_type*>(pdata);
-  const Char_type* pend = p + sec_len / sizeof(Char_type);
-  const Char_type* pend0 = pend;
+  if (!object->section_is_compressed(shndx, &sec_len))
+    sec_len = convert_to_section_size_type(object->section_size(shndx));
 
   if (sec_len % sizeof(Char_type) != 0)
     {
       object->error(_("mergeable string section length not multiple of "
 		      "character size"));
-      if (is_new)
-	delete[] pdata;
       return false;
     }
 
-  if (pend[-1] != 0)
+  Merged_strings_list* merged_strings_list =
+      new Merged_strings_list(object, shndx, sec_len);
+  this->merged_strings_lists_.push_back(merged_strings_list);
+
+  // When using threads, leave the strings to be read in parallel
+  // with those of other input sections.
+  if (parameters->options().threads())
+    this->deferred_lists_.push_back(merged_strings_list);
+  else
+    {
+      this->read_strings(merged_strings_list, false);
+      this->add_strings(merged_strings_list);
+    }
+
+  // For script processing, we keep the input sections.
+  if (this->keeps_input_sections())
+    record_input_section(object, shndx);
+
+  return true;
+}
+
+// Find the strings in an input section, recording their offsets in
+// the merged_strings list along with their hash codes.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::read_strings(
+    Merged_strings_list* merged_strings_list,
+    bool copy)
+{
+  Timer timer;
+  timer.start();
+
+  Relobj* object = merged_strings_list->object;
+  section_size_type sec_len;
+  bool is_new;
+  const unsigned char* pdata =
+    object->decompressed_section_contents(merged_strings_list->shndx,
+					  &sec_len, &is_new);
+  if (copy && !is_new)
+    {
+      unsigned char* pcopy = new unsigned char[sec_len];
+      memcpy(pcopy, pdata, sec_len);
+      pdata = pcopy;
+      is_new = true;
+    }
+  merged_strings_list->contents = pdata;
+  merged_strings_list->contents_is_new = is_new;
+
+  const Char_type* p = reinterpret_cast<const Char_type*>(pdata);
+  const Char_type* pend = p + sec_len / sizeof(Char_type);
+  const Char_type* pend0 = pend;
+
+  if (sec_len > 0 && pend[-1] != 0)
     {
-      gold_warning(_("%s: last entry in mergeable string section '%s' "
-		     "not null terminated"),
-		   object->name().c_str(),
-		   object->section_name(shndx).c_str());
+      merged_strings_list->is_unterminated = true;
       // Find the end of the last NULL-terminated string in the buffer.
       while (pend0 > p && pend0[-1] != 0)
 	--pend0;
     }
 
-  Merged_strings_list* merged_strings_list =
-      new Merged_strings_list(object, shndx);
-  this->merged_strings_lists_.push_back(merged_strings_list);
   Merged_strings& merged_strings = merged_strings_list->merged_strings;
+  std::vector<size_t>& hash_codes = merged_strings_list->hash_codes;
 
-  // Count the number of non-null strings in the section and size the list.
+  // Count the number of strings in the section and size the lists.
   size_t count = 0;
   const Char_type* pt = p;
   while (pt < pend0)
     {
-      size_t len = string_length(pt);
-      if (len != 0)
-	++count;
-      pt += len + 1;
+      pt += string_length(pt) + 1;
+      ++count;
     }
   if (pend0 < pend)
     ++count;
   merged_strings.reserve(count + 1);
+  hash_codes.reserve(count);
 
   // The index I is in bytes, not characters.
   section_size_type i = 0;
@@ -493,8 +536,6 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   // We assume here that the beginning of the section is correctly
   // aligned, so each string within the section must retain the same
   // modulo.
-  uintptr_t init_align_modulo = (reinterpret_cast<uintptr_t>(pdata)
-				 & (this->addralign() - 1));
   bool has_misaligned_strings = false;
 
   while (p < pend)
@@ -502,15 +543,12 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
       size_t len = p < pend0 ? string_length(p) : pend - p;
 
       // Within merge input section each string must be aligned.
-      if (len != 0
-	  && ((reinterpret_cast<uintptr_t>(p) & (this->addralign() - 1))
-	      != init_align_modulo))
-	  has_misaligned_strings = true;
-
-      Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
+      if (len != 0 && (i & (this->addralign() - 1)) != 0)
+	has_misaligned_strings = true;
 
-      merged_strings.push_back(Merged_string(i, key));
+      merged_strings.push_back(Merged_string(i, 0));
+      hash_codes.push_back(Stringpool_template<Char_type>::hash_string(p,
+								       len));
       p += len + 1;
       i += (len + 1) * sizeof(Char_type);
     }
@@ -519,23 +557,89 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   // compute the length of the last string.
   merged_strings.push_back(Merged_string(i, 0));
 
+  merged_strings_list->has_misaligned_strings = has_misaligned_strings;
+  merged_strings_list->read_time = timer.get_elapsed_time().wall;
+  merged_strings_list->is_read = true;
+}
+
+// Add the strings found by read_strings to the Stringpool, and free
+// the section contents.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::add_strings(
+    Merged_strings_list* merged_strings_list)
+{
+  Timer timer;
+  timer.start();
+
+  Relobj* object = merged_strings_list->object;
+  unsigned int shndx = merged_strings_list->shndx;
+  const unsigned char* pdata = merged_strings_list->contents;
+  const Char_type* pbase = reinterpret_cast<const Char_type*>(pdata);
+  Merged_strings& merged_strings = merged_strings_list->merged_strings;
+  const std::vector<size_t>& hash_codes = merged_strings_list->hash_codes;
+  gold_assert(merged_strings.size() == hash_codes.size() + 1);
+
+  if (merged_strings_list->is_unterminated)
+    gold_warning(_("%s: last entry in mergeable string section '%s' "
+		   "not null terminated"),
+		 object->name().c_str(),
+		 object->section_name(shndx).c_str());
+
+  section_size_type i = 0;
+  size_t count = 0;
+  for (size_t j = 0; j < hash_codes.size(); ++j)
+    {
+      section_size_type next = merged_strings[j + 1].offset;
+      size_t len = (next - i) / sizeof(Char_type) - 1;
+      if (len != 0)
+	++count;
+
+      Stringpool::Key key;
+      this->stringpool_.add_with_length_and_hash(pbase + i / sizeof(Char_type),
+						 len, hash_codes[j], true,
+						 &key);
+      merged_strings[j].stringpool_key = key;
+      i = next;
+    }
+
   this->input_count_ += count;
   this->input_size_ += i;
 
-  if (has_misaligned_strings)
+  if (merged_strings_list->has_misaligned_strings)
     gold_warning(_("%s: section %s contains incorrectly aligned strings;"
 		   " the alignment of those strings won't be preserved"),
 		 object->name().c_str(),
 		 object->section_name(shndx).c_str());
 
-  // For script processing, we keep the input sections.
-  if (this->keeps_input_sections())
-    record_input_section(object, shndx);
-
-  if (is_new)
+  if (merged_strings_list->contents_is_new)
     delete[] pdata;
+  merged_strings_list->contents = NULL;
+  std::vector<size_t>().swap(merged_strings_list->hash_codes);
 
-  return true;
+  this->read_time_ += merged_strings_list->read_time;
+  this->add_time_ += timer.get_elapsed_time().wall;
+}
+
+// Add the strings of all the deferred input sections, in the order
+// in which the input sections were added.
+
+template<typename Char_type>
+void
+Output_merge_string<Char_type>::do_add_deferred_input_sections()
+{
+  while (this->deferred_added_ < this->deferred_lists_.size()
+	 && this->deferred_lists_[this->deferred_added_]->is_read)
+    {
+      this->add_strings(this->deferred_lists_[this->deferred_added_]);
+      ++this->deferred_added_;
+    }
+  if (this->deferred_added_ == this->deferred_lists_.size())
+    {
+      this->deferred_lists_.clear();
+      this->deferred_added_ = 0;
+    }
 }
 
 // Finalize the mappings from the input sections to the output
@@ -545,6 +649,11 @@ template<typename Char_type>
 section_size_type
 Output_merge_string<Char_type>::finalize_merged_data()
 {
+  gold_assert(this->deferred_lists_.empty());
+
+  Timer timer;
+  timer.start();
+
   this->stringpool_.set_string_offsets();
 
   for (typename Merged_strings_lists::const_iterator l =
@@ -581,6 +690,8 @@ Output_merge_string<Char_type>::finalize_merged_data()
   // finds a better alignment.
   this->merged_strings_lists_.clear();
 
+  this->finalize_time_ += timer.get_elapsed_time().wall;
+
   return this->stringpool_.get_strtab_size();
 }
 
@@ -654,6 +765,12 @@ Output_merge_string<Char_type>::do_print_merge_stats(const char* section_name)
 	  program_name, buf, this->input_size_);
   fprintf(stderr, _("%s: %s input strings: %zu\n"),
 	  program_name, buf, this->input_count_);
+  fprintf(stderr, _("%s: %s merge time: read %ld.%03ld, add %ld.%03ld, "
+		    "finalize %ld.%03ld\n"),
+	  program_name, buf,
+	  this->read_time_ / 1000, this->read_time_ % 1000,
+	  this->add_time_ / 1000, this->add_time_ % 1000,
+	  this->finalize_time_ / 1000, this->finalize_time_ % 1000);
   this->stringpool_.print_stats(buf);
 }
 
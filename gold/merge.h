@@ -235,7 +235,41 @@ class Output_merge_base : public Output_section_data
     gold_assert(this->keeps_input_sections_);
     return this->input_sections_.end();
   }
- 
+
+  // When using threads, merged string sections do not read the
+  // strings of an input section when it is added.  Instead the input
+  // sections are read and their strings hashed in parallel, in
+  // batches of files, once all input sections have been added; see
+  // Layout::add_deferred_merge_strings.
+
+  // Return the number of input sections which have not been read.
+  size_t
+  deferred_input_section_count() const
+  { return this->do_deferred_input_section_count(); }
+
+  // Return the object of deferred input section I.
+  Relobj*
+  deferred_input_section_object(size_t i) const
+  { return this->do_deferred_input_section_object(i); }
+
+  // Return the size of deferred input section I, uncompressed.
+  section_size_type
+  deferred_input_section_size(size_t i) const
+  { return this->do_deferred_input_section_size(i); }
+
+  // Read deferred input section I.  The object must be locked.  This
+  // may be called in parallel for input sections in different files.
+  void
+  read_deferred_input_section(size_t i)
+  { this->do_read_deferred_input_section(i); }
+
+  // Add the data read from the deferred input sections, in order,
+  // up to the first one which has not been read yet.  This may be
+  // called in parallel for different merge sections.
+  void
+  add_deferred_input_sections()
+  { this->do_add_deferred_input_sections(); }
+
  protected:
   // Return the output offset for an input offset.
   bool
@@ -253,6 +287,28 @@ class Output_merge_base : public Output_section_data
   do_set_keeps_input_sections()
   { this->keeps_input_sections_ = true; }
 
+  // These may be overridden by the child class if it defers reading
+  // input sections.
+  virtual size_t
+  do_deferred_input_section_count() const
+  { return 0; }
+
+  virtual Relobj*
+  do_deferred_input_section_object(size_t) const
+  { gold_unreachable(); }
+
+  virtual section_size_type
+  do_deferred_input_section_size(size_t) const
+  { gold_unreachable(); }
+
+  virtual void
+  do_read_deferred_input_section(size_t)
+  { gold_unreachable(); }
+
+  virtual void
+  do_add_deferred_input_sections()
+  { }
+
   // Record the merged input section for script processing.
   void
   record_input_section(Relobj* relobj, unsigned int shndx);
@@ -402,7 +458,9 @@ class Output_merge_string : public Output_merge_base
  public:
   Output_merge_string(uint64_t addralign)
     : Output_merge_base(sizeof(Char_type), addralign), stringpool_(addralign),
-      merged_strings_lists_(), input_count_(0), input_size_(0)
+      merged_strings_lists_(), deferred_lists_(), deferred_added_(0),
+      input_count_(0),
+      input_size_(0), read_time_(0), add_time_(0), finalize_time_(0)
   {
     this->stringpool_.set_no_zero_null();
   }
@@ -461,6 +519,30 @@ class Output_merge_string : public Output_merge_base
     Output_merge_base::do_set_keeps_input_sections();
   }
 
+  // Return the number of input sections which have not been read.
+  size_t
+  do_deferred_input_section_count() const
+  { return this->deferred_lists_.size(); }
+
+  // Return the object of deferred input section I.
+  Relobj*
+  do_deferred_input_section_object(size_t i) const
+  { return this->deferred_lists_[i]->object; }
+
+  // Return the size of deferred input section I.
+  section_size_type
+  do_deferred_input_section_size(size_t i) const
+  { return this->deferred_lists_[i]->size; }
+
+  // Read deferred input section I.
+  void
+  do_read_deferred_input_section(size_t i)
+  { this->read_strings(this->deferred_lists_[i], true); }
+
+  // Add the strings of the deferred input sections.
+  void
+  do_add_deferred_input_sections();
+
  private:
   // The name of the string type, for stats.
   const char*
@@ -488,25 +570,69 @@ class Output_merge_string : public Output_merge_base
     Relobj* object;
     // The input section in the input object.
     unsigned int shndx;
+    // The size of the input section, uncompressed.
+    section_size_type size;
     // The list of merged strings.
     Merged_strings merged_strings;
-
-    Merged_strings_list(Relobj* objecta, unsigned int shndxa)
-      : object(objecta), shndx(shndxa), merged_strings()
+    // The following fields hold the results of read_strings until
+    // add_strings is called.  The contents of the input section.
+    const unsigned char* contents;
+    // Whether CONTENTS must be freed.
+    bool contents_is_new;
+    // Whether the last string in the input section is not null
+    // terminated.
+    bool is_unterminated;
+    // Whether the input section contains misaligned strings.
+    bool has_misaligned_strings;
+    // The hash code of each string in MERGED_STRINGS.
+    std::vector<size_t> hash_codes;
+    // The time taken by read_strings.
+    long read_time;
+    // Whether read_strings has been called.
+    bool is_read;
+
+    Merged_strings_list(Relobj* objecta, unsigned int shndxa,
+			section_size_type sizea)
+      : object(objecta), shndx(shndxa), size(sizea), merged_strings(),
+	contents(NULL),
+	contents_is_new(false), is_unterminated(false),
+	has_misaligned_strings(false), hash_codes(),
+	read_time(0), is_read(false)
     { }
   };
 
   typedef std::vector<Merged_strings_list*> Merged_strings_lists;
 
+  // Find the strings in an input section and compute their hash
+  // codes.  If COPY is true, keep a copy of the section contents,
+  // since the object will be unlocked before add_strings is called.
+  void
+  read_strings(Merged_strings_list*, bool copy);
+
+  // Add the strings found by read_strings to the Stringpool.
+  void
+  add_strings(Merged_strings_list*);
+
   // As we see the strings, we add them to a Stringpool.
   Stringpool_template<Char_type> stringpool_;
   // Map from a location in an input object to an entry in the
   // Stringpool.
   Merged_strings_lists merged_strings_lists_;
+  // The entries in merged_strings_lists_ which were not read when
+  // they were added.
+  Merged_strings_lists deferred_lists_;
+  // The number of entries in deferred_lists_ which have been added to
+  // the Stringpool.
+  size_t deferred_added_;
   // The number of entries seen in input files.
   size_t input_count_;
   // The total size of input sections.
   size_t input_size_;
+  // Time spent reading and hashing input strings, adding them to the
+  // Stringpool, and finalizing, in milliseconds, for --stats.
+  long read_time_;
+  long add_time_;
+  long finalize_time_;
 };
 
 } // End namespace gold.
@@ -42,6 +42,7 @@
 #include "compressed_output.h"
 #include "incremental.h"
 #include "merge.h"
+#include "ehframe.h"
 
 namespace gold
 {
@@ -61,6 +62,8 @@ Read_symbols_data::~Read_symbols_data()
     delete this->symbols;
   if (this->symbol_names != NULL)
     delete this->symbol_names;
+  if (this->symbol_name_infos != NULL)
+    delete this->symbol_name_infos;
   if (this->versym != NULL)
     delete this->versym;
   if (this->verdef != NULL)
@@ -477,6 +480,8 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
     kept_comdat_sections_(),
     has_eh_frame_(false),
     discarded_eh_frame_shndx_(-1U),
+    eh_frame_input_(NULL),
+    eh_frame_input_shndx_(0),
     is_deferred_layout_(false),
     deferred_layout_(),
     deferred_layout_relocs_(),
@@ -488,6 +493,7 @@ Sized_relobj_file<size, big_endian>::Sized_relobj_file(
 template<int size, bool big_endian>
 Sized_relobj_file<size, big_endian>::~Sized_relobj_file()
 {
+  delete this->eh_frame_input_;
 }
 
 // Set up an object file based on the file header.  This sets up the
@@ -663,6 +669,70 @@ Sized_relobj_file<size, big_endian>::find_eh_frame(
     }
 }
 
+// Read the CIEs and FDEs of the first GNU .eh_frame section.  This
+// runs while reading the symbols, which may happen in parallel, so
+// that the layout, which is serialized, only has to decide which FDEs
+// to keep.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::read_eh_frame(
+    const unsigned char* pshdrs,
+    const char* names,
+    section_size_type names_size,
+    const unsigned char* symbols,
+    section_size_type symbols_size,
+    const unsigned char* symbol_names,
+    section_size_type symbol_names_size)
+{
+  if (!this->has_eh_frame_
+      || parameters->options().relocatable()
+      || parameters->incremental())
+    return;
+
+  const unsigned char* s = NULL;
+  while (1)
+    {
+      s = this->template find_shdr<size, big_endian>(pshdrs, ".eh_frame",
+						     names, names_size, s);
+      if (s == NULL)
+	return;
+      typename This::Shdr shdr(s);
+      if (this->check_eh_frame_flags(&shdr))
+	break;
+    }
+  const unsigned int shndx = (s - pshdrs) / This::shdr_size;
+
+  // Find the reloc section, using -1U if there is more than one, as
+  // do_layout does.
+  const unsigned int shnum = this->shnum();
+  unsigned int reloc_shndx = 0;
+  unsigned int reloc_type = elfcpp::SHT_NULL;
+  const unsigned char* p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      unsigned int sh_type = shdr.get_sh_type();
+      if ((sh_type == elfcpp::SHT_REL || sh_type == elfcpp::SHT_RELA)
+	  && this->adjust_shndx(shdr.get_sh_info()) == shndx)
+	{
+	  if (reloc_shndx != 0)
+	    reloc_shndx = -1U;
+	  else
+	    {
+	      reloc_shndx = i;
+	      reloc_type = sh_type;
+	    }
+	}
+    }
+
+  this->eh_frame_input_ =
+    Eh_frame::read_ehframe_input_section(this, symbols, symbols_size,
+					 symbol_names, symbol_names_size,
+					 shndx, reloc_shndx, reloc_type);
+  this->eh_frame_input_shndx_ = shndx;
+}
+
 // Return TRUE if this is a section whose contents will be needed in the
 // Add_symbols task.  This function is only called for sections that have
 // already passed the test in is_compressed_debug_section() and the debug
@@ -682,12 +752,14 @@ need_decompressed_section(const char* name)
       // We will need .zdebug_str if this is not an incremental link
       // (i.e., we are processing string merge sections) or if we need
       // to build a gdb index.
-      if ((!parameters->incremental() || parameters->options().gdb_index())
+      if ((!parameters->incremental()
+	   || parameters->options().scan_debug_info())
 	  && strcmp(name, "str") == 0)
 	return true;
 
-      // We will need these other sections when building a gdb index.
-      if (parameters->options().gdb_index()
+      // We will need these other sections when building a gdb index
+      // or a .debug_names section.
+      if (parameters->options().scan_debug_info()
 	  && (strcmp(name, "info") == 0
 	      || strcmp(name, "types") == 0
 	      || strcmp(name, "pubnames") == 0
@@ -703,7 +775,7 @@ need_decompressed_section(const char* name)
   // Otherwise, we would decompress the section twice: once for
   // string merge processing, and once for building the gdb index.
   if (!parameters->incremental()
-      && parameters->options().gdb_index()
+      && parameters->options().scan_debug_info()
       && strcmp(name, "str") == 0)
     return true;
 
@@ -815,7 +887,7 @@ Sized_relobj_file<size, big_endian>::do_find_special_sections(
 
   return (this->has_eh_frame_
 	  || (!parameters->options().relocatable()
-	      && parameters->options().gdb_index()
+	      && parameters->options().scan_debug_info()
 	      && (memmem(names, sd->section_names_size, "debug_info", 11) == 0
 		  || memmem(names, sd->section_names_size,
 			    "debug_types", 12) == 0)));
@@ -918,6 +990,22 @@ Sized_relobj_file<size, big_endian>::base_read_symbols(Read_symbols_data* sd)
   sd->symbol_names = fvstrtab;
   sd->symbol_names_size =
     convert_to_section_size_type(strtabshdr.get_sh_size());
+
+  // Do as much of the work of adding the symbols to the symbol table
+  // as we can now, since this may run in parallel.
+  sd->symbol_name_infos = new Symbol_name_infos();
+  Symbol_table::compute_symbol_name_infos<size, big_endian>(
+      fvsymtab->data() + sd->external_symbols_offset,
+      extsize / sym_size,
+      reinterpret_cast<const char*>(fvstrtab->data()),
+      sd->symbol_names_size,
+      sd->symbol_name_infos);
+
+  // Likewise read the exception frame information.
+  this->read_eh_frame(pshdrs,
+		      reinterpret_cast<const char*>(sd->section_names->data()),
+		      sd->section_names_size, fvsymtab->data(), readsize,
+		      fvstrtab->data(), sd->symbol_names_size);
 }
 
 // Return the section index of symbol SYM.  Set *VALUE to its value in
@@ -1770,11 +1858,12 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
 	  this->layout_section(layout, i, name, shdr, reloc_shndx[i],
 			       reloc_type[i]);
 
-	  // When generating a .gdb_index section, we do additional
-	  // processing of .debug_info and .debug_types sections after all
-	  // the other sections for the same reason as above.
+	  // When generating a .gdb_index or .debug_names section, we do
+	  // additional processing of .debug_info and .debug_types
+	  // sections after all the other sections for the same reason as
+	  // above.
 	  if (!relocatable
-	      && parameters->options().gdb_index()
+	      && parameters->options().scan_debug_info()
 	      && !(shdr.get_sh_flags() & elfcpp::SHF_ALLOC))
 	    {
 	      if (strcmp(name, ".debug_info") == 0
@@ -1866,8 +1955,8 @@ Sized_relobj_file<size, big_endian>::do_layout(Symbol_table* symtab,
       out_section_offsets[i] = invalid_address;
     }
 
-  // When building a .gdb_index section, scan the .debug_info and
-  // .debug_types sections.
+  // When building a .gdb_index or .debug_names section, scan the
+  // .debug_info and .debug_types sections.
   gold_assert(!is_pass_one
 	      || (debug_info_sections.empty() && debug_types_sections.empty()));
   for (std::vector<unsigned int>::const_iterator p
@@ -2020,10 +2109,13 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
 
   const char* sym_names =
     reinterpret_cast<const char*>(sd->symbol_names->data());
+  gold_assert(sd->symbol_name_infos != NULL
+	      && sd->symbol_name_infos->size() == symcount);
   symtab->add_from_relobj(this,
 			  sd->symbols->data() + sd->external_symbols_offset,
 			  symcount, this->local_symbol_count_,
 			  sym_names, sd->symbol_names_size,
+			  *sd->symbol_name_infos,
 			  &this->symbols_,
 			  &this->defined_count_);
 
@@ -2031,6 +2123,8 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
   sd->symbols = NULL;
   delete sd->symbol_names;
   sd->symbol_names = NULL;
+  delete sd->symbol_name_infos;
+  sd->symbol_name_infos = NULL;
 }
 
 // Find out if this object, that is a member of a lib group, should be included
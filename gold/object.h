@@ -48,18 +48,49 @@ class Pluginobj;
 class Dynobj;
 class Object_merge_map;
 class Relocatable_relocs;
+class Eh_frame_input;
 struct Symbols_data;
 
 template<typename Stringpool_char>
 class Stringpool_template;
 
+// Information about the name of a global symbol in a relocatable
+// object.  None of this depends on the symbol table, so it is
+// computed by read_symbols(), which runs in parallel for different
+// objects, rather than by add_symbols(), which must run in order.
+
+struct Symbol_name_info
+{
+  Symbol_name_info()
+    : name_hash(0), version_hash(0), name_length(0), version_offset(0),
+      version_length(0), is_default_version(false)
+  { }
+
+  // The Stringpool hash code of the name, not including any version.
+  size_t name_hash;
+  // The Stringpool hash code of the version, if there is one.
+  size_t version_hash;
+  // The length of the name, not including any version.
+  unsigned int name_length;
+  // If the name is of the form foo@VERSION or foo@@VERSION, the
+  // offset of VERSION from the start of the name.  Otherwise zero.
+  unsigned int version_offset;
+  // The length of VERSION.
+  unsigned int version_length;
+  // Whether the name is of the form foo@@VERSION.
+  bool is_default_version;
+};
+
+typedef std::vector<Symbol_name_info> Symbol_name_infos;
+
 // Data to pass from read_symbols() to add_symbols().
 
 struct Read_symbols_data
 {
   Read_symbols_data()
     : section_headers(NULL), section_names(NULL), symbols(NULL),
-      symbol_names(NULL), versym(NULL), verdef(NULL), verneed(NULL)
+      symbol_names(NULL), symbol_name_infos(NULL), versym(NULL),
+      verdef(NULL), verneed(NULL)
   { }
 
   ~Read_symbols_data();
@@ -82,6 +113,10 @@ struct Read_symbols_data
   File_view* symbol_names;
   // Size of symbol name data in bytes.
   section_size_type symbol_names_size;
+  // Precomputed information about the names of the external symbols,
+  // one entry per external symbol.  This is only used on relocatable
+  // objects.
+  Symbol_name_infos* symbol_name_infos;
 
   // Version information.  This is only used on dynamic objects.
   // Version symbol data (from SHT_GNU_versym section).
@@ -112,7 +147,7 @@ struct Symbol_location_info
 struct Section_relocs
 {
   Section_relocs()
-    : contents(NULL)
+    : contents(NULL), is_prescanned(false), pending()
   { }
 
   ~Section_relocs()
@@ -134,6 +169,11 @@ struct Section_relocs
   bool needs_special_offset_handling;
   // Whether the data section is allocated (has the SHF_ALLOC flag set).
   bool is_data_section_allocated;
+  // Whether the target prescanned the relocs.  If it did, PENDING
+  // holds the relocs which the target still needs to scan.
+  bool is_prescanned;
+  // The relocs which prescanning did not rule out, in order.
+  std::vector<unsigned char> pending;
 };
 
 // Relocations in an object file.  This is read in read_relocs and
@@ -1150,6 +1190,12 @@ class Relobj : public Object
   gc_process_relocs(Symbol_table* symtab, Layout* layout, Read_relocs_data* rd)
   { return this->do_gc_process_relocs(symtab, layout, rd); }
 
+  // Prescan the relocs, to find the ones which scan_relocs can skip.
+  // This may run in parallel for different objects.
+  void
+  prescan_relocs(Symbol_table* symtab, Read_relocs_data* rd)
+  { return this->do_prescan_relocs(symtab, rd); }
+
   // Scan the relocs and adjust the symbol table.
   void
   scan_relocs(Symbol_table* symtab, Layout* layout, Read_relocs_data* rd)
@@ -1389,6 +1435,11 @@ class Relobj : public Object
   virtual void
   do_gc_process_relocs(Symbol_table*, Layout*, Read_relocs_data*) = 0;
 
+  // Prescan the relocs--may be implemented by child class.
+  virtual void
+  do_prescan_relocs(Symbol_table*, Read_relocs_data*)
+  { }
+
   // Scan the relocs--implemented by child class.
   virtual void
   do_scan_relocs(Symbol_table*, Layout*, Read_relocs_data*) = 0;
@@ -2206,6 +2257,20 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   symbol_count() const
   { return this->local_symbol_count_ + this->symbols_.size(); }
 
+  // If the .eh_frame section SHNDX was read along with the symbols,
+  // set *INPUT to what was found there, or to NULL if it could not be
+  // parsed, and return true.  The caller takes ownership of *INPUT.
+  bool
+  release_eh_frame_input(unsigned int shndx, Eh_frame_input** input)
+  {
+    if (shndx == 0 || shndx != this->eh_frame_input_shndx_)
+      return false;
+    *input = this->eh_frame_input_;
+    this->eh_frame_input_ = NULL;
+    this->eh_frame_input_shndx_ = 0;
+    return true;
+  }
+
   // If SYM is the index of a global symbol in the object file's
   // symbol table, return the Symbol object.  Otherwise, return NULL.
   Symbol*
@@ -2407,6 +2472,10 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   void
   do_gc_process_relocs(Symbol_table*, Layout*, Read_relocs_data*);
 
+  // Prescan the relocs to find the ones which do not need scanning.
+  void
+  do_prescan_relocs(Symbol_table*, Read_relocs_data*);
+
   // Scan the relocs and adjust the symbol table.
   void
   do_scan_relocs(Symbol_table*, Layout*, Read_relocs_data*);
@@ -2621,6 +2690,15 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   find_eh_frame(const unsigned char* pshdrs, const char* names,
 		section_size_type names_size) const;
 
+  // Read the CIEs and FDEs of the .eh_frame section while reading the
+  // symbols.
+  void
+  read_eh_frame(const unsigned char* pshdrs, const char* names,
+		section_size_type names_size, const unsigned char* symbols,
+		section_size_type symbols_size,
+		const unsigned char* symbol_names,
+		section_size_type symbol_names_size);
+
   // Whether to include a section group in the link.
   bool
   include_section_group(Symbol_table*, Layout*, unsigned int, const char*,
@@ -2845,6 +2923,12 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   // If this object has a GNU style .eh_frame section that is discarded in
   // output, record the index here.  Otherwise it is -1U.
   unsigned int discarded_eh_frame_shndx_;
+  // The CIEs and FDEs read from the .eh_frame section
+  // eh_frame_input_shndx_ while reading the symbols, or NULL if the
+  // section could not be parsed.  eh_frame_input_shndx_ is 0 if no
+  // section was read.
+  Eh_frame_input* eh_frame_input_;
+  unsigned int eh_frame_input_shndx_;
   // True if the layout of this object was deferred, waiting for plugin
   // replacement files.
   bool is_deferred_layout_;
@@ -39,6 +39,7 @@
 #include "target-select.h"
 #include "options.h"
 #include "plugin.h"
+#include "link-cache.h"
 
 namespace gold
 {
@@ -1259,6 +1260,7 @@ General_options::finalize()
       if (!in)
 	gold_fatal(_("unable to open -retain-symbols-file file %s: %s"),
 		   this->retain_symbols_file(), strerror(errno));
+      record_link_cache_input(this->retain_symbols_file());
       std::string line;
       std::getline(in, line);   // this chops off the trailing \n, if any
       while (in)
@@ -1310,6 +1312,11 @@ General_options::finalize()
   if (this->relocatable() && this->retain_symbols_file())
     gold_fatal(_("-retain-symbols-file does not yet work with -r"));
 
+  if (this->call_graph_ordering_file() != NULL
+      && this->section_ordering_file() != NULL)
+    gold_fatal(_("--call-graph-ordering-file and --section-ordering-file "
+		 "are incompatible"));
+
   if (this->oformat_enum() != General_options::OBJECT_FORMAT_ELF
       && (this->shared()
 	  || this->pie()
@@ -1359,6 +1366,43 @@ General_options::finalize()
 			 "incremental link"));
 	  this->set_compress_debug_sections("none");
 	}
+      if (this->debug_names())
+	{
+	  gold_warning(_("ignoring --debug-names for an incremental link"));
+	  this->set_debug_names(false);
+	}
+    }
+
+  // A link found in the link cache does not run far enough to
+  // produce anything but the output file, and the output file must be
+  // determined by the inputs.
+  if (this->link_cache() != NULL)
+    {
+      const char* option = NULL;
+      if (this->incremental_mode_ != INCREMENTAL_OFF)
+	option = "--incremental";
+      else if (strcmp(this->output_file_name(), "-") == 0)
+	option = "-o -";
+      else if (this->user_set_build_id()
+	       && strcmp(this->build_id(), "uuid") == 0)
+	option = "--build-id=uuid";
+      else if (this->user_set_Map())
+	option = "-Map";
+      else if (this->cref())
+	option = "--cref";
+      else if (this->user_set_print_symbol_counts())
+	option = "--print-symbol-counts";
+      else if (this->print_gc_sections())
+	option = "--print-gc-sections";
+      else if (this->print_icf_sections())
+	option = "--print-icf-sections";
+      else if (this->print_output_format())
+	option = "--print-output-format";
+      if (option != NULL)
+	{
+	  gold_warning(_("ignoring --link-cache with %s"), option);
+	  this->set_link_cache(NULL);
+	}
     }
 
   // --rosegment-gap implies --rosegment.
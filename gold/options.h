@@ -720,7 +720,8 @@ class General_options
 
   DEFINE_uint64(build_id_chunk_size_for_treehash,
 		options::TWO_DASHES, '\0', 2 << 20,
-		N_("Chunk size for '--build-id=tree'"), N_("SIZE"));
+		N_("Chunk size for '--build-id=tree' and '--build-id=fast'"),
+		N_("SIZE"));
 
   DEFINE_uint64(build_id_min_file_size_for_treehash, options::TWO_DASHES,
 		'\0', 40 << 20,
@@ -759,6 +760,10 @@ class General_options
 	      N_("Compress .debug_* sections in the output file"),
 	      ("[none,zlib,zlib-gnu,zlib-gabi]"),
 	      {"none", "zlib", "zlib-gnu", "zlib-gabi"});
+  DEFINE_uint(compress_debug_sections_threads, options::TWO_DASHES, '\0', 1,
+	      N_("Split each compressed section into up to COUNT pieces "
+		 "which are compressed in parallel"),
+	      N_("COUNT"));
 
   DEFINE_bool(copy_dt_needed_entries, options::TWO_DASHES, '\0', false,
 	      N_("Not supported"),
@@ -786,6 +791,10 @@ class General_options
 		N_("Turn on debugging"),
 		N_("[all,files,script,task][,...]"));
 
+  DEFINE_bool(debug_names, options::TWO_DASHES, '\0', false,
+	      N_("Generate DWARF 5 .debug_names section"),
+	      N_("Do not generate .debug_names section"));
+
   DEFINE_special(defsym, options::TWO_DASHES, '\0',
 		 N_("Define a symbol"), N_("SYMBOL=EXPRESSION"));
 
@@ -860,6 +869,12 @@ class General_options
 	      N_("Treat warnings as errors"),
 	      N_("Do not treat warnings as errors"));
 
+  DEFINE_uint64(file_view_budget, options::TWO_DASHES, '\0', 0,
+		N_("Limit the input file views kept between uses to SIZE "
+		   "bytes, discarding the least recently used (0 for no "
+		   "limit)"),
+		N_("SIZE"));
+
   DEFINE_string(fini, options::ONE_DASH, '\0', "_fini",
 		N_("Call SYMBOL at unload-time"), N_("SYMBOL"));
 
@@ -917,6 +932,10 @@ class General_options
   DEFINE_string(soname, options::ONE_DASH, 'h', NULL,
 		N_("Set shared library name"), N_("FILENAME"));
 
+  DEFINE_uint(hash_bloom_bits, options::TWO_DASHES, '\0', 0,
+	      N_("Minimum number of .gnu.hash bloom filter bits per symbol"),
+	      N_("BITS"));
+
   DEFINE_double(hash_bucket_empty_fraction, options::TWO_DASHES, '\0', 0.0,
 		N_("Min fraction of empty buckets in dynamic hash"),
 		N_("FRACTION"));
@@ -1010,6 +1029,15 @@ class General_options
   DEFINE_dirlist(library_path, options::TWO_DASHES, 'L',
 		 N_("Add directory to search path"), N_("DIR"));
 
+  DEFINE_string(link_cache, options::TWO_DASHES, '\0', NULL,
+		N_("Reuse outputs of earlier links with the same inputs, "
+		   "cached in DIR"),
+		N_("DIR"));
+  DEFINE_uint64(link_cache_size, options::TWO_DASHES, '\0', 1073741824,
+		N_("Limit the link cache to SIZE bytes, removing the least "
+		   "recently used files (0 for no limit)"),
+		N_("SIZE"));
+
   DEFINE_bool(long_plt, options::TWO_DASHES, '\0', false,
 	      N_("(ARM only) Generate long PLT entries"),
 	      N_("(ARM only) Do not generate long PLT entries"));
@@ -1037,6 +1065,9 @@ class General_options
 
   DEFINE_string(Map, options::ONE_DASH, '\0', NULL, N_("Write map file"),
 		N_("MAPFILENAME"));
+  DEFINE_enum(Map_format, options::TWO_DASHES, '\0', "text",
+	      N_("Map file format"), N_("[text,json]"),
+	      {"text", "json"});
 
   // n
 
@@ -1119,6 +1150,11 @@ class General_options
 	      N_("Use posix_fallocate to reserve space in the output file"),
 	      N_("Use fallocate or ftruncate to reserve space"));
 
+  DEFINE_bool(prefetch_archive_members, options::TWO_DASHES, '\0', false,
+	      N_("Check archive symbol tables in parallel and prefetch "
+		 "the members which will be loaded"),
+	      N_("Do not prefetch archive members"));
+
   DEFINE_bool(preread_archive_symbols, options::TWO_DASHES, '\0', false,
 	      N_("Preread archive symbols when multi-threaded"), NULL);
 
@@ -1199,6 +1235,10 @@ class General_options
   DEFINE_string(section_ordering_file, options::TWO_DASHES, '\0', NULL,
 		N_("Layout sections in the order specified"),
 		N_("FILENAME"));
+  DEFINE_string(call_graph_ordering_file, options::TWO_DASHES, '\0', NULL,
+		N_("Layout functions in an order computed from the "
+		   "weighted call graph in FILENAME"),
+		N_("FILENAME"));
 
   DEFINE_special(section_start, options::TWO_DASHES, '\0',
 		 N_("Set address of section"), N_("SECTION=ADDRESS"));
@@ -1254,6 +1294,10 @@ class General_options
 
   DEFINE_bool(trace, options::TWO_DASHES, 't', false,
 	      N_("Print the name of each input file"), NULL);
+  DEFINE_string(trace_tasks, options::TWO_DASHES, '\0', NULL,
+		N_("Write a timeline of the tasks run to FILE, in the "
+		   "Chrome trace event format"),
+		N_("FILE"));
 
   DEFINE_bool(target1_abs, options::TWO_DASHES, '\0', false,
 	      N_("(ARM only) Force R_ARM_TARGET1 type to R_ARM_ABS32"),
@@ -1573,6 +1617,12 @@ class General_options
   icf_safe_folding() const
   { return this->icf_status_ == ICF_SAFE; }
 
+  // Whether the debug info is scanned to build a .gdb_index or
+  // .debug_names section.
+  bool
+  scan_debug_info() const
+  { return this->gdb_index() || this->debug_names(); }
+
   // The --demangle option takes an optional string, and there is also
   // a --no-demangle option.  This is the best way to decide whether
   // to demangle or not.
@@ -1600,6 +1650,11 @@ class General_options
   have_dynamic_list() const
   { return this->have_dynamic_list_; }
 
+  // Return the --dynamic-list information.
+  const Version_script_info*
+  dynamic_list_info() const
+  { return this->dynamic_list_.version_script_info(); }
+
   // Finalize the dynamic list.
   void
   finalize_dynamic_list()
@@ -43,6 +43,7 @@
 #include "reloc.h"
 #include "merge.h"
 #include "descriptors.h"
+#include "gold-threads.h"
 #include "layout.h"
 #include "output.h"
 
@@ -3841,6 +3842,27 @@ Output_section::write_to_postprocessing_buffer()
     }
 }
 
+// Return the offset within this section of POSD.  This follows the
+// layout used by set_final_data_size and
+// write_to_postprocessing_buffer.
+
+off_t
+Output_section::output_section_data_offset(
+    const Output_section_data* posd) const
+{
+  off_t off = this->first_input_offset_;
+  for (Input_section_list::const_iterator p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    {
+      off = align_address(off, p->addralign());
+      if (p->is_output_section_data() && p->output_section_data() == posd)
+	return off;
+      off += p->data_size();
+    }
+  gold_unreachable();
+}
+
 // Get the input sections for linker script processing.  We leave
 // behind the Output_section_data entries.  Note that this may be
 // slightly incorrect for merge sections.  We will leave them behind,
@@ -4055,6 +4077,19 @@ Output_section::print_merge_stats()
     p->print_merge_stats(this->name_);
 }
 
+// Add the merge sections of this output section to MERGE_SECTIONS.
+
+void
+Output_section::get_merge_sections(
+    std::vector<Output_merge_base*>* merge_sections) const
+{
+  for (Input_section_list::const_iterator p = this->input_sections_.begin();
+       p != this->input_sections_.end();
+       ++p)
+    if (p->is_merge_section())
+      merge_sections->push_back(p->output_merge_base());
+}
+
 // Set a fixed layout for the section.  Used for incremental update links.
 
 void
@@ -4965,6 +5000,12 @@ Output_segment::print_section_list_to_mapfile(Mapfile* mapfile,
 
 // Output_file methods.
 
+// Output_file variables.
+
+unsigned long long Output_file::streamed_bytes;
+unsigned long long Output_file::buffered_bytes;
+unsigned long long Output_file::max_buffered_bytes;
+
 Output_file::Output_file(const char* name)
   : name_(name),
     o_(-1),
@@ -4972,7 +5013,11 @@ Output_file::Output_file(const char* name)
     base_(NULL),
     map_is_anonymous_(false),
     map_is_allocated_(false),
-    is_temporary_(false)
+    is_temporary_(false),
+    is_streaming_(false),
+    lock_(NULL),
+    streamed_views_(),
+    written_ranges_()
 {
 }
 
@@ -5130,6 +5175,14 @@ Output_file::open(off_t file_size)
 void
 Output_file::resize(off_t file_size)
 {
+  if (this->is_streaming_)
+    {
+      if (::ftruncate(this->o_, file_size) < 0)
+	gold_fatal(_("%s: ftruncate: %s"), this->name_, strerror(errno));
+      this->file_size_ = file_size;
+      return;
+    }
+
   // If the mmap is mapping an anonymous memory buffer, this is easy:
   // just mremap to the new size.  If it's mapping to a file, we want
   // to unmap to flush to the file, then remap after growing the file.
@@ -5244,6 +5297,11 @@ Output_file::map()
       && this->map_no_anonymous(true))
     return;
 
+  // Rather than holding the whole file in memory, write each view to
+  // the file as it is finished.
+  if (this->start_streaming())
+    return;
+
   // The mmap call might fail because of file system issues: the file
   // system might not support mmap at all, or it might not support
   // mmap with PROT_WRITE.  I'm not sure which errno values we will
@@ -5262,7 +5320,24 @@ Output_file::map()
 void
 Output_file::unmap()
 {
-  if (this->map_is_anonymous_)
+  if (this->is_streaming_)
+    {
+      // Write out the resident views, and any views which were not
+      // released.
+      for (Streamed_views::iterator p = this->streamed_views_.begin();
+	   p != this->streamed_views_.end();
+	   ++p)
+	{
+	  while (!p->second.covered.empty())
+	    this->finish_covered_view(p->first, &p->second, 0);
+	  this->pwrite_all(p->first, p->second.view, p->second.size);
+	  delete[] p->second.view;
+	  Output_file::add_buffered_bytes(
+	      -static_cast<ssize_t>(p->second.size));
+	}
+      this->streamed_views_.clear();
+    }
+  else if (this->map_is_anonymous_)
     {
       // We've already written out the data, so there is no reason to
       // waste time unmapping or freeing the memory.
@@ -5275,6 +5350,474 @@ Output_file::unmap()
   this->base_ = NULL;
 }
 
+// Set up to stream the output to the file.  We can only do this for
+// a regular file, since views are written in whatever order they are
+// finished.  An incremental link needs the whole file in memory.
+
+bool
+Output_file::start_streaming()
+{
+  struct stat statbuf;
+  if (this->o_ == STDOUT_FILENO
+      || this->o_ == STDERR_FILENO
+      || this->is_temporary_
+      || parameters->incremental()
+      || ::fstat(this->o_, &statbuf) != 0
+      || !S_ISREG(statbuf.st_mode))
+    return false;
+
+  // Any part of the file which is never written reads as zero.
+  if (::ftruncate(this->o_, this->file_size_) < 0)
+    gold_fatal(_("%s: ftruncate: %s"), this->name_, strerror(errno));
+
+  if (this->lock_ == NULL)
+    this->lock_ = new Lock();
+  this->is_streaming_ = true;
+  return true;
+}
+
+// Copy the part of the buffer FROM, which holds the file at
+// FROM_START, which overlaps the buffer TO, which holds the file at
+// TO_START, into TO.
+
+static void
+copy_streamed_overlap(off_t to_start, unsigned char* to, size_t to_size,
+		      off_t from_start, const unsigned char* from,
+		      size_t from_size)
+{
+  off_t lo = std::max(to_start, from_start);
+  off_t hi = std::min(to_start + static_cast<off_t>(to_size),
+		      from_start + static_cast<off_t>(from_size));
+  if (lo < hi)
+    memcpy(to + (lo - to_start), from + (lo - from_start), hi - lo);
+}
+
+// Return a buffer for part of the file when streaming.  Several
+// users, such as the PLT and the .got.plt section, or the tasks
+// applying relocations to a merged section, may write to the same
+// part of the file at once.  With a map they would each write their
+// own bytes, so here a view which lies within a live view shares its
+// buffer.  Otherwise the new buffer starts out with the current
+// contents of the file.
+
+// A view which partly overlaps live views, or contains them, such as
+// the view of a whole output section used for a merged input section
+// while other input sections of the output section are being
+// written, can not share their buffers, and writing either buffer
+// when it is released would overwrite what was written to the
+// other.  So the new view gets a buffer covering all of them, which
+// starts out with their contents and replaces them in the list of
+// live views.  Their users keep writing to their old buffers, which
+// are copied to the new one when they are released.  The bytes of a
+// covered view belong to its users until then; the users of the new
+// view must only write to other parts of it, as is the case for a
+// merged section, which only applies relocations to the merged data.
+
+unsigned char*
+Output_file::acquire_streamed_view(off_t start, size_t size,
+				   bool is_resident)
+{
+  gold_assert(start >= 0
+	      && start + static_cast<off_t>(size) <= this->file_size_);
+  const off_t end = start + static_cast<off_t>(size);
+
+  // An empty view has nothing to write.
+  static unsigned char empty_view;
+  if (size == 0)
+    return &empty_view;
+
+  Hold_lock hl(*this->lock_);
+
+  // Since the live views are disjoint, the ones which overlap the new
+  // view are the ones ending after START, going back from the last
+  // one which starts before END.
+  Streamed_views::iterator last = this->streamed_views_.lower_bound(end);
+  Streamed_views::iterator first = last;
+  while (first != this->streamed_views_.begin())
+    {
+      Streamed_views::iterator p = first;
+      --p;
+      if (p->first + static_cast<off_t>(p->second.size) <= start)
+	break;
+      first = p;
+    }
+
+  if (first != last)
+    {
+      Streamed_views::iterator p = first;
+      ++p;
+      Streamed_view* sv = &first->second;
+      const off_t view_end = first->first + static_cast<off_t>(sv->size);
+      if (p == last && first->first <= start && end <= view_end)
+	{
+	  // The new view lies within a live view.  Share the buffer of
+	  // the oldest covered view which contains it, if any, since
+	  // that holds the current contents.
+	  if (is_resident)
+	    sv->is_resident = true;
+	  for (std::vector<Covered_view>::iterator pc = sv->covered.begin();
+	       pc != sv->covered.end();
+	       ++pc)
+	    {
+	      if (pc->start <= start
+		  && end <= pc->start + static_cast<off_t>(pc->size))
+		{
+		  ++pc->refs;
+		  return pc->view + (start - pc->start);
+		}
+	    }
+	  ++sv->refs;
+	  return sv->view + (start - first->first);
+	}
+    }
+
+  // Merge the new view with the live views which it overlaps.
+  off_t new_start = start;
+  off_t new_end = end;
+  if (first != last)
+    {
+      new_start = std::min(new_start, first->first);
+      Streamed_views::iterator p = last;
+      --p;
+      new_end = std::max(new_end,
+			 p->first + static_cast<off_t>(p->second.size));
+    }
+  const size_t new_size = new_end - new_start;
+
+  unsigned char* view = new unsigned char[new_size];
+  Output_file::add_buffered_bytes(new_size);
+  if (this->is_written(new_start, new_end))
+    this->pread_all(new_start, view, new_size);
+  else
+    memset(view, 0, new_size);
+
+  Streamed_view nsv;
+  nsv.size = new_size;
+  nsv.view = view;
+  nsv.refs = 1;
+  nsv.is_resident = is_resident;
+  for (Streamed_views::iterator p = first; p != last; ++p)
+    {
+      Streamed_view* sv = &p->second;
+      copy_streamed_overlap(new_start, view, new_size, p->first, sv->view,
+			    sv->size);
+      // The older covered views hold the current contents of their
+      // parts of the file.
+      for (std::vector<Covered_view>::reverse_iterator pc =
+	     sv->covered.rbegin();
+	   pc != sv->covered.rend();
+	   ++pc)
+	copy_streamed_overlap(new_start, view, new_size, pc->start,
+			      pc->view, pc->size);
+      nsv.covered.insert(nsv.covered.end(), sv->covered.begin(),
+			 sv->covered.end());
+      if (sv->refs > 0)
+	{
+	  Covered_view cv;
+	  cv.start = p->first;
+	  cv.size = sv->size;
+	  cv.view = sv->view;
+	  cv.refs = sv->refs;
+	  nsv.covered.push_back(cv);
+	}
+      else
+	{
+	  delete[] sv->view;
+	  Output_file::add_buffered_bytes(-static_cast<ssize_t>(sv->size));
+	}
+      if (sv->is_resident)
+	nsv.is_resident = true;
+    }
+  this->streamed_views_.erase(first, last);
+
+  Streamed_views::iterator p =
+    this->streamed_views_.insert(std::make_pair(new_start,
+						Streamed_view())).first;
+  p->second.size = nsv.size;
+  p->second.view = nsv.view;
+  p->second.refs = nsv.refs;
+  p->second.is_resident = nsv.is_resident;
+  p->second.covered.swap(nsv.covered);
+  return view + (start - new_start);
+}
+
+// Release a buffer returned by acquire_streamed_view.  When the last
+// user releases it, write it out.
+
+void
+Output_file::release_streamed_view(off_t start, size_t size,
+				   const unsigned char* view)
+{
+  if (size == 0)
+    return;
+
+  Hold_lock hl(*this->lock_);
+
+  // The view lies within the last live view which starts at or
+  // before START.
+  Streamed_views::iterator p = this->streamed_views_.upper_bound(start);
+  gold_assert(p != this->streamed_views_.begin());
+  --p;
+  Streamed_view* sv = &p->second;
+
+  // The view may be in the buffer of a covered view.
+  bool is_covered = false;
+  for (size_t i = 0; i < sv->covered.size(); ++i)
+    {
+      Covered_view* cv = &sv->covered[i];
+      if (view >= cv->view && view < cv->view + cv->size)
+	{
+	  gold_assert(cv->refs > 0);
+	  --cv->refs;
+	  if (cv->refs > 0)
+	    return;
+	  this->finish_covered_view(p->first, sv, i);
+	  is_covered = true;
+	  break;
+	}
+    }
+  if (!is_covered)
+    {
+      gold_assert(view >= sv->view && view < sv->view + sv->size);
+      gold_assert(sv->refs > 0);
+      --sv->refs;
+    }
+
+  if (sv->refs > 0 || sv->is_resident || !sv->covered.empty())
+    return;
+
+  // The live views are disjoint, so there are no others to update.
+  this->pwrite_all(p->first, sv->view, sv->size);
+  this->add_written(p->first, p->first + static_cast<off_t>(sv->size));
+  delete[] sv->view;
+  Output_file::add_buffered_bytes(-static_cast<ssize_t>(sv->size));
+  this->streamed_views_.erase(p);
+}
+
+// Copy the covered view at index I of SV, which starts at START in the
+// file, to SV and to the later covered views which overlap it, since
+// they were filled in before its users were done, and free it.
+
+void
+Output_file::finish_covered_view(off_t start, Streamed_view* sv, size_t i)
+{
+  Covered_view cv = sv->covered[i];
+  copy_streamed_overlap(start, sv->view, sv->size, cv.start, cv.view,
+			cv.size);
+  for (size_t j = i + 1; j < sv->covered.size(); ++j)
+    {
+      Covered_view* later = &sv->covered[j];
+      copy_streamed_overlap(later->start, later->view, later->size,
+			    cv.start, cv.view, cv.size);
+    }
+  sv->covered.erase(sv->covered.begin() + i);
+  delete[] cv.view;
+  Output_file::add_buffered_bytes(-static_cast<ssize_t>(cv.size));
+}
+
+// Read part of the file into a new buffer when streaming.
+
+const unsigned char*
+Output_file::read_streamed_view(off_t start, size_t size)
+{
+  gold_assert(start >= 0
+	      && start + static_cast<off_t>(size) <= this->file_size_);
+  unsigned char* view = new unsigned char[size];
+  Hold_lock hl(*this->lock_);
+  Output_file::add_buffered_bytes(size);
+  this->pread_all(start, view, size);
+  this->copy_from_streamed_views(start, view, size);
+  return view;
+}
+
+// Free a buffer returned by read_streamed_view.
+
+void
+Output_file::free_streamed_view(size_t size, const unsigned char* view)
+{
+  delete[] view;
+  Hold_lock hl(*this->lock_);
+  Output_file::add_buffered_bytes(-static_cast<ssize_t>(size));
+}
+
+// Write data to the file when streaming.
+
+void
+Output_file::write_streamed(off_t start, const unsigned char* data,
+			    size_t size)
+{
+  gold_assert(start >= 0
+	      && start + static_cast<off_t>(size) <= this->file_size_);
+  // Write the data to any live views which overlap it too, so that
+  // they do not overwrite it with stale contents when they are
+  // written.  We hold the lock while writing so that writes to the
+  // same part of the file are done in order.
+  Hold_lock hl(*this->lock_);
+  this->pwrite_all(start, data, size);
+  this->add_written(start, start + static_cast<off_t>(size));
+  this->copy_to_streamed_views(start, data, size);
+}
+
+// Write data to the file at START.  The lock must be held unless
+// threads are no longer running.
+
+void
+Output_file::pwrite_all(off_t start, const unsigned char* data,
+			size_t size)
+{
+  size_t done = 0;
+  while (done < size)
+    {
+      ssize_t len = ::pwrite(this->o_, data + done, size - done,
+			     start + done);
+      if (len < 0 && errno == EINTR)
+	continue;
+      if (len < 0)
+	gold_fatal(_("%s: write: %s"), this->name_, strerror(errno));
+      if (len == 0)
+	gold_fatal(_("%s: write: unexpected 0 return-value"), this->name_);
+      done += len;
+    }
+  Output_file::streamed_bytes += size;
+}
+
+// Read data from the file at START.
+
+void
+Output_file::pread_all(off_t start, unsigned char* data, size_t size)
+{
+  size_t done = 0;
+  while (done < size)
+    {
+      ssize_t len = ::pread(this->o_, data + done, size - done,
+			    start + done);
+      if (len < 0 && errno == EINTR)
+	continue;
+      if (len < 0)
+	gold_fatal(_("%s: read: %s"), this->name_, strerror(errno));
+      if (len == 0)
+	gold_fatal(_("%s: read: unexpected EOF"), this->name_);
+      done += len;
+    }
+}
+
+// Copy DATA, which is being written to the file at START, to any live
+// views which overlap it.
+
+void
+Output_file::copy_to_streamed_views(off_t start, const unsigned char* data,
+				    size_t size)
+{
+  const off_t end = start + static_cast<off_t>(size);
+  Streamed_views::iterator limit = this->streamed_views_.lower_bound(end);
+  for (Streamed_views::iterator p = this->streamed_views_.begin();
+       p != limit;
+       ++p)
+    {
+      copy_streamed_overlap(p->first, p->second.view, p->second.size,
+			    start, data, size);
+      for (std::vector<Covered_view>::iterator pc =
+	     p->second.covered.begin();
+	   pc != p->second.covered.end();
+	   ++pc)
+	copy_streamed_overlap(pc->start, pc->view, pc->size, start, data,
+			      size);
+    }
+}
+
+// Copy the parts of any live views which overlap the range of the
+// file at START into DATA.
+
+void
+Output_file::copy_from_streamed_views(off_t start, unsigned char* data,
+				      size_t size)
+{
+  const off_t end = start + static_cast<off_t>(size);
+  Streamed_views::iterator limit = this->streamed_views_.lower_bound(end);
+  for (Streamed_views::iterator p = this->streamed_views_.begin();
+       p != limit;
+       ++p)
+    {
+      copy_streamed_overlap(start, data, size, p->first, p->second.view,
+			    p->second.size);
+      // The older covered views hold the current contents of their
+      // parts of the file.
+      for (std::vector<Covered_view>::reverse_iterator pc =
+	     p->second.covered.rbegin();
+	   pc != p->second.covered.rend();
+	   ++pc)
+	copy_streamed_overlap(start, data, size, pc->start, pc->view,
+			      pc->size);
+    }
+}
+
+// Return whether any part of the range from START to END has been
+// written.
+
+bool
+Output_file::is_written(off_t start, off_t end) const
+{
+  Written_ranges::const_iterator p = this->written_ranges_.upper_bound(start);
+  if (p != this->written_ranges_.end() && p->first < end)
+    return true;
+  if (p == this->written_ranges_.begin())
+    return false;
+  --p;
+  return p->second > start;
+}
+
+// Record that the range from START to END has been written, merging
+// it with the ranges it touches.
+
+void
+Output_file::add_written(off_t start, off_t end)
+{
+  Written_ranges::iterator p = this->written_ranges_.upper_bound(start);
+  if (p != this->written_ranges_.begin())
+    {
+      Written_ranges::iterator prev = p;
+      --prev;
+      if (prev->second >= start)
+	{
+	  start = prev->first;
+	  end = std::max(end, prev->second);
+	  this->written_ranges_.erase(prev);
+	}
+    }
+  while (p != this->written_ranges_.end() && p->first <= end)
+    {
+      end = std::max(end, p->second);
+      this->written_ranges_.erase(p++);
+    }
+  this->written_ranges_[start] = end;
+}
+
+// Count SIZE bytes of view buffers allocated, or freed if SIZE is
+// negative.  The lock must be held unless threads are no longer
+// running.
+
+void
+Output_file::add_buffered_bytes(ssize_t size)
+{
+  Output_file::buffered_bytes += size;
+  if (Output_file::buffered_bytes > Output_file::max_buffered_bytes)
+    Output_file::max_buffered_bytes = Output_file::buffered_bytes;
+}
+
+// Print statistics about streamed output.
+
+void
+Output_file::print_stats()
+{
+  if (Output_file::streamed_bytes == 0)
+    return;
+  fprintf(stderr, _("%s: total bytes streamed to output: %llu\n"),
+	  program_name, Output_file::streamed_bytes);
+  fprintf(stderr,
+	  _("%s: maximum output bytes buffered at one time: %llu\n"),
+	  program_name, Output_file::max_buffered_bytes);
+}
+
 // Close the output file.
 
 void
@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <list>
+#include <map>
 #include <vector>
 
 #include "elfcpp.h"
@@ -36,6 +37,7 @@ namespace gold
 {
 
 class General_options;
+class Lock;
 class Object;
 class Symbol;
 class Output_merge_base;
@@ -94,13 +96,26 @@ class Output_file
   filename()
   { return this->name_; }
 
-  // We currently always use mmap which makes the view handling quite
-  // simple.  In the future we may support other approaches.
+  // Normally the file, or an anonymous buffer holding the whole
+  // file, is mapped into memory, and a view is just a pointer into
+  // the map.  When the output file is not mapped and is a regular
+  // file, we instead stream the output: each view is a separate
+  // buffer which is written to the file when the view is finished.
+  // A view which lies within another live view shares its buffer,
+  // and a view which overlaps live views is merged with them.  Views
+  // returned by get_input_output_view are kept in memory until the
+  // file is closed.
 
   // Write data to the output file.
   void
   write(off_t offset, const void* data, size_t len)
-  { memcpy(this->base_ + offset, data, len); }
+  {
+    if (this->is_streaming_)
+      this->write_streamed(offset, static_cast<const unsigned char*>(data),
+			   len);
+    else
+      memcpy(this->base_ + offset, data, len);
+  }
 
   // Get a buffer to use to write to the file, given the offset into
   // the file and the size.
@@ -109,22 +124,32 @@ class Output_file
   {
     gold_assert(start >= 0
 		&& start + static_cast<off_t>(size) <= this->file_size_);
+    if (this->is_streaming_)
+      return this->acquire_streamed_view(start, size, false);
     return this->base_ + start;
   }
 
   // VIEW must have been returned by get_output_view.  Write the
   // buffer to the file, passing in the offset and the size.
   void
-  write_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_output_view(off_t start, size_t size, unsigned char* view)
+  {
+    if (this->is_streaming_)
+      this->release_streamed_view(start, size, view);
+  }
 
   // Get a read/write buffer.  This is used when we want to write part
   // of the file, read it in, and write it again.
   unsigned char*
   get_input_output_view(off_t start, size_t size)
-  { return this->get_output_view(start, size); }
+  {
+    if (this->is_streaming_)
+      return this->acquire_streamed_view(start, size, true);
+    return this->get_output_view(start, size);
+  }
 
-  // Write a read/write buffer back to the file.
+  // Write a read/write buffer back to the file.  When streaming, the
+  // buffer is written when the file is closed.
   void
   write_input_output_view(off_t, size_t, unsigned char*)
   { }
@@ -133,14 +158,134 @@ class Output_file
   // of the file back it in.
   const unsigned char*
   get_input_view(off_t start, size_t size)
-  { return this->get_output_view(start, size); }
+  {
+    if (this->is_streaming_)
+      return this->read_streamed_view(start, size);
+    return this->get_output_view(start, size);
+  }
 
   // Release a read bfufer.
   void
-  free_input_view(off_t, size_t, const unsigned char*)
-  { }
+  free_input_view(off_t, size_t size, const unsigned char* view)
+  {
+    if (this->is_streaming_)
+      this->free_streamed_view(size, view);
+  }
+
+  // Print statistics about streamed output.
+  static void
+  print_stats();
 
  private:
+  // A live view which was merged into a later view which overlaps
+  // it.  Its users still write to its own buffer, which is copied to
+  // the later view when they are done.
+  struct Covered_view
+  {
+    // The file offset of the buffer.
+    off_t start;
+    // The size of the buffer.
+    size_t size;
+    // The buffer.
+    unsigned char* view;
+    // The number of users of the buffer.
+    int refs;
+  };
+
+  // A buffer holding part of the file when streaming.
+  struct Streamed_view
+  {
+    Streamed_view()
+      : size(0), view(NULL), refs(0), is_resident(false), covered()
+    { }
+
+    // The size of the buffer.
+    size_t size;
+    // The buffer.
+    unsigned char* view;
+    // The number of users of the buffer.
+    int refs;
+    // Whether to keep the buffer until the file is closed.
+    bool is_resident;
+    // The live views merged into this one, oldest first.
+    std::vector<Covered_view> covered;
+  };
+
+  // Live streamed views, indexed by file offset.  A view which lies
+  // within a live view shares its buffer, and a view which overlaps
+  // live views is merged with them, so these do not overlap.
+  typedef std::map<off_t, Streamed_view> Streamed_views;
+
+  // Ranges of the file which have been written when streaming,
+  // mapping the start of each range to its end.
+  typedef std::map<off_t, off_t> Written_ranges;
+
+  // Set up to stream the output to the file.  Return whether that is
+  // possible.
+  bool
+  start_streaming();
+
+  // Return a buffer for part of the file when streaming.  If
+  // IS_RESIDENT, keep the buffer until the file is closed.
+  unsigned char*
+  acquire_streamed_view(off_t start, size_t size, bool is_resident);
+
+  // Release a buffer returned by acquire_streamed_view, writing it to
+  // the file if there are no other users.
+  void
+  release_streamed_view(off_t start, size_t size,
+			const unsigned char* view);
+
+  // Copy the covered view at index I of SV, whose users are done with
+  // it, to SV and to the later covered views, and free it.
+  void
+  finish_covered_view(off_t start, Streamed_view* sv, size_t i);
+
+  // Read part of the file into a new buffer when streaming.
+  const unsigned char*
+  read_streamed_view(off_t start, size_t size);
+
+  // Free a buffer returned by read_streamed_view.
+  void
+  free_streamed_view(size_t size, const unsigned char* view);
+
+  // Write data to the file when streaming.
+  void
+  write_streamed(off_t start, const unsigned char* data, size_t size);
+
+  // Write data to the file at START.
+  void
+  pwrite_all(off_t start, const unsigned char* data, size_t size);
+
+  // Read data from the file at START.
+  void
+  pread_all(off_t start, unsigned char* data, size_t size);
+
+  // Copy DATA, to be written to the file at START, to any live views
+  // which overlap it.
+  void
+  copy_to_streamed_views(off_t start, const unsigned char* data,
+			 size_t size);
+
+  // Copy the parts of any live views which overlap the range of the
+  // file at START into DATA.
+  void
+  copy_from_streamed_views(off_t start, unsigned char* data, size_t size);
+
+  // Return whether any part of the range from START to END has been
+  // written.
+  bool
+  is_written(off_t start, off_t end) const;
+
+  // Record that the range from START to END has been written.
+  void
+  add_written(off_t start, off_t end);
+
+  // Count SIZE bytes of view buffers allocated (if positive) or freed.
+  // The lock must be held.
+  static void
+  add_buffered_bytes(ssize_t size);
+
   // Map the file into memory or, if that fails, allocate anonymous
   // memory.
   void
@@ -172,6 +317,23 @@ class Output_file
   bool map_is_allocated_;
   // True if this is a temporary file which should not be output.
   bool is_temporary_;
+  // True if we are streaming the output to the file rather than
+  // mapping it.
+  bool is_streaming_;
+  // Controls access to streamed_views_, written_ranges_ and the
+  // statistics.
+  Lock* lock_;
+  // The live views when streaming.
+  Streamed_views streamed_views_;
+  // The ranges written when streaming.
+  Written_ranges written_ranges_;
+
+  // The number of bytes written when streaming.
+  static unsigned long long streamed_bytes;
+  // The number of bytes currently held in view buffers when streaming.
+  static unsigned long long buffered_bytes;
+  // The largest value of buffered_bytes.
+  static unsigned long long max_buffered_bytes;
 };
 
 // An abtract class for data which has to go into the output file.
@@ -3641,12 +3803,24 @@ class Output_section : public Output_data
   void
   create_postprocessing_buffer();
 
+  // Return whether the postprocessing buffer has been created.
+  bool
+  has_postprocessing_buffer() const
+  { return this->postprocessing_buffer_ != NULL; }
+
   // If a section requires postprocessing, this is the size of the
   // buffer to which relocations should be applied.
   off_t
   postprocessing_buffer_size() const
   { return this->current_data_size_for_child(); }
 
+  // Return the offset within this section of POSD, which must have
+  // been added with add_output_section_data.  Unlike POSD->address(),
+  // this works for a section that requires postprocessing, where the
+  // addresses of the Output_section_data objects are not set.
+  off_t
+  output_section_data_offset(const Output_section_data* posd) const;
+
   // Modify the section name.  This is only permitted for an
   // unallocated section, and only before the size has been finalized.
   // Otherwise the name will not get into Layout::namepool_.
@@ -4090,6 +4264,10 @@ class Output_section : public Output_data
   void
   print_merge_stats();
 
+  // Add the merge sections of this output section to MERGE_SECTIONS.
+  void
+  get_merge_sections(std::vector<Output_merge_base*>* merge_sections) const;
+
   // Set a fixed layout for the section.  Used for incremental update links.
   void
   set_fixed_layout(uint64_t sh_addr, off_t sh_offset, off_t sh_size,
@@ -240,6 +240,11 @@ class Plugin_manager
     return this->objects_[handle];
   }
 
+  // Return TRUE if any input files have been claimed by a plugin.
+  bool
+  any_claimed() const
+  { return this->any_claimed_; }
+
   // Return TRUE if any input files have been claimed by a plugin
   // and we are still in the initial input phase.
   bool
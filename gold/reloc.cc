@@ -85,10 +85,12 @@ Read_relocs::run(Workqueue* workqueue)
     }
   else
     {
-      workqueue->queue_next(new Scan_relocs(this->symtab_, this->layout_,
-					    this->object_, rd,
-                                            this->this_blocker_,
-					    this->next_blocker_));
+      workqueue->queue_next(new Prescan_relocs(this->symtab_, this->layout_,
+					       this->object_, rd,
+					       this->commons_blocker_,
+					       this->scan_blocker_,
+					       this->this_blocker_,
+					       this->next_blocker_));
     }
 }
 
@@ -145,10 +147,63 @@ Gc_process_relocs::get_name() const
   return "Gc_process_relocs " + this->object_->name();
 }
 
+// Prescan_relocs methods.
+
+// These tasks look only at the relocations read by Read_relocs and at
+// the symbol table, which does not change while they run, so they do
+// not lock the file and they can run in parallel.  They must wait for
+// the common symbols to be allocated.
+
+Task_token*
+Prescan_relocs::is_runnable()
+{
+  if (this->commons_blocker_ != NULL && this->commons_blocker_->is_blocked())
+    return this->commons_blocker_;
+  return NULL;
+}
+
+// The first Scan_relocs task waits for all of us.
+
+void
+Prescan_relocs::locks(Task_locker* tl)
+{
+  tl->add(this, this->scan_blocker_);
+}
+
+// Prescan the relocs and then start a Scan_relocs task.
+
+void
+Prescan_relocs::run(Workqueue* workqueue)
+{
+  this->object_->prescan_relocs(this->symtab_, this->rd_);
+
+  // The first Scan_relocs task is blocked by SCAN_BLOCKER_, so it
+  // runs after all the Prescan_relocs tasks, and it can delete the
+  // COMMONS_BLOCKER_ which they share.
+  Task_token* commons_blocker = NULL;
+  if (this->this_blocker_ == this->scan_blocker_)
+    commons_blocker = this->commons_blocker_;
+  workqueue->queue_next(new Scan_relocs(this->symtab_, this->layout_,
+					this->object_, this->rd_,
+					commons_blocker,
+					this->this_blocker_,
+					this->next_blocker_));
+}
+
+// Return a debugging name for the task.
+
+std::string
+Prescan_relocs::get_name() const
+{
+  return "Prescan_relocs " + this->object_->name();
+}
+
 // Scan_relocs methods.
 
 Scan_relocs::~Scan_relocs()
 {
+  if (this->commons_blocker_ != NULL)
+    delete this->commons_blocker_;
   if (this->this_blocker_ != NULL)
     delete this->this_blocker_;
 }
@@ -418,6 +473,47 @@ Sized_relobj_file<size, big_endian>::do_gc_process_relocs(Symbol_table* symtab,
 }
 
 
+// Prescan the relocs, keeping only those which may require
+// GOT/PLT/COPY relocations.  This runs in parallel for different
+// objects, and must not change anything but the Section_relocs.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::do_prescan_relocs(Symbol_table* symtab,
+						       Read_relocs_data* rd)
+{
+  if (parameters->options().relocatable())
+    return;
+
+  Sized_target<size, big_endian>* target =
+    parameters->sized_target<size, big_endian>();
+
+  const unsigned char* local_symbols;
+  if (rd->local_symbols == NULL)
+    local_symbols = NULL;
+  else
+    local_symbols = rd->local_symbols->data();
+
+  for (Read_relocs_data::Relocs_list::iterator p = rd->relocs.begin();
+       p != rd->relocs.end();
+       ++p)
+    {
+      if ((parameters->options().gc_sections()
+	   || parameters->options().icf_enabled())
+	  && p->output_section == NULL)
+	continue;
+      if (!p->is_data_section_allocated)
+	continue;
+      p->is_prescanned = target->prescan_relocs(symtab, this, p->data_shndx,
+						p->sh_type,
+						p->contents->data(),
+						p->reloc_count,
+						p->needs_special_offset_handling,
+						this->local_symbol_count_,
+						local_symbols, &p->pending);
+    }
+}
+
 // Scan the relocs and adjust the symbol table.  This looks for
 // relocations which require GOT/PLT/COPY relocations.
 
@@ -459,12 +555,29 @@ Sized_relobj_file<size, big_endian>::do_scan_relocs(Symbol_table* symtab,
 	  // only scan allocated sections.  We may see a non-allocated
 	  // section here if we are emitting relocs.
 	  if (p->is_data_section_allocated)
-	    target->scan_relocs(symtab, layout, this, p->data_shndx,
-				p->sh_type, p->contents->data(),
-				p->reloc_count, p->output_section,
-				p->needs_special_offset_handling,
-				this->local_symbol_count_,
-				local_symbols);
+	    {
+	      // If the relocs were prescanned, only scan the ones that
+	      // Prescan_relocs kept.
+	      const unsigned char* prelocs = p->contents->data();
+	      size_t reloc_count = p->reloc_count;
+	      if (p->is_prescanned)
+		{
+		  const int reloc_size =
+		    (p->sh_type == elfcpp::SHT_REL
+		     ? elfcpp::Elf_sizes<size>::rel_size
+		     : elfcpp::Elf_sizes<size>::rela_size);
+		  prelocs = p->pending.empty() ? NULL : &p->pending[0];
+		  reloc_count = p->pending.size() / reloc_size;
+		}
+	      if (!p->is_prescanned || reloc_count > 0)
+		target->scan_relocs(symtab, layout, this, p->data_shndx,
+				    p->sh_type, prelocs, reloc_count,
+				    p->output_section,
+				    p->needs_special_offset_handling,
+				    this->local_symbol_count_,
+				    local_symbols);
+	      std::vector<unsigned char>().swap(p->pending);
+	    }
 	  if (parameters->options().emit_relocs())
 	    this->emit_relocs_scan(symtab, layout, local_symbols, p);
 	  if (layout->incremental_inputs() != NULL)
@@ -1666,6 +1779,13 @@ Sized_relobj_file<64, true>::do_gc_process_relocs(Symbol_table* symtab,
 						  Read_relocs_data* rd);
 #endif
 
+#ifdef HAVE_TARGET_32_LITTLE
+template
+void
+Sized_relobj_file<32, false>::do_prescan_relocs(Symbol_table* symtab,
+						Read_relocs_data* rd);
+#endif
+
 #ifdef HAVE_TARGET_32_LITTLE
 template
 void
@@ -1674,6 +1794,13 @@ Sized_relobj_file<32, false>::do_scan_relocs(Symbol_table* symtab,
 					     Read_relocs_data* rd);
 #endif
 
+#ifdef HAVE_TARGET_32_BIG
+template
+void
+Sized_relobj_file<32, true>::do_prescan_relocs(Symbol_table* symtab,
+					       Read_relocs_data* rd);
+#endif
+
 #ifdef HAVE_TARGET_32_BIG
 template
 void
@@ -1682,6 +1809,13 @@ Sized_relobj_file<32, true>::do_scan_relocs(Symbol_table* symtab,
 					    Read_relocs_data* rd);
 #endif
 
+#ifdef HAVE_TARGET_64_LITTLE
+template
+void
+Sized_relobj_file<64, false>::do_prescan_relocs(Symbol_table* symtab,
+						Read_relocs_data* rd);
+#endif
+
 #ifdef HAVE_TARGET_64_LITTLE
 template
 void
@@ -1690,6 +1824,13 @@ Sized_relobj_file<64, false>::do_scan_relocs(Symbol_table* symtab,
 					     Read_relocs_data* rd);
 #endif
 
+#ifdef HAVE_TARGET_64_BIG
+template
+void
+Sized_relobj_file<64, true>::do_prescan_relocs(Symbol_table* symtab,
+					       Read_relocs_data* rd);
+#endif
+
 #ifdef HAVE_TARGET_64_BIG
 template
 void
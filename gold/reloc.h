@@ -64,10 +64,13 @@ class Read_relocs : public Task
  public:
   //   THIS_BLOCKER and NEXT_BLOCKER are passed along to a Scan_relocs
   // or Gc_process_relocs task, so that they run in a deterministic
-  // order.
+  // order.  COMMONS_BLOCKER and SCAN_BLOCKER are passed along to a
+  // Prescan_relocs task; they are NULL when queuing Gc_process_relocs.
   Read_relocs(Symbol_table* symtab, Layout* layout, Relobj* object,
+	      Task_token* commons_blocker, Task_token* scan_blocker,
 	      Task_token* this_blocker, Task_token* next_blocker)
     : symtab_(symtab), layout_(layout), object_(object),
+      commons_blocker_(commons_blocker), scan_blocker_(scan_blocker),
       this_blocker_(this_blocker), next_blocker_(next_blocker)
   { }
 
@@ -89,6 +92,8 @@ class Read_relocs : public Task
   Symbol_table* symtab_;
   Layout* layout_;
   Relobj* object_;
+  Task_token* commons_blocker_;
+  Task_token* scan_blocker_;
   Task_token* this_blocker_;
   Task_token* next_blocker_;
 };
@@ -134,6 +139,53 @@ class Gc_process_relocs : public Task
   Task_token* next_blocker_;
 };
 
+// Prescan the relocations for an object, dropping the ones which can
+// not require any GOT/PLT/COPY relocations.  These tasks run in
+// parallel, and then start a Scan_relocs task for the relocations
+// that are left.
+
+class Prescan_relocs : public Task
+{
+ public:
+  // COMMONS_BLOCKER, if not NULL, prevents this task from running
+  // until the common symbols have been allocated.  SCAN_BLOCKER
+  // prevents the first Scan_relocs task from running until all the
+  // Prescan_relocs tasks are finished.  THIS_BLOCKER and NEXT_BLOCKER
+  // are passed along to the Scan_relocs task.
+  Prescan_relocs(Symbol_table* symtab, Layout* layout, Relobj* object,
+		 Read_relocs_data* rd, Task_token* commons_blocker,
+		 Task_token* scan_blocker, Task_token* this_blocker,
+		 Task_token* next_blocker)
+    : symtab_(symtab), layout_(layout), object_(object), rd_(rd),
+      commons_blocker_(commons_blocker), scan_blocker_(scan_blocker),
+      this_blocker_(this_blocker), next_blocker_(next_blocker)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable();
+
+  void
+  locks(Task_locker*);
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const;
+
+ private:
+  Symbol_table* symtab_;
+  Layout* layout_;
+  Relobj* object_;
+  Read_relocs_data* rd_;
+  Task_token* commons_blocker_;
+  Task_token* scan_blocker_;
+  Task_token* this_blocker_;
+  Task_token* next_blocker_;
+};
+
 // Scan the relocations for an object to see if they require any
 // GOT/PLT/COPY relocations.
 
@@ -142,12 +194,15 @@ class Scan_relocs : public Task
  public:
   // THIS_BLOCKER prevents this task from running until the previous
   // one is finished.  NEXT_BLOCKER prevents the next task from
-  // running.
+  // running.  COMMONS_BLOCKER is the blocker shared by the
+  // Prescan_relocs tasks, which the first Scan_relocs task deletes
+  // since it runs after all of them; it is NULL for the others.
   Scan_relocs(Symbol_table* symtab, Layout* layout, Relobj* object,
-	      Read_relocs_data* rd, Task_token* this_blocker,
-	      Task_token* next_blocker)
+	      Read_relocs_data* rd, Task_token* commons_blocker,
+	      Task_token* this_blocker, Task_token* next_blocker)
     : symtab_(symtab), layout_(layout), object_(object), rd_(rd),
-      this_blocker_(this_blocker), next_blocker_(next_blocker)
+      commons_blocker_(commons_blocker), this_blocker_(this_blocker),
+      next_blocker_(next_blocker)
   { }
 
   ~Scan_relocs();
@@ -171,6 +226,7 @@ class Scan_relocs : public Task
   Layout* layout_;
   Relobj* object_;
   Read_relocs_data* rd_;
+  Task_token* commons_blocker_;
   Task_token* this_blocker_;
   Task_token* next_blocker_;
 };
@@ -25,9 +25,12 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 #include <fnmatch.h>
+#include <functional>
 #include <string>
 #include <vector>
+#include <sys/time.h>
 #include "filenames.h"
 
 #include "elfcpp.h"
@@ -1996,14 +1999,20 @@ Lazy_demangler::get()
 
 Version_script_info::Version_script_info()
   : dependency_lists_(), expression_lists_(), version_trees_(), globs_(),
-    default_version_(NULL), default_is_global_(false), is_finalized_(false)
+    default_version_(NULL), default_is_global_(false), is_finalized_(false),
+    lookup_count_(0), fnmatch_count_(0), lookup_usec_(0)
 {
   for (int i = 0; i < LANGUAGE_COUNT; ++i)
-    this->exact_[i] = NULL;
+    {
+      this->exact_[i] = NULL;
+      this->glob_matchers_[i] = NULL;
+    }
 }
 
 Version_script_info::~Version_script_info()
 {
+  for (int i = 0; i < LANGUAGE_COUNT; ++i)
+    delete this->glob_matchers_[i];
 }
 
 // Forget all the known version script information.
@@ -2271,7 +2280,7 @@ Version_script_info::build_expression_list_lookup(
 	{
 	  if (this->unquote(&pattern))
 	    {
-	      this->globs_.push_back(Glob(&exp, v, is_global));
+	      this->add_glob(&exp, v, is_global);
 	      continue;
 	    }
 	}
@@ -2283,6 +2292,312 @@ Version_script_info::build_expression_list_lookup(
     }
 }
 
+// Split the glob PATTERN into tokens, and store them in *TOKENS.
+// Record any bracket expressions in MATCHER.  We match patterns with
+// fnmatch using FNM_NOESCAPE, so a backslash is an ordinary
+// character.  Return false if the pattern has a bracket expression
+// which we do not handle, such as a character class name or one
+// with no closing ']'; in that case *TOKENS holds the tokens before
+// it.
+
+bool
+Version_script_info::glob_tokenize(const std::string& pattern,
+				   Glob_matcher* matcher,
+				   std::vector<unsigned int>* tokens)
+{
+  size_t len = pattern.length();
+  for (size_t i = 0; i < len; ++i)
+    {
+      unsigned char c = pattern[i];
+      if (c == '*')
+	tokens->push_back(GLOB_TOKEN_STAR);
+      else if (c == '?')
+	tokens->push_back(GLOB_TOKEN_ANY);
+      else if (c != '[')
+	tokens->push_back(c);
+      else
+	{
+	  size_t j = i + 1;
+	  if (j < len && (pattern[j] == '!' || pattern[j] == '^'))
+	    ++j;
+	  if (j < len && pattern[j] == ']')
+	    ++j;
+	  while (j < len && pattern[j] != ']')
+	    {
+	      if (pattern[j] == '['
+		  && j + 1 < len
+		  && strchr(":=.", pattern[j + 1]) != NULL)
+		return false;
+	      ++j;
+	    }
+	  if (j >= len)
+	    return false;
+
+	  std::string text(pattern, i, j + 1 - i);
+	  std::pair<std::map<std::string, unsigned int>::iterator, bool> ins =
+	    matcher->class_map.insert(std::make_pair(text,
+						     matcher->classes.size()));
+	  if (ins.second)
+	    {
+	      // Let fnmatch tell us which characters are in the class.
+	      std::vector<bool> chars(128);
+	      for (int k = 1; k < 128; ++k)
+		{
+		  char buf[2] = { static_cast<char>(k), '\0' };
+		  chars[k] = fnmatch(text.c_str(), buf, FNM_NOESCAPE) == 0;
+		}
+	      matcher->classes.push_back(chars);
+	    }
+	  tokens->push_back(GLOB_TOKEN_CLASS + ins.first->second);
+	  i = j;
+	}
+    }
+  return true;
+}
+
+// Add the nodes for the tokens from BEGIN to END to the glob trie
+// *TRIE, if they are not already there, and return the index of the
+// last one.  If REVERSE is true, add the tokens in reverse order.
+
+unsigned int
+Version_script_info::glob_trie_add(
+    Glob_trie* trie,
+    std::vector<unsigned int>::const_iterator begin,
+    std::vector<unsigned int>::const_iterator end,
+    bool reverse)
+{
+  unsigned int node = 0;
+  size_t count = end - begin;
+  for (size_t i = 0; i < count; ++i)
+    {
+      unsigned int token = reverse ? *(end - 1 - i) : *(begin + i);
+      gold_assert(token != GLOB_TOKEN_STAR);
+      unsigned int child = 0;
+      bool found = false;
+      if (token < GLOB_TOKEN_ANY)
+	{
+	  std::vector<std::pair<unsigned char, unsigned int> >& children =
+	    (*trie)[node].children;
+	  std::pair<unsigned char, unsigned int> key(token, 0);
+	  std::vector<std::pair<unsigned char, unsigned int> >::iterator q =
+	    std::lower_bound(children.begin(), children.end(), key);
+	  if (q != children.end() && q->first == token)
+	    {
+	      child = q->second;
+	      found = true;
+	    }
+	  else
+	    {
+	      child = trie->size();
+	      children.insert(q, std::make_pair(key.first, child));
+	    }
+	}
+      else
+	{
+	  std::vector<std::pair<unsigned int, unsigned int> >& children =
+	    (*trie)[node].wild_children;
+	  for (size_t j = 0; j < children.size(); ++j)
+	    {
+	      if (children[j].first == token)
+		{
+		  child = children[j].second;
+		  found = true;
+		  break;
+		}
+	    }
+	  if (!found)
+	    {
+	      child = trie->size();
+	      children.push_back(std::make_pair(token, child));
+	    }
+	}
+      // Don't use a reference into *TRIE across this push_back.
+      if (!found)
+	trie->push_back(Glob_trie_node());
+      node = child;
+    }
+  return node;
+}
+
+// Add to *NEXT the children in TRIE of the nodes in CURRENT for the
+// ASCII character C.
+
+void
+Version_script_info::glob_trie_step(const Glob_matcher* matcher,
+				    const Glob_trie& trie,
+				    const std::vector<unsigned int>& current,
+				    unsigned char c,
+				    std::vector<unsigned int>* next)
+{
+  for (size_t i = 0; i < current.size(); ++i)
+    {
+      const Glob_trie_node& n(trie[current[i]]);
+
+      std::pair<unsigned char, unsigned int> key(c, 0);
+      std::vector<std::pair<unsigned char, unsigned int> >::const_iterator q =
+	std::lower_bound(n.children.begin(), n.children.end(), key);
+      if (q != n.children.end() && q->first == c)
+	next->push_back(q->second);
+
+      for (size_t j = 0; j < n.wild_children.size(); ++j)
+	{
+	  unsigned int token = n.wild_children[j].first;
+	  if (token == GLOB_TOKEN_ANY
+	      || matcher->classes[token - GLOB_TOKEN_CLASS][c])
+	    next->push_back(n.wild_children[j].second);
+	}
+    }
+}
+
+// Add the glob pattern of the expression EXP, which maps to V and
+// IS_GLOBAL.  A pattern "PREFIX*", "*SUFFIX", or one with no '*', is
+// matched entirely by the tries.  Any other pattern is only passed to
+// fnmatch for names which match the tokens before its first '*'.
+
+void
+Version_script_info::add_glob(const Version_expression* exp,
+			      const Version_tree* v, bool is_global)
+{
+  int index = this->globs_.size();
+  this->globs_.push_back(Glob(exp, v, is_global));
+
+  Glob_matcher* matcher = this->glob_matchers_[exp->language];
+  if (matcher == NULL)
+    {
+      matcher = new Glob_matcher();
+      this->glob_matchers_[exp->language] = matcher;
+    }
+  matcher->globs.push_back(index);
+
+  std::vector<unsigned int> tokens;
+  bool ok = glob_tokenize(exp->pattern, matcher, &tokens);
+  std::vector<unsigned int>::const_iterator first_star =
+    std::find(tokens.begin(), tokens.end(),
+	      static_cast<unsigned int>(GLOB_TOKEN_STAR));
+  size_t star_count = std::count(tokens.begin(), tokens.end(),
+				 static_cast<unsigned int>(GLOB_TOKEN_STAR));
+
+  if (ok && star_count == 0)
+    {
+      unsigned int node = glob_trie_add(&matcher->prefixes, tokens.begin(),
+					tokens.end(), false);
+      matcher->prefixes[node].full_match = index;
+    }
+  else if (ok && star_count == 1 && first_star + 1 == tokens.end())
+    {
+      unsigned int node = glob_trie_add(&matcher->prefixes, tokens.begin(),
+					first_star, false);
+      matcher->prefixes[node].match = index;
+    }
+  else if (ok && star_count == 1 && first_star == tokens.begin())
+    {
+      unsigned int node = glob_trie_add(&matcher->suffixes, first_star + 1,
+					tokens.end(), true);
+      matcher->suffixes[node].match = index;
+    }
+  else
+    {
+      unsigned int node = glob_trie_add(&matcher->prefixes, tokens.begin(),
+					first_star, false);
+      matcher->prefixes[node].candidates.push_back(index);
+    }
+}
+
+// Return the index in globs_ of the last pattern in MATCHER which
+// matches NAME, if that is greater than BEST.  Otherwise return BEST.
+
+int
+Version_script_info::match_globs(const Glob_matcher* matcher,
+				 const char* name, int best) const
+{
+  size_t len = 0;
+  bool is_ascii = true;
+  for (const char* p = name; *p != '\0'; ++p, ++len)
+    if ((*p & 0x80) != 0)
+      is_ascii = false;
+
+  std::vector<unsigned int> candidates;
+  if (!is_ascii)
+    {
+      // In a multibyte locale '?' may match more than one byte, so
+      // just try every pattern.
+      for (std::vector<unsigned int>::const_reverse_iterator p =
+	     matcher->globs.rbegin();
+	   p != matcher->globs.rend() && static_cast<int>(*p) > best;
+	   ++p)
+	candidates.push_back(*p);
+    }
+  else
+    {
+      // Walk down the trie of prefixes, collecting the patterns which
+      // need to be checked with fnmatch.
+      const Glob_trie& prefixes(matcher->prefixes);
+      std::vector<unsigned int> current(1, 0);
+      std::vector<unsigned int> next;
+      for (size_t i = 0; ; ++i)
+	{
+	  for (size_t j = 0; j < current.size(); ++j)
+	    {
+	      const Glob_trie_node& n(prefixes[current[j]]);
+	      if (n.match > best)
+		best = n.match;
+	      if (i == len && n.full_match > best)
+		best = n.full_match;
+	      for (std::vector<unsigned int>::const_reverse_iterator p =
+		     n.candidates.rbegin();
+		   p != n.candidates.rend() && static_cast<int>(*p) > best;
+		   ++p)
+		candidates.push_back(*p);
+	    }
+	  if (i == len)
+	    break;
+	  next.clear();
+	  glob_trie_step(matcher, prefixes, current, name[i], &next);
+	  if (next.empty())
+	    break;
+	  current.swap(next);
+	}
+
+      // Walk back from the end of the name through the trie of
+      // suffixes.
+      const Glob_trie& suffixes(matcher->suffixes);
+      current.assign(1, 0);
+      for (size_t i = len; ; --i)
+	{
+	  for (size_t j = 0; j < current.size(); ++j)
+	    {
+	      const Glob_trie_node& n(suffixes[current[j]]);
+	      if (n.match > best)
+		best = n.match;
+	    }
+	  if (i == 0)
+	    break;
+	  next.clear();
+	  glob_trie_step(matcher, suffixes, current, name[i - 1], &next);
+	  if (next.empty())
+	    break;
+	  current.swap(next);
+	}
+
+      std::sort(candidates.begin(), candidates.end(),
+		std::greater<unsigned int>());
+    }
+
+  // Try the candidates which would win over BEST, starting with the
+  // last one.
+  for (size_t i = 0; i < candidates.size(); ++i)
+    {
+      if (static_cast<int>(candidates[i]) <= best)
+	break;
+      const Glob& glob(this->globs_[candidates[i]]);
+      ++this->fnmatch_count_;
+      if (fnmatch(glob.expression->pattern.c_str(), name, FNM_NOESCAPE) == 0)
+	return candidates[i];
+    }
+
+  return best;
+}
+
 // Return the name to match given a name, a language code, and two
 // lazy demanglers.
 
@@ -2315,6 +2630,29 @@ bool
 Version_script_info::get_symbol_version(const char* symbol_name,
 					std::string* pversion,
 					bool* p_is_global) const
+{
+  ++this->lookup_count_;
+  if (!parameters->options_valid() || !parameters->options().stats())
+    return this->lookup_symbol_version(symbol_name, pversion, p_is_global);
+
+  // Unlike the times call made by Timer, gettimeofday is cheap enough
+  // to call around each lookup.
+  struct timeval start;
+  gettimeofday(&start, NULL);
+  bool ret = this->lookup_symbol_version(symbol_name, pversion, p_is_global);
+  struct timeval end;
+  gettimeofday(&end, NULL);
+  this->lookup_usec_ += ((end.tv_sec - start.tv_sec) * 1000000LL
+			 + (end.tv_usec - start.tv_usec));
+  return ret;
+}
+
+// Do the work of get_symbol_version.
+
+bool
+Version_script_info::lookup_symbol_version(const char* symbol_name,
+					   std::string* pversion,
+					   bool* p_is_global) const
 {
   Lazy_demangler cpp_demangled_name(symbol_name, DMGL_ANSI | DMGL_PARAMS);
   Lazy_demangler java_demangled_name(symbol_name,
@@ -2366,29 +2704,32 @@ Version_script_info::get_symbol_version(const char* symbol_name,
 	}
     }
 
-  // Look through the glob patterns in reverse order.
+  // Find the last glob pattern which matches, in any language.
 
-  for (Globs::const_reverse_iterator p = this->globs_.rbegin();
-       p != this->globs_.rend();
-       ++p)
+  int best = -1;
+  for (int i = 0; i < LANGUAGE_COUNT; ++i)
     {
-      int language = p->expression->language;
-      const char* name_to_match = this->get_name_to_match(symbol_name,
-							  language,
+      const Glob_matcher* matcher = this->glob_matchers_[i];
+      if (matcher == NULL)
+	continue;
+
+      const char* name_to_match = this->get_name_to_match(symbol_name, i,
 							  &cpp_demangled_name,
 							  &java_demangled_name);
       if (name_to_match == NULL)
 	continue;
 
-      if (fnmatch(p->expression->pattern.c_str(), name_to_match,
-		  FNM_NOESCAPE) == 0)
-	{
-	  if (pversion != NULL)
-	    *pversion = p->version->tag;
-	  if (p_is_global != NULL)
-	    *p_is_global = p->is_global;
-	  return true;
-	}
+      best = this->match_globs(matcher, name_to_match, best);
+    }
+
+  if (best >= 0)
+    {
+      const Glob& glob(this->globs_[best]);
+      if (pversion != NULL)
+	*pversion = glob.version->tag;
+      if (p_is_global != NULL)
+	*p_is_global = glob.is_global;
+      return true;
     }
 
   // Finally, there may be a wildcard.
@@ -2404,6 +2745,20 @@ Version_script_info::get_symbol_version(const char* symbol_name,
   return false;
 }
 
+// Print statistics about symbol lookups.
+
+void
+Version_script_info::print_stats(const char* name) const
+{
+  fprintf(stderr, _("%s: %s: %u symbol lookups, %zu patterns, "
+		    "%u fnmatch fallbacks\n"),
+	  program_name, name, this->lookup_count_, this->globs_.size(),
+	  this->fnmatch_count_);
+  fprintf(stderr, _("%s: %s lookup time: (wall: %llu.%06llu)\n"),
+	  program_name, name, this->lookup_usec_ / 1000000,
+	  this->lookup_usec_ % 1000000);
+}
+
 // Give an error if any exact symbol names (not wildcards) appear in a
 // version script, but there is no such symbol.
 
@@ -31,6 +31,7 @@
 #define GOLD_SCRIPT_H
 
 #include <cstdio>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -226,10 +227,19 @@ class Version_script_info
   void
   print(FILE*) const;
 
+  // Print statistics about symbol lookups to stderr.  NAME describes
+  // the script, for the message.
+  void
+  print_stats(const char* name) const;
+
  private:
   void
   print_expression_list(FILE* f, const Version_expression_list*) const;
 
+  bool
+  lookup_symbol_version(const char* symbol, std::string* pversion,
+			bool* p_is_global) const;
+
   bool
   get_symbol_version_helper(const char* symbol,
 			    bool check_global,
@@ -287,6 +297,97 @@ class Version_script_info
 
   typedef std::vector<Glob> Globs;
 
+  // The glob patterns are compiled into tries, so that looking up a
+  // symbol does not have to try every pattern.  The patterns are
+  // split into tokens: a literal character, '?', a bracket
+  // expression, or '*'.  The edges of a trie are the tokens other
+  // than '*'.  The trie for the start of the name holds the tokens
+  // before the first '*' of each pattern.  The trie for the end of the
+  // name holds the tokens after the '*' of each pattern "*SUFFIX", in
+  // reverse order.  The tries only work a byte at a time, so a name
+  // with non-ASCII characters falls back to calling fnmatch.
+
+  // A token which is not a literal character.
+  enum
+  {
+    // '?'.
+    GLOB_TOKEN_ANY = 256,
+    // '*'.
+    GLOB_TOKEN_STAR = 257,
+    // The first bracket expression; bracket expression N is
+    // GLOB_TOKEN_CLASS + N.
+    GLOB_TOKEN_CLASS = 258
+  };
+
+  struct Glob_trie_node
+  {
+    Glob_trie_node()
+      : children(), wild_children(), match(-1), full_match(-1),
+	candidates()
+    { }
+
+    // The child nodes for literal characters, as pairs of the
+    // character and the index of the node, sorted by character.
+    std::vector<std::pair<unsigned char, unsigned int> > children;
+    // The child nodes for the other tokens, as pairs of the token and
+    // the index of the node.
+    std::vector<std::pair<unsigned int, unsigned int> > wild_children;
+    // The index in globs_ of the last pattern which matches every
+    // name that reaches this node, or -1 if there is none.  This is
+    // set for a pattern "PREFIX*" at the node for PREFIX.
+    int match;
+    // The index in globs_ of the last pattern which matches a name
+    // which ends at this node, or -1.  This is set for a pattern with
+    // no '*'.
+    int full_match;
+    // The indexes in globs_, in increasing order, of the other
+    // patterns whose tokens before the first '*' end at this node.
+    // These are checked by calling fnmatch.
+    std::vector<unsigned int> candidates;
+  };
+
+  typedef std::vector<Glob_trie_node> Glob_trie;
+
+  // The compiled glob patterns for one language.
+  struct Glob_matcher
+  {
+    Glob_matcher()
+      : prefixes(1), suffixes(1), classes(), class_map(), globs()
+    { }
+
+    // The trie of prefixes.
+    Glob_trie prefixes;
+    // The trie of reversed suffixes.
+    Glob_trie suffixes;
+    // The ASCII characters matched by each bracket expression.
+    std::vector<std::vector<bool> > classes;
+    // Map from the text of a bracket expression to its index in
+    // CLASSES.
+    std::map<std::string, unsigned int> class_map;
+    // The indexes in globs_ of all the patterns in this language, in
+    // increasing order, for names which the tries can not handle.
+    std::vector<unsigned int> globs;
+  };
+
+  static bool
+  glob_tokenize(const std::string&, Glob_matcher*,
+		std::vector<unsigned int>*);
+
+  static unsigned int
+  glob_trie_add(Glob_trie*, std::vector<unsigned int>::const_iterator,
+		std::vector<unsigned int>::const_iterator, bool reverse);
+
+  static void
+  glob_trie_step(const Glob_matcher*, const Glob_trie&,
+		 const std::vector<unsigned int>&, unsigned char,
+		 std::vector<unsigned int>*);
+
+  void
+  add_glob(const Version_expression*, const Version_tree*, bool is_global);
+
+  int
+  match_globs(const Glob_matcher*, const char*, int) const;
+
   bool
   unquote(std::string*) const;
 
@@ -310,8 +411,11 @@ class Version_script_info
   std::vector<Version_tree*> version_trees_;
   // Exact matches for global symbols, by language.
   Exact* exact_[LANGUAGE_COUNT];
-  // A vector of glob patterns mapping to Version_trees.
+  // A vector of glob patterns mapping to Version_trees.  When more
+  // than one pattern matches, the last one wins.
   Globs globs_;
+  // The compiled glob patterns, by language.
+  Glob_matcher* glob_matchers_[LANGUAGE_COUNT];
   // The default version to use, if there is one.  This is from a
   // pattern of "*".
   const Version_tree* default_version_;
@@ -319,6 +423,15 @@ class Version_script_info
   bool default_is_global_;
   // Whether this has been finalized.
   bool is_finalized_;
+  // The number of symbols looked up, for statistics.  The statistics
+  // are not locked, so they are approximate with --threads.
+  mutable unsigned int lookup_count_;
+  // The number of patterns tried with fnmatch because the tries could
+  // not decide them, for statistics.
+  mutable unsigned int fnmatch_count_;
+  // The wall clock time spent looking up symbols, in microseconds,
+  // summed over all threads.  This is only recorded with --stats.
+  mutable unsigned long long lookup_usec_;
 };
 
 // This class manages assignments to symbols.  These can appear in
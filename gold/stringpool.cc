@@ -24,10 +24,13 @@
 
 #include <cstring>
 #include <algorithm>
+#include <functional>
+#include <map>
 #include <vector>
 
 #include "output.h"
 #include "parameters.h"
+#include "gold-threads.h"
 #include "stringpool.h"
 
 namespace gold
@@ -241,6 +244,21 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 						      size_t length,
 						      bool copy,
 						      Key* pkey)
+{
+  return this->add_with_length_and_hash(s, length, string_hash(s, length),
+					copy, pkey);
+}
+
+// Add a string whose hash code has already been computed.
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_with_length_and_hash(
+    const Stringpool_char* s,
+    size_t length,
+    size_t hash_code,
+    bool copy,
+    Key* pkey)
 {
   typedef std::pair<typename String_set_type::iterator, bool> Insert_type;
 
@@ -252,7 +270,7 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
       // When we don't need to copy the string, we can call insert
       // directly.
 
-      std::pair<Hashkey, Hashval> element(Hashkey(s, length), k);
+      std::pair<Hashkey, Hashval> element(Hashkey(s, length, hash_code), k);
 
       Insert_type ins = this->string_set_.insert(element);
 
@@ -279,7 +297,7 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
   // canonicalize it by copying it into the canonical list. The hash
   // code will only be computed once.
 
-  Hashkey hk(s, length);
+  Hashkey hk(s, length, hash_code);
   typename String_set_type::const_iterator p = this->string_set_.find(hk);
   if (p != this->string_set_.end())
     {
@@ -368,6 +386,85 @@ Stringpool_template<Stringpool_char>::is_suffix(const Stringpool_char* s1,
   return memcmp(s1, s2 + len2 - len1, len1 * sizeof(Stringpool_char)) == 0;
 }
 
+// Jobs which sort separate vectors of strings, used when sorting a
+// large string pool.
+
+template<typename Sort_vector, typename Comparison>
+class Sort_string_buckets : public Parallel_jobs
+{
+ public:
+  Sort_string_buckets(const std::vector<Sort_vector*>& buckets)
+    : buckets_(buckets)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  { std::sort(this->buckets_[i]->begin(), this->buckets_[i]->end(),
+	      Comparison()); }
+
+ private:
+  const std::vector<Sort_vector*>& buckets_;
+};
+
+// Below this number of strings we always sort in a single thread.
+
+static const size_t parallel_sort_min_strings = 100000;
+
+// Sort the strings in V for suffix merging.  For a large pool this
+// splits the strings into buckets by their last character and sorts
+// the buckets in parallel.  Stringpool_sort_comparison compares the
+// last character first, so concatenating the sorted buckets in
+// descending order of last character, with the empty string (which
+// sorts after everything) at the end, gives exactly the order that a
+// single sort of the whole vector would give.
+
+template<typename Stringpool_char>
+void
+Stringpool_template<Stringpool_char>::sort_strings(
+    std::vector<Stringpool_sort_info>* v)
+{
+  int thread_count = Parallel_jobs::default_thread_count();
+  if (thread_count <= 1 || v->size() < parallel_sort_min_strings)
+    {
+      std::sort(v->begin(), v->end(), Stringpool_sort_comparison());
+      return;
+    }
+
+  typedef std::vector<Stringpool_sort_info> Sort_vector;
+  typedef std::map<Stringpool_char, Sort_vector,
+		   std::greater<Stringpool_char> > Bucket_map;
+  Bucket_map buckets;
+  Sort_vector empty;
+  for (typename Sort_vector::const_iterator p = v->begin();
+       p != v->end();
+       ++p)
+    {
+      const Hashkey& hk((*p)->first);
+      if (hk.length == 0)
+	empty.push_back(*p);
+      else
+	buckets[hk.string[hk.length - 1]].push_back(*p);
+    }
+
+  std::vector<Sort_vector*> jobs;
+  jobs.reserve(buckets.size());
+  for (typename Bucket_map::iterator p = buckets.begin();
+       p != buckets.end();
+       ++p)
+    jobs.push_back(&p->second);
+
+  Sort_string_buckets<Sort_vector, Stringpool_sort_comparison> sorter(jobs);
+  sorter.run(jobs.size(), thread_count);
+
+  v->clear();
+  for (typename Bucket_map::const_iterator p = buckets.begin();
+       p != buckets.end();
+       ++p)
+    v->insert(v->end(), p->second.begin(), p->second.end());
+  v->insert(v->end(), empty.begin(), empty.end());
+}
+
 // Turn the stringpool into an ELF strtab: determine the offsets of
 // each string in the table.
 
@@ -408,7 +505,7 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
            ++p)
         v.push_back(Stringpool_sort_info(p));
 
-      std::sort(v.begin(), v.end(), Stringpool_sort_comparison());
+      this->sort_strings(&v);
 
       section_offset_type last_offset = -1;
       for (typename std::vector<Stringpool_sort_info>::iterator last = v.end(),
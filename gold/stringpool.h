@@ -229,6 +229,21 @@ class Stringpool_template
   const Stringpool_char*
   add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey);
 
+  // Add string S of length LEN characters to the pool, where
+  // HASH_CODE is the value returned by hash_string for S and LEN.
+  // This permits callers to compute the hash code ahead of time,
+  // possibly in a different thread.
+  const Stringpool_char*
+  add_with_length_and_hash(const Stringpool_char* s, size_t len,
+			   size_t hash_code, bool copy, Key* pkey);
+
+  // Return the hash code which the pool will use for string S of
+  // length LEN characters.  This does not look at the pool, so it is
+  // safe to call while another thread is adding strings.
+  static size_t
+  hash_string(const Stringpool_char* s, size_t len)
+  { return string_hash(s, len); }
+
   // If the string S is present in the pool, return the canonical
   // string pointer.  Otherwise, return NULL.  If PKEY is not NULL,
   // set *PKEY to the key.
@@ -353,6 +368,10 @@ class Stringpool_template
     Hashkey(const Stringpool_char* s, size_t len)
       : string(s), length(len), hash_code(string_hash(s, len))
     { }
+
+    Hashkey(const Stringpool_char* s, size_t len, size_t hash)
+      : string(s), length(len), hash_code(hash)
+    { }
   };
 
   // Hash function.  This is trivial, since we have already computed
@@ -388,6 +407,10 @@ class Stringpool_template
     operator()(const Stringpool_sort_info&, const Stringpool_sort_info&) const;
   };
 
+  // Sort strings for suffix merging, possibly using several threads.
+  void
+  sort_strings(std::vector<Stringpool_sort_info>*);
+
   // Keys map to offsets via a Chunked_vector.  We only use the
   // offsets if we turn this into an string table section.
   typedef Chunked_vector<section_offset_type> Key_to_offset;
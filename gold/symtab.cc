@@ -31,6 +31,7 @@
 #include "demangle.h"
 
 #include "gc.h"
+#include "gold-threads.h"
 #include "object.h"
 #include "dwarf_reader.h"
 #include "dynobj.h"
@@ -45,6 +46,11 @@
 namespace gold
 {
 
+// The number of global symbols written by each job when writing the
+// symbol table in parallel.
+
+static const size_t symtab_write_job_size = 4096;
+
 // Class Symbol.
 
 // Initialize fields in Symbol.  This initializes everything except u_
@@ -567,7 +573,9 @@ Symbol_table::Symbol_table(unsigned int count,
   : saw_undefined_(0), offset_(0), table_(count), namepool_(),
     forwarders_(), commons_(), tls_commons_(), small_commons_(),
     large_commons_(), forced_locals_(), warnings_(),
-    version_script_(version_script), gc_(NULL), icf_(NULL),
+    candidate_odr_violations_(), odr_symbols_(0), odr_locations_(0),
+    odr_files_(0), odr_time_(), version_script_(version_script),
+    gc_(NULL), icf_(NULL),
     target_symbols_()
 {
   namepool_.reserve(count);
@@ -1144,6 +1152,59 @@ Symbol_table::add_from_object(Object* object,
   return ret;
 }
 
+// Split the names of the external symbols of a relocatable object
+// into name and version, and compute their hash codes.  This is
+// called while reading the symbols, so it must not touch the symbol
+// table.  Bad name offsets are diagnosed by add_from_relobj.
+
+template<int size, bool big_endian>
+void
+Symbol_table::compute_symbol_name_infos(const unsigned char* syms,
+					size_t count,
+					const char* sym_names,
+					size_t sym_name_size,
+					Symbol_name_infos* infos)
+{
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+
+  infos->resize(count);
+
+  const unsigned char* p = syms;
+  for (size_t i = 0; i < count; ++i, p += sym_size)
+    {
+      elfcpp::Sym<size, big_endian> sym(p);
+
+      unsigned int st_name = sym.get_st_name();
+      if (st_name >= sym_name_size)
+	continue;
+
+      Symbol_name_info* info = &(*infos)[i];
+      const char* name = sym_names + st_name;
+
+      // In an object file, an '@' in the name separates the symbol
+      // name from the version name.  If there are two '@' characters,
+      // this is the default version.
+      const char* ver = strchr(name, '@');
+      if (ver == NULL)
+	info->name_length = strlen(name);
+      else
+	{
+	  info->name_length = ver - name;
+	  ++ver;
+	  if (*ver == '@')
+	    {
+	      info->is_default_version = true;
+	      ++ver;
+	    }
+	  info->version_offset = ver - name;
+	  info->version_length = strlen(ver);
+	  info->version_hash = Stringpool::hash_string(ver,
+						       info->version_length);
+	}
+      info->name_hash = Stringpool::hash_string(name, info->name_length);
+    }
+}
+
 // Add all the symbols in a relocatable object to the hash table.
 
 template<int size, bool big_endian>
@@ -1155,6 +1216,7 @@ Symbol_table::add_from_relobj(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_infos& name_infos,
     typename Sized_relobj_file<size, big_endian>::Symbols* sympointers,
     size_t* defined)
 {
@@ -1211,12 +1273,14 @@ Symbol_table::add_from_relobj(
 	  is_defined_in_discarded_section = true;
 	}
 
-      // In an object file, an '@' in the name separates the symbol
-      // name from the version name.  If there are two '@' characters,
-      // this is the default version.
-      const char* ver = strchr(name, '@');
+      // The name was split into name and version by
+      // compute_symbol_name_infos.
+      const Symbol_name_info& name_info(name_infos[i]);
+      const char* ver = NULL;
+      if (name_info.version_offset != 0)
+	ver = name + name_info.version_offset;
       Stringpool::Key ver_key = 0;
-      int namelen = 0;
+      int namelen = name_info.name_length;
       // IS_DEFAULT_VERSION: is the version default?
       // IS_FORCED_LOCAL: is the symbol forced local?
       bool is_default_version = false;
@@ -1225,29 +1289,21 @@ Symbol_table::add_from_relobj(
       // FIXME: For incremental links, we don't store version information,
       // so we need to ignore version symbols for now.
       if (parameters->incremental_update() && ver != NULL)
-	{
-	  namelen = ver - name;
-	  ver = NULL;
-	}
+	ver = NULL;
 
       if (ver != NULL)
         {
           // The symbol name is of the form foo@VERSION or foo@@VERSION
-          namelen = ver - name;
-          ++ver;
-	  if (*ver == '@')
-	    {
-	      is_default_version = true;
-	      ++ver;
-	    }
-	  ver = this->namepool_.add(ver, true, &ver_key);
+	  is_default_version = name_info.is_default_version;
+	  ver = this->namepool_.add_with_length_and_hash(
+	      ver, name_info.version_length, name_info.version_hash, true,
+	      &ver_key);
         }
       // We don't want to assign a version to an undefined symbol,
       // even if it is listed in the version script.  FIXME: What
       // about a common symbol?
       else
 	{
-	  namelen = strlen(name);
 	  if (!this->version_script_.empty()
 	      && st_shndx != elfcpp::SHN_UNDEF)
 	    {
@@ -1319,8 +1375,9 @@ Symbol_table::add_from_relobj(
         }
 
       Stringpool::Key name_key;
-      name = this->namepool_.add_with_length(name, namelen, true,
-					     &name_key);
+      name = this->namepool_.add_with_length_and_hash(name, namelen,
+						      name_info.name_hash,
+						      true, &name_key);
 
       Sized_symbol<size>* res;
       res = this->add_from_object(relobj, name, name_key, ver, ver_key,
@@ -2955,32 +3012,38 @@ Symbol_table::write_globals(const Stringpool* sympool,
 			    const Stringpool* dynpool,
 			    Output_symtab_xindex* symtab_xindex,
 			    Output_symtab_xindex* dynsym_xindex,
-			    Output_file* of) const
+			    Output_file* of,
+			    Workqueue* workqueue,
+			    Task_token* final_blocker) const
 {
   switch (parameters->size_and_endianness())
     {
 #ifdef HAVE_TARGET_32_LITTLE
     case Parameters::TARGET_32_LITTLE:
       this->sized_write_globals<32, false>(sympool, dynpool, symtab_xindex,
-					   dynsym_xindex, of);
+					   dynsym_xindex, of, workqueue,
+					   final_blocker);
       break;
 #endif
 #ifdef HAVE_TARGET_32_BIG
     case Parameters::TARGET_32_BIG:
       this->sized_write_globals<32, true>(sympool, dynpool, symtab_xindex,
-					  dynsym_xindex, of);
+					  dynsym_xindex, of, workqueue,
+					  final_blocker);
       break;
 #endif
 #ifdef HAVE_TARGET_64_LITTLE
     case Parameters::TARGET_64_LITTLE:
       this->sized_write_globals<64, false>(sympool, dynpool, symtab_xindex,
-					   dynsym_xindex, of);
+					   dynsym_xindex, of, workqueue,
+					   final_blocker);
       break;
 #endif
 #ifdef HAVE_TARGET_64_BIG
     case Parameters::TARGET_64_BIG:
       this->sized_write_globals<64, true>(sympool, dynpool, symtab_xindex,
-					  dynsym_xindex, of);
+					  dynsym_xindex, of, workqueue,
+					  final_blocker);
       break;
 #endif
     default:
@@ -2988,7 +3051,329 @@ Symbol_table::write_globals(const Stringpool* sympool,
     }
 }
 
-// Write out the global symbols.
+// Write out the global symbol SYM to the views PSYMS and
+// DYNAMIC_VIEW, either of which may be NULL.  This may be called for
+// different symbols in parallel, so the extended section indexes are
+// returned in SYMTAB_XINDEX and DYNSYM_XINDEX rather than being added
+// to the Output_symtab_xindex sections directly, and a symbol with an
+// unsupported section index is added to BAD_SHNDX rather than being
+// reported.
+
+template<int size, bool big_endian>
+void
+Symbol_table::sized_write_global(Sized_symbol<size>* sym,
+				 const Stringpool* sympool,
+				 const Stringpool* dynpool,
+				 unsigned char* psyms,
+				 unsigned char* dynamic_view,
+				 Xindex_list* symtab_xindex,
+				 Xindex_list* dynsym_xindex,
+				 Bad_shndx_list* bad_shndx) const
+{
+  const Target& target = parameters->target();
+
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+
+  unsigned int sym_index = sym->symtab_index();
+  unsigned int dynsym_index;
+  if (dynamic_view == NULL)
+    dynsym_index = -1U;
+  else
+    dynsym_index = sym->dynsym_index();
+
+  unsigned int shndx;
+  typename elfcpp::Elf_types<size>::Elf_Addr sym_value = sym->value();
+  typename elfcpp::Elf_types<size>::Elf_Addr dynsym_value = sym_value;
+  elfcpp::STB binding = sym->binding();
+
+  // If --weak-unresolved-symbols is set, change binding of unresolved
+  // global symbols to STB_WEAK.
+  if (parameters->options().weak_unresolved_symbols()
+      && binding == elfcpp::STB_GLOBAL
+      && sym->is_undefined())
+    binding = elfcpp::STB_WEAK;
+
+  // If --no-gnu-unique is set, change STB_GNU_UNIQUE to STB_GLOBAL.
+  if (binding == elfcpp::STB_GNU_UNIQUE
+      && !parameters->options().gnu_unique())
+    binding = elfcpp::STB_GLOBAL;
+
+  switch (sym->source())
+    {
+    case Symbol::FROM_OBJECT:
+      {
+	bool is_ordinary;
+	unsigned int in_shndx = sym->shndx(&is_ordinary);
+
+	if (!is_ordinary
+	    && in_shndx != elfcpp::SHN_ABS
+	    && !Symbol::is_common_shndx(in_shndx))
+	  {
+	    bad_shndx->push_back(std::make_pair(sym, in_shndx));
+	    shndx = in_shndx;
+	  }
+	else
+	  {
+	    Object* symobj = sym->object();
+	    if (symobj->is_dynamic())
+	      {
+		if (sym->needs_dynsym_value())
+		  dynsym_value = target.dynsym_value(sym);
+		shndx = elfcpp::SHN_UNDEF;
+		if (sym->is_undef_binding_weak())
+		  binding = elfcpp::STB_WEAK;
+		else
+		  binding = elfcpp::STB_GLOBAL;
+	      }
+	    else if (symobj->pluginobj() != NULL)
+	      shndx = elfcpp::SHN_UNDEF;
+	    else if (in_shndx == elfcpp::SHN_UNDEF
+		     || (!is_ordinary
+			 && (in_shndx == elfcpp::SHN_ABS
+			     || Symbol::is_common_shndx(in_shndx))))
+	      shndx = in_shndx;
+	    else
+	      {
+		Relobj* relobj = static_cast<Relobj*>(symobj);
+		Output_section* os = relobj->output_section(in_shndx);
+		if (this->is_section_folded(relobj, in_shndx))
+		  {
+		    // This global symbol must be written out even though
+		    // it is folded.
+		    // Get the os of the section it is folded onto.
+		    Section_id folded =
+			 this->icf_->get_folded_section(relobj, in_shndx);
+		    gold_assert(folded.first !=NULL);
+		    Relobj* folded_obj = 
+		      reinterpret_cast<Relobj*>(folded.first);
+		    os = folded_obj->output_section(folded.second);  
+		    gold_assert(os != NULL);
+		  }
+		gold_assert(os != NULL);
+		shndx = os->out_shndx();
+
+		if (shndx >= elfcpp::SHN_LORESERVE)
+		  {
+		    if (sym_index != -1U)
+		      symtab_xindex->push_back(std::make_pair(sym_index,
+							      shndx));
+		    if (dynsym_index != -1U)
+		      dynsym_xindex->push_back(std::make_pair(dynsym_index,
+							      shndx));
+		    shndx = elfcpp::SHN_XINDEX;
+		  }
+
+		// In object files symbol values are section
+		// relative.
+		if (parameters->options().relocatable())
+		  sym_value -= os->address();
+	      }
+	  }
+      }
+      break;
+
+    case Symbol::IN_OUTPUT_DATA:
+      {
+	Output_data* od = sym->output_data();
+
+	shndx = od->out_shndx();
+	if (shndx >= elfcpp::SHN_LORESERVE)
+	  {
+	    if (sym_index != -1U)
+	      symtab_xindex->push_back(std::make_pair(sym_index, shndx));
+	    if (dynsym_index != -1U)
+	      dynsym_xindex->push_back(std::make_pair(dynsym_index, shndx));
+	    shndx = elfcpp::SHN_XINDEX;
+	  }
+
+	// In object files symbol values are section
+	// relative.
+	if (parameters->options().relocatable())
+	  {
+	    Output_section* os = od->output_section();
+	    gold_assert(os != NULL);
+	    sym_value -= os->address();
+	  }
+      }
+      break;
+
+    case Symbol::IN_OUTPUT_SEGMENT:
+      {
+	Output_segment* oseg = sym->output_segment();
+	Output_section* osect = oseg->first_section();
+	if (osect == NULL)
+	  shndx = elfcpp::SHN_ABS;
+	else
+	  shndx = osect->out_shndx();
+      }
+      break;
+
+    case Symbol::IS_CONSTANT:
+      shndx = elfcpp::SHN_ABS;
+      break;
+
+    case Symbol::IS_UNDEFINED:
+      shndx = elfcpp::SHN_UNDEF;
+      break;
+
+    default:
+      gold_unreachable();
+    }
+
+  if (sym_index != -1U)
+    {
+      sym_index -= this->first_global_index_;
+      gold_assert(sym_index < this->output_count_);
+      unsigned char* ps = psyms + (sym_index * sym_size);
+      this->sized_write_symbol<size, big_endian>(sym, sym_value, shndx,
+						 binding, sympool, ps);
+    }
+
+  if (dynsym_index != -1U)
+    {
+      dynsym_index -= this->first_dynamic_global_index_;
+      gold_assert(dynsym_index < this->dynamic_count_);
+      unsigned char* pd = dynamic_view + (dynsym_index * sym_size);
+      this->sized_write_symbol<size, big_endian>(sym, dynsym_value, shndx,
+						 binding, dynpool, pd);
+      // Allow a target to adjust dynamic symbol value.
+      parameters->target().adjust_dyn_symbol(sym, pd);
+    }
+}
+
+// The state shared by the tasks which write the global symbols.
+// Range I of SYMS starts with symbol I * symtab_write_job_size.  The
+// task for range I records the extended section indexes and the bad
+// section indexes that it finds in the lists for range I, which are
+// used in order once all the ranges are written.
+
+template<int size, bool big_endian>
+class Symbol_table::Write_globals_state
+{
+ public:
+  Write_globals_state(const Stringpool* sympool, const Stringpool* dynpool,
+		      Output_symtab_xindex* symtab_xindex,
+		      Output_symtab_xindex* dynsym_xindex,
+		      Output_file* of, unsigned char* psyms,
+		      unsigned char* dynamic_view)
+    : sympool(sympool), dynpool(dynpool), symtab_xindex(symtab_xindex),
+      dynsym_xindex(dynsym_xindex), of(of), psyms(psyms),
+      dynamic_view(dynamic_view), syms(), symtab_xindexes(),
+      dynsym_xindexes(), bad_shndxes(), ranges_blocker(new Task_token(true))
+  { }
+
+  ~Write_globals_state()
+  { delete this->ranges_blocker; }
+
+  const Stringpool* sympool;
+  const Stringpool* dynpool;
+  Output_symtab_xindex* symtab_xindex;
+  Output_symtab_xindex* dynsym_xindex;
+  Output_file* of;
+  unsigned char* psyms;
+  unsigned char* dynamic_view;
+  // The symbols to write.
+  std::vector<Symbol*> syms;
+  // The lists for each range.
+  std::vector<Xindex_list> symtab_xindexes;
+  std::vector<Xindex_list> dynsym_xindexes;
+  std::vector<Bad_shndx_list> bad_shndxes;
+  // Blocks the finish task until all the ranges are written.
+  Task_token* ranges_blocker;
+};
+
+// A task which writes one range of the global symbols.
+
+template<int size, bool big_endian>
+class Symbol_table::Write_globals_range_task : public Task
+{
+ public:
+  Write_globals_range_task(const Symbol_table* symtab,
+			   Write_globals_state<size, big_endian>* state,
+			   size_t range)
+    : symtab_(symtab), state_(state), range_(range)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->state_->ranges_blocker); }
+
+  void
+  run(Workqueue*)
+  {
+    Write_globals_state<size, big_endian>* state = this->state_;
+    size_t i = this->range_;
+    size_t end = std::min((i + 1) * symtab_write_job_size,
+			  state->syms.size());
+    for (size_t j = i * symtab_write_job_size; j < end; ++j)
+      this->symtab_->sized_write_global<size, big_endian>(
+	  static_cast<Sized_symbol<size>*>(state->syms[j]),
+	  state->sympool, state->dynpool, state->psyms, state->dynamic_view,
+	  &state->symtab_xindexes[i], &state->dynsym_xindexes[i],
+	  &state->bad_shndxes[i]);
+  }
+
+  std::string
+  get_name() const
+  { return "Write_globals_range_task"; }
+
+ private:
+  const Symbol_table* symtab_;
+  Write_globals_state<size, big_endian>* state_;
+  size_t range_;
+};
+
+// A task which runs after all the ranges of global symbols are
+// written.  It reports errors, records the extended section indexes,
+// writes the target symbols and releases the views.  It unblocks
+// FINAL_BLOCKER when it is done.
+
+template<int size, bool big_endian>
+class Symbol_table::Write_globals_finish_task : public Task
+{
+ public:
+  Write_globals_finish_task(const Symbol_table* symtab,
+			    Write_globals_state<size, big_endian>* state,
+			    Task_token* final_blocker)
+    : symtab_(symtab), state_(state), final_blocker_(final_blocker)
+  { }
+
+  ~Write_globals_finish_task()
+  { delete this->state_; }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->state_->ranges_blocker->is_blocked())
+      return this->state_->ranges_blocker;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->final_blocker_); }
+
+  void
+  run(Workqueue*)
+  { this->symtab_->sized_finish_write_globals(this->state_); }
+
+  std::string
+  get_name() const
+  { return "Write_globals_finish_task"; }
+
+ private:
+  const Symbol_table* symtab_;
+  Write_globals_state<size, big_endian>* state_;
+  Task_token* final_blocker_;
+};
+
+// Write out the global symbols.  This finds the symbols to write, and
+// queues tasks to write them in ranges, which may run in parallel,
+// and a task to finish up which unblocks FINAL_BLOCKER.
 
 template<int size, bool big_endian>
 void
@@ -2996,15 +3381,14 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
 				  const Stringpool* dynpool,
 				  Output_symtab_xindex* symtab_xindex,
 				  Output_symtab_xindex* dynsym_xindex,
-				  Output_file* of) const
+				  Output_file* of,
+				  Workqueue* workqueue,
+				  Task_token* final_blocker) const
 {
-  const Target& target = parameters->target();
-
   const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
 
   const unsigned int output_count = this->output_count_;
   const section_size_type oview_size = output_count * sym_size;
-  const unsigned int first_global_index = this->first_global_index_;
   unsigned char* psyms;
   if (this->offset_ == 0 || output_count == 0)
     psyms = NULL;
@@ -3013,193 +3397,93 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
 
   const unsigned int dynamic_count = this->dynamic_count_;
   const section_size_type dynamic_size = dynamic_count * sym_size;
-  const unsigned int first_dynamic_global_index =
-    this->first_dynamic_global_index_;
   unsigned char* dynamic_view;
   if (this->dynamic_offset_ == 0 || dynamic_count == 0)
     dynamic_view = NULL;
   else
     dynamic_view = of->get_output_view(this->dynamic_offset_, dynamic_size);
 
+  Write_globals_state<size, big_endian>* state =
+    new Write_globals_state<size, big_endian>(sympool, dynpool,
+					      symtab_xindex, dynsym_xindex,
+					      of, psyms, dynamic_view);
+
+  // Find the symbols to write.  Warnings about unresolved symbols in
+  // shared libraries are issued here, so that they come out in the
+  // same order however many threads we use.
+  std::vector<Symbol*>& syms(state->syms);
+  syms.reserve(this->table_.size());
   for (Symbol_table_type::const_iterator p = this->table_.begin();
        p != this->table_.end();
        ++p)
     {
-      Sized_symbol<size>* sym = static_cast<Sized_symbol<size>*>(p->second);
+      Symbol* sym = p->second;
 
       // Possibly warn about unresolved symbols in shared libraries.
       this->warn_about_undefined_dynobj_symbol(sym);
 
-      unsigned int sym_index = sym->symtab_index();
-      unsigned int dynsym_index;
-      if (dynamic_view == NULL)
-	dynsym_index = -1U;
-      else
-	dynsym_index = sym->dynsym_index();
-
-      if (sym_index == -1U && dynsym_index == -1U)
+      if (sym->symtab_index() == -1U
+	  && (dynamic_view == NULL || sym->dynsym_index() == -1U))
 	{
 	  // This symbol is not included in the output file.
 	  continue;
 	}
 
-      unsigned int shndx;
-      typename elfcpp::Elf_types<size>::Elf_Addr sym_value = sym->value();
-      typename elfcpp::Elf_types<size>::Elf_Addr dynsym_value = sym_value;
-      elfcpp::STB binding = sym->binding();
-
-      // If --weak-unresolved-symbols is set, change binding of unresolved
-      // global symbols to STB_WEAK.
-      if (parameters->options().weak_unresolved_symbols()
-	  && binding == elfcpp::STB_GLOBAL
-	  && sym->is_undefined())
-	binding = elfcpp::STB_WEAK;
-
-      // If --no-gnu-unique is set, change STB_GNU_UNIQUE to STB_GLOBAL.
-      if (binding == elfcpp::STB_GNU_UNIQUE
-	  && !parameters->options().gnu_unique())
-	binding = elfcpp::STB_GLOBAL;
-
-      switch (sym->source())
-	{
-	case Symbol::FROM_OBJECT:
-	  {
-	    bool is_ordinary;
-	    unsigned int in_shndx = sym->shndx(&is_ordinary);
-
-	    if (!is_ordinary
-		&& in_shndx != elfcpp::SHN_ABS
-		&& !Symbol::is_common_shndx(in_shndx))
-	      {
-		gold_error(_("%s: unsupported symbol section 0x%x"),
-			   sym->demangled_name().c_str(), in_shndx);
-		shndx = in_shndx;
-	      }
-	    else
-	      {
-		Object* symobj = sym->object();
-		if (symobj->is_dynamic())
-		  {
-		    if (sym->needs_dynsym_value())
-		      dynsym_value = target.dynsym_value(sym);
-		    shndx = elfcpp::SHN_UNDEF;
-		    if (sym->is_undef_binding_weak())
-		      binding = elfcpp::STB_WEAK;
-		    else
-		      binding = elfcpp::STB_GLOBAL;
-		  }
-		else if (symobj->pluginobj() != NULL)
-		  shndx = elfcpp::SHN_UNDEF;
-		else if (in_shndx == elfcpp::SHN_UNDEF
-			 || (!is_ordinary
-			     && (in_shndx == elfcpp::SHN_ABS
-				 || Symbol::is_common_shndx(in_shndx))))
-		  shndx = in_shndx;
-		else
-		  {
-		    Relobj* relobj = static_cast<Relobj*>(symobj);
-		    Output_section* os = relobj->output_section(in_shndx);
-                    if (this->is_section_folded(relobj, in_shndx))
-                      {
-                        // This global symbol must be written out even though
-                        // it is folded.
-                        // Get the os of the section it is folded onto.
-                        Section_id folded =
-                             this->icf_->get_folded_section(relobj, in_shndx);
-                        gold_assert(folded.first !=NULL);
-                        Relobj* folded_obj = 
-                          reinterpret_cast<Relobj*>(folded.first);
-                        os = folded_obj->output_section(folded.second);  
-                        gold_assert(os != NULL);
-                      }
-		    gold_assert(os != NULL);
-		    shndx = os->out_shndx();
-
-		    if (shndx >= elfcpp::SHN_LORESERVE)
-		      {
-			if (sym_index != -1U)
-			  symtab_xindex->add(sym_index, shndx);
-			if (dynsym_index != -1U)
-			  dynsym_xindex->add(dynsym_index, shndx);
-			shndx = elfcpp::SHN_XINDEX;
-		      }
-
-		    // In object files symbol values are section
-		    // relative.
-		    if (parameters->options().relocatable())
-		      sym_value -= os->address();
-		  }
-	      }
-	  }
-	  break;
-
-	case Symbol::IN_OUTPUT_DATA:
-	  {
-	    Output_data* od = sym->output_data();
-
-	    shndx = od->out_shndx();
-	    if (shndx >= elfcpp::SHN_LORESERVE)
-	      {
-		if (sym_index != -1U)
-		  symtab_xindex->add(sym_index, shndx);
-		if (dynsym_index != -1U)
-		  dynsym_xindex->add(dynsym_index, shndx);
-		shndx = elfcpp::SHN_XINDEX;
-	      }
-
-	    // In object files symbol values are section
-	    // relative.
-	    if (parameters->options().relocatable())
-	      {
-		Output_section* os = od->output_section();
-		gold_assert(os != NULL);
-		sym_value -= os->address();
-	      }
-	  }
-	  break;
-
-	case Symbol::IN_OUTPUT_SEGMENT:
-	  {
-	    Output_segment* oseg = sym->output_segment();
-	    Output_section* osect = oseg->first_section();
-	    if (osect == NULL)
-	      shndx = elfcpp::SHN_ABS;
-	    else
-	      shndx = osect->out_shndx();
-	  }
-	  break;
-
-	case Symbol::IS_CONSTANT:
-	  shndx = elfcpp::SHN_ABS;
-	  break;
+      syms.push_back(sym);
+    }
 
-	case Symbol::IS_UNDEFINED:
-	  shndx = elfcpp::SHN_UNDEF;
-	  break;
+  // The symbol names were added to the string pools when the symbol
+  // table was finalized, so the string offsets are fixed, and each
+  // symbol is written at the index which was assigned to it then.
+  // So the ranges may be written in any order.
+  size_t range_count = ((syms.size() + symtab_write_job_size - 1)
+			/ symtab_write_job_size);
+  state->symtab_xindexes.resize(range_count);
+  state->dynsym_xindexes.resize(range_count);
+  state->bad_shndxes.resize(range_count);
+  state->ranges_blocker->add_blockers(range_count);
+
+  for (size_t i = 0; i < range_count; ++i)
+    workqueue->queue_soon(new Write_globals_range_task<size, big_endian>(
+			    this, state, i));
+  workqueue->queue_soon(new Write_globals_finish_task<size, big_endian>(
+			  this, state, final_blocker));
+}
 
-	default:
-	  gold_unreachable();
-	}
+// Finish writing out the global symbols, once all the ranges in STATE
+// have been written.
 
-      if (sym_index != -1U)
-	{
-	  sym_index -= first_global_index;
-	  gold_assert(sym_index < output_count);
-	  unsigned char* ps = psyms + (sym_index * sym_size);
-	  this->sized_write_symbol<size, big_endian>(sym, sym_value, shndx,
-						     binding, sympool, ps);
-	}
+template<int size, bool big_endian>
+void
+Symbol_table::sized_finish_write_globals(
+    Write_globals_state<size, big_endian>* state) const
+{
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+  const unsigned int output_count = this->output_count_;
+  const unsigned int first_global_index = this->first_global_index_;
+  const unsigned int dynamic_count = this->dynamic_count_;
+  const unsigned int first_dynamic_global_index =
+    this->first_dynamic_global_index_;
+  unsigned char* const psyms = state->psyms;
+  unsigned char* const dynamic_view = state->dynamic_view;
 
-      if (dynsym_index != -1U)
-	{
-	  dynsym_index -= first_dynamic_global_index;
-	  gold_assert(dynsym_index < dynamic_count);
-	  unsigned char* pd = dynamic_view + (dynsym_index * sym_size);
-	  this->sized_write_symbol<size, big_endian>(sym, dynsym_value, shndx,
-						     binding, dynpool, pd);
-          // Allow a target to adjust dynamic symbol value.
-          parameters->target().adjust_dyn_symbol(sym, pd);
-	}
+  // Report the errors and record the extended section indexes in
+  // symbol order.
+  for (size_t i = 0; i < state->bad_shndxes.size(); ++i)
+    {
+      for (Bad_shndx_list::const_iterator p = state->bad_shndxes[i].begin();
+	   p != state->bad_shndxes[i].end();
+	   ++p)
+	gold_error(_("%s: unsupported symbol section 0x%x"),
+		   p->first->demangled_name().c_str(), p->second);
+      for (Xindex_list::const_iterator p = state->symtab_xindexes[i].begin();
+	   p != state->symtab_xindexes[i].end();
+	   ++p)
+	state->symtab_xindex->add(p->first, p->second);
+      for (Xindex_list::const_iterator p = state->dynsym_xindexes[i].begin();
+	   p != state->dynsym_xindexes[i].end();
+	   ++p)
+	state->dynsym_xindex->add(p->first, p->second);
     }
 
   // Write the target-specific symbols.
@@ -3235,8 +3519,8 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
 	  gold_assert(sym_index < output_count);
 	  unsigned char* ps = psyms + (sym_index * sym_size);
 	  this->sized_write_symbol<size, big_endian>(sym, sym->value(), shndx,
-						     sym->binding(), sympool,
-						     ps);
+						     sym->binding(),
+						     state->sympool, ps);
 	}
 
       if (dynsym_index != -1U)
@@ -3245,14 +3529,16 @@ Symbol_table::sized_write_globals(const Stringpool* sympool,
 	  gold_assert(dynsym_index < dynamic_count);
 	  unsigned char* pd = dynamic_view + (dynsym_index * sym_size);
 	  this->sized_write_symbol<size, big_endian>(sym, sym->value(), shndx,
-						     sym->binding(), dynpool,
-						     pd);
+						     sym->binding(),
+						     state->dynpool, pd);
 	}
     }
 
-  of->write_output_view(this->offset_, oview_size, psyms);
+  Output_file* of = state->of;
+  of->write_output_view(this->offset_, output_count * sym_size, psyms);
   if (dynamic_view != NULL)
-    of->write_output_view(this->dynamic_offset_, dynamic_size, dynamic_view);
+    of->write_output_view(this->dynamic_offset_, dynamic_count * sym_size,
+			  dynamic_view);
 }
 
 // Write out the symbol SYM, in section SHNDX, to P.  POOL is the
@@ -3410,6 +3696,25 @@ Symbol_table::print_stats() const
 	  program_name, this->table_.size());
 #endif
   this->namepool_.print_stats("symbol table stringpool");
+  if (!this->version_script_.empty())
+    this->version_script_.print_stats("version script");
+  if (parameters->options().have_dynamic_list())
+    parameters->options().dynamic_list_info()->print_stats("dynamic list");
+  if (parameters->options().detect_odr_violations())
+    {
+      fprintf(stderr, _("%s: ODR violation candidates: %u symbols, "
+			"%u locations in %u files\n"),
+	      program_name, this->odr_symbols_, this->odr_locations_,
+	      this->odr_files_);
+      const Timer::TimeStats& elapsed(this->odr_time_);
+      fprintf(stderr,
+	      _("%s: ODR violation check time: "
+		"(user: %ld.%06ld sys: %ld.%06ld wall: %ld.%06ld)\n"),
+	      program_name,
+	      elapsed.user / 1000, (elapsed.user % 1000) * 1000,
+	      elapsed.sys / 1000, (elapsed.sys % 1000) * 1000,
+	      elapsed.wall / 1000, (elapsed.wall % 1000) * 1000);
+    }
 }
 
 // We check for ODR violations by looking for symbols with the same
@@ -3448,31 +3753,85 @@ struct Odr_violation_compare
 };
 
 // Returns all of the lines attached to LOC, not just the one the
-// instruction actually came from.
-std::vector<std::string>
-Symbol_table::linenos_from_loc(const Task* task,
-                               const Symbol_location& loc)
-{
-  // We need to lock the object in order to read it.  This
-  // means that we have to run in a singleton Task.  If we
-  // want to run this in a general Task for better
-  // performance, we will need one Task for object, plus
-  // appropriate locking to ensure that we don't conflict with
-  // other uses of the object.  Also note, one_addr2line is not
-  // currently thread-safe.
-  Task_lock_obj<Object> tl(task, loc.object);
+// instruction actually came from.  LINEINFO is the line information
+// for the object of LOC, which must be locked.
 
+std::vector<std::string>
+Symbol_table::linenos_from_loc(const Symbol_location& loc,
+			       Dwarf_line_info* lineinfo)
+{
   std::vector<std::string> result;
   Symbol_location code_loc = loc;
   parameters->target().function_location(&code_loc);
-  // 16 is the size of the object-cache that one_addr2line should use.
-  std::string canonical_result = Dwarf_line_info::one_addr2line(
-      code_loc.object, code_loc.shndx, code_loc.offset, 16, &result);
+  gold_assert(code_loc.object == loc.object);
+  std::string canonical_result = lineinfo->addr2line(code_loc.shndx,
+						     code_loc.offset,
+						     &result);
   if (!canonical_result.empty())
     result.push_back(canonical_result);
   return result;
 }
 
+// Jobs which find the line numbers of the candidate ODR violations.
+// Job I handles the locations in FILES[I], which are all in objects
+// read from the same input file, so that no two jobs read the same
+// file at once.  The locations are sorted by object, and the line
+// information of each object is decoded just once, for all the
+// locations in it.
+
+class Symbol_table::Odr_lineno_jobs : public Parallel_jobs
+{
+ public:
+  Odr_lineno_jobs(const Task* task,
+		  const std::vector<const Symbol_location*>& locs,
+		  const std::vector<std::vector<size_t> >& files,
+		  std::vector<std::vector<std::string> >* linenos)
+    : task_(task), locs_(locs), files_(files), linenos_(linenos)
+  { }
+
+ protected:
+  void
+  do_job(size_t i)
+  {
+    const std::vector<size_t>& file(this->files_[i]);
+    size_t j = 0;
+    while (j < file.size())
+      {
+	Object* object = this->locs_[file[j]]->object;
+	Task_lock_obj<Object> tl(this->task_, object);
+	Dwarf_line_info* lineinfo = Dwarf_line_info::create(object, -1U);
+	for (; j < file.size() && this->locs_[file[j]]->object == object; ++j)
+	  (*this->linenos_)[file[j]] =
+	    Symbol_table::linenos_from_loc(*this->locs_[file[j]], lineinfo);
+	delete lineinfo;
+      }
+  }
+
+ private:
+  const Task* task_;
+  const std::vector<const Symbol_location*>& locs_;
+  const std::vector<std::vector<size_t> >& files_;
+  std::vector<std::vector<std::string> >* linenos_;
+};
+
+// Sort the indexes of locations in a file by object, so that each
+// object is read once.
+
+class Odr_location_object_compare
+{
+ public:
+  Odr_location_object_compare(const std::vector<const Symbol_location*>& locs)
+    : locs_(locs)
+  { }
+
+  bool
+  operator()(size_t i1, size_t i2) const
+  { return this->locs_[i1]->object < this->locs_[i2]->object; }
+
+ private:
+  const std::vector<const Symbol_location*>& locs_;
+};
+
 // OutputIterator that records if it was ever assigned to.  This
 // allows it to be used with std::set_intersection() to check for
 // intersection rather than computing the intersection.
@@ -3508,57 +3867,96 @@ struct Check_intersection
 
 void
 Symbol_table::detect_odr_violations(const Task* task,
-				    const char* output_file_name) const
+				    const char* output_file_name)
 {
+  Timer timer;
+  timer.start();
+
+  // Collect the locations of the symbols which have more than one,
+  // and group them by the input file which holds them.  NAMES[I] is
+  // the name of a symbol, and its locations are LOCS[STARTS[I]]
+  // through LOCS[STARTS[I + 1] - 1].
+  std::vector<const char*> names;
+  std::vector<size_t> starts;
+  std::vector<const Symbol_location*> locs;
+  std::vector<std::vector<size_t> > files;
+  Unordered_map<const Input_file*, size_t> file_indexes;
   for (Odr_map::const_iterator it = candidate_odr_violations_.begin();
        it != candidate_odr_violations_.end();
        ++it)
     {
-      const char* const symbol_name = it->first;
+      if (it->second.size() < 2)
+	continue;
+      names.push_back(it->first);
+      starts.push_back(locs.size());
+      for (Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
+	     p = it->second.begin();
+	   p != it->second.end();
+	   ++p)
+	{
+	  std::pair<Unordered_map<const Input_file*, size_t>::iterator, bool>
+	    ins = file_indexes.insert(std::make_pair(p->object->input_file(),
+						     files.size()));
+	  if (ins.second)
+	    files.push_back(std::vector<size_t>());
+	  files[ins.first->second].push_back(locs.size());
+	  locs.push_back(&*p);
+	}
+    }
+  starts.push_back(locs.size());
+
+  for (std::vector<std::vector<size_t> >::iterator p = files.begin();
+       p != files.end();
+       ++p)
+    std::stable_sort(p->begin(), p->end(), Odr_location_object_compare(locs));
 
-      std::string first_object_name;
-      std::vector<std::string> first_object_linenos;
+  // Find the line numbers of all the locations.  Each input file is
+  // read by only one job.
+  std::vector<std::vector<std::string> > linenos(locs.size());
+  Odr_lineno_jobs jobs(task, locs, files, &linenos);
+  jobs.run(files.size(), Parallel_jobs::default_thread_count());
 
-      Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
-          locs = it->second.begin();
-      const Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
-          locs_end = it->second.end();
-      for (; locs != locs_end && first_object_linenos.empty(); ++locs)
-        {
-          // Save the line numbers from the first definition to
-          // compare to the other definitions.  Ideally, we'd compare
-          // every definition to every other, but we don't want to
-          // take O(N^2) time to do this.  This shortcut may cause
-          // false negatives that appear or disappear depending on the
-          // link order, but it won't cause false positives.
-          first_object_name = locs->object->name();
-          first_object_linenos = this->linenos_from_loc(task, *locs);
-        }
-      if (first_object_linenos.empty())
+  for (size_t i = 0; i < names.size(); ++i)
+    {
+      const char* const symbol_name = names[i];
+      const size_t end = starts[i + 1];
+
+      // Save the line numbers from the first definition to compare
+      // to the other definitions.  Ideally, we'd compare every
+      // definition to every other, but we don't want to take O(N^2)
+      // time to do this.  This shortcut may cause false negatives
+      // that appear or disappear depending on the link order, but it
+      // won't cause false positives.
+      size_t first = end;
+      size_t j = starts[i];
+      for (; j < end && first == end; ++j)
+	if (!linenos[j].empty())
+	  first = j;
+      if (first == end)
 	continue;
 
       // Sort by Odr_violation_compare to make std::set_intersection work.
+      std::vector<std::string>& first_object_linenos(linenos[first]);
       std::string first_object_canonical_result = first_object_linenos.back();
       std::sort(first_object_linenos.begin(), first_object_linenos.end(),
                 Odr_violation_compare());
 
-      for (; locs != locs_end; ++locs)
+      for (; j < end; ++j)
         {
-          std::vector<std::string> linenos =
-              this->linenos_from_loc(task, *locs);
+          std::vector<std::string>& linenos_j(linenos[j]);
           // linenos will be empty if we couldn't parse the debug info.
-          if (linenos.empty())
+          if (linenos_j.empty())
             continue;
           // Sort by Odr_violation_compare to make std::set_intersection work.
-          gold_assert(!linenos.empty());
-          std::string second_object_canonical_result = linenos.back();
-          std::sort(linenos.begin(), linenos.end(), Odr_violation_compare());
+          std::string second_object_canonical_result = linenos_j.back();
+          std::sort(linenos_j.begin(), linenos_j.end(),
+		    Odr_violation_compare());
 
           Check_intersection intersection_result =
               std::set_intersection(first_object_linenos.begin(),
                                     first_object_linenos.end(),
-                                    linenos.begin(),
-                                    linenos.end(),
+                                    linenos_j.begin(),
+                                    linenos_j.end(),
                                     Check_intersection(),
                                     Odr_violation_compare());
           if (!intersection_result.had_intersection())
@@ -3572,10 +3970,10 @@ Symbol_table::detect_odr_violations(const Task* task,
               // set of locations, but that seems too verbose.
               fprintf(stderr, _("  %s from %s\n"),
                       first_object_canonical_result.c_str(),
-                      first_object_name.c_str());
+                      locs[first]->object->name().c_str());
               fprintf(stderr, _("  %s from %s\n"),
                       second_object_canonical_result.c_str(),
-                      locs->object->name().c_str());
+                      locs[j]->object->name().c_str());
               // Only print one broken pair, to avoid needing to
               // compare against a list of the disjoint definition
               // locations we've found so far.  (If we kept comparing
@@ -3586,8 +3984,11 @@ Symbol_table::detect_odr_violations(const Task* task,
             }
         }
     }
-  // We only call one_addr2line() in this function, so we can clear its cache.
-  Dwarf_line_info::clear_addr2line_cache();
+
+  this->odr_symbols_ = names.size();
+  this->odr_locations_ = locs.size();
+  this->odr_files_ = files.size();
+  this->odr_time_ = timer.get_elapsed_time();
 }
 
 // Warnings functions.
@@ -3660,6 +4061,15 @@ Sized_symbol<64>::allocate_common(Output_data*, Value_type);
 #endif
 
 #ifdef HAVE_TARGET_32_LITTLE
+template
+void
+Symbol_table::compute_symbol_name_infos<32, false>(
+    const unsigned char* syms,
+    size_t count,
+    const char* sym_names,
+    size_t sym_name_size,
+    Symbol_name_infos* infos);
+
 template
 void
 Symbol_table::add_from_relobj<32, false>(
@@ -3669,11 +4079,21 @@ Symbol_table::add_from_relobj<32, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_infos& name_infos,
     Sized_relobj_file<32, false>::Symbols* sympointers,
     size_t* defined);
 #endif
 
 #ifdef HAVE_TARGET_32_BIG
+template
+void
+Symbol_table::compute_symbol_name_infos<32, true>(
+    const unsigned char* syms,
+    size_t count,
+    const char* sym_names,
+    size_t sym_name_size,
+    Symbol_name_infos* infos);
+
 template
 void
 Symbol_table::add_from_relobj<32, true>(
@@ -3683,11 +4103,21 @@ Symbol_table::add_from_relobj<32, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_infos& name_infos,
     Sized_relobj_file<32, true>::Symbols* sympointers,
     size_t* defined);
 #endif
 
 #ifdef HAVE_TARGET_64_LITTLE
+template
+void
+Symbol_table::compute_symbol_name_infos<64, false>(
+    const unsigned char* syms,
+    size_t count,
+    const char* sym_names,
+    size_t sym_name_size,
+    Symbol_name_infos* infos);
+
 template
 void
 Symbol_table::add_from_relobj<64, false>(
@@ -3697,11 +4127,21 @@ Symbol_table::add_from_relobj<64, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_infos& name_infos,
     Sized_relobj_file<64, false>::Symbols* sympointers,
     size_t* defined);
 #endif
 
 #ifdef HAVE_TARGET_64_BIG
+template
+void
+Symbol_table::compute_symbol_name_infos<64, true>(
+    const unsigned char* syms,
+    size_t count,
+    const char* sym_names,
+    size_t sym_name_size,
+    Symbol_name_infos* infos);
+
 template
 void
 Symbol_table::add_from_relobj<64, true>(
@@ -3711,6 +4151,7 @@ Symbol_table::add_from_relobj<64, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_infos& name_infos,
     Sized_relobj_file<64, true>::Symbols* sympointers,
     size_t* defined);
 #endif
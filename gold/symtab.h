@@ -34,6 +34,7 @@
 #include "parameters.h"
 #include "stringpool.h"
 #include "object.h"
+#include "timer.h"
 
 namespace gold
 {
@@ -60,6 +61,9 @@ class Output_file;
 class Output_symtab_xindex;
 class Garbage_collection;
 class Icf;
+class Dwarf_line_info;
+class Workqueue;
+class Task_token;
 
 // The base class of an entry in the symbol table.  The symbol table
 // can have a lot of entries, so we don't want this class too big.
@@ -1415,10 +1419,22 @@ class Symbol_table
   inline void
   gc_mark_dyn_syms(Symbol* sym);
 
+  // Compute the Symbol_name_info for each of the COUNT external
+  // symbols SYMS, whose names are in SYM_NAMES, and store them in
+  // INFOS.  This does not use the symbol table, so it may be called
+  // from a Read_symbols task running in parallel with the tasks which
+  // add symbols to the table.
+  template<int size, bool big_endian>
+  static void
+  compute_symbol_name_infos(const unsigned char* syms, size_t count,
+			    const char* sym_names, size_t sym_name_size,
+			    Symbol_name_infos* infos);
+
   // Add COUNT external symbols from the relocatable object RELOBJ to
   // the symbol table.  SYMS is the symbols, SYMNDX_OFFSET is the
   // offset in the symbol table of the first symbol, SYM_NAMES is
-  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.  This sets
+  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.  NAME_INFOS
+  // is the result of compute_symbol_name_infos for SYMS.  This sets
   // SYMPOINTERS to point to the symbols in the symbol table.  It sets
   // *DEFINED to the number of defined symbols.
   template<int size, bool big_endian>
@@ -1426,7 +1442,7 @@ class Symbol_table
   add_from_relobj(Sized_relobj_file<size, big_endian>* relobj,
 		  const unsigned char* syms, size_t count,
 		  size_t symndx_offset, const char* sym_names,
-		  size_t sym_name_size,
+		  size_t sym_name_size, const Symbol_name_infos& name_infos,
 		  typename Sized_relobj_file<size, big_endian>::Symbols*,
 		  size_t* defined);
 
@@ -1561,7 +1577,7 @@ class Symbol_table
   // Check candidate_odr_violations_ to find symbols with the same name
   // but apparently different definitions (different source-file/line-no).
   void
-  detect_odr_violations(const Task*, const char* output_file_name) const;
+  detect_odr_violations(const Task*, const char* output_file_name);
 
   // Add any undefined symbols named on the command line to the symbol
   // table.
@@ -1631,11 +1647,13 @@ class Symbol_table
   output_count() const
   { return this->output_count_; }
 
-  // Write out the global symbols.
+  // Write out the global symbols.  This queues tasks on the
+  // Workqueue to write them, and the last of those tasks unblocks
+  // FINAL_BLOCKER.
   void
   write_globals(const Stringpool*, const Stringpool*,
 		Output_symtab_xindex*, Output_symtab_xindex*,
-		Output_file*) const;
+		Output_file*, Workqueue*, Task_token* final_blocker) const;
 
   // Write out a section symbol.  Return the updated offset.
   void
@@ -1859,10 +1877,14 @@ class Symbol_table
 			   Mapfile*, Sort_commons_order);
 
   // Returns all of the lines attached to LOC, not just the one the
-  // instruction actually came from.  This helps the ODR checker avoid
-  // false positives.
+  // instruction actually came from, using LINEINFO, the line
+  // information for the object of LOC.  This helps the ODR checker
+  // avoid false positives.
   static std::vector<std::string>
-  linenos_from_loc(const Task* task, const Symbol_location& loc);
+  linenos_from_loc(const Symbol_location& loc, Dwarf_line_info* lineinfo);
+
+  // Jobs which read the line numbers of the candidate ODR violations.
+  class Odr_lineno_jobs;
 
   // Implement detect_odr_violations.
   template<int size, bool big_endian>
@@ -1890,7 +1912,44 @@ class Symbol_table
   void
   sized_write_globals(const Stringpool*, const Stringpool*,
 		      Output_symtab_xindex*, Output_symtab_xindex*,
-		      Output_file*) const;
+		      Output_file*, Workqueue*, Task_token*) const;
+
+  // The state shared by the tasks which write the global symbols.
+  template<int size, bool big_endian>
+  class Write_globals_state;
+
+  // A task which writes a range of the global symbols.
+  template<int size, bool big_endian>
+  class Write_globals_range_task;
+
+  // A task which finishes writing the global symbols.
+  template<int size, bool big_endian>
+  class Write_globals_finish_task;
+
+  // Finish writing the global symbols, after all the ranges are
+  // written.
+  template<int size, bool big_endian>
+  void
+  sized_finish_write_globals(Write_globals_state<size, big_endian>*) const;
+
+  // A list of symbol indexes and the section indexes which must be
+  // recorded for them in an Output_symtab_xindex.
+  typedef std::vector<std::pair<unsigned int, unsigned int> > Xindex_list;
+
+  // A list of symbols and the unsupported section indexes which they
+  // are defined in.
+  typedef std::vector<std::pair<Symbol*, unsigned int> > Bad_shndx_list;
+
+  // Write out a global symbol to the views of the symbol table and
+  // the dynamic symbol table.  Add the symbol to SYMTAB_XINDEX or
+  // DYNSYM_XINDEX if it needs an extended section index.
+  template<int size, bool big_endian>
+  void
+  sized_write_global(Sized_symbol<size>*, const Stringpool* sympool,
+		     const Stringpool* dynpool, unsigned char* psyms,
+		     unsigned char* dynamic_view, Xindex_list* symtab_xindex,
+		     Xindex_list* dynsym_xindex,
+		     Bad_shndx_list* bad_shndx) const;
 
   // Write out a symbol to P.
   template<int size, bool big_endian>
@@ -1966,6 +2025,13 @@ class Symbol_table
   Warnings warnings_;
   // Manage potential One Definition Rule (ODR) violations.
   Odr_map candidate_odr_violations_;
+  // For --stats: the number of symbols checked for ODR violations, the
+  // number of their locations, the number of input files read to find
+  // the line numbers, and the time taken.
+  unsigned int odr_symbols_;
+  unsigned int odr_locations_;
+  unsigned int odr_files_;
+  Timer::TimeStats odr_time_;
 
   // When we emit a COPY reloc for a symbol, we define it in an
   // Output_data.  When it's time to emit version information for it,
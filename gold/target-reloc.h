@@ -113,6 +113,106 @@ scan_relocs(
     }
 }
 
+// Return true if a relocation against the global symbol GSYM can be
+// resolved at link time, so that it needs no PLT entry and no dynamic
+// relocation.  This is used by prescan_relocs, which runs in
+// parallel, so it does not look at a --dynamic-list.
+
+inline bool
+prescan_symbol_is_local(const Symbol* gsym)
+{
+  if (gsym->is_from_dynobj()
+      || !gsym->is_defined()
+      || gsym->type() == elfcpp::STT_GNU_IFUNC)
+    return false;
+  if (!parameters->options().shared()
+      || gsym->visibility() != elfcpp::STV_DEFAULT
+      || gsym->is_forced_local())
+    return true;
+  if (parameters->options().have_dynamic_list())
+    return false;
+  return !gsym->is_preemptible();
+}
+
+// This function implements the generic part of reloc prescanning.
+// It is called for different objects in parallel before any
+// relocations are scanned.  It copies to *PENDING the relocations
+// which scan_relocs must see, dropping the ones for which Scan would
+// do nothing.  The template parameter Scan must provide two static
+// functions, local_reloc_is_trivial() and global_reloc_is_trivial(),
+// which return true if local() or global() would do nothing for a
+// relocation.
+
+template<int size, bool big_endian, typename Scan, typename Classify_reloc>
+inline void
+prescan_relocs(
+    Symbol_table* symtab,
+    Sized_relobj_file<size, big_endian>* object,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    bool needs_special_offset_handling,
+    size_t local_count,
+    const unsigned char* plocal_syms,
+    std::vector<unsigned char>* pending)
+{
+  typedef typename Classify_reloc::Reltype Reltype;
+  const int reloc_size = Classify_reloc::reloc_size;
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+
+  // The output offsets are not known yet, so leave them to
+  // scan_relocs.
+  if (needs_special_offset_handling)
+    {
+      pending->assign(prelocs, prelocs + reloc_count * reloc_size);
+      return;
+    }
+
+  for (size_t i = 0; i < reloc_count; ++i, prelocs += reloc_size)
+    {
+      Reltype reloc(prelocs);
+
+      unsigned int r_sym = Classify_reloc::get_r_sym(&reloc);
+      unsigned int r_type = Classify_reloc::get_r_type(&reloc);
+
+      bool is_trivial;
+      if (r_sym < local_count)
+	{
+	  gold_assert(plocal_syms != NULL);
+	  typename elfcpp::Sym<size, big_endian> lsym(plocal_syms
+						      + r_sym * sym_size);
+	  unsigned int shndx = lsym.get_st_shndx();
+	  // Looking up an extended section index may read the
+	  // SHT_SYMTAB_SHNDX section, which is not safe to do here
+	  // without a lock, so leave those relocations to scan_relocs.
+	  if (shndx == elfcpp::SHN_XINDEX)
+	    is_trivial = false;
+	  else
+	    {
+	      bool is_ordinary;
+	      shndx = object->adjust_sym_shndx(r_sym, shndx, &is_ordinary);
+	      bool is_discarded = (is_ordinary
+				   && shndx != elfcpp::SHN_UNDEF
+				   && !object->is_section_included(shndx)
+				   && !symtab->is_section_folded(object,
+								 shndx));
+	      is_trivial = Scan::local_reloc_is_trivial(r_type, lsym,
+							is_discarded);
+	    }
+	}
+      else
+	{
+	  Symbol* gsym = object->global_symbol(r_sym);
+	  gold_assert(gsym != NULL);
+	  if (gsym->is_forwarder())
+	    gsym = symtab->resolve_forwards(gsym);
+	  is_trivial = Scan::global_reloc_is_trivial(r_type, gsym);
+	}
+
+      if (!is_trivial)
+	pending->insert(pending->end(), prelocs, prelocs + reloc_size);
+    }
+}
+
 // Behavior for relocations to discarded comdat sections.
 
 enum Comdat_behavior
@@ -395,6 +395,12 @@ class Target
     return this->do_relax(pass, input_objects, symtab, layout, task);
   }
 
+  // Print target specific statistics about relaxation to stderr.
+  // This is used for --stats.
+  void
+  print_relax_stats() const
+  { this->do_print_relax_stats(); }
+
   // Return the target-specific name of attributes section.  This is
   // NULL if a target does not use attributes section or if it uses
   // the default section name ".gnu.attributes".
@@ -737,6 +743,11 @@ class Target
   do_relax(int, const Input_objects*, Symbol_table*, Layout*, const Task*)
   { return false; }
 
+  // Virtual function which may be overridden by the child class.
+  virtual void
+  do_print_relax_stats() const
+  { }
+
   // A function for targets to call.  Return whether BYTES/LEN matches
   // VIEW/VIEW_SIZE at OFFSET.
   bool
@@ -899,6 +910,22 @@ class Sized_target : public Target
 	      size_t local_symbol_count,
 	      const unsigned char* plocal_symbols) = 0;
 
+  // Prescan the relocations for a section before calling scan_relocs.
+  // This is called for different objects in parallel, before any
+  // relocations are scanned, so it must not change anything but
+  // *PENDING.  Append to *PENDING the relocations which scan_relocs
+  // must see; the others must be relocations for which scan_relocs
+  // would do nothing, whatever other relocations it sees.  Return
+  // false if the target does not prescan, in which case scan_relocs
+  // sees all the relocations.  The other arguments are as for
+  // scan_relocs.
+  virtual bool
+  prescan_relocs(Symbol_table*, Sized_relobj_file<size, big_endian>*,
+		 unsigned int, unsigned int, const unsigned char*, size_t,
+		 bool, size_t, const unsigned char*,
+		 std::vector<unsigned char>*)
+  { return false; }
+
   // Relocate section data.  SH_TYPE is the type of the relocation
   // section, SHT_REL or SHT_RELA.  PRELOCS points to the relocation
   // information.  RELOC_COUNT is the number of relocs.
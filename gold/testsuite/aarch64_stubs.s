@@ -0,0 +1,18 @@
+	.text
+	.global	_start
+	.type	_start, %function
+_start:
+	bl	far_func
+	b	far_func
+	bl	near_func
+	ret
+
+	.type	near_func, %function
+near_func:
+	ret
+
+	.section .far,"ax",%progbits
+	.global	far_func
+	.type	far_func, %function
+far_func:
+	ret
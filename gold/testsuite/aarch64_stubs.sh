@@ -0,0 +1,80 @@
+#!/bin/sh
+
+# aarch64_stubs.sh -- test AArch64 long branch stubs.
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# aarch64_stubs.s has a call and a jump to far_func, which the linker
+# script puts out of range, and a call to near_func.  Both far branches
+# must go through one long branch stub after near_func.  Nothing moves
+# in the second relaxation pass, so it must not examine any stub group
+# again.
+
+check()
+{
+    file=$1
+    lbl=$2
+    line=$3
+    pattern=$4
+
+    found=`grep "<$lbl>:" $file`
+    if test -z "$found"; then
+        echo "Label $lbl not found."
+        exit 1
+    fi
+
+    match_pattern=`grep "<$lbl>:" -A$line $file | tail -n 1 | grep -e "$pattern"`
+    if test -z "$match_pattern"; then
+        echo "Expected pattern did not found in line $line after label $lbl:"
+        echo "    $pattern"
+        echo ""
+        echo "Extract:"
+        grep "<$lbl>:" -A$line $file
+        echo ""
+        echo "Actual output below:"
+        cat "$file"
+        exit 1
+    fi
+}
+
+check_stats()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected text in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check "aarch64_stubs.stdout" "_start" 1 "\<bl[[:space:]]\+400014 <near_func+0x4>"
+check "aarch64_stubs.stdout" "_start" 2 "\<b[[:space:]]\+400014 <near_func+0x4>"
+check "aarch64_stubs.stdout" "_start" 3 "\<bl[[:space:]]\+400010 <near_func>"
+check "aarch64_stubs.stdout" "near_func" 2 "\<adrp[[:space:]]\+x16, 10000000 <far_func>"
+check "aarch64_stubs.stdout" "near_func" 3 "\<add[[:space:]]\+x16, x16, #0x0\b"
+check "aarch64_stubs.stdout" "near_func" 4 "\<br[[:space:]]\+x16\b"
+
+check_stats "aarch64_stubs.err" "relaxation pass 1: stub groups: 2; examined: 1; branches: 2;"
+check_stats "aarch64_stubs.err" "relaxation pass 2: stub groups: 2; examined: 0;"
+
+exit 0
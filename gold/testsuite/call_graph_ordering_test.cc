@@ -0,0 +1,59 @@
+// call_graph_ordering_test.cc -- a test case for gold
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The goal of this program is to verify that --call-graph-ordering-file
+// places each callee after its heaviest caller, and the hottest
+// cluster first.  The functions are defined out of order.
+
+int hot3()
+{
+  return 3;
+}
+
+int cold2()
+{
+  return 2;
+}
+
+int hot2()
+{
+  return hot3() + 2;
+}
+
+int cold1()
+{
+  return cold2() + 1;
+}
+
+int hot1()
+{
+  return hot2() + 1;
+}
+
+int unlisted()
+{
+  return 0;
+}
+
+int main()
+{
+  return hot1() + cold1() + unlisted() - 9;
+}
@@ -0,0 +1,64 @@
+#!/bin/sh
+
+# call_graph_ordering_test.sh -- test --call-graph-ordering-file
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The goal of this program is to verify if --call-graph-ordering-file
+# works as intended.  File call_graph_ordering_test.cc is in this test.
+
+set -e
+
+check()
+{
+    awk "
+BEGIN { saw1 = 0; saw2 = 0; err = 0; }
+/.*$2\$/ { saw1 = 1; }
+/.*$3\$/ {
+     saw2 = 1;
+     if (!saw1)
+       {
+	  printf \"layout of $2 and $3 is not right\\n\";
+	  err = 1;
+	  exit 1;
+       }
+    }
+END {
+      if (!saw1 && !err)
+        {
+	  printf \"did not see $2\\n\";
+	  exit 1;
+	}
+      if (!saw2 && !err)
+	{
+	  printf \"did not see $3\\n\";
+	  exit 1;
+	}
+    }" $1
+}
+
+# A function not in the profile goes ahead of the ordered ones.
+check call_graph_ordering_test.stdout "_Z8unlistedv" "_Z4hot1v"
+# Each callee follows its heaviest caller.
+check call_graph_ordering_test.stdout "_Z4hot1v" "_Z4hot2v"
+check call_graph_ordering_test.stdout "_Z4hot2v" "_Z4hot3v"
+check call_graph_ordering_test.stdout "_Z5cold1v" "_Z5cold2v"
+# The hot cluster comes first.
+check call_graph_ordering_test.stdout "_Z4hot3v" "_Z5cold1v"
@@ -0,0 +1,57 @@
+#!/bin/sh
+
+# compress_threads_test.sh -- check debug sections compressed in chunks
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+
+# With --compress-debug-sections-threads a large debug section is
+# compressed in several chunks by separate tasks.  The sections of a
+# link compressed in a few large chunks and of one compressed in many
+# small chunks must decompress to the same bytes as the sections of an
+# uncompressed link.
+
+check_same()
+{
+    if ! cmp -s "$1" "$2"; then
+	echo "Debug sections differ between $1 and $2:"
+	diff -u "$1" "$2" | head -20
+	exit 1
+    fi
+}
+
+chunks()
+{
+    sed -n -e 's/.*compressed section chunks: \([0-9]*\)$/\1/p' "$1"
+}
+
+if ! grep -q "Hex dump of section '.debug_info'" compress_threads_test_1.stdout; then
+    echo "Missing .debug_info in compress_threads_test_1.stdout"
+    exit 1
+fi
+
+check_same compress_threads_test_1.stdout compress_threads_test_2.stdout
+check_same compress_threads_test_1.stdout compress_threads_test_3.stdout
+
+large=`chunks compress_threads_test_2.err`
+small=`chunks compress_threads_test_3.err`
+if test -z "$large" || test -z "$small" || test "$large" -lt 2 \
+   || test "$small" -le "$large"; then
+    echo "Unexpected chunk counts: $large large chunks, $small small chunks"
+    exit 1
+fi
+
+exit 0
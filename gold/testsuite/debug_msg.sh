@@ -117,6 +117,20 @@ then
   check debug_msg_cdebug.err "odr_violation2.cc:2[7-9]"
 fi
 
+# With --threads the line information of the objects is read in
+# parallel, but the errors should be the same and in the same order.
+# A linker without thread support warns about --threads.
+check debug_msg_threads.err ": symbol 'Ordering::operator()(int, int)' defined in multiple places (possible ODR violation):"
+check debug_msg_threads.err ": symbol 'SometimesInlineFunction(int)' defined in multiple places (possible ODR violation):"
+sed -e 's/debug_msg_threads/debug_msg/' -e '/ignoring --thread/d' \
+    debug_msg_threads.err > debug_msg_threads.cmp
+if ! cmp -s debug_msg.err debug_msg_threads.cmp
+then
+  echo "Errors differ between debug_msg.err and debug_msg_threads.err:"
+  diff -u debug_msg.err debug_msg_threads.cmp
+  exit 1
+fi
+
 # When linking together .so's, we don't catch the line numbers, but we
 # still find all the undefined variables, and the ODR violation.
 check debug_msg_so.err "debug_msg.so: error: undefined reference to 'undef_fn1()'"
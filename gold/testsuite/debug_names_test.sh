@@ -0,0 +1,54 @@
+#!/bin/sh
+
+# debug_names_test.sh -- a test case for the --debug-names option.
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected output:"
+	echo "   $2"
+	echo ""
+	echo "Actual error output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+STDOUT=debug_names_test.stdout
+
+check $STDOUT "^Contents of the .debug_names section"
+check $STDOUT "^Version 5"
+check $STDOUT "^CU table:"
+
+# Look for some of the names we know should be in the index.
+
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* main: .*DW_TAG_subprogram"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* int: .*DW_TAG_base_type"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* one: .*DW_TAG_namespace"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* c2<int>: .*DW_TAG_class_type"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* c1_count: .*DW_TAG_variable"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* F_A: .*DW_TAG_enumerator"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* anonymous_union_var: .*DW_TAG_variable"
+check $STDOUT "^\[ *[0-9]*\] #[0-9a-f]* inline_func_1: .*DW_TAG_subprogram"
+
+exit 0
@@ -0,0 +1,50 @@
+#!/bin/sh
+
+# eh_frame_hdr_order_test.sh -- check the order of the .eh_frame_hdr table
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# eh_frame_hdr_order_test.s has enough functions that with --threads
+# the .eh_frame_hdr table is sorted in slices which are then merged.
+# The functions are spread over .text.unlikely, .text.hot and .text,
+# which are placed in a different order than that of the FDEs.  The
+# .stdout files hold the table as pairs of decimal offsets.  The table
+# must be sorted by PC, with no two equal PCs, and must be the same as
+# in a serial link.
+
+count=`wc -l < eh_frame_hdr_order_test_1.stdout`
+if test "$count" -ne 120000; then
+    echo "Expected 120000 entries in eh_frame_hdr_order_test_1.stdout, found $count"
+    exit 1
+fi
+
+if ! awk 'NR > 1 && $1 <= prev { exit 1 } { prev = $1 }' \
+     eh_frame_hdr_order_test_2.stdout; then
+    echo "The .eh_frame_hdr table is not sorted in eh_frame_hdr_order_test_2.so"
+    exit 1
+fi
+
+if ! cmp -s eh_frame_hdr_order_test_1.stdout eh_frame_hdr_order_test_2.stdout; then
+    echo "The .eh_frame_hdr table differs with --threads"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,38 @@
+#!/bin/sh
+
+# eh_frame_parse_test.sh -- test an .eh_frame section gold can't parse
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# The .eh_frame section of eh_frame_parse_test_2.o has a CIE and an
+# FDE followed by data gold does not understand, so the section is
+# copied unchanged.  Its FDE must not also be attached to the CIE of
+# eh_frame_parse_test_1.o, which it shares.  The output should have
+# exactly one FDE for each function.
+
+fdes=`grep -c " FDE " eh_frame_parse_test.stdout`
+if test "$fdes" != "2"; then
+    echo "Expected 2 FDEs in eh_frame_parse_test.stdout, found $fdes:"
+    cat eh_frame_parse_test.stdout
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,8 @@
+	.text
+	.globl	eh_frame_parse_good
+	.type	eh_frame_parse_good, @function
+eh_frame_parse_good:
+	.cfi_startproc
+	ret
+	.cfi_endproc
+	.size	eh_frame_parse_good, .-eh_frame_parse_good
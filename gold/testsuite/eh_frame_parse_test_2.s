@@ -0,0 +1,39 @@
+	.text
+	.globl	eh_frame_parse_bad
+	.type	eh_frame_parse_bad, @function
+eh_frame_parse_bad:
+.Lbad:
+	ret
+	.size	eh_frame_parse_bad, .-eh_frame_parse_bad
+
+# An .eh_frame section which gold can not parse.  The CIE is the same
+# as the one the assembler writes for eh_frame_parse_test_1.s, so it
+# is merged with that one, and the FDE is read before gold finds the
+# data after the zero terminator.
+
+	.section .eh_frame,"a",@unwind
+.Lcie:
+	.long	.Lcie_end - .Lcie_id
+.Lcie_id:
+	.long	0
+	.byte	1
+	.string	"zR"
+	.uleb128 1
+	.sleb128 -8
+	.uleb128 16
+	.uleb128 1
+	.byte	0x1b
+	.byte	0x0c, 7, 8
+	.byte	0x90, 1
+	.balign	8
+.Lcie_end:
+	.long	.Lfde_end - .Lfde_id
+.Lfde_id:
+	.long	.Lfde_id - .Lcie
+	.long	.Lbad - .
+	.long	1
+	.uleb128 0
+	.balign	8
+.Lfde_end:
+	.long	0
+	.long	0
@@ -0,0 +1,121 @@
+// fast_hash_unittest.cc -- test and time the --build-id=fast hash
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sys/time.h>
+
+#include "md5.h"
+#include "sha1.h"
+#include "elfcpp.h"
+#include "fast-hash.h"
+
+#include "test.h"
+
+namespace gold_testsuite
+{
+
+using namespace gold;
+
+// The size of the buffer we time the hashes on.
+const size_t fast_hash_bench_size = 64 << 20;
+
+// Return the fast hash of the LEN bytes at S, which is the xxHash64
+// of S.
+
+static uint64_t
+xxhash64(const char* s, size_t len)
+{
+  unsigned char result[fast_hash_size];
+  fast_hash_buffer(s, len, result);
+  return elfcpp::Swap_unaligned<64, false>::readval(result);
+}
+
+// Hash the buffer with HASH_BUFFER, and report the throughput.
+
+static void
+time_hash(const char* name, void* (*hash_buffer)(const char*, size_t, void*),
+	  const char* buffer, size_t len)
+{
+  unsigned char result[20];
+  struct timeval start;
+  gettimeofday(&start, NULL);
+  hash_buffer(buffer, len, result);
+  struct timeval end;
+  gettimeofday(&end, NULL);
+
+  double secs = ((end.tv_sec - start.tv_sec)
+		 + (end.tv_usec - start.tv_usec) / 1e6);
+  if (secs <= 0)
+    secs = 1e-6;
+  double gb = static_cast<double>(len) / (1 << 30);
+  printf("%-5s %8.0f MB/s, %7.3f s per GB of output\n",
+	 name, len / secs / (1 << 20), secs / gb);
+}
+
+bool
+Fast_hash_test(Test_report*)
+{
+  // The result is xxHash64 with a seed of zero; check it against the
+  // published values.
+  CHECK(xxhash64("", 0) == 0xef46db3751d8e999ULL);
+  CHECK(xxhash64("a", 1) == 0xd24ec4f1a98c6e5bULL);
+  CHECK(xxhash64("abc", 3) == 0x44bc2cf5ad770999ULL);
+  const char* s = "Nobody inspects the spammish repetition";
+  CHECK(xxhash64(s, strlen(s)) == 0xfbcea83c8a378bf1ULL);
+
+  // Changing the length or the last byte changes the result.
+  char* buffer = new char[fast_hash_bench_size];
+  uint32_t x = 1;
+  for (size_t i = 0; i < fast_hash_bench_size; ++i)
+    {
+      x = x * 1103515245 + 12345;
+      buffer[i] = x >> 24;
+    }
+  unsigned char r1[fast_hash_size];
+  unsigned char r2[fast_hash_size];
+  for (size_t len = 0; len < 100; ++len)
+    {
+      fast_hash_buffer(buffer, len, r1);
+      fast_hash_buffer(buffer, len + 1, r2);
+      CHECK(memcmp(r1, r2, fast_hash_size) != 0);
+      if (len > 0)
+	{
+	  buffer[len - 1] ^= 1;
+	  fast_hash_buffer(buffer, len, r2);
+	  buffer[len - 1] ^= 1;
+	  CHECK(memcmp(r1, r2, fast_hash_size) != 0);
+	}
+    }
+
+  time_hash("md5", md5_buffer, buffer, fast_hash_bench_size);
+  time_hash("sha1", sha1_buffer, buffer, fast_hash_bench_size);
+  time_hash("fast", fast_hash_buffer, buffer, fast_hash_bench_size);
+
+  delete[] buffer;
+  return true;
+}
+
+Register_test fast_hash_register("Fast_hash", Fast_hash_test);
+
+} // End namespace gold_testsuite.
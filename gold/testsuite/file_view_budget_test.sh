@@ -0,0 +1,55 @@
+#!/bin/sh
+
+# file_view_budget_test.sh -- test --file-view-budget
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# The same program, which pulls many members out of the static C++
+# library, is linked without a budget, and with a budget small enough
+# that input file views are discarded, serially and with --threads.
+# The outputs must be the same.
+
+check()
+{
+    if ! grep -q "$2" "$1"; then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_same()
+{
+    if ! cmp -s "$1" "$2"; then
+	echo "$1 and $2 differ"
+	exit 1
+    fi
+}
+
+check file_view_budget_test_2.err "input file views discarded for budget: [1-9]"
+check file_view_budget_test_3.err "input file views discarded for budget: [1-9]"
+check_same file_view_budget_test_1 file_view_budget_test_2
+check_same file_view_budget_test_1 file_view_budget_test_3
+
+exit 0
@@ -0,0 +1,67 @@
+#!/bin/sh
+
+# gc_threads_test.sh -- compare --gc-sections with and without --threads
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# With --threads the sections referenced for --gc-sections are marked
+# by several tasks, each handling part of one level of the search.
+# gc_threads_test.c has a table referencing 2000 functions, enough for
+# several tasks, and each of those functions references another one.
+# The sections removed must be the same as in a serial link.  Any
+# warnings about --threads are ignored.
+
+removed()
+{
+    grep "removing unused section" "$1"
+}
+
+check_removed()
+{
+    if ! grep -q "'.text.$2' in file 'gc_threads_test.o'" "$1"; then
+	echo "Section .text.$2 not removed in $1"
+	exit 1
+    fi
+}
+
+check_kept()
+{
+    if grep -q "'.text.$2' in file 'gc_threads_test.o'" "$1"; then
+	echo "Section .text.$2 removed in $1"
+	exit 1
+    fi
+}
+
+check_removed gc_threads_test_1.stdout gc_threads_func_3999
+check_removed gc_threads_test_1.stdout gc_threads_leaf_3999
+check_kept gc_threads_test_1.stdout gc_threads_func_4000
+check_kept gc_threads_test_1.stdout gc_threads_leaf_4000
+
+removed gc_threads_test_1.stdout > gc_threads_test_1.removed
+removed gc_threads_test_2.stdout > gc_threads_test_2.removed
+
+if ! cmp -s gc_threads_test_1.removed gc_threads_test_2.removed; then
+    echo "Removed sections differ with --threads:"
+    diff -u gc_threads_test_1.removed gc_threads_test_2.removed | head -20
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,54 @@
+#!/bin/sh
+
+# hash_bloom_bits_test.sh -- test --hash-bloom-bits
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# The same shared library is linked with the default bloom filter,
+# with --hash-bloom-bits=1, which is smaller than the default and
+# must not shrink it, and with --hash-bloom-bits=512, which must
+# grow the .gnu.hash section.
+
+gnu_hash_size()
+{
+    size=`awk '{ for (i = 1; i < NF; i++)
+		   if ($i == ".gnu.hash") print $(i + 4) }' "$1"`
+    if test -z "$size"; then
+	echo "No .gnu.hash section in $1"
+	exit 1
+    fi
+    printf "%d" "0x$size"
+}
+
+size_default=`gnu_hash_size hash_bloom_bits_test_1.stdout` || exit 1
+size_1=`gnu_hash_size hash_bloom_bits_test_2.stdout` || exit 1
+size_512=`gnu_hash_size hash_bloom_bits_test_3.stdout` || exit 1
+
+if test "$size_1" -ne "$size_default"; then
+    echo ".gnu.hash size with --hash-bloom-bits=1 is $size_1, expected $size_default"
+    exit 1
+fi
+
+if test "$size_512" -le "$size_default"; then
+    echo ".gnu.hash size with --hash-bloom-bits=512 is $size_512, expected more than $size_default"
+    exit 1
+fi
+
+exit 0
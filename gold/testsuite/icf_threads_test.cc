@@ -0,0 +1,73 @@
+// icf_threads_test.cc -- a test case for gold
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This file is compiled several times with a different value of
+// FILE, so that the link has several input files whose sections may
+// be read and checksummed by separate tasks.  The func functions fold
+// into five groups in the first ICF iteration, and the call functions
+// fold in the second iteration once their callees have been folded.
+
+#define NAME2(prefix, file, k) prefix ## file ## _ ## k
+#define NAME(prefix, file, k) NAME2(prefix, file, k)
+
+#define FUNCS(k, m)						\
+  int NAME(icf_threads_func_, FILE, k)(int a)			\
+  { return a * m + 1; }						\
+  int NAME(icf_threads_call_, FILE, k)(int a)			\
+  { return NAME(icf_threads_func_, FILE, k)(a) + 1; }
+
+FUNCS(1, 2)
+FUNCS(2, 3)
+FUNCS(3, 4)
+FUNCS(4, 5)
+FUNCS(5, 6)
+FUNCS(6, 2)
+FUNCS(7, 3)
+FUNCS(8, 4)
+FUNCS(9, 5)
+FUNCS(10, 6)
+FUNCS(11, 2)
+FUNCS(12, 3)
+FUNCS(13, 4)
+FUNCS(14, 5)
+FUNCS(15, 6)
+FUNCS(16, 2)
+FUNCS(17, 3)
+FUNCS(18, 4)
+FUNCS(19, 5)
+FUNCS(20, 6)
+
+#if FILE == 1
+
+int icf_threads_call_2_3(int);
+int icf_threads_call_3_8(int);
+int icf_threads_call_4_20(int);
+
+int
+main()
+{
+  return (icf_threads_call_1_1(0)
+	  + icf_threads_call_2_3(0)
+	  + icf_threads_call_3_8(0)
+	  + icf_threads_call_4_20(0)) == 8 ? 0 : 1;
+}
+
+#endif
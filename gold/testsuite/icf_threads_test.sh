@@ -0,0 +1,49 @@
+#!/bin/sh
+
+# icf_threads_test.sh -- compare --icf with and without --threads
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# With --threads the sections of the input files are read and
+# checksummed for --icf by separate tasks.  The sections folded must
+# be the same as in a serial link.  The timing lines printed for each
+# ICF iteration are ignored.
+
+folded()
+{
+    grep "ICF folding section" "$1" | sed -e 's/^[^:]*: //'
+}
+
+folded icf_threads_test_1.stdout > icf_threads_test_1.folded
+folded icf_threads_test_2.stdout > icf_threads_test_2.folded
+
+if ! grep -q "icf_threads_call_4_20" icf_threads_test_1.folded; then
+    echo "Missing folded sections in icf_threads_test_1.stdout"
+    exit 1
+fi
+
+if ! cmp -s icf_threads_test_1.folded icf_threads_test_2.folded; then
+    echo "Folded sections differ with --threads:"
+    diff -u icf_threads_test_1.folded icf_threads_test_2.folded | head -20
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,74 @@
+#!/bin/sh
+
+# link_cache_test.sh -- test --link-cache
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# The same program is linked several times with --link-cache and
+# --stats, and each link's statistics are in link_cache_test_N.err:
+#  1: the first link, which misses;
+#  2: the same link, which finds the manifest of link 1 and its output;
+#  3: after an input file is edited, which misses;
+#  4: the same link, which finds the manifest of link 3;
+#  5: after a library appears earlier in the search path, which misses;
+#  6, 7: a link issuing warnings, which is not added to the cache, so
+#     that link 7 misses and repeats the warnings;
+#  8: with --link-cache-size=1, which removes everything it adds.
+
+check()
+{
+    if ! grep -q "$2" "$1"; then
+	echo "Did not find expected output in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_result()
+{
+    check "$1" "link cache: $2\$"
+    check "$1" "link cache manifest: $3\$"
+}
+
+check_result link_cache_test_1.err miss "not found"
+check_result link_cache_test_2.err hit hit
+check_result link_cache_test_3.err miss miss
+check_result link_cache_test_4.err hit hit
+check_result link_cache_test_5.err miss miss
+check_result link_cache_test_6.err miss "not found"
+check_result link_cache_test_7.err miss "not found"
+check link_cache_test_7.err "warning: "
+check link_cache_test_8.err "link cache files removed: [1-9]"
+
+if ! cmp -s link_cache_test_1.out link_cache_test_2.out; then
+    echo "link_cache_test_2.out differs from link_cache_test_1.out"
+    exit 1
+fi
+
+if ls link_cache_test.dir | grep -q "\.output\$"; then
+    echo "link_cache_test.dir was not emptied by --link-cache-size=1"
+    exit 1
+fi
+
+exit 0
@@ -0,0 +1,48 @@
+// map_json_test.cc -- a test case for gold --Map-format=json
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The goal of this program is to check that the JSON map records
+// sections folded by --icf and sections removed by --gc-sections.
+// folded_func must be folded into kept_func, and unused_func must be
+// garbage collected.  It also checks that a section name which is not
+// valid UTF-8 is escaped.
+
+int kept_func()
+{
+  return 1;
+}
+
+int folded_func()
+{
+  return 1;
+}
+
+int unused_func()
+{
+  return 2;
+}
+
+int bad_name_var __attribute__((section(".data.bad\xff"))) = 1;
+
+int main()
+{
+  return kept_func() + folded_func() + bad_name_var - 3;
+}
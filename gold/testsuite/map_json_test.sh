@@ -0,0 +1,50 @@
+#!/bin/sh
+
+# map_json_test.sh -- test --Map-format=json
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# File map_json_test.cc is in this test.  This checks that the JSON
+# map lists the folded and the garbage collected sections, and the
+# symbols of the kept sections, and that it escapes bytes which are
+# not valid UTF-8.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected text in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check map_json_test.map '^{$'
+check map_json_test.map '"name": ".text._Z11folded_funcv", .*"reason": "icf", "folded_into": {"file": "map_json_test.o"'
+check map_json_test.map '"name": ".text._Z11unused_funcv", .*"reason": "gc"'
+check map_json_test.map '{"name": ".text", "address": "0x'
+check map_json_test.map '{"name": "_Z9kept_funcv", "demangled": "kept_func()", "address": "0x[0-9a-f]*", "size": [1-9]'
+check map_json_test.map '{"name": ".data.bad\\u00ff", "file": "map_json_test.o"'
+check map_json_test.map '^}$'
+
+exit 0
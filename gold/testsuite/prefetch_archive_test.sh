@@ -0,0 +1,52 @@
+#!/bin/sh
+
+# prefetch_archive_test.sh -- test --prefetch-archive-members
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This links thin_archive_main.o against an archive of the thin
+# archive test objects with --prefetch-archive-members.  Each member
+# is only referenced by the member after it, so the members must be
+# found over several passes of the archive map.  Check that all of
+# them are loaded and that the prefetch found at least one of them.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected text in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check prefetch_archive_test.err "archive libraries: 1$"
+check prefetch_archive_test.err "loaded archive members: 4$"
+check prefetch_archive_test.err "prefetched archive members: [1-9]"
+
+check prefetch_archive_test.stdout " T _Z2t1v$"
+check prefetch_archive_test.stdout " T _Z2t2v$"
+check prefetch_archive_test.stdout " T _Z2t3v$"
+check prefetch_archive_test.stdout " T _Z2t4v$"
+
+exit 0
@@ -0,0 +1,61 @@
+// prescan_relocs_test.cc -- test the parallel relocation prescan.
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The prescan drops calls to functions which can not be preempted
+// before the serial scan.  Calls to the other functions must still
+// get PLT entries.  prescan_relocs_test.sh checks the PLT relocations
+// in shared libraries built from this file.
+
+extern "C"
+{
+
+__attribute__ ((visibility ("hidden"))) int
+hidden_func()
+{
+  return 1;
+}
+
+__attribute__ ((visibility ("protected"))) int
+protected_func()
+{
+  return 2;
+}
+
+int
+listed_func()
+{
+  return 3;
+}
+
+int
+unlisted_func()
+{
+  return 4;
+}
+
+int
+call_funcs()
+{
+  return (hidden_func() + protected_func() + listed_func()
+	  + unlisted_func());
+}
+
+}
@@ -0,0 +1,67 @@
+#!/bin/sh
+
+# prescan_relocs_test.sh -- test the parallel relocation prescan
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# prescan_relocs_test_1.so is a plain shared library, so the calls to
+# the default visibility functions need PLT entries.
+# prescan_relocs_test_2.so is linked with -Bsymbolic-functions and a
+# dynamic list which only exports listed_func.  The prescan leaves
+# those calls to the serial scan, which must only make a PLT entry for
+# listed_func.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected text in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected text in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check prescan_relocs_test_1.stdout "JUMP_SLOT.* listed_func"
+check prescan_relocs_test_1.stdout "JUMP_SLOT.* unlisted_func"
+check_missing prescan_relocs_test_1.stdout "hidden_func"
+check_missing prescan_relocs_test_1.stdout "protected_func"
+
+check prescan_relocs_test_2.stdout "JUMP_SLOT.* listed_func"
+check_missing prescan_relocs_test_2.stdout "unlisted_func"
+check_missing prescan_relocs_test_2.stdout "hidden_func"
+check_missing prescan_relocs_test_2.stdout "protected_func"
+
+exit 0
@@ -0,0 +1,42 @@
+#!/bin/sh
+
+# streamed_merge_test.sh -- test --no-mmap-output-file with merged sections
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# The same objects are linked with the output file mapped, and
+# streamed with and without --threads.  The views of the merged
+# string sections overlap the views of the regular .rodata sections
+# in the same output section, and the streamed outputs must be the
+# same as the mapped one.
+
+check_same()
+{
+    if ! cmp -s "$1" "$2"; then
+	echo "$1 and $2 differ"
+	exit 1
+    fi
+}
+
+check_same streamed_merge_test_1 streamed_merge_test_3
+check_same streamed_merge_test_2 streamed_merge_test_3
+
+exit 0
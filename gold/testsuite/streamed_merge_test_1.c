@@ -0,0 +1,52 @@
+/* streamed_merge_test_1.c -- test --no-mmap-output-file with merged
+   sections, file 1 of 2.
+
+   Copyright (C) 2017 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   Each file has a regular .rodata section followed by a merged
+   string section, which go in the same output section.  Relocating
+   the merged section needs a view of the whole output section, which
+   overlaps the view of the regular section when the output file is
+   streamed.  There is no startup code, so no other object has a view
+   of the whole output section first.  */
+
+extern const char streamed_table_2[];
+extern const char *streamed_str_2 (void);
+
+const char streamed_table_1[] = "regular rodata 1";
+
+const char *
+streamed_str_1 (void)
+{
+  return "merged string 1";
+}
+
+const char * volatile streamed_result[4];
+
+void _start (void);
+
+void
+_start (void)
+{
+  streamed_result[0] = streamed_table_1;
+  streamed_result[1] = streamed_str_1 ();
+  streamed_result[2] = streamed_table_2;
+  streamed_result[3] = streamed_str_2 ();
+}
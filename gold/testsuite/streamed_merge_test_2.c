@@ -0,0 +1,33 @@
+/* streamed_merge_test_2.c -- test --no-mmap-output-file with merged
+   sections, file 2 of 2.
+
+   Copyright (C) 2017 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   See streamed_merge_test_1.c for details.  */
+
+const char *streamed_str_2 (void);
+
+const char streamed_table_2[] = "regular rodata 2";
+
+const char *
+streamed_str_2 (void)
+{
+  return "merged string 2";
+}
@@ -0,0 +1,64 @@
+#!/bin/sh
+
+# threads_symtab_test.sh -- compare the symbol tables of --threads links
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+
+# The global symbols are written in ranges by separate tasks.  The
+# symbol tables of a shared library with enough symbols to need
+# several ranges must be the same when it is linked with --threads as
+# when it is linked serially.
+
+check_same()
+{
+    if ! cmp -s "$1" "$2"; then
+	echo "Symbol tables differ between $1 and $2:"
+	diff -u "$1" "$2" | head -20
+	exit 1
+    fi
+}
+
+if ! grep -q "threads_symtab_func_10000" threads_symtab_test_1.stdout; then
+    echo "Missing symbols in threads_symtab_test_1.stdout"
+    exit 1
+fi
+
+check_same threads_symtab_test_1.stdout threads_symtab_test_2.stdout
+check_same threads_symtab_test_1.stdout threads_symtab_test_3.stdout
+
+# The names of the symbols are also hashed in parallel when the
+# objects are read.  Check C++ names, versioned names, and template
+# instances defined in more than one object.
+for sym in _ZN18threads_symtab_cxx1a9func_2000Ei \
+	   _ZN18threads_symtab_cxx1b9func_2000Ei \
+	   _ZN18threads_symtab_cxx3BoxILi2000EE3getEv \
+	   threads_symtab_cxx_ver_2000@VER_1 \
+	   threads_symtab_cxx_ver_2000@@VER_2; do
+    if ! grep -q " $sym\$" threads_symtab_cxx_test_1.stdout; then
+	echo "Missing $sym in threads_symtab_cxx_test_1.stdout"
+	exit 1
+    fi
+done
+
+check_same threads_symtab_cxx_test_1.stdout threads_symtab_cxx_test_2.stdout
+check_same threads_symtab_cxx_test_1.stdout threads_symtab_cxx_test_3.stdout
+
+exit 0
@@ -0,0 +1,74 @@
+#!/bin/sh
+
+# trace_tasks_test.sh -- test --trace-tasks
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This checks that the --trace-tasks output of linking basic_test.o
+# is a valid JSON trace.  gold writes one event per line, so each line
+# is matched against the JSON grammar of the event it must hold.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected text in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+TRACE=trace_tasks_test.json
+
+check $TRACE '"name":"Add_symbols [^"]*basic_test.o","cat":"Add_symbols","ph":"X"'
+check $TRACE '"name":"process_name"'
+
+LC_ALL=C awk '
+BEGIN {
+  s = "\"([^\"\\\\]|\\\\[\"\\\\/bfnrt]|\\\\u[0-9a-f][0-9a-f][0-9a-f][0-9a-f])*\"";
+  n = "[0-9]+";
+  first = "^\\{\"traceEvents\":\\[$";
+  task = "^\\{\"name\":" s ",\"cat\":" s ",\"ph\":\"X\",\"pid\":1,\"tid\":" n ",\"ts\":" n ",\"dur\":" n "(,\"args\":\\{\"blocked_us\":" n ",\"ready_us\":" n "\\})?\\},$";
+  thread = "^\\{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" n ",\"args\":\\{\"name\":" s "\\}\\},$";
+  process = "^\\{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":\\{\"name\":" s "\\}\\}$";
+  last = "^\\],\"displayTimeUnit\":\"ms\"\\}$";
+  state = 0;
+}
+state == 0 && $0 ~ first { state = 1; next; }
+state == 1 && $0 ~ task { next; }
+(state == 1 || state == 2) && $0 ~ thread { state = 2; next; }
+state == 2 && $0 ~ process { state = 3; next; }
+state == 3 && $0 ~ last { state = 4; next; }
+{
+  printf "unexpected line %d: %s\n", NR, $0;
+  exit 1;
+}
+END {
+  if (state != 4)
+    {
+      printf "incomplete trace\n";
+      exit 1;
+    }
+}' $TRACE || { cat $TRACE; exit 1; }
+
+exit 0
@@ -0,0 +1,47 @@
+// ver_glob_test.cc -- test wildcard matching in ver_glob_test.map
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+extern "C" {
+void glob_q1() {} // VER_1
+void glob_q12() {} // local
+void glob_ra() {} // VER_1
+void glob_rc() {} // VER_1
+void glob_rd() {} // local
+void glob_x_suffix_end() {} // VER_1
+void glob_x_suffix_end2() {} // local
+void glob_a_x_b_y_c() {} // VER_1
+void glob_abc() {} // VER_1
+void glob_a_x_c_y_b() {} // local
+// Names with the UTF-8 characters U+00FC and U+00FD after "glob_",
+// with the bytes written out.
+void glob_nonascii_1() __asm__("glob_\303\274x");
+void glob_nonascii_1() {} // VER_1
+void glob_nonascii_2() __asm__("glob_\303\275y");
+void glob_nonascii_2() {} // VER_2
+void glob_nonascii_3() __asm__("glob_\303\275z");
+void glob_nonascii_3() {} // local
+}
+
+namespace ns
+{
+void lastwin(int) {} // VER_2, from the C++ block
+void cwins(int) {} // VER_2, from the C pattern
+}
@@ -0,0 +1,86 @@
+#!/bin/sh
+
+# ver_glob_test.sh -- test wildcard matching in version scripts
+
+# Copyright (C) 2017 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# This file goes with ver_glob_test.cc, whose symbols are given
+# versions by the patterns in ver_glob_test.map.  We check the
+# version of each symbol in the resulting shared object, and that
+# the symbols matched only by "local: *" are not exported.  When
+# several patterns match a symbol, the last one wins, whether it is
+# in a C or a C++ block.
+
+check()
+{
+    if ! grep -q "$2" "$1"
+    then
+	echo "Did not find expected symbol in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+check_missing()
+{
+    if grep -q "$2" "$1"
+    then
+	echo "Found unexpected symbol in $1:"
+	echo "   $2"
+	echo ""
+	echo "Actual output below:"
+	cat "$1"
+	exit 1
+    fi
+}
+
+# glob_q?
+check ver_glob_test.stdout "VER_1  *glob_q1$"
+check_missing ver_glob_test.stdout "glob_q12$"
+
+# glob_r[a-c]
+check ver_glob_test.stdout "VER_1  *glob_ra$"
+check ver_glob_test.stdout "VER_1  *glob_rc$"
+check_missing ver_glob_test.stdout "glob_rd$"
+
+# *_suffix_end
+check ver_glob_test.stdout "VER_1  *glob_x_suffix_end$"
+check_missing ver_glob_test.stdout "glob_x_suffix_end2$"
+
+# glob_a*b*c
+check ver_glob_test.stdout "VER_1  *glob_a_x_b_y_c$"
+check ver_glob_test.stdout "VER_1  *glob_abc$"
+check_missing ver_glob_test.stdout "glob_a_x_c_y_b$"
+
+# glob_*x and "glob_\303\275y"
+check ver_glob_test.stdout "VER_1  *glob_`printf '\303\274'`x$"
+check ver_glob_test.stdout "VER_2  *glob_`printf '\303\275'`y$"
+check_missing ver_glob_test.stdout "glob_`printf '\303\275'`z$"
+
+# The last match wins.
+check ver_glob_test.stdout "VER_2  *ns::lastwin(int)$"
+check ver_glob_test.stdout "VER_2  *ns::cwins(int)$"
+
+check ver_glob_test.err "version script lookup time: "
+
+exit 0
@@ -0,0 +1,187 @@
+// workqueue_unittest.cc -- test and time the gold workqueue
+
+// Copyright (C) 2017 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+#include "gold.h"
+
+#include <cstdio>
+#include <sys/time.h>
+
+#include "errors.h"
+#include "options.h"
+#include "parameters.h"
+#include "workqueue.h"
+
+#include "test.h"
+
+namespace gold_testsuite
+{
+
+using namespace gold;
+
+// The number of groups of tasks, and the number of tasks in each
+// group.
+const int workqueue_groups = 256;
+const int workqueue_group_size = 64;
+
+// The number of tasks run, the number of tasks currently holding the
+// shared lock, and the number of times we saw more than one.
+static unsigned int tasks_run;
+static unsigned int lock_holders;
+static unsigned int lock_violations;
+
+// A task which does no work, like a Read_symbols task which holds a
+// blocker for the task which follows it.
+
+class Work_task : public Task
+{
+ public:
+  Work_task(Task_token* next_blocker)
+    : next_blocker_(next_blocker)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->next_blocker_); }
+
+  void
+  run(Workqueue*)
+  { __sync_fetch_and_add(&tasks_run, 1); }
+
+  std::string
+  get_name() const
+  { return "Work_task"; }
+
+ private:
+  Task_token* next_blocker_;
+};
+
+// A task which waits for a group of Work_tasks, and then takes a lock
+// shared by all the groups, like an Add_symbols task.
+
+class Follow_task : public Task
+{
+ public:
+  Follow_task(Task_token* this_blocker, Task_token* lock)
+    : this_blocker_(this_blocker), lock_(lock)
+  { }
+
+  ~Follow_task()
+  { delete this->this_blocker_; }
+
+  Task_token*
+  is_runnable()
+  {
+    if (this->this_blocker_->is_blocked())
+      return this->this_blocker_;
+    if (!this->lock_->is_writable())
+      return this->lock_;
+    return NULL;
+  }
+
+  void
+  locks(Task_locker* tl)
+  { tl->add(this, this->lock_); }
+
+  void
+  run(Workqueue*)
+  {
+    if (__sync_add_and_fetch(&lock_holders, 1) != 1)
+      __sync_fetch_and_add(&lock_violations, 1);
+    __sync_fetch_and_add(&tasks_run, 1);
+    __sync_fetch_and_sub(&lock_holders, 1);
+  }
+
+  std::string
+  get_name() const
+  { return "Follow_task"; }
+
+ private:
+  Task_token* this_blocker_;
+  Task_token* lock_;
+};
+
+// Run the tasks using THREADS threads, and report the time taken to
+// dispatch each task.
+
+static bool
+run_workqueue(Test_report*, const General_options& options, int threads)
+{
+  Workqueue* workqueue = new Workqueue(options);
+  Task_token* lock = new Task_token(false);
+
+  tasks_run = 0;
+  lock_violations = 0;
+  for (int i = 0; i < workqueue_groups; ++i)
+    {
+      Task_token* blocker = new Task_token(true);
+      blocker->add_blockers(workqueue_group_size);
+      for (int j = 0; j < workqueue_group_size; ++j)
+	workqueue->queue(new Work_task(blocker));
+      workqueue->queue(new Follow_task(blocker, lock));
+    }
+
+  struct timeval start;
+  gettimeofday(&start, NULL);
+  workqueue->set_thread_count(threads);
+  workqueue->process(0);
+  struct timeval end;
+  gettimeofday(&end, NULL);
+
+  unsigned int count = workqueue_groups * (workqueue_group_size + 1);
+  CHECK(tasks_run == count);
+  CHECK(lock_violations == 0);
+
+  double usecs = ((end.tv_sec - start.tv_sec) * 1e6
+		  + (end.tv_usec - start.tv_usec));
+  printf("%3d threads: %u tasks in %.0f us, %.0f ns per task\n",
+	 threads, count, usecs, usecs * 1000 / count);
+
+  // This waits for the worker threads to exit.
+  delete workqueue;
+  delete lock;
+
+  return true;
+}
+
+bool
+Workqueue_test(Test_report* report)
+{
+  Errors errors(gold::program_name);
+  set_parameters_errors(&errors);
+
+  Command_line command_line;
+  const char* args[] = { "--threads" };
+  command_line.process(1, args);
+  set_parameters_options(&command_line.options());
+
+  return (run_workqueue(report, command_line.options(), 1)
+	  && run_workqueue(report, command_line.options(), 8)
+	  && run_workqueue(report, command_line.options(), 32)
+	  && run_workqueue(report, command_line.options(), 128));
+}
+
+Register_test workqueue_register("Workqueue", Workqueue_test);
+
+} // End namespace gold_testsuite.
@@ -61,6 +61,11 @@ class Task_list
   Task*
   pop_front();
 
+  // Remove the last Task on the list and return it.  Return NULL if
+  // the list is empty.
+  Task*
+  pop_back();
+
  private:
   // The start of the list.  NULL if the list is empty.
   Task* head_;
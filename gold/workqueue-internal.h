@@ -91,17 +91,26 @@ class Workqueue_threader_threadpool : public Workqueue_threader
   process(int thread_number)
   { this->get_workqueue()->process(thread_number); }
 
+  // Note that a thread has exited.
+  void
+  thread_exited();
+
  private:
   // This is set if we need to check the thread count.
   volatile sig_atomic_t check_thread_count_;
 
   // Lock for the remaining members.
   Lock lock_;
+  // Signalled when a thread exits.
+  Condvar exit_condvar_;
   // The number of threads we want to create.  This is set to zero
   // when all threads should exit.
   int desired_thread_count_;
   // The number of threads currently running.
   int threads_;
+  // The number of threads which have been created and have not yet
+  // exited.
+  int live_threads_;
 };
 
 } // End namespace gold.
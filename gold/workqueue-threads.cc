@@ -114,11 +114,14 @@ Workqueue_thread::thread_body(void* arg)
 {
   Workqueue_thread* pwt = reinterpret_cast<Workqueue_thread*>(arg);
 
-  pwt->threadpool_->process(pwt->thread_number_);
+  Workqueue_threader_threadpool* threadpool = pwt->threadpool_;
+  threadpool->process(pwt->thread_number_);
 
   // Delete the thread object as we exit.
   delete pwt;
 
+  threadpool->thread_exited();
+
   return NULL;
 }
 
@@ -131,8 +134,10 @@ Workqueue_threader_threadpool::Workqueue_threader_threadpool(
   : Workqueue_threader(workqueue),
     check_thread_count_(0),
     lock_(),
+    exit_condvar_(this->lock_),
     desired_thread_count_(1),
-    threads_(1)
+    threads_(1),
+    live_threads_(0)
 {
 }
 
@@ -140,8 +145,13 @@ Workqueue_threader_threadpool::Workqueue_threader_threadpool(
 
 Workqueue_threader_threadpool::~Workqueue_threader_threadpool()
 {
-  // Tell the threads to exit.
+  // Tell the threads to exit, and wait for them, since they use the
+  // Workqueue.
   this->get_workqueue()->set_thread_count(0);
+
+  Hold_lock hl(this->lock_);
+  while (this->live_threads_ > 0)
+    this->exit_condvar_.wait();
 }
 
 // Set the thread count.
@@ -157,6 +167,8 @@ Workqueue_threader_threadpool::set_thread_count(int thread_count)
     create = this->desired_thread_count_ - this->threads_;
     if (create < 0)
       this->check_thread_count_ = 1;
+    else
+      this->live_threads_ += create;
   }
 
   if (create > 0)
@@ -171,6 +183,16 @@ Workqueue_threader_threadpool::set_thread_count(int thread_count)
     }
 }
 
+// Note that a thread has exited.
+
+void
+Workqueue_threader_threadpool::thread_exited()
+{
+  Hold_lock hl(this->lock_);
+  --this->live_threads_;
+  this->exit_condvar_.signal();
+}
+
 // Return whether the current thread should be cancelled.
 
 bool
@@ -22,6 +22,12 @@
 
 #include "gold.h"
 
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <sys/time.h>
+
 #include "debug.h"
 #include "options.h"
 #include "timer.h"
@@ -47,6 +53,7 @@ Task_list::push_back(Task* t)
   else
     {
       this->tail_->set_list_next(t);
+      t->set_list_prev(this->tail_);
       this->tail_ = t;
     }
 }
@@ -65,6 +72,7 @@ Task_list::push_front(Task* t)
   else
     {
       t->set_list_next(this->head_);
+      this->head_->set_list_prev(t);
       this->head_ = t;
     }
 }
@@ -88,12 +96,183 @@ Task_list::pop_front()
 	{
 	  this->head_ = ret->list_next();
 	  gold_assert(this->head_ != NULL);
+	  this->head_->set_list_prev(NULL);
 	  ret->clear_list_next();
 	}
     }
   return ret;
 }
 
+// Remove and return the last Task on the list.
+
+inline Task*
+Task_list::pop_back()
+{
+  Task* ret = this->tail_;
+  if (ret != NULL)
+    {
+      if (ret == this->head_)
+	{
+	  gold_assert(ret->list_next() == NULL);
+	  this->head_ = NULL;
+	  this->tail_ = NULL;
+	}
+      else
+	{
+	  this->tail_ = ret->list_prev();
+	  gold_assert(this->tail_ != NULL);
+	  this->tail_->clear_list_next();
+	  ret->set_list_prev(NULL);
+	}
+    }
+  return ret;
+}
+
+// Class Workqueue_trace records the tasks run for --trace-tasks, and
+// writes them out in the Chrome trace event format, which can be
+// viewed with chrome://tracing or Perfetto.  Each task is an event on
+// the thread which ran it, and records how long the task waited for
+// Task_tokens and how long it was ready to run before a thread picked
+// it up.  The times a thread spends waiting for a task to run are
+// events too.  The Workqueue lock must be held when calling the
+// member functions.
+
+class Workqueue_trace
+{
+ public:
+  Workqueue_trace(const char* filename)
+    : filename_(filename), start_time_(Workqueue_trace::now()), events_(),
+      written_(false)
+  { }
+
+  // Return the current time in microseconds.
+  static uint64_t
+  now()
+  {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+  }
+
+  // Record that THREAD ran the task named NAME from START to END.
+  void
+  add_task(int thread, const std::string& name, uint64_t start, uint64_t end,
+	   uint64_t blocked_time, uint64_t ready_time)
+  {
+    this->events_.push_back(Event(name, thread, start, end, blocked_time,
+				  ready_time));
+  }
+
+  // Record that THREAD waited for a task to run from START to END.
+  void
+  add_idle(int thread, uint64_t start, uint64_t end)
+  { this->events_.push_back(Event("", thread, start, end, 0, 0)); }
+
+  // Write out the trace.
+  void
+  write();
+
+ private:
+  struct Event
+  {
+    Event(const std::string& name_arg, int thread_arg, uint64_t start_arg,
+	  uint64_t end_arg, uint64_t blocked_time_arg,
+	  uint64_t ready_time_arg)
+      : name(name_arg), thread(thread_arg), start(start_arg), end(end_arg),
+	blocked_time(blocked_time_arg), ready_time(ready_time_arg)
+    { }
+
+    // The name of the task, or empty for a thread waiting for a task.
+    std::string name;
+    int thread;
+    uint64_t start;
+    uint64_t end;
+    uint64_t blocked_time;
+    uint64_t ready_time;
+  };
+
+  // Write S as a JSON string to F.
+  static void
+  write_string(FILE* f, const std::string& s);
+
+  // The file to write.
+  const char* filename_;
+  // The time at which we started tracing.
+  uint64_t start_time_;
+  // The events recorded.
+  std::vector<Event> events_;
+  // Whether we have written the trace.
+  bool written_;
+};
+
+// Write S to F as a JSON string.
+
+void
+Workqueue_trace::write_string(FILE* f, const std::string& s)
+{
+  write_json_string(f, s.data(), s.length());
+}
+
+// Write the trace.  Each task is a complete event, named by the task,
+// and categorized by the first word of its name, which is usually the
+// name of the Task class.
+
+void
+Workqueue_trace::write()
+{
+  if (this->written_)
+    return;
+  this->written_ = true;
+
+  FILE* f = fopen(this->filename_, "w");
+  if (f == NULL)
+    {
+      gold_error(_("cannot open --trace-tasks file %s: %s"),
+		 this->filename_, strerror(errno));
+      return;
+    }
+
+  fprintf(f, "{\"traceEvents\":[\n");
+  int max_thread = 0;
+  for (std::vector<Event>::const_iterator p = this->events_.begin();
+       p != this->events_.end();
+       ++p)
+    {
+      if (p->thread > max_thread)
+	max_thread = p->thread;
+      fprintf(f, "{\"name\":");
+      if (p->name.empty())
+	fprintf(f, "\"(idle)\",\"cat\":\"idle\"");
+      else
+	{
+	  write_string(f, p->name);
+	  fprintf(f, ",\"cat\":");
+	  write_string(f, p->name.substr(0, p->name.find(' ')));
+	}
+      fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%llu,"
+	      "\"dur\":%llu",
+	      p->thread,
+	      static_cast<unsigned long long>(p->start - this->start_time_),
+	      static_cast<unsigned long long>(p->end - p->start));
+      if (!p->name.empty())
+	fprintf(f, ",\"args\":{\"blocked_us\":%llu,\"ready_us\":%llu}",
+		static_cast<unsigned long long>(p->blocked_time),
+		static_cast<unsigned long long>(p->ready_time));
+      fprintf(f, "},\n");
+    }
+  for (int i = 0; i <= max_thread; ++i)
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+	    "\"tid\":%d,\"args\":{\"name\":\"thread %d\"}},\n", i, i);
+  fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+	  "\"args\":{\"name\":");
+  write_string(f, program_name);
+  fprintf(f, "}}\n],\"displayTimeUnit\":\"ms\"}\n");
+
+  if (fclose(f) != 0)
+    gold_error(_("cannot write --trace-tasks file %s: %s"),
+	       this->filename_, strerror(errno));
+}
+
 // The simple single-threaded implementation of Workqueue_threader.
 
 class Workqueue_threader_single : public Workqueue_threader
@@ -122,8 +301,16 @@ Workqueue::Workqueue(const General_options& options)
     tasks_(),
     running_(0),
     waiting_(0),
+    thread_tasks_(),
+    thread_tasks_count_(0),
+    use_thread_tasks_(false),
+    thread_count_(1),
+    tasks_run_(0),
+    thread_tasks_run_(0),
+    tasks_stolen_(0),
     condvar_(this->lock_),
-    threader_(NULL)
+    threader_(NULL),
+    trace_(NULL)
 {
   bool threads = options.threads();
 #ifndef ENABLE_THREADS
@@ -135,14 +322,43 @@ Workqueue::Workqueue(const General_options& options)
     {
 #ifdef ENABLE_THREADS
       this->threader_ = new Workqueue_threader_threadpool(this);
+      this->use_thread_tasks_ = true;
+      // The list for the main thread.  set_thread_count adds the
+      // lists for the other threads.
+      this->thread_tasks_.push_back(new Task_list());
+      Parallel_jobs::set_workqueue(this);
 #else
       gold_unreachable();
 #endif
     }
+
+  if (options.trace_tasks() != NULL)
+    this->trace_ = new Workqueue_trace(options.trace_tasks());
 }
 
 Workqueue::~Workqueue()
 {
+  if (this->use_thread_tasks_)
+    Parallel_jobs::set_workqueue(NULL);
+
+  // Wait for the threads to exit before freeing what they use.
+  delete this->threader_;
+  for (std::vector<Task_list*>::iterator p = this->thread_tasks_.begin();
+       p != this->thread_tasks_.end();
+       ++p)
+    delete *p;
+  delete this->trace_;
+}
+
+// When tracing, note that T is waiting for a Task_token if IS_BLOCKED,
+// or is ready to run otherwise.  This must be called with the
+// Workqueue lock held.
+
+inline void
+Workqueue::trace_state(Task* t, bool is_blocked)
+{
+  if (this->trace_ != NULL)
+    t->set_trace_state(Workqueue_trace::now(), is_blocked);
 }
 
 // Add a task to the end of a specific queue, or put it on the list
@@ -154,6 +370,7 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
   Hold_lock hl(this->lock_);
 
   Task_token* token = t->is_runnable();
+  this->trace_state(t, token != NULL);
   if (token != NULL)
     {
       if (front)
@@ -222,6 +439,7 @@ Workqueue::find_runnable_in_list(Task_list* tasks)
       if (token == NULL)
 	return t;
 
+      this->trace_state(t, true);
       token->add_waiting(t);
       ++this->waiting_;
     }
@@ -230,15 +448,90 @@ Workqueue::find_runnable_in_list(Task_list* tasks)
   return NULL;
 }
 
+// Return the list of tasks made runnable by THREAD_NUMBER.  The
+// workqueue lock must be held when this is called.
+
+Task_list*
+Workqueue::thread_list(int thread_number)
+{
+  gold_assert(thread_number >= 0
+	      && static_cast<size_t>(thread_number)
+		  < this->thread_tasks_.size());
+  return this->thread_tasks_[thread_number];
+}
+
+// Find a runnable task on the list of tasks made runnable by
+// THREAD_NUMBER.  If STEAL is false, the thread is looking at its own
+// list, and we take the newest task, whose data is most likely to
+// still be in the cache.  Otherwise we take the oldest task.  If we
+// find a Task waiting for a Token, add it to the list for that Token.
+// The workqueue lock must be held when this is called.
+
+Task*
+Workqueue::find_runnable_in_thread_list(int thread_number, bool steal)
+{
+  Task_list* tasks = this->thread_list(thread_number);
+  Task* t;
+  while ((t = steal ? tasks->pop_front() : tasks->pop_back()) != NULL)
+    {
+      --this->thread_tasks_count_;
+
+      Task_token* token = t->is_runnable();
+      if (token == NULL)
+	{
+	  if (steal)
+	    ++this->tasks_stolen_;
+	  else
+	    ++this->thread_tasks_run_;
+	  return t;
+	}
+
+      this->trace_state(t, true);
+      token->add_waiting(t);
+      ++this->waiting_;
+    }
+  return NULL;
+}
+
+// Move the tasks made runnable by THREAD_NUMBER to the end of the
+// common list, because the thread is exiting.  The workqueue lock must
+// be held when this is called.
+
+void
+Workqueue::release_thread_list(int thread_number)
+{
+  Task_list* tasks = this->thread_list(thread_number);
+  if (tasks->empty())
+    return;
+  Task* t;
+  while ((t = tasks->pop_front()) != NULL)
+    {
+      --this->thread_tasks_count_;
+      this->tasks_.push_back(t);
+    }
+  this->condvar_.broadcast();
+}
+
 // Find a runnable task.  Return NULL if none could be found.  The
 // workqueue lock must be held when this is called.
 
 Task*
-Workqueue::find_runnable()
+Workqueue::find_runnable(int thread_number)
 {
   Task* t = this->find_runnable_in_list(&this->first_tasks_);
+  if (t == NULL && this->thread_tasks_count_ > 0)
+    t = this->find_runnable_in_thread_list(thread_number, false);
   if (t == NULL)
     t = this->find_runnable_in_list(&this->tasks_);
+  if (t == NULL && this->thread_tasks_count_ > 0)
+    {
+      // Take a task from another thread, starting with the next one,
+      // so that the threads do not all look at the same list.
+      size_t count = this->thread_tasks_.size();
+      for (size_t i = 1; i < count && t == NULL; ++i)
+	t = this->find_runnable_in_thread_list((thread_number + i) % count,
+					       true);
+    }
   return t;
 }
 
@@ -249,13 +542,14 @@ Workqueue::find_runnable()
 Task*
 Workqueue::find_runnable_or_wait(int thread_number)
 {
-  Task* t = this->find_runnable();
+  Task* t = this->find_runnable(thread_number);
 
   while (t == NULL)
     {
       if (this->running_ == 0
 	  && this->first_tasks_.empty()
-	  && this->tasks_.empty())
+	  && this->tasks_.empty()
+	  && this->thread_tasks_count_ == 0)
 	{
 	  // Kick all the threads to make them exit.
 	  this->condvar_.broadcast();
@@ -265,15 +559,24 @@ Workqueue::find_runnable_or_wait(int thread_number)
 	}
 
       if (this->should_cancel_thread(thread_number))
-	return NULL;
+	{
+	  this->release_thread_list(thread_number);
+	  return NULL;
+	}
 
       gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
 
+      uint64_t idle_start = this->trace_ == NULL ? 0 : Workqueue_trace::now();
+
       this->condvar_.wait();
 
+      if (this->trace_ != NULL)
+	this->trace_->add_idle(thread_number, idle_start,
+			       Workqueue_trace::now());
+
       gold_debug(DEBUG_TASK, "%3d awake", thread_number);
 
-      t = this->find_runnable();
+      t = this->find_runnable(thread_number);
     }
 
   return t;
@@ -305,6 +608,7 @@ Workqueue::find_and_run_task(int thread_number)
     t->locks(&tl);
 
     ++this->running_;
+    ++this->tasks_run_;
   }
 
   while (t != NULL)
@@ -316,8 +620,20 @@ Workqueue::find_and_run_task(int thread_number)
       if (is_debugging_enabled(DEBUG_TASK))
         timer.start();
 
+      uint64_t trace_start = 0;
+      uint64_t trace_end = 0;
+      if (this->trace_ != NULL)
+	{
+	  // Get the name now, as the task may change while it runs.
+	  t->name();
+	  trace_start = Workqueue_trace::now();
+	}
+
       t->run(this);
 
+      if (this->trace_ != NULL)
+	trace_end = Workqueue_trace::now();
+
       if (is_debugging_enabled(DEBUG_TASK))
         {
           Timer::TimeStats elapsed = timer.get_elapsed_time();
@@ -335,14 +651,22 @@ Workqueue::find_and_run_task(int thread_number)
       {
 	Hold_lock hl(this->lock_);
 
+	if (this->trace_ != NULL)
+	  {
+	    t->set_trace_state(trace_start, false);
+	    this->trace_->add_task(thread_number, t->name(), trace_start,
+				   trace_end, t->trace_blocked_time(),
+				   t->trace_ready_time());
+	  }
+
 	--this->running_;
 
 	// Release the locks for the task.  This must be done with the
 	// workqueue lock held.  Get the next Task to run if any.
-	next = this->release_locks(t, &tl);
+	next = this->release_locks(t, &tl, thread_number);
 
 	if (next == NULL)
-	  next = this->find_runnable();
+	  next = this->find_runnable(thread_number);
 
 	// If we have another Task to run, get the Locks.  This must
 	// be called while we are still holding the Workqueue lock.
@@ -352,6 +676,7 @@ Workqueue::find_and_run_task(int thread_number)
 	    next->locks(&tl);
 
 	    ++this->running_;
+	    ++this->tasks_run_;
 	  }
       }
 
@@ -371,7 +696,10 @@ Workqueue::find_and_run_task(int thread_number)
 
 // 2) Otherwise, T is runnable.  If *PRET is not NULL, then we have
 // already decided which Task to run next.  Add T to the list of
-// runnable tasks, and signal another thread.
+// runnable tasks, and signal another thread.  When using threads, the
+// list is the one for THREAD_NUMBER, the thread which made T
+// runnable; another thread which runs out of work will take T from
+// it.
 
 // 3) Otherwise, *PRET is NULL.  If IS_BLOCKER is false, then T was
 // waiting on a write lock.  We can grab that lock now, so we run T
@@ -394,9 +722,11 @@ Workqueue::find_and_run_task(int thread_number)
 // Return true if we set *PRET to T, false otherwise.
 
 bool
-Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
+Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret,
+			   int thread_number)
 {
   Task_token* token = t->is_runnable();
+  this->trace_state(t, token != NULL);
 
   if (token != NULL)
     {
@@ -414,7 +744,9 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
     should_return = true;
   else if (t->should_run_soon())
     should_return = true;
-  else if (!this->first_tasks_.empty() || !this->tasks_.empty())
+  else if (!this->first_tasks_.empty()
+	   || !this->tasks_.empty()
+	   || this->thread_tasks_count_ > 0)
     should_queue = true;
   else
     should_return = true;
@@ -429,6 +761,11 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
     {
       if (t->should_run_soon())
 	this->first_tasks_.push_back(t);
+      else if (this->use_thread_tasks_)
+	{
+	  this->thread_list(thread_number)->push_back(t);
+	  ++this->thread_tasks_count_;
+	}
       else
 	this->tasks_.push_back(t);
       this->condvar_.signal();
@@ -438,13 +775,13 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
   gold_unreachable();
 }
 
-// Release the locks associated with a Task.  Return the first
-// runnable Task that we find.  If we find more runnable tasks, add
-// them to the run queue and signal any other threads.  This must be
-// called with the Workqueue lock held.
+// Release the locks associated with a Task, which was run by
+// THREAD_NUMBER.  Return the first runnable Task that we find.  If we
+// find more runnable tasks, add them to the run queue and signal any
+// other threads.  This must be called with the Workqueue lock held.
 
 Task*
-Workqueue::release_locks(Task* t, Task_locker* tl)
+Workqueue::release_locks(Task* t, Task_locker* tl, int thread_number)
 {
   Task* ret = NULL;
   for (Task_locker::iterator p = tl->begin(); p != tl->end(); ++p)
@@ -460,7 +797,7 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	      while ((t = token->remove_first_waiting()) != NULL)
 		{
 		  --this->waiting_;
-		  this->return_or_queue(t, true, &ret);
+		  this->return_or_queue(t, true, &ret, thread_number);
 		}
 	    }
 	}
@@ -477,7 +814,7 @@ Workqueue::release_locks(Task* t, Task_locker* tl)
 	  while ((t = token->remove_first_waiting()) != NULL)
 	    {
 	      --this->waiting_;
-	      if (this->return_or_queue(t, false, &ret))
+	      if (this->return_or_queue(t, false, &ret, thread_number))
 		break;
 	    }
 	}
@@ -504,11 +841,27 @@ Workqueue::set_thread_count(int threads)
 {
   Hold_lock hl(this->lock_);
 
+  // Thread numbers are always less than the largest thread count, so
+  // make the lists for any new threads here.
+  if (this->use_thread_tasks_)
+    while (this->thread_tasks_.size() < static_cast<size_t>(threads))
+      this->thread_tasks_.push_back(new Task_list());
+
+  this->thread_count_ = threads;
   this->threader_->set_thread_count(threads);
   // Wake up all the threads, since something has changed.
   this->condvar_.broadcast();
 }
 
+// Return the thread count.
+
+int
+Workqueue::thread_count()
+{
+  Hold_lock hl(this->lock_);
+  return this->thread_count_;
+}
+
 // Add a new blocker to an existing Task_token.
 
 void
@@ -518,4 +871,31 @@ Workqueue::add_blocker(Task_token* token)
   token->add_blocker();
 }
 
+// Write the trace of the tasks run.
+
+void
+Workqueue::write_trace()
+{
+  Hold_lock hl(this->lock_);
+  if (this->trace_ != NULL)
+    this->trace_->write();
+}
+
+// Print statistics.
+
+void
+Workqueue::print_stats()
+{
+  Hold_lock hl(this->lock_);
+  fprintf(stderr, _("%s: workqueue tasks run: %u\n"),
+	  program_name, this->tasks_run_);
+  if (this->use_thread_tasks_)
+    {
+      fprintf(stderr, _("%s: workqueue tasks run from own thread list: %u\n"),
+	      program_name, this->thread_tasks_run_);
+      fprintf(stderr, _("%s: workqueue tasks stolen from other threads: %u\n"),
+	      program_name, this->tasks_stolen_);
+    }
+}
+
 } // End namespace gold.
@@ -28,6 +28,7 @@
 #define GOLD_WORKQUEUE_H
 
 #include <string>
+#include <vector>
 
 #include "gold-threads.h"
 #include "token.h"
@@ -45,7 +46,9 @@ class Task
 {
  public:
   Task()
-    : list_next_(NULL), name_(), should_run_soon_(false)
+    : list_next_(NULL), list_prev_(NULL), name_(), should_run_soon_(false),
+      trace_is_blocked_(false), trace_time_(0), trace_blocked_time_(0),
+      trace_ready_time_(0)
   { }
   virtual ~Task()
   { }
@@ -96,6 +99,43 @@ class Task
   clear_list_next()
   { this->list_next_ = NULL; }
 
+  // Get the previous Task on the list of Tasks.  Called by Task_list.
+  Task*
+  list_prev() const
+  { return this->list_prev_; }
+
+  // Set the previous Task on the list of Tasks.  Called by Task_list.
+  void
+  set_list_prev(Task* t)
+  { this->list_prev_ = t; }
+
+  // Note that at time NOW, in microseconds, the Task started waiting
+  // for a Task_token if IS_BLOCKED, or was ready to run otherwise.
+  // Called by the Workqueue when tracing tasks.
+  void
+  set_trace_state(uint64_t now, bool is_blocked)
+  {
+    if (this->trace_time_ != 0)
+      {
+	if (this->trace_is_blocked_)
+	  this->trace_blocked_time_ += now - this->trace_time_;
+	else
+	  this->trace_ready_time_ += now - this->trace_time_;
+      }
+    this->trace_is_blocked_ = is_blocked;
+    this->trace_time_ = now;
+  }
+
+  // The time the Task spent waiting for a Task_token.
+  uint64_t
+  trace_blocked_time() const
+  { return this->trace_blocked_time_; }
+
+  // The time the Task spent ready to run, waiting for a thread.
+  uint64_t
+  trace_ready_time() const
+  { return this->trace_ready_time_; }
+
   // Return the name of the Task.  This is only used for debugging
   // purposes.
   const std::string&
@@ -122,11 +162,21 @@ class Task
   // a container, in order to avoid memory allocation while holding
   // the Workqueue lock.
   Task* list_next_;
+  // If this Task is on a list, this is a pointer to the previous Task
+  // on the list, so that we can remove Tasks from either end.
+  Task* list_prev_;
   // Task name, for debugging purposes.
   std::string name_;
   // Whether this Task should be executed soon.  This is used for
   // Tasks which can be run after some data is read.
   bool should_run_soon_;
+  // When tracing tasks, whether the Task is waiting for a Task_token,
+  // the time at which it started waiting or became ready to run, and
+  // the total times it has spent in each state.
+  bool trace_is_blocked_;
+  uint64_t trace_time_;
+  uint64_t trace_blocked_time_;
+  uint64_t trace_ready_time_;
 };
 
 // An interface for Task_function.  This is a convenience class to run
@@ -194,6 +244,7 @@ class Task_function : public Task
 // The workqueue itself.
 
 class Workqueue_threader;
+class Workqueue_trace;
 
 class Workqueue
 {
@@ -227,12 +278,26 @@ class Workqueue
   void
   set_thread_count(int);
 
+  // Return the number of threads set by set_thread_count.  This is
+  // the thread count for the current phase of the link, which is
+  // shared by the Tasks and the Parallel_jobs they run.
+  int
+  thread_count();
+
   // Add a new blocker to an existing Task_token. This must be done
   // with the workqueue lock held.  This should not be done routinely,
   // only in special circumstances.
   void
   add_blocker(Task_token*);
 
+  // Write the trace of the tasks run, if --trace-tasks was used.
+  void
+  write_trace();
+
+  // Print statistics.
+  void
+  print_stats();
+
  private:
   // This class can not be copied.
   Workqueue(const Workqueue&);
@@ -248,28 +313,45 @@ class Workqueue
 
   // Find a runnable task.
   Task*
-  find_runnable();
+  find_runnable(int thread_number);
 
   // Find a runnable task in a list.
   Task*
   find_runnable_in_list(Task_list*);
 
+  // Find a runnable task in the list of a thread.
+  Task*
+  find_runnable_in_thread_list(int thread_number, bool steal);
+
+  // Return the list of tasks made runnable by a thread.
+  Task_list*
+  thread_list(int thread_number);
+
+  // Move the tasks on the list of a thread to the common list.
+  void
+  release_thread_list(int thread_number);
+
   // Find an run a task.
   bool
   find_and_run_task(int);
 
   // Release the locks for a Task.  Return the next Task to run.
   Task*
-  release_locks(Task*, Task_locker*);
+  release_locks(Task*, Task_locker*, int thread_number);
 
   // Store T into *PRET, or queue it as appropriate.
   bool
-  return_or_queue(Task* t, bool is_blocker, Task** pret);
+  return_or_queue(Task* t, bool is_blocker, Task** pret, int thread_number);
 
   // Return whether to cancel this thread.
   bool
   should_cancel_thread(int thread_number);
 
+  // When tracing, note that T is waiting for a Task_token if
+  // IS_BLOCKED, or is ready to run otherwise.
+  void
+  trace_state(Task* t, bool is_blocked);
+
   // Master Workqueue lock.  This controls access to the following
   // member variables.
   Lock lock_;
@@ -281,6 +363,23 @@ class Workqueue
   int running_;
   // Number of tasks waiting for a lock to release.
   int waiting_;
+  // When using threads, the lists of tasks made runnable by each
+  // thread, indexed by thread number.  A thread runs the tasks on its
+  // own list newest first, and when it runs out of work it takes the
+  // oldest tasks from the lists of other threads.
+  std::vector<Task_list*> thread_tasks_;
+  // The number of tasks on the thread_tasks_ lists.
+  int thread_tasks_count_;
+  // Whether to use thread_tasks_.
+  bool use_thread_tasks_;
+  // The thread count set by set_thread_count.
+  int thread_count_;
+  // The number of tasks run, the number which a thread took from its
+  // own list, and the number which it took from the list of another
+  // thread.
+  unsigned int tasks_run_;
+  unsigned int thread_tasks_run_;
+  unsigned int tasks_stolen_;
   // Condition variable associated with lock_.  This is signalled when
   // there may be a new Task to execute.
   Condvar condvar_;
@@ -288,6 +387,9 @@ class Workqueue
   // The threading implementation.  This is set at construction time
   // and not changed thereafter.
   Workqueue_threader* threader_;
+  // The trace of the tasks run, or NULL if we are not tracing.
+  // Accessed with lock_ held.
+  Workqueue_trace* trace_;
 };
 
 } // End namespace gold.
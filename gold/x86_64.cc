@@ -625,6 +625,19 @@ class Target_x86_64 : public Sized_target<size, false>
 	      size_t local_symbol_count,
 	      const unsigned char* plocal_symbols);
 
+  // Prescan the relocations, dropping the ones that need no work.
+  bool
+  prescan_relocs(Symbol_table* symtab,
+		 Sized_relobj_file<size, false>* object,
+		 unsigned int data_shndx,
+		 unsigned int sh_type,
+		 const unsigned char* prelocs,
+		 size_t reloc_count,
+		 bool needs_special_offset_handling,
+		 size_t local_symbol_count,
+		 const unsigned char* plocal_symbols,
+		 std::vector<unsigned char>* pending);
+
   // Finalize the sections.
   void
   do_finalize_sections(Layout*, const Input_objects*, Symbol_table*);
@@ -874,6 +887,16 @@ class Target_x86_64 : public Sized_target<size, false>
     static inline int
     get_reference_flags(unsigned int r_type);
 
+    // Return true if local() or global() would do nothing for a
+    // relocation.  These are called by prescan_relocs.
+    static inline bool
+    local_reloc_is_trivial(unsigned int r_type,
+			   const elfcpp::Sym<size, false>& lsym,
+			   bool is_discarded);
+
+    static inline bool
+    global_reloc_is_trivial(unsigned int r_type, const Symbol* gsym);
+
     inline void
     local(Symbol_table* symtab, Layout* layout, Target_x86_64* target,
 	  Sized_relobj_file<size, false>* object,
@@ -2794,6 +2817,82 @@ Target_x86_64<size>::Scan::get_reference_flags(unsigned int r_type)
     }
 }
 
+// Return true if Scan::local would do nothing for a relocation.
+
+template<int size>
+inline bool
+Target_x86_64<size>::Scan::local_reloc_is_trivial(
+    unsigned int r_type,
+    const elfcpp::Sym<size, false>& lsym,
+    bool is_discarded)
+{
+  if (is_discarded)
+    return true;
+  if (lsym.get_st_type() == elfcpp::STT_GNU_IFUNC)
+    return false;
+
+  switch (r_type)
+    {
+    case elfcpp::R_X86_64_NONE:
+    case elfcpp::R_X86_64_GNU_VTINHERIT:
+    case elfcpp::R_X86_64_GNU_VTENTRY:
+    case elfcpp::R_X86_64_PC64:
+    case elfcpp::R_X86_64_PC32:
+    case elfcpp::R_X86_64_PC32_BND:
+    case elfcpp::R_X86_64_PC16:
+    case elfcpp::R_X86_64_PC8:
+    case elfcpp::R_X86_64_PLT32:
+    case elfcpp::R_X86_64_PLT32_BND:
+      return true;
+
+    case elfcpp::R_X86_64_64:
+    case elfcpp::R_X86_64_32:
+    case elfcpp::R_X86_64_32S:
+    case elfcpp::R_X86_64_16:
+    case elfcpp::R_X86_64_8:
+      return !parameters->options().output_is_position_independent();
+
+    default:
+      return false;
+    }
+}
+
+// Return true if Scan::global would do nothing for a relocation.
+
+template<int size>
+inline bool
+Target_x86_64<size>::Scan::global_reloc_is_trivial(unsigned int r_type,
+						    const Symbol* gsym)
+{
+  if (!prescan_symbol_is_local(gsym))
+    return false;
+
+  switch (r_type)
+    {
+    case elfcpp::R_X86_64_NONE:
+    case elfcpp::R_X86_64_GNU_VTINHERIT:
+    case elfcpp::R_X86_64_GNU_VTENTRY:
+    case elfcpp::R_X86_64_PC64:
+    case elfcpp::R_X86_64_PC32:
+    case elfcpp::R_X86_64_PC32_BND:
+    case elfcpp::R_X86_64_PC16:
+    case elfcpp::R_X86_64_PC8:
+    case elfcpp::R_X86_64_PLT32:
+    case elfcpp::R_X86_64_PLT32_BND:
+      return true;
+
+    case elfcpp::R_X86_64_64:
+    case elfcpp::R_X86_64_32:
+    case elfcpp::R_X86_64_32S:
+    case elfcpp::R_X86_64_16:
+    case elfcpp::R_X86_64_8:
+      return !parameters->options().output_is_position_independent();
+
+    default:
+      return false;
+    }
+}
+
 // Report an unsupported relocation against a local symbol.
 
 template<int size>
@@ -3822,6 +3921,40 @@ Target_x86_64<size>::scan_relocs(Symbol_table* symtab,
     plocal_symbols);
 }
 
+// Prescan relocations for a section.
+
+template<int size>
+bool
+Target_x86_64<size>::prescan_relocs(Symbol_table* symtab,
+				    Sized_relobj_file<size, false>* object,
+				    unsigned int,
+				    unsigned int sh_type,
+				    const unsigned char* prelocs,
+				    size_t reloc_count,
+				    bool needs_special_offset_handling,
+				    size_t local_symbol_count,
+				    const unsigned char* plocal_symbols,
+				    std::vector<unsigned char>* pending)
+{
+  typedef gold::Default_classify_reloc<elfcpp::SHT_RELA, size, false>
+      Classify_reloc;
+
+  // Leave the error to scan_relocs.
+  if (sh_type == elfcpp::SHT_REL)
+    return false;
+
+  gold::prescan_relocs<size, false, Scan, Classify_reloc>(
+    symtab,
+    object,
+    prelocs,
+    reloc_count,
+    needs_special_offset_handling,
+    local_symbol_count,
+    plocal_symbols,
+    pending);
+  return true;
+}
+
 // Finalize the sections.
 
 template<int size>